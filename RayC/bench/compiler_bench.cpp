@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <ray/compiler/ast/arena.hpp>
+#include <ray/compiler/ast/flat.hpp>
+#include <ray/compiler/ast/flatBuilder.hpp>
+#include <ray/compiler/driver.hpp>
+#include <ray/compiler/environment/dataModel/dataModel.hpp>
+#include <ray/compiler/generators/c/c_transpiler.hpp>
+#include <ray/compiler/lang/moduleStore.hpp>
+#include <ray/compiler/lang/sourceUnit.hpp>
+#include <ray/compiler/lexer/lexer.hpp>
+#include <ray/compiler/lexer/token_stream.hpp>
+#include <ray/compiler/parser/parser.hpp>
+#include <ray/compiler/passes/typeChecker.hpp>
+#include <ray/compiler/passes/typeScanner.hpp>
+#include <ray/compiler/source_buffer.hpp>
+#include <ray/util/counters.hpp>
+
+#include "peak_rss.hpp"
+#include "synthetic_source.hpp"
+#include "tree_walk.hpp"
+
+using namespace ray::compiler;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view usage =
+    "Usage: {} [options]\n"
+    "  --functions N    generated functions (default 1000)\n"
+    "  --structs N      generated structs (default 100)\n"
+    "  --nesting N      depth of the blocks in every function (default 4)\n"
+    "  --terms N        operands of the expression in every function "
+    "(default 16)\n"
+    "  --source FILE    benchmark FILE, which cannot import modules, instead "
+    "of a\n                   generated source\n"
+    "  --iterations N   runs of every benchmark, the best one is kept "
+    "(default 5)\n"
+    "  --json FILE      write the results to FILE as JSON\n"
+    "  --write FILE     write the generated source to FILE and exit\n";
+
+struct Arguments {
+	ray::bench::SourceShape shape;
+	std::string sourceFile;
+	size_t iterations = 5;
+	std::string jsonFile;
+	std::string writeFile;
+};
+
+std::optional<Arguments> parseArguments(int argc, char **argv) {
+	Arguments arguments;
+	for (int i = 1; i < argc; i++) {
+		std::string_view name = argv[i];
+		if (i + 1 >= argc) {
+			return std::nullopt;
+		}
+		std::string_view value = argv[++i];
+		auto number = [&]() {
+			return static_cast<size_t>(
+			    std::strtoull(value.data(), nullptr, 10));
+		};
+		if (name == "--functions") {
+			arguments.shape.functions = number();
+		} else if (name == "--structs") {
+			arguments.shape.structs = number();
+		} else if (name == "--nesting") {
+			arguments.shape.nesting = number();
+		} else if (name == "--terms") {
+			arguments.shape.terms = number();
+		} else if (name == "--source") {
+			arguments.sourceFile = value;
+		} else if (name == "--iterations") {
+			arguments.iterations = std::max<size_t>(number(), 1);
+		} else if (name == "--json") {
+			arguments.jsonFile = value;
+		} else if (name == "--write") {
+			arguments.writeFile = value;
+		} else {
+			return std::nullopt;
+		}
+	}
+	return arguments;
+}
+
+// every run of one benchmark, along with what its last run allocated
+struct Samples {
+	std::string_view name;
+	std::vector<Clock::duration> runs;
+	uint64_t allocations = 0;
+	uint64_t allocatedBytes = 0;
+
+	Clock::duration best() const { return std::ranges::min(runs); }
+	Clock::duration mean() const {
+		Clock::duration total{};
+		for (auto run : runs) {
+			total += run;
+		}
+		return total / static_cast<Clock::rep>(runs.size());
+	}
+};
+
+template <typename Body> void measure(Samples &samples, Body &&body) {
+	auto counters = util::threadCounters;
+	auto start = Clock::now();
+	body();
+	samples.runs.push_back(Clock::now() - start);
+	samples.allocations =
+	    util::threadCounters.allocations - counters.allocations;
+	samples.allocatedBytes =
+	    util::threadCounters.allocatedBytes - counters.allocatedBytes;
+}
+
+double milliseconds(Clock::duration duration) {
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double perSecond(size_t amount, Clock::duration duration) {
+	auto seconds = std::chrono::duration<double>(duration).count();
+	return seconds > 0 ? static_cast<double>(amount) / seconds : 0;
+}
+
+template <typename Pass> bool reportFailure(std::string_view phase,
+                                            const Pass &pass) {
+	if (!pass.hasFailed()) {
+		return false;
+	}
+	std::cerr << std::format("benchmark input failed in {}\n", phase);
+	for (const auto &error : pass.getErrors()) {
+		std::cerr << error;
+	}
+	return true;
+}
+
+// runs every phase the way the driver does, each one timed on its own. the
+// parser scans its tokens on demand so lexing is also timed separately. the
+// pointer tree and the flat tree are also walked without doing anything, the
+// dispatch cost every pass pays on the tree it walks
+bool measurePhases(std::string_view source, size_t iterations,
+                   std::vector<Samples> &phases) {
+	// the references below stay valid while the phases are added
+	phases.reserve(phases.size() + 8);
+	auto &lex = phases.emplace_back(Samples{.name = "lex"});
+	auto &parse = phases.emplace_back(Samples{.name = "parse"});
+	auto &lower = phases.emplace_back(Samples{.name = "lower"});
+	auto &walkPointers = phases.emplace_back(Samples{.name = "walk-ast"});
+	auto &walkFlat = phases.emplace_back(Samples{.name = "walk-flat"});
+	auto &scan = phases.emplace_back(Samples{.name = "scan"});
+	auto &check = phases.emplace_back(Samples{.name = "check"});
+	auto &codegen = phases.emplace_back(Samples{.name = "codegen"});
+
+	const auto &dataModel = environment::DataModel::LP64DataModel();
+	lang::ModuleStore moduleStore(dataModel);
+	for (size_t i = 0; i < iterations; i++) {
+		measure(lex, [&] {
+			Lexer lexer(source);
+			(void)lexer.scanTokens();
+		});
+
+		ast::Arena arena;
+		Lexer lexer(source);
+		Parser parser("bench.ray", TokenStream(lexer), arena);
+		std::vector<ast::NodePtr<ast::Statement>> statements;
+		measure(parse, [&] { statements = parser.parse(); });
+		if (parser.failed() || !lexer.getErrors().empty()) {
+			std::cerr << "benchmark input does not parse\n";
+			for (const auto &error : parser.getErrors()) {
+				std::cerr << error;
+			}
+			return false;
+		}
+
+		ast::flat::Tree tree;
+		measure(lower,
+		        [&] { tree = ast::flat::Builder().build(statements); });
+
+		size_t pointerNodes = 0;
+		size_t flatNodes = 0;
+		measure(walkPointers, [&] {
+			pointerNodes = ray::bench::PointerTreeWalker().walk(statements);
+		});
+		measure(walkFlat,
+		        [&] { flatNodes = ray::bench::FlatTreeWalker().walk(tree); });
+		if (pointerNodes != tree.size() || flatNodes != tree.size()) {
+			std::cerr << std::format("walked {} pointer tree and {} flat tree "
+			                         "nodes out of {}\n",
+			                         pointerNodes, flatNodes, tree.size());
+			return false;
+		}
+
+		lang::SourceUnit sourceUnit;
+		passes::TypeScanner typeScanner("bench.ray", dataModel, sourceUnit);
+		measure(scan, [&] { typeScanner.resolve(tree); });
+		if (reportFailure("scan", typeScanner)) {
+			return false;
+		}
+		passes::TypeChecker typeChecker("bench.ray", moduleStore, "bench.ray",
+		                                dataModel, sourceUnit);
+		measure(check, [&] { typeChecker.resolve(tree); });
+		if (reportFailure("check", typeChecker)) {
+			return false;
+		}
+		generator::c::CTranspilerGenerator generator(
+		    "bench.ray", moduleStore, "bench.ray", sourceUnit, dataModel);
+		measure(codegen, [&] { generator.resolve(tree); });
+		if (reportFailure("codegen", generator)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// compiles the file with a fresh driver every run, as a rayc process would.
+// the units are compiled on worker threads so only the time is measured
+bool measureEndToEnd(const std::filesystem::path &input, size_t iterations,
+                     Samples &samples) {
+	auto output = std::filesystem::path(input).replace_extension(".c");
+	std::string inputArgument = input.string();
+	std::string outputArgument = output.string();
+	std::string program = "rayc";
+	std::string outputFlag = "-o";
+	char *argv[] = {program.data(), inputArgument.data(), outputFlag.data(),
+	                outputArgument.data(), nullptr};
+	for (size_t i = 0; i < iterations; i++) {
+		std::ostringstream out;
+		std::ostringstream diagnostics;
+		auto start = Clock::now();
+		int status = Driver().run(4, argv, out, diagnostics);
+		samples.runs.push_back(Clock::now() - start);
+		if (status != 0) {
+			std::cerr << "benchmark input does not compile\n"
+			          << out.str() << diagnostics.str();
+			return false;
+		}
+	}
+	return true;
+}
+
+std::string toJson(const Arguments &arguments, std::string_view source,
+                   const std::vector<Samples> &phases,
+                   const Samples &endToEnd, size_t peakRSS) {
+	size_t lines = ray::bench::countLines(source);
+	std::string json = std::format(
+	    "{{\"version\":1,\"input\":{{\"generated\":{},\"functions\":{},"
+	    "\"structs\":{},\"nesting\":{},\"terms\":{},\"lines\":{},"
+	    "\"bytes\":{}}},\"iterations\":{},\"phases\":[",
+	    arguments.sourceFile.empty(), arguments.shape.functions,
+	    arguments.shape.structs, arguments.shape.nesting,
+	    arguments.shape.terms, lines, source.size(), arguments.iterations);
+	auto timesJson = [&](const Samples &samples) {
+		return std::format(
+		    "\"name\":\"{}\",\"bestNs\":{},\"meanNs\":{},"
+		    "\"linesPerSecond\":{:.0f}",
+		    samples.name,
+		    std::chrono::nanoseconds(samples.best()).count(),
+		    std::chrono::nanoseconds(samples.mean()).count(),
+		    perSecond(lines, samples.best()));
+	};
+	for (size_t i = 0; i < phases.size(); i++) {
+		json += std::format(
+		    "{}{{{},\"allocations\":{},\"allocatedBytes\":{}}}",
+		    i == 0 ? "" : ",", timesJson(phases[i]), phases[i].allocations,
+		    phases[i].allocatedBytes);
+	}
+	json += std::format("],\"endToEnd\":{{{}}},\"peakRssKiB\":{}}}\n",
+	                    timesJson(endToEnd), peakRSS);
+	return json;
+}
+
+} // namespace
+
+// times every compiler phase and whole builds over a generated source, or a
+// given one, and reports the throughput and the peak memory of the process
+int main(int argc, char **argv) {
+	auto arguments = parseArguments(argc, argv);
+	if (!arguments) {
+		std::cerr << std::format(usage, argv[0]);
+		return 1;
+	}
+
+	std::string source;
+	if (arguments->sourceFile.empty()) {
+		source = ray::bench::generateSource(arguments->shape);
+	} else {
+		auto file = SourceBuffer::open(arguments->sourceFile);
+		if (!file) {
+			std::cerr << std::format("could not open file: {}\n",
+			                         arguments->sourceFile);
+			return 1;
+		}
+		source = file->view();
+	}
+	if (!arguments->writeFile.empty()) {
+		std::ofstream(arguments->writeFile, std::ios::binary) << source;
+		return 0;
+	}
+
+	std::vector<Samples> phases;
+	if (!measurePhases(source, arguments->iterations, phases)) {
+		return 1;
+	}
+
+	// the driver reads its input from disk like any other build
+	std::error_code error;
+	auto stamp = Clock::now().time_since_epoch().count();
+	auto directory = std::filesystem::temp_directory_path(error) /
+	                 std::format("rayc-bench-{}", stamp);
+	std::filesystem::create_directories(directory, error);
+	auto input = directory / "bench.ray";
+	std::ofstream(input, std::ios::binary) << source;
+	Samples endToEnd{.name = "rayc"};
+	bool compiled = measureEndToEnd(input, arguments->iterations, endToEnd);
+	std::filesystem::remove_all(directory, error);
+	if (!compiled) {
+		return 1;
+	}
+
+	size_t lines = ray::bench::countLines(source);
+	size_t peakRSS = ray::bench::peakRSS();
+	std::cout << std::format("input: {} lines, {} bytes\n", lines,
+	                         source.size());
+	auto times = [&](const Samples &samples) {
+		return std::format("{:<9} best {:>9.3f} ms  mean {:>9.3f} ms  "
+		                   "{:>10.0f} lines/s",
+		                   samples.name, milliseconds(samples.best()),
+		                   milliseconds(samples.mean()),
+		                   perSecond(lines, samples.best()));
+	};
+	for (const auto &samples : phases) {
+		std::cout << std::format("{}  {:>8} allocs\n", times(samples),
+		                         samples.allocations);
+	}
+	std::cout << times(endToEnd) << '\n';
+	std::cout << std::format("peak rss: {} KiB\n", peakRSS);
+
+	if (!arguments->jsonFile.empty()) {
+		std::ofstream json(arguments->jsonFile, std::ios::binary);
+		json << toJson(*arguments, source, phases, endToEnd, peakRSS);
+		if (!json) {
+			std::cerr << std::format("could not write {}\n",
+			                         arguments->jsonFile);
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ray/compiler/ast/arena.hpp>
+#include <ray/compiler/ast/flat.hpp>
+#include <ray/compiler/ast/flatBuilder.hpp>
+#include <ray/compiler/lexer/lexer.hpp>
+#include <ray/compiler/lexer/token_stream.hpp>
+#include <ray/compiler/parser/parser.hpp>
+#include <ray/compiler/source_buffer.hpp>
+
+#include "peak_rss.hpp"
+
+using namespace ray::compiler;
+
+// parses the given file replicated `copies` times, `iterations` times in a row
+// and reports the parse time along with the memory used by the AST before
+// and after lowering it to the flat tree the passes walk.
+// `--allocator make_unique` gives every node its own heap block instead of
+// the arena chunks, to compare against how the parser used to allocate
+int main(int argc, char **argv) {
+	auto allocation = ast::Arena::Allocation::chunked;
+	std::string_view allocatorName = "arena";
+	std::vector<std::string_view> args;
+	for (int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+		if (arg == "--allocator" && i + 1 < argc) {
+			allocatorName = argv[++i];
+		} else {
+			args.push_back(arg);
+		}
+	}
+	if (allocatorName == "make_unique") {
+		allocation = ast::Arena::Allocation::perNode;
+	} else if (allocatorName != "arena") {
+		std::cerr << std::format("unknown allocator: {}\n", allocatorName);
+		return 1;
+	}
+	if (args.empty()) {
+		std::cerr << std::format("Usage: {} [--allocator arena|make_unique] "
+		                         "<file.ray> [copies] [iterations]\n",
+		                         argv[0]);
+		return 1;
+	}
+	auto number = [&](size_t index, size_t fallback) -> size_t {
+		if (index >= args.size()) {
+			return fallback;
+		}
+		return std::strtoull(std::string(args[index]).c_str(), nullptr, 10);
+	};
+	size_t copies = std::max<size_t>(number(1, 1), 1);
+	size_t iterations = std::max<size_t>(number(2, 5), 1);
+
+	auto file = SourceBuffer::open(std::string(args[0]));
+	if (!file) {
+		std::cerr << std::format("could not open file: {}\n", args[0]);
+		return 1;
+	}
+	std::string source;
+	source.reserve(file->view().size() * copies);
+	for (size_t i = 0; i < copies; i++) {
+		source += file->view();
+		source += '\n';
+	}
+
+	using clock = std::chrono::steady_clock;
+	clock::duration best = clock::duration::max();
+	clock::duration total{};
+	size_t statementCount = 0;
+	size_t astBytes = 0;
+	size_t flatBytes = 0;
+	for (size_t i = 0; i < iterations; i++) {
+		auto start = clock::now();
+		{
+			ast::Arena arena(allocation);
+			Lexer lexer(source);
+			Parser parser("bench.ray", TokenStream(lexer), arena);
+			auto statements = parser.parse();
+			if (parser.failed() || !lexer.getErrors().empty()) {
+				std::cerr << "benchmark input does not parse\n";
+				return 1;
+			}
+			statementCount = statements.size();
+			astBytes = arena.getBytesUsed();
+			flatBytes = ast::flat::Builder().build(statements).getBytesUsed();
+		}
+		auto elapsed = clock::now() - start;
+		best = std::min(best, elapsed);
+		total += elapsed;
+	}
+
+	auto toMs = [](clock::duration duration) {
+		return std::chrono::duration<double, std::milli>(duration).count();
+	};
+	std::cout << std::format("allocator: {}\n", allocatorName);
+	std::cout << std::format("input: {} bytes, {} top level statements\n",
+	                         source.size(), statementCount);
+	std::cout << std::format("parse + lower: best {:.3f} ms, mean {:.3f} ms "
+	                         "over {} iterations\n",
+	                         toMs(best), toMs(total) / iterations, iterations);
+	std::cout << std::format("ast nodes: {} KiB\n", astBytes / 1024);
+	std::cout << std::format("flat tree: {} KiB\n", flatBytes / 1024);
+	std::cout << std::format("peak rss: {} KiB\n", ray::bench::peakRSS());
+	return 0;
+}
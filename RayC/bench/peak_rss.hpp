@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define RAYC_BENCH_HAS_RUSAGE 1
+#endif
+
+namespace ray::bench {
+
+// peak resident set size of the process in KiB, 0 if not available
+inline size_t peakRSS() {
+#ifdef RAYC_BENCH_HAS_RUSAGE
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+#ifdef __APPLE__
+	// reported in bytes instead of kilobytes
+	return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#else
+	return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#else
+	return 0;
+#endif
+}
+
+} // namespace ray::bench
@@ -0,0 +1,127 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <string>
+#include <string_view>
+
+namespace ray::bench {
+
+// what a generated source is made of, every function holds one long
+// expression and one tower of nested blocks
+struct SourceShape {
+	size_t functions = 1000;
+	size_t structs = 100;
+	// depth of the if and while blocks nested in every function
+	size_t nesting = 4;
+	// operands of the expression every function starts with
+	size_t terms = 16;
+};
+
+namespace detail {
+
+inline void indent(std::string &source, size_t depth) {
+	source.append(depth, '\t');
+}
+
+inline void appendNesting(std::string &source, size_t depth, size_t level);
+
+// the scanner wants the statements of a nested block and both branches of an
+// if to yield the same type, so they only hold declarations and blocks
+inline void appendBody(std::string &source, size_t depth, size_t level) {
+	indent(source, level + 1);
+	source += std::format("let v{}: s32 = x - {};\n", level, level);
+	if (level < depth) {
+		appendNesting(source, depth, level);
+	}
+}
+
+// alternates if/else and while blocks down to the given depth
+inline void appendNesting(std::string &source, size_t depth, size_t level) {
+	indent(source, level + 1);
+	if (level % 2 == 0) {
+		source += std::format("if x > {} {{\n", level);
+		appendBody(source, depth, level + 1);
+		indent(source, level + 1);
+		source += "} else {\n";
+		indent(source, level + 2);
+		source += std::format("while x < {} {{\n", level);
+		indent(source, level + 3);
+		source += "x += 1;\n";
+		indent(source, level + 2);
+		source += "}\n";
+	} else {
+		source += std::format("while x > {} {{\n", level * 10);
+		appendBody(source, depth, level + 1);
+	}
+	indent(source, level + 1);
+	source += "}\n";
+}
+
+// cycles through parameters, a parenthesized subexpression and literals
+// so the operators never divide by zero
+inline void appendExpression(std::string &source, size_t terms) {
+	constexpr std::string_view operators[] = {" + ", " * ", " - ", " % "};
+	for (size_t i = 0; i < terms; i++) {
+		if (i > 0) {
+			source += operators[i % 4];
+		}
+		switch (i % 4) {
+		case 0:
+			source += "a";
+			break;
+		case 1:
+			source += "b";
+			break;
+		case 2:
+			source += std::format("(a - {})", i);
+			break;
+		default:
+			source += std::format("{}", i % 9 + 1);
+		}
+	}
+}
+
+} // namespace detail
+
+// a Ray source that goes through every compiler phase without errors, made
+// of structs and functions calling the one declared before them
+inline std::string generateSource(const SourceShape &shape) {
+	std::string source;
+	for (size_t i = 0; i < shape.structs; i++) {
+		source += std::format("struct Shape{} {{\n"
+		                      "\tfield0: s32;\n"
+		                      "\tmut field1: f64;\n"
+		                      "\tfield2: *u8;\n"
+		                      "\tfield3: usize;\n"
+		                      "}}\n\n",
+		                      i);
+	}
+	for (size_t i = 0; i < shape.functions; i++) {
+		source += std::format("fn compute{}(a: s32, b: s32) -> s32 {{\n", i);
+		source += "\tlet x: mut s32 = ";
+		detail::appendExpression(source, std::max<size_t>(shape.terms, 1));
+		source += ";\n";
+		if (shape.structs > 0) {
+			size_t structId = i % shape.structs;
+			source += std::format("\tlet shape: *Shape{} = 0 as *Shape{};\n",
+			                      structId, structId);
+		}
+		if (shape.nesting > 0) {
+			detail::appendNesting(source, shape.nesting, 0);
+		}
+		if (i > 0) {
+			source += std::format("\treturn x + compute{}(a - 1, b);\n", i - 1);
+		} else {
+			source += "\treturn x;\n";
+		}
+		source += "}\n\n";
+	}
+	return source;
+}
+
+inline size_t countLines(std::string_view source) {
+	return static_cast<size_t>(std::ranges::count(source, '\n'));
+}
+
+} // namespace ray::bench
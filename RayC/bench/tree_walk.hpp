@@ -0,0 +1,337 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include <ray/compiler/ast/expression.hpp>
+#include <ray/compiler/ast/flat.hpp>
+#include <ray/compiler/ast/statement.hpp>
+
+namespace ray::bench {
+
+// visits every node of a pointer tree through the virtual visitors the passes
+// used before the flat tree, children before their parent
+class PointerTreeWalker : public compiler::ast::ExpressionVisitor,
+                          public compiler::ast::StatementVisitor {
+	size_t nodes = 0;
+
+  public:
+	size_t walk(const std::vector<compiler::ast::NodePtr<compiler::ast::Statement>>& statements) {
+		nodes = 0;
+		walkChildren(statements);
+		return nodes;
+	}
+
+  private:
+	void visitVariableExpression(const compiler::ast::Variable&) override {
+		nodes++;
+	}
+	void visitIntrinsicExpression(const compiler::ast::Intrinsic&) override {
+		nodes++;
+	}
+	void visitAssignExpression(const compiler::ast::Assign& node) override {
+		walkChildren(node.lhs);
+		walkChildren(node.rhs);
+		nodes++;
+	}
+	void visitBinaryExpression(const compiler::ast::Binary& node) override {
+		walkChildren(node.left);
+		walkChildren(node.right);
+		nodes++;
+	}
+	void visitCallExpression(const compiler::ast::Call& node) override {
+		walkChildren(node.callee);
+		walkChildren(node.arguments);
+		nodes++;
+	}
+	void visitIntrinsicCallExpression(const compiler::ast::IntrinsicCall& node) override {
+		walkChildren(node.callee);
+		walkChildren(node.arguments);
+		nodes++;
+	}
+	void visitGetExpression(const compiler::ast::Get& node) override {
+		walkChildren(node.object);
+		nodes++;
+	}
+	void visitGroupingExpression(const compiler::ast::Grouping& node) override {
+		walkChildren(node.expression);
+		nodes++;
+	}
+	void visitLiteralExpression(const compiler::ast::Literal&) override {
+		nodes++;
+	}
+	void visitLogicalExpression(const compiler::ast::Logical& node) override {
+		walkChildren(node.left);
+		walkChildren(node.right);
+		nodes++;
+	}
+	void visitSetExpression(const compiler::ast::Set& node) override {
+		walkChildren(node.object);
+		walkChildren(node.value);
+		nodes++;
+	}
+	void visitUnaryExpression(const compiler::ast::Unary& node) override {
+		walkChildren(node.expr);
+		nodes++;
+	}
+	void visitArrayAccessExpression(const compiler::ast::ArrayAccess& node) override {
+		walkChildren(node.array);
+		walkChildren(node.index);
+		nodes++;
+	}
+	void visitArrayTypeExpression(const compiler::ast::ArrayType& node) override {
+		walkChildren(node.subType);
+		nodes++;
+	}
+	void visitTupleTypeExpression(const compiler::ast::TupleType& node) override {
+		walkChildren(node.expressions);
+		nodes++;
+	}
+	void visitPointerTypeExpression(const compiler::ast::PointerType& node) override {
+		walkChildren(node.subtype);
+		nodes++;
+	}
+	void visitNamedTypeExpression(const compiler::ast::NamedType&) override {
+		nodes++;
+	}
+	void visitCastExpression(const compiler::ast::Cast& node) override {
+		walkChildren(node.expression);
+		walkChildren(node.type);
+		nodes++;
+	}
+	void visitParameterExpression(const compiler::ast::Parameter& node) override {
+		walkChildren(node.type);
+		nodes++;
+	}
+	void visitBlockStatement(const compiler::ast::Block& node) override {
+		walkChildren(node.statements);
+		nodes++;
+	}
+	void visitTerminalExprStatement(const compiler::ast::TerminalExpr& node) override {
+		walkChildren(node.expression);
+		nodes++;
+	}
+	void visitExpressionStmtStatement(const compiler::ast::ExpressionStmt& node) override {
+		walkChildren(node.expression);
+		nodes++;
+	}
+	void visitFunctionStatement(const compiler::ast::Function& node) override {
+		walkChildren(node.params);
+		walkChildren(node.body);
+		walkChildren(node.returnType);
+		nodes++;
+	}
+	void visitIfStatement(const compiler::ast::If& node) override {
+		walkChildren(node.condition);
+		walkChildren(node.thenBranch);
+		walkChildren(node.elseBranch);
+		nodes++;
+	}
+	void visitJumpStatement(const compiler::ast::Jump& node) override {
+		walkChildren(node.returnValue);
+		nodes++;
+	}
+	void visitVarDeclStatement(const compiler::ast::VarDecl& node) override {
+		walkChildren(node.type);
+		walkChildren(node.initializer);
+		nodes++;
+	}
+	void visitMemberStatement(const compiler::ast::Member& node) override {
+		walkChildren(node.type);
+		walkChildren(node.initializer);
+		nodes++;
+	}
+	void visitWhileStatement(const compiler::ast::While& node) override {
+		walkChildren(node.condition);
+		walkChildren(node.body);
+		nodes++;
+	}
+	void visitStructStatement(const compiler::ast::Struct& node) override {
+		walkChildren(node.members);
+		nodes++;
+	}
+	void visitCompDirectiveStatement(const compiler::ast::CompDirective& node) override {
+		walkChildren(node.child);
+		nodes++;
+	}
+
+	template <typename T> void walkChildren(const T& node) { node.visit(*this); }
+	template <typename T> void walkChildren(const compiler::ast::NodePtr<T>& node) {
+		if (node) {
+			walkChildren(*node);
+		}
+	}
+	template <typename T> void walkChildren(const std::optional<T>& node) {
+		if (node) {
+			walkChildren(*node);
+		}
+	}
+	template <typename T> void walkChildren(const std::vector<T>& nodes) {
+		for (const auto& node : nodes) {
+			walkChildren(node);
+		}
+	}
+};
+
+// visits every node of a flat tree through the kind switch of
+// flat::Visitor, in the same order as PointerTreeWalker
+class FlatTreeWalker : public compiler::ast::flat::Visitor<FlatTreeWalker> {
+	friend class compiler::ast::flat::Visitor<FlatTreeWalker>;
+
+	size_t nodes = 0;
+
+  public:
+	size_t walk(const compiler::ast::flat::Tree& tree) {
+		bind(tree);
+		nodes = 0;
+		for (compiler::ast::flat::NodeId root : tree.getRoots()) {
+			walkChildren(root);
+		}
+		return nodes;
+	}
+
+  private:
+	void visitVariableExpression(const compiler::ast::flat::Variable&) {
+		nodes++;
+	}
+	void visitIntrinsicExpression(const compiler::ast::flat::Intrinsic&) {
+		nodes++;
+	}
+	void visitAssignExpression(const compiler::ast::flat::Assign& node) {
+		walkChildren(node.lhs);
+		walkChildren(node.rhs);
+		nodes++;
+	}
+	void visitBinaryExpression(const compiler::ast::flat::Binary& node) {
+		walkChildren(node.left);
+		walkChildren(node.right);
+		nodes++;
+	}
+	void visitCallExpression(const compiler::ast::flat::Call& node) {
+		walkChildren(node.callee);
+		walkChildren(node.arguments);
+		nodes++;
+	}
+	void visitIntrinsicCallExpression(const compiler::ast::flat::IntrinsicCall& node) {
+		walkChildren(node.callee);
+		walkChildren(node.arguments);
+		nodes++;
+	}
+	void visitGetExpression(const compiler::ast::flat::Get& node) {
+		walkChildren(node.object);
+		nodes++;
+	}
+	void visitGroupingExpression(const compiler::ast::flat::Grouping& node) {
+		walkChildren(node.expression);
+		nodes++;
+	}
+	void visitLiteralExpression(const compiler::ast::flat::Literal&) {
+		nodes++;
+	}
+	void visitLogicalExpression(const compiler::ast::flat::Logical& node) {
+		walkChildren(node.left);
+		walkChildren(node.right);
+		nodes++;
+	}
+	void visitSetExpression(const compiler::ast::flat::Set& node) {
+		walkChildren(node.object);
+		walkChildren(node.value);
+		nodes++;
+	}
+	void visitUnaryExpression(const compiler::ast::flat::Unary& node) {
+		walkChildren(node.expr);
+		nodes++;
+	}
+	void visitArrayAccessExpression(const compiler::ast::flat::ArrayAccess& node) {
+		walkChildren(node.array);
+		walkChildren(node.index);
+		nodes++;
+	}
+	void visitArrayTypeExpression(const compiler::ast::flat::ArrayType& node) {
+		walkChildren(node.subType);
+		nodes++;
+	}
+	void visitTupleTypeExpression(const compiler::ast::flat::TupleType& node) {
+		walkChildren(node.expressions);
+		nodes++;
+	}
+	void visitPointerTypeExpression(const compiler::ast::flat::PointerType& node) {
+		walkChildren(node.subtype);
+		nodes++;
+	}
+	void visitNamedTypeExpression(const compiler::ast::flat::NamedType&) {
+		nodes++;
+	}
+	void visitCastExpression(const compiler::ast::flat::Cast& node) {
+		walkChildren(node.expression);
+		walkChildren(node.type);
+		nodes++;
+	}
+	void visitParameterExpression(const compiler::ast::flat::Parameter& node) {
+		walkChildren(node.type);
+		nodes++;
+	}
+	void visitBlockStatement(const compiler::ast::flat::Block& node) {
+		walkChildren(node.statements);
+		nodes++;
+	}
+	void visitTerminalExprStatement(const compiler::ast::flat::TerminalExpr& node) {
+		walkChildren(node.expression);
+		nodes++;
+	}
+	void visitExpressionStmtStatement(const compiler::ast::flat::ExpressionStmt& node) {
+		walkChildren(node.expression);
+		nodes++;
+	}
+	void visitFunctionStatement(const compiler::ast::flat::Function& node) {
+		walkChildren(node.params);
+		walkChildren(node.body);
+		walkChildren(node.returnType);
+		nodes++;
+	}
+	void visitIfStatement(const compiler::ast::flat::If& node) {
+		walkChildren(node.condition);
+		walkChildren(node.thenBranch);
+		walkChildren(node.elseBranch);
+		nodes++;
+	}
+	void visitJumpStatement(const compiler::ast::flat::Jump& node) {
+		walkChildren(node.returnValue);
+		nodes++;
+	}
+	void visitVarDeclStatement(const compiler::ast::flat::VarDecl& node) {
+		walkChildren(node.type);
+		walkChildren(node.initializer);
+		nodes++;
+	}
+	void visitMemberStatement(const compiler::ast::flat::Member& node) {
+		walkChildren(node.type);
+		walkChildren(node.initializer);
+		nodes++;
+	}
+	void visitWhileStatement(const compiler::ast::flat::While& node) {
+		walkChildren(node.condition);
+		walkChildren(node.body);
+		nodes++;
+	}
+	void visitStructStatement(const compiler::ast::flat::Struct& node) {
+		walkChildren(node.members);
+		nodes++;
+	}
+	void visitCompDirectiveStatement(const compiler::ast::flat::CompDirective& node) {
+		walkChildren(node.child);
+		nodes++;
+	}
+
+	void walkChildren(compiler::ast::flat::NodeId id) {
+		if (id) {
+			visit(id);
+		}
+	}
+	void walkChildren(compiler::ast::flat::NodeRange range) {
+		for (compiler::ast::flat::NodeId id : tree().range(range)) {
+			walkChildren(id);
+		}
+	}
+};
+
+} // namespace ray::bench
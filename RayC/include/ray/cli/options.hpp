@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstddef>
 #include <filesystem>
+#include <ostream>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace ray::compiler::cli {
 
@@ -34,13 +39,41 @@ class Options {
 
 	bool assembly = false;
 	TargetEnum target = TargetEnum::NONE;
+	// a file when compiling a single file, otherwise the directory that
+	// receives a C file per input keeping its path relative to the input
 	std::filesystem::path output;
-	std::filesystem::path input;
+	// source files or module roots, every .ray file under a root is compiled
+	std::vector<std::filesystem::path> inputs;
+	// directory holding the .rayi interfaces of the compiled and imported
+	// modules, importers read them instead of parsing the module again
+	std::filesystem::path interfaceDirectory;
+	// directory of the build cache, compiled units are reused from it while
+	// their source and the interfaces of their imports do not change
+	std::filesystem::path cacheDirectory;
+	// prints the time and what every phase created after the diagnostics
+	bool timeReport = false;
+	// the same report as JSON, for tools tracking the compiler performance
+	std::filesystem::path timeReportJson;
+	// Chrome trace events of the phases, declarations and imported modules
+	std::filesystem::path traceFile;
+	// incremental output: writes the C code of every declaration as soon as
+	// it is checked instead of once the whole unit is done. only the pending
+	// C text is bounded, the tree and the checker state of the unit stay in
+	// memory until it ends. ignored with a build cache
+	bool streamOutput = false;
+	// worker threads used to compile the inputs, 0 uses every core
+	size_t jobs = 0;
 	TargetDataModel dataModel = getHostDataModel();
+	// package name and root directory used to resolve "name:file.ray" imports
+	std::vector<std::pair<std::string, std::filesystem::path>> packages;
 
-	bool validate() const;
+	// problems found are written to the stream
+	bool validate(std::ostream &errors) const;
+	// several inputs or a module root compile into an output directory
+	bool compilesToDirectory() const;
 
 	static TargetEnum targetFromString(std::string_view str);
+	static std::string_view targetToString(TargetEnum target);
 	static constexpr TargetEnum defaultTarget = TargetEnum::C_SOURCE;
 	static constexpr TargetDataModel getHostDataModel() {
 #ifdef __LP64__
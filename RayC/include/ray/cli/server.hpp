@@ -0,0 +1,22 @@
+#pragma once
+#include <filesystem>
+#include <optional>
+#include <span>
+
+namespace ray::compiler::cli {
+
+// serves compile requests on a local socket until interrupted. builds run one
+// after the other on a single Driver so imported modules, with the names and
+// types they declare, stay in memory between them while what the compiled
+// files interned is dropped after each build. a client that does not send its
+// request in time is dropped. returns the exit code
+int runServer(const std::filesystem::path &socketPath);
+
+// forwards the arguments along with the working directory to a server and
+// prints what the build printed. nullopt when no server could be reached or
+// it did not answer, the caller then compiles in process. a warning telling
+// why is printed in that case
+std::optional<int> runClient(const std::filesystem::path &socketPath,
+                             std::span<char *const> arguments);
+
+} // namespace ray::compiler::cli
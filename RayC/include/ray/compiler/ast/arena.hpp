@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ray::compiler::ast {
+
+// nodes allocated from an Arena only get destroyed by their owner, the memory
+// itself is given back when the arena is released
+struct ArenaDeleter {
+	template <typename T> void operator()(T *node) const {
+		std::destroy_at(node);
+	}
+};
+
+template <typename T> using NodePtr = std::unique_ptr<T, ArenaDeleter>;
+
+// bump allocator owning the AST nodes of a compilation unit, nodes are laid
+// out in the order the parser creates them and all of them are released at
+// once when the arena goes out of scope, so it must outlive every NodePtr
+// made from it
+class Arena {
+  public:
+	// perNode gives every node a heap block of its own, the way the parser
+	// allocated them with std::make_unique before the arena. it is only there
+	// for the parse benchmark to compare both, the compiler always chunks
+	enum class Allocation { chunked, perNode };
+
+  private:
+	static constexpr size_t chunkSize = 64 * 1024;
+
+	std::vector<std::unique_ptr<std::byte[]>> chunks;
+	std::byte *cursor = nullptr;
+	std::byte *chunkEnd = nullptr;
+	size_t bytesUsed = 0;
+	Allocation allocation;
+
+  public:
+	explicit Arena(Allocation allocation = Allocation::chunked)
+	    : allocation(allocation) {}
+	Arena(const Arena &) = delete;
+	Arena &operator=(const Arena &) = delete;
+
+	template <typename T, typename... Args> NodePtr<T> make(Args &&...args) {
+		void *memory = allocate(sizeof(T), alignof(T));
+		return NodePtr<T>(new (memory) T(std::forward<Args>(args)...));
+	}
+
+	void *allocate(size_t size, size_t alignment) {
+		auto address = reinterpret_cast<uintptr_t>(cursor);
+		size_t padding = (alignment - address % alignment) % alignment;
+		if (cursor == nullptr ||
+		    size + padding > static_cast<size_t>(chunkEnd - cursor)) {
+			return allocateSlow(size, alignment);
+		}
+		std::byte *memory = cursor + padding;
+		cursor = memory + size;
+		bytesUsed += size;
+		return memory;
+	}
+
+	// bytes handed out to nodes, not counting padding or unused chunk space
+	size_t getBytesUsed() const { return bytesUsed; }
+	// with Allocation::perNode every node is a chunk of its own
+	size_t getChunkCount() const { return chunks.size(); }
+
+  private:
+	void *allocateSlow(size_t size, size_t alignment);
+};
+
+} // namespace ray::compiler::ast
@@ -3,6 +3,7 @@
 #include <vector>
 #include <optional>
 #include <ray/compiler/lexer/token.hpp>
+#include <ray/compiler/ast/arena.hpp>
 #include <ray/compiler/ast/intrinsic.hpp>
 
 namespace ray::compiler::ast {
@@ -69,6 +70,12 @@ class Variable : public Expression {
 		name(std::move(name)),
 		token(std::move(token)) {}
 
+	static NodePtr<Variable> create(Arena& arena,
+	        Token name,
+	        Token token) {
+		return arena.make<Variable>(std::move(name), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitVariableExpression(*this);
 	}
@@ -90,6 +97,13 @@ class Intrinsic : public Expression {
 		intrinsic(std::move(intrinsic)),
 		token(std::move(token)) {}
 
+	static NodePtr<Intrinsic> create(Arena& arena,
+	        Token name,
+	        IntrinsicType intrinsic,
+	        Token token) {
+		return arena.make<Intrinsic>(std::move(name), std::move(intrinsic), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitIntrinsicExpression(*this);
 	}
@@ -100,20 +114,28 @@ class Intrinsic : public Expression {
 };
 class Assign : public Expression {
   public:
-	std::unique_ptr<Expression> lhs;
+	NodePtr<Expression> lhs;
 	Token assignmentOp;
-	std::unique_ptr<Expression> rhs;
+	NodePtr<Expression> rhs;
 	Token token;
 
-	Assign(std::unique_ptr<Expression> lhs,
+	Assign(NodePtr<Expression> lhs,
 	        Token assignmentOp,
-	        std::unique_ptr<Expression> rhs,
+	        NodePtr<Expression> rhs,
 	        Token token):
 		lhs(std::move(lhs)),
 		assignmentOp(std::move(assignmentOp)),
 		rhs(std::move(rhs)),
 		token(std::move(token)) {}
 
+	static NodePtr<Assign> create(Arena& arena,
+	        NodePtr<Expression> lhs,
+	        Token assignmentOp,
+	        NodePtr<Expression> rhs,
+	        Token token) {
+		return arena.make<Assign>(std::move(lhs), std::move(assignmentOp), std::move(rhs), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitAssignExpression(*this);
 	}
@@ -124,20 +146,28 @@ class Assign : public Expression {
 };
 class Binary : public Expression {
   public:
-	std::unique_ptr<Expression> left;
+	NodePtr<Expression> left;
 	Token op;
-	std::unique_ptr<Expression> right;
+	NodePtr<Expression> right;
 	Token token;
 
-	Binary(std::unique_ptr<Expression> left,
+	Binary(NodePtr<Expression> left,
 	        Token op,
-	        std::unique_ptr<Expression> right,
+	        NodePtr<Expression> right,
 	        Token token):
 		left(std::move(left)),
 		op(std::move(op)),
 		right(std::move(right)),
 		token(std::move(token)) {}
 
+	static NodePtr<Binary> create(Arena& arena,
+	        NodePtr<Expression> left,
+	        Token op,
+	        NodePtr<Expression> right,
+	        Token token) {
+		return arena.make<Binary>(std::move(left), std::move(op), std::move(right), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitBinaryExpression(*this);
 	}
@@ -148,20 +178,28 @@ class Binary : public Expression {
 };
 class Call : public Expression {
   public:
-	std::unique_ptr<Expression> callee;
+	NodePtr<Expression> callee;
 	Token paren;
-	std::vector<std::unique_ptr<Expression>> arguments;
+	std::vector<NodePtr<Expression>> arguments;
 	Token token;
 
-	Call(std::unique_ptr<Expression> callee,
+	Call(NodePtr<Expression> callee,
 	        Token paren,
-	        std::vector<std::unique_ptr<Expression>> arguments,
+	        std::vector<NodePtr<Expression>> arguments,
 	        Token token):
 		callee(std::move(callee)),
 		paren(std::move(paren)),
 		arguments(std::move(arguments)),
 		token(std::move(token)) {}
 
+	static NodePtr<Call> create(Arena& arena,
+	        NodePtr<Expression> callee,
+	        Token paren,
+	        std::vector<NodePtr<Expression>> arguments,
+	        Token token) {
+		return arena.make<Call>(std::move(callee), std::move(paren), std::move(arguments), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitCallExpression(*this);
 	}
@@ -172,20 +210,28 @@ class Call : public Expression {
 };
 class IntrinsicCall : public Expression {
   public:
-	std::unique_ptr<Intrinsic> callee;
+	NodePtr<Intrinsic> callee;
 	Token paren;
-	std::vector<std::unique_ptr<Expression>> arguments;
+	std::vector<NodePtr<Expression>> arguments;
 	Token token;
 
-	IntrinsicCall(std::unique_ptr<Intrinsic> callee,
+	IntrinsicCall(NodePtr<Intrinsic> callee,
 	        Token paren,
-	        std::vector<std::unique_ptr<Expression>> arguments,
+	        std::vector<NodePtr<Expression>> arguments,
 	        Token token):
 		callee(std::move(callee)),
 		paren(std::move(paren)),
 		arguments(std::move(arguments)),
 		token(std::move(token)) {}
 
+	static NodePtr<IntrinsicCall> create(Arena& arena,
+	        NodePtr<Intrinsic> callee,
+	        Token paren,
+	        std::vector<NodePtr<Expression>> arguments,
+	        Token token) {
+		return arena.make<IntrinsicCall>(std::move(callee), std::move(paren), std::move(arguments), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitIntrinsicCallExpression(*this);
 	}
@@ -196,17 +242,24 @@ class IntrinsicCall : public Expression {
 };
 class Get : public Expression {
   public:
-	std::unique_ptr<Expression> object;
+	NodePtr<Expression> object;
 	Token name;
 	Token token;
 
-	Get(std::unique_ptr<Expression> object,
+	Get(NodePtr<Expression> object,
 	        Token name,
 	        Token token):
 		object(std::move(object)),
 		name(std::move(name)),
 		token(std::move(token)) {}
 
+	static NodePtr<Get> create(Arena& arena,
+	        NodePtr<Expression> object,
+	        Token name,
+	        Token token) {
+		return arena.make<Get>(std::move(object), std::move(name), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitGetExpression(*this);
 	}
@@ -217,14 +270,20 @@ class Get : public Expression {
 };
 class Grouping : public Expression {
   public:
-	std::unique_ptr<Expression> expression;
+	NodePtr<Expression> expression;
 	Token token;
 
-	Grouping(std::unique_ptr<Expression> expression,
+	Grouping(NodePtr<Expression> expression,
 	        Token token):
 		expression(std::move(expression)),
 		token(std::move(token)) {}
 
+	static NodePtr<Grouping> create(Arena& arena,
+	        NodePtr<Expression> expression,
+	        Token token) {
+		return arena.make<Grouping>(std::move(expression), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitGroupingExpression(*this);
 	}
@@ -236,16 +295,23 @@ class Grouping : public Expression {
 class Literal : public Expression {
   public:
 	Token kind;
-	std::string value;
+	std::string_view value;
 	Token token;
 
 	Literal(Token kind,
-	        std::string value,
+	        std::string_view value,
 	        Token token):
 		kind(std::move(kind)),
 		value(std::move(value)),
 		token(std::move(token)) {}
 
+	static NodePtr<Literal> create(Arena& arena,
+	        Token kind,
+	        std::string_view value,
+	        Token token) {
+		return arena.make<Literal>(std::move(kind), std::move(value), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitLiteralExpression(*this);
 	}
@@ -256,20 +322,28 @@ class Literal : public Expression {
 };
 class Logical : public Expression {
   public:
-	std::unique_ptr<Expression> left;
+	NodePtr<Expression> left;
 	Token op;
-	std::unique_ptr<Expression> right;
+	NodePtr<Expression> right;
 	Token token;
 
-	Logical(std::unique_ptr<Expression> left,
+	Logical(NodePtr<Expression> left,
 	        Token op,
-	        std::unique_ptr<Expression> right,
+	        NodePtr<Expression> right,
 	        Token token):
 		left(std::move(left)),
 		op(std::move(op)),
 		right(std::move(right)),
 		token(std::move(token)) {}
 
+	static NodePtr<Logical> create(Arena& arena,
+	        NodePtr<Expression> left,
+	        Token op,
+	        NodePtr<Expression> right,
+	        Token token) {
+		return arena.make<Logical>(std::move(left), std::move(op), std::move(right), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitLogicalExpression(*this);
 	}
@@ -280,16 +354,16 @@ class Logical : public Expression {
 };
 class Set : public Expression {
   public:
-	std::unique_ptr<Expression> object;
+	NodePtr<Expression> object;
 	Token name;
 	Token assignmentOp;
-	std::unique_ptr<Expression> value;
+	NodePtr<Expression> value;
 	Token token;
 
-	Set(std::unique_ptr<Expression> object,
+	Set(NodePtr<Expression> object,
 	        Token name,
 	        Token assignmentOp,
-	        std::unique_ptr<Expression> value,
+	        NodePtr<Expression> value,
 	        Token token):
 		object(std::move(object)),
 		name(std::move(name)),
@@ -297,6 +371,15 @@ class Set : public Expression {
 		value(std::move(value)),
 		token(std::move(token)) {}
 
+	static NodePtr<Set> create(Arena& arena,
+	        NodePtr<Expression> object,
+	        Token name,
+	        Token assignmentOp,
+	        NodePtr<Expression> value,
+	        Token token) {
+		return arena.make<Set>(std::move(object), std::move(name), std::move(assignmentOp), std::move(value), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitSetExpression(*this);
 	}
@@ -309,18 +392,26 @@ class Unary : public Expression {
   public:
 	Token op;
 	bool isPrefix;
-	std::unique_ptr<Expression> expr;
+	NodePtr<Expression> expr;
 	Token token;
 
 	Unary(Token op,
 	        bool isPrefix,
-	        std::unique_ptr<Expression> expr,
+	        NodePtr<Expression> expr,
 	        Token token):
 		op(std::move(op)),
 		isPrefix(std::move(isPrefix)),
 		expr(std::move(expr)),
 		token(std::move(token)) {}
 
+	static NodePtr<Unary> create(Arena& arena,
+	        Token op,
+	        bool isPrefix,
+	        NodePtr<Expression> expr,
+	        Token token) {
+		return arena.make<Unary>(std::move(op), std::move(isPrefix), std::move(expr), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitUnaryExpression(*this);
 	}
@@ -331,17 +422,24 @@ class Unary : public Expression {
 };
 class ArrayAccess : public Expression {
   public:
-	std::unique_ptr<Expression> array;
-	std::unique_ptr<Expression> index;
+	NodePtr<Expression> array;
+	NodePtr<Expression> index;
 	Token token;
 
-	ArrayAccess(std::unique_ptr<Expression> array,
-	        std::unique_ptr<Expression> index,
+	ArrayAccess(NodePtr<Expression> array,
+	        NodePtr<Expression> index,
 	        Token token):
 		array(std::move(array)),
 		index(std::move(index)),
 		token(std::move(token)) {}
 
+	static NodePtr<ArrayAccess> create(Arena& arena,
+	        NodePtr<Expression> array,
+	        NodePtr<Expression> index,
+	        Token token) {
+		return arena.make<ArrayAccess>(std::move(array), std::move(index), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitArrayAccessExpression(*this);
 	}
@@ -353,16 +451,23 @@ class ArrayAccess : public Expression {
 class ArrayType : public Expression {
   public:
 	bool isMutable;
-	std::unique_ptr<Expression> subType;
+	NodePtr<Expression> subType;
 	Token token;
 
 	ArrayType(bool isMutable,
-	        std::unique_ptr<Expression> subType,
+	        NodePtr<Expression> subType,
 	        Token token):
 		isMutable(std::move(isMutable)),
 		subType(std::move(subType)),
 		token(std::move(token)) {}
 
+	static NodePtr<ArrayType> create(Arena& arena,
+	        bool isMutable,
+	        NodePtr<Expression> subType,
+	        Token token) {
+		return arena.make<ArrayType>(std::move(isMutable), std::move(subType), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitArrayTypeExpression(*this);
 	}
@@ -374,16 +479,23 @@ class ArrayType : public Expression {
 class TupleType : public Expression {
   public:
 	bool isMutable;
-	std::vector<std::unique_ptr<Expression>> expressions;
+	std::vector<NodePtr<Expression>> expressions;
 	Token token;
 
 	TupleType(bool isMutable,
-	        std::vector<std::unique_ptr<Expression>> expressions,
+	        std::vector<NodePtr<Expression>> expressions,
 	        Token token):
 		isMutable(std::move(isMutable)),
 		expressions(std::move(expressions)),
 		token(std::move(token)) {}
 
+	static NodePtr<TupleType> create(Arena& arena,
+	        bool isMutable,
+	        std::vector<NodePtr<Expression>> expressions,
+	        Token token) {
+		return arena.make<TupleType>(std::move(isMutable), std::move(expressions), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitTupleTypeExpression(*this);
 	}
@@ -395,16 +507,23 @@ class TupleType : public Expression {
 class PointerType : public Expression {
   public:
 	bool isMutable;
-	std::unique_ptr<Expression> subtype;
+	NodePtr<Expression> subtype;
 	Token token;
 
 	PointerType(bool isMutable,
-	        std::unique_ptr<Expression> subtype,
+	        NodePtr<Expression> subtype,
 	        Token token):
 		isMutable(std::move(isMutable)),
 		subtype(std::move(subtype)),
 		token(std::move(token)) {}
 
+	static NodePtr<PointerType> create(Arena& arena,
+	        bool isMutable,
+	        NodePtr<Expression> subtype,
+	        Token token) {
+		return arena.make<PointerType>(std::move(isMutable), std::move(subtype), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitPointerTypeExpression(*this);
 	}
@@ -426,6 +545,13 @@ class NamedType : public Expression {
 		isMutable(std::move(isMutable)),
 		token(std::move(token)) {}
 
+	static NodePtr<NamedType> create(Arena& arena,
+	        Token name,
+	        bool isMutable,
+	        Token token) {
+		return arena.make<NamedType>(std::move(name), std::move(isMutable), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitNamedTypeExpression(*this);
 	}
@@ -436,17 +562,24 @@ class NamedType : public Expression {
 };
 class Cast : public Expression {
   public:
-	std::unique_ptr<Expression> expression;
-	std::unique_ptr<Expression> type;
+	NodePtr<Expression> expression;
+	NodePtr<Expression> type;
 	Token token;
 
-	Cast(std::unique_ptr<Expression> expression,
-	        std::unique_ptr<Expression> type,
+	Cast(NodePtr<Expression> expression,
+	        NodePtr<Expression> type,
 	        Token token):
 		expression(std::move(expression)),
 		type(std::move(type)),
 		token(std::move(token)) {}
 
+	static NodePtr<Cast> create(Arena& arena,
+	        NodePtr<Expression> expression,
+	        NodePtr<Expression> type,
+	        Token token) {
+		return arena.make<Cast>(std::move(expression), std::move(type), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitCastExpression(*this);
 	}
@@ -458,16 +591,23 @@ class Cast : public Expression {
 class Parameter : public Expression {
   public:
 	Token name;
-	std::unique_ptr<Expression> type;
+	NodePtr<Expression> type;
 	Token token;
 
 	Parameter(Token name,
-	        std::unique_ptr<Expression> type,
+	        NodePtr<Expression> type,
 	        Token token):
 		name(std::move(name)),
 		type(std::move(type)),
 		token(std::move(token)) {}
 
+	static NodePtr<Parameter> create(Arena& arena,
+	        Token name,
+	        NodePtr<Expression> type,
+	        Token token) {
+		return arena.make<Parameter>(std::move(name), std::move(type), std::move(token));
+	}
+
 	void visit(ExpressionVisitor& visitor) const override {
 		visitor.visitParameterExpression(*this);
 	}
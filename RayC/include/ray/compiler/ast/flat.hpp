@@ -0,0 +1,797 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <ray/compiler/lexer/token.hpp>
+#include <ray/compiler/ast/intrinsic.hpp>
+
+namespace ray::compiler::ast::flat {
+
+using CompDirectiveAttr = std::unordered_map<std::string, std::string>;
+
+// index of a node inside a Tree, default constructed ids refer to no node
+struct NodeId {
+	static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+	uint32_t index = invalidIndex;
+
+	bool valid() const { return index != invalidIndex; }
+	explicit operator bool() const { return valid(); }
+	bool operator==(const NodeId& other) const = default;
+};
+
+// index of a token inside a Tree
+using TokenId = uint32_t;
+
+// children of a node stored back to back inside a Tree
+struct NodeRange {
+	uint32_t first = 0;
+	uint32_t count = 0;
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+};
+
+enum class NodeKind : uint8_t {
+	Variable,
+	Intrinsic,
+	Assign,
+	Binary,
+	Call,
+	IntrinsicCall,
+	Get,
+	Grouping,
+	Literal,
+	Logical,
+	Set,
+	Unary,
+	ArrayAccess,
+	ArrayType,
+	TupleType,
+	PointerType,
+	NamedType,
+	Cast,
+	Parameter,
+	Block,
+	TerminalExpr,
+	ExpressionStmt,
+	Function,
+	If,
+	Jump,
+	VarDecl,
+	Member,
+	While,
+	Struct,
+	CompDirective,
+};
+
+// expression kinds are laid out first
+inline bool isExpression(NodeKind kind) { return kind <= NodeKind::Parameter; }
+inline bool isStatement(NodeKind kind) { return !isExpression(kind); }
+
+struct Variable {
+	static constexpr NodeKind nodeKind = NodeKind::Variable;
+	static constexpr std::string_view variantName() { return "Variable"; }
+
+	TokenId name;
+	TokenId token;
+};
+
+struct Intrinsic {
+	static constexpr NodeKind nodeKind = NodeKind::Intrinsic;
+	static constexpr std::string_view variantName() { return "Intrinsic"; }
+
+	TokenId name;
+	IntrinsicType intrinsic;
+	TokenId token;
+};
+
+struct Assign {
+	static constexpr NodeKind nodeKind = NodeKind::Assign;
+	static constexpr std::string_view variantName() { return "Assign"; }
+
+	NodeId lhs;
+	TokenId assignmentOp;
+	NodeId rhs;
+	TokenId token;
+};
+
+struct Binary {
+	static constexpr NodeKind nodeKind = NodeKind::Binary;
+	static constexpr std::string_view variantName() { return "Binary"; }
+
+	NodeId left;
+	TokenId op;
+	NodeId right;
+	TokenId token;
+};
+
+struct Call {
+	static constexpr NodeKind nodeKind = NodeKind::Call;
+	static constexpr std::string_view variantName() { return "Call"; }
+
+	NodeId callee;
+	TokenId paren;
+	NodeRange arguments;
+	TokenId token;
+};
+
+struct IntrinsicCall {
+	static constexpr NodeKind nodeKind = NodeKind::IntrinsicCall;
+	static constexpr std::string_view variantName() { return "IntrinsicCall"; }
+
+	NodeId callee;
+	TokenId paren;
+	NodeRange arguments;
+	TokenId token;
+};
+
+struct Get {
+	static constexpr NodeKind nodeKind = NodeKind::Get;
+	static constexpr std::string_view variantName() { return "Get"; }
+
+	NodeId object;
+	TokenId name;
+	TokenId token;
+};
+
+struct Grouping {
+	static constexpr NodeKind nodeKind = NodeKind::Grouping;
+	static constexpr std::string_view variantName() { return "Grouping"; }
+
+	NodeId expression;
+	TokenId token;
+};
+
+struct Literal {
+	static constexpr NodeKind nodeKind = NodeKind::Literal;
+	static constexpr std::string_view variantName() { return "Literal"; }
+
+	TokenId kind;
+	std::string_view value;
+	TokenId token;
+};
+
+struct Logical {
+	static constexpr NodeKind nodeKind = NodeKind::Logical;
+	static constexpr std::string_view variantName() { return "Logical"; }
+
+	NodeId left;
+	TokenId op;
+	NodeId right;
+	TokenId token;
+};
+
+struct Set {
+	static constexpr NodeKind nodeKind = NodeKind::Set;
+	static constexpr std::string_view variantName() { return "Set"; }
+
+	NodeId object;
+	TokenId name;
+	TokenId assignmentOp;
+	NodeId value;
+	TokenId token;
+};
+
+struct Unary {
+	static constexpr NodeKind nodeKind = NodeKind::Unary;
+	static constexpr std::string_view variantName() { return "Unary"; }
+
+	TokenId op;
+	bool isPrefix;
+	NodeId expr;
+	TokenId token;
+};
+
+struct ArrayAccess {
+	static constexpr NodeKind nodeKind = NodeKind::ArrayAccess;
+	static constexpr std::string_view variantName() { return "ArrayAccess"; }
+
+	NodeId array;
+	NodeId index;
+	TokenId token;
+};
+
+struct ArrayType {
+	static constexpr NodeKind nodeKind = NodeKind::ArrayType;
+	static constexpr std::string_view variantName() { return "ArrayType"; }
+
+	bool isMutable;
+	NodeId subType;
+	TokenId token;
+};
+
+struct TupleType {
+	static constexpr NodeKind nodeKind = NodeKind::TupleType;
+	static constexpr std::string_view variantName() { return "TupleType"; }
+
+	bool isMutable;
+	NodeRange expressions;
+	TokenId token;
+};
+
+struct PointerType {
+	static constexpr NodeKind nodeKind = NodeKind::PointerType;
+	static constexpr std::string_view variantName() { return "PointerType"; }
+
+	bool isMutable;
+	NodeId subtype;
+	TokenId token;
+};
+
+struct NamedType {
+	static constexpr NodeKind nodeKind = NodeKind::NamedType;
+	static constexpr std::string_view variantName() { return "NamedType"; }
+
+	TokenId name;
+	bool isMutable;
+	TokenId token;
+};
+
+struct Cast {
+	static constexpr NodeKind nodeKind = NodeKind::Cast;
+	static constexpr std::string_view variantName() { return "Cast"; }
+
+	NodeId expression;
+	NodeId type;
+	TokenId token;
+};
+
+struct Parameter {
+	static constexpr NodeKind nodeKind = NodeKind::Parameter;
+	static constexpr std::string_view variantName() { return "Parameter"; }
+
+	TokenId name;
+	NodeId type;
+	TokenId token;
+};
+
+struct Block {
+	static constexpr NodeKind nodeKind = NodeKind::Block;
+	static constexpr std::string_view variantName() { return "Block"; }
+
+	NodeRange statements;
+	TokenId token;
+};
+
+struct TerminalExpr {
+	static constexpr NodeKind nodeKind = NodeKind::TerminalExpr;
+	static constexpr std::string_view variantName() { return "TerminalExpr"; }
+
+	NodeId expression;
+	TokenId token;
+};
+
+struct ExpressionStmt {
+	static constexpr NodeKind nodeKind = NodeKind::ExpressionStmt;
+	static constexpr std::string_view variantName() { return "ExpressionStmt"; }
+
+	NodeId expression;
+	TokenId token;
+};
+
+struct Function {
+	static constexpr NodeKind nodeKind = NodeKind::Function;
+	static constexpr std::string_view variantName() { return "Function"; }
+
+	TokenId name;
+	bool publicVisibility;
+	NodeRange params;
+	NodeId body;
+	NodeId returnType;
+	TokenId token;
+};
+
+struct If {
+	static constexpr NodeKind nodeKind = NodeKind::If;
+	static constexpr std::string_view variantName() { return "If"; }
+
+	NodeId condition;
+	NodeId thenBranch;
+	NodeId elseBranch;
+	TokenId token;
+};
+
+struct Jump {
+	static constexpr NodeKind nodeKind = NodeKind::Jump;
+	static constexpr std::string_view variantName() { return "Jump"; }
+
+	TokenId keyword;
+	NodeId returnValue;
+	TokenId token;
+};
+
+struct VarDecl {
+	static constexpr NodeKind nodeKind = NodeKind::VarDecl;
+	static constexpr std::string_view variantName() { return "VarDecl"; }
+
+	TokenId name;
+	NodeId type;
+	bool is_mutable;
+	NodeId initializer;
+	TokenId token;
+};
+
+struct Member {
+	static constexpr NodeKind nodeKind = NodeKind::Member;
+	static constexpr std::string_view variantName() { return "Member"; }
+
+	TokenId name;
+	NodeId type;
+	bool is_mutable;
+	NodeId initializer;
+	TokenId token;
+};
+
+struct While {
+	static constexpr NodeKind nodeKind = NodeKind::While;
+	static constexpr std::string_view variantName() { return "While"; }
+
+	NodeId condition;
+	NodeId body;
+	TokenId token;
+};
+
+struct Struct {
+	static constexpr NodeKind nodeKind = NodeKind::Struct;
+	static constexpr std::string_view variantName() { return "Struct"; }
+
+	TokenId name;
+	bool publicVisibility;
+	bool declaration;
+	NodeRange members;
+	std::vector<bool> memberVisibility;
+	TokenId token;
+};
+
+struct CompDirective {
+	static constexpr NodeKind nodeKind = NodeKind::CompDirective;
+	static constexpr std::string_view variantName() { return "CompDirective"; }
+
+	TokenId name;
+	CompDirectiveAttr values;
+	NodeId child;
+	TokenId token;
+};
+
+// AST of a compilation unit stored as flat arrays, a node is its kind plus
+// an index into the payload table of that kind, children are referenced by
+// NodeId and variable sized children lists are slices of a shared array
+class Tree {
+	std::vector<NodeKind> kinds;
+	std::vector<uint32_t> payloads;
+	std::vector<NodeId> children;
+	std::vector<Token> tokens;
+	NodeRange roots;
+
+	std::vector<Variable> variableNodes;
+	std::vector<Intrinsic> intrinsicNodes;
+	std::vector<Assign> assignNodes;
+	std::vector<Binary> binaryNodes;
+	std::vector<Call> callNodes;
+	std::vector<IntrinsicCall> intrinsicCallNodes;
+	std::vector<Get> getNodes;
+	std::vector<Grouping> groupingNodes;
+	std::vector<Literal> literalNodes;
+	std::vector<Logical> logicalNodes;
+	std::vector<Set> setNodes;
+	std::vector<Unary> unaryNodes;
+	std::vector<ArrayAccess> arrayAccessNodes;
+	std::vector<ArrayType> arrayTypeNodes;
+	std::vector<TupleType> tupleTypeNodes;
+	std::vector<PointerType> pointerTypeNodes;
+	std::vector<NamedType> namedTypeNodes;
+	std::vector<Cast> castNodes;
+	std::vector<Parameter> parameterNodes;
+	std::vector<Block> blockNodes;
+	std::vector<TerminalExpr> terminalExprNodes;
+	std::vector<ExpressionStmt> expressionStmtNodes;
+	std::vector<Function> functionNodes;
+	std::vector<If> ifNodes;
+	std::vector<Jump> jumpNodes;
+	std::vector<VarDecl> varDeclNodes;
+	std::vector<Member> memberNodes;
+	std::vector<While> whileNodes;
+	std::vector<Struct> structNodes;
+	std::vector<CompDirective> compDirectiveNodes;
+
+  public:
+	size_t size() const { return kinds.size(); }
+	size_t tokenCount() const { return tokens.size(); }
+
+	NodeKind kind(NodeId id) const {
+		assert(id.index < kinds.size());
+		return kinds[id.index];
+	}
+	const Token& token(TokenId id) const {
+		assert(id < tokens.size());
+		return tokens[id];
+	}
+	std::span<const NodeId> range(NodeRange range) const {
+		return std::span<const NodeId>(children).subspan(range.first, range.count);
+	}
+	std::span<const NodeId> getRoots() const { return range(roots); }
+
+	template <typename T> const T& get(NodeId id) const {
+		assert(kind(id) == T::nodeKind);
+		return table(std::type_identity<T>())[payloads[id.index]];
+	}
+	// returns nullptr when the node is not of the requested kind
+	template <typename T> const T* tryGet(NodeId id) const {
+		return id && kind(id) == T::nodeKind ? &get<T>(id) : nullptr;
+	}
+
+	const Token& getToken(NodeId id) const {
+		switch (kind(id)) {
+		case NodeKind::Variable:
+			return token(get<Variable>(id).token);
+		case NodeKind::Intrinsic:
+			return token(get<Intrinsic>(id).token);
+		case NodeKind::Assign:
+			return token(get<Assign>(id).token);
+		case NodeKind::Binary:
+			return token(get<Binary>(id).token);
+		case NodeKind::Call:
+			return token(get<Call>(id).token);
+		case NodeKind::IntrinsicCall:
+			return token(get<IntrinsicCall>(id).token);
+		case NodeKind::Get:
+			return token(get<Get>(id).token);
+		case NodeKind::Grouping:
+			return token(get<Grouping>(id).token);
+		case NodeKind::Literal:
+			return token(get<Literal>(id).token);
+		case NodeKind::Logical:
+			return token(get<Logical>(id).token);
+		case NodeKind::Set:
+			return token(get<Set>(id).token);
+		case NodeKind::Unary:
+			return token(get<Unary>(id).token);
+		case NodeKind::ArrayAccess:
+			return token(get<ArrayAccess>(id).token);
+		case NodeKind::ArrayType:
+			return token(get<ArrayType>(id).token);
+		case NodeKind::TupleType:
+			return token(get<TupleType>(id).token);
+		case NodeKind::PointerType:
+			return token(get<PointerType>(id).token);
+		case NodeKind::NamedType:
+			return token(get<NamedType>(id).token);
+		case NodeKind::Cast:
+			return token(get<Cast>(id).token);
+		case NodeKind::Parameter:
+			return token(get<Parameter>(id).token);
+		case NodeKind::Block:
+			return token(get<Block>(id).token);
+		case NodeKind::TerminalExpr:
+			return token(get<TerminalExpr>(id).token);
+		case NodeKind::ExpressionStmt:
+			return token(get<ExpressionStmt>(id).token);
+		case NodeKind::Function:
+			return token(get<Function>(id).token);
+		case NodeKind::If:
+			return token(get<If>(id).token);
+		case NodeKind::Jump:
+			return token(get<Jump>(id).token);
+		case NodeKind::VarDecl:
+			return token(get<VarDecl>(id).token);
+		case NodeKind::Member:
+			return token(get<Member>(id).token);
+		case NodeKind::While:
+			return token(get<While>(id).token);
+		case NodeKind::Struct:
+			return token(get<Struct>(id).token);
+		case NodeKind::CompDirective:
+			return token(get<CompDirective>(id).token);
+		}
+		std::unreachable();
+	}
+	std::string_view variantName(NodeId id) const {
+		switch (kind(id)) {
+		case NodeKind::Variable:
+			return Variable::variantName();
+		case NodeKind::Intrinsic:
+			return Intrinsic::variantName();
+		case NodeKind::Assign:
+			return Assign::variantName();
+		case NodeKind::Binary:
+			return Binary::variantName();
+		case NodeKind::Call:
+			return Call::variantName();
+		case NodeKind::IntrinsicCall:
+			return IntrinsicCall::variantName();
+		case NodeKind::Get:
+			return Get::variantName();
+		case NodeKind::Grouping:
+			return Grouping::variantName();
+		case NodeKind::Literal:
+			return Literal::variantName();
+		case NodeKind::Logical:
+			return Logical::variantName();
+		case NodeKind::Set:
+			return Set::variantName();
+		case NodeKind::Unary:
+			return Unary::variantName();
+		case NodeKind::ArrayAccess:
+			return ArrayAccess::variantName();
+		case NodeKind::ArrayType:
+			return ArrayType::variantName();
+		case NodeKind::TupleType:
+			return TupleType::variantName();
+		case NodeKind::PointerType:
+			return PointerType::variantName();
+		case NodeKind::NamedType:
+			return NamedType::variantName();
+		case NodeKind::Cast:
+			return Cast::variantName();
+		case NodeKind::Parameter:
+			return Parameter::variantName();
+		case NodeKind::Block:
+			return Block::variantName();
+		case NodeKind::TerminalExpr:
+			return TerminalExpr::variantName();
+		case NodeKind::ExpressionStmt:
+			return ExpressionStmt::variantName();
+		case NodeKind::Function:
+			return Function::variantName();
+		case NodeKind::If:
+			return If::variantName();
+		case NodeKind::Jump:
+			return Jump::variantName();
+		case NodeKind::VarDecl:
+			return VarDecl::variantName();
+		case NodeKind::Member:
+			return Member::variantName();
+		case NodeKind::While:
+			return While::variantName();
+		case NodeKind::Struct:
+			return Struct::variantName();
+		case NodeKind::CompDirective:
+			return CompDirective::variantName();
+		}
+		std::unreachable();
+	}
+
+	// bytes used by the node storage, excluding unused capacity and memory
+	// owned by the payload values
+	size_t getBytesUsed() const {
+		return kinds.size() * sizeof(NodeKind) +
+		       payloads.size() * sizeof(uint32_t) +
+		       children.size() * sizeof(NodeId) +
+		       tokens.size() * sizeof(Token) +
+		       variableNodes.size() * sizeof(Variable) +
+		       intrinsicNodes.size() * sizeof(Intrinsic) +
+		       assignNodes.size() * sizeof(Assign) +
+		       binaryNodes.size() * sizeof(Binary) +
+		       callNodes.size() * sizeof(Call) +
+		       intrinsicCallNodes.size() * sizeof(IntrinsicCall) +
+		       getNodes.size() * sizeof(Get) +
+		       groupingNodes.size() * sizeof(Grouping) +
+		       literalNodes.size() * sizeof(Literal) +
+		       logicalNodes.size() * sizeof(Logical) +
+		       setNodes.size() * sizeof(Set) +
+		       unaryNodes.size() * sizeof(Unary) +
+		       arrayAccessNodes.size() * sizeof(ArrayAccess) +
+		       arrayTypeNodes.size() * sizeof(ArrayType) +
+		       tupleTypeNodes.size() * sizeof(TupleType) +
+		       pointerTypeNodes.size() * sizeof(PointerType) +
+		       namedTypeNodes.size() * sizeof(NamedType) +
+		       castNodes.size() * sizeof(Cast) +
+		       parameterNodes.size() * sizeof(Parameter) +
+		       blockNodes.size() * sizeof(Block) +
+		       terminalExprNodes.size() * sizeof(TerminalExpr) +
+		       expressionStmtNodes.size() * sizeof(ExpressionStmt) +
+		       functionNodes.size() * sizeof(Function) +
+		       ifNodes.size() * sizeof(If) +
+		       jumpNodes.size() * sizeof(Jump) +
+		       varDeclNodes.size() * sizeof(VarDecl) +
+		       memberNodes.size() * sizeof(Member) +
+		       whileNodes.size() * sizeof(While) +
+		       structNodes.size() * sizeof(Struct) +
+		       compDirectiveNodes.size() * sizeof(CompDirective);
+	}
+
+	template <typename T> NodeId add(T payload) {
+		auto& nodes = table(std::type_identity<T>());
+		assert(kinds.size() < NodeId::invalidIndex);
+		NodeId id{static_cast<uint32_t>(kinds.size())};
+		kinds.push_back(T::nodeKind);
+		payloads.push_back(static_cast<uint32_t>(nodes.size()));
+		nodes.push_back(std::move(payload));
+		return id;
+	}
+	TokenId addToken(const Token& token) {
+		tokens.push_back(token);
+		return static_cast<TokenId>(tokens.size() - 1);
+	}
+	NodeRange addRange(std::span<const NodeId> ids) {
+		NodeRange range{static_cast<uint32_t>(children.size()),
+		                static_cast<uint32_t>(ids.size())};
+		children.insert(children.end(), ids.begin(), ids.end());
+		return range;
+	}
+	void setRoots(NodeRange range) { roots = range; }
+
+  private:
+	const std::vector<Variable>& table(std::type_identity<Variable>) const { return variableNodes; }
+	std::vector<Variable>& table(std::type_identity<Variable>) { return variableNodes; }
+	const std::vector<Intrinsic>& table(std::type_identity<Intrinsic>) const { return intrinsicNodes; }
+	std::vector<Intrinsic>& table(std::type_identity<Intrinsic>) { return intrinsicNodes; }
+	const std::vector<Assign>& table(std::type_identity<Assign>) const { return assignNodes; }
+	std::vector<Assign>& table(std::type_identity<Assign>) { return assignNodes; }
+	const std::vector<Binary>& table(std::type_identity<Binary>) const { return binaryNodes; }
+	std::vector<Binary>& table(std::type_identity<Binary>) { return binaryNodes; }
+	const std::vector<Call>& table(std::type_identity<Call>) const { return callNodes; }
+	std::vector<Call>& table(std::type_identity<Call>) { return callNodes; }
+	const std::vector<IntrinsicCall>& table(std::type_identity<IntrinsicCall>) const { return intrinsicCallNodes; }
+	std::vector<IntrinsicCall>& table(std::type_identity<IntrinsicCall>) { return intrinsicCallNodes; }
+	const std::vector<Get>& table(std::type_identity<Get>) const { return getNodes; }
+	std::vector<Get>& table(std::type_identity<Get>) { return getNodes; }
+	const std::vector<Grouping>& table(std::type_identity<Grouping>) const { return groupingNodes; }
+	std::vector<Grouping>& table(std::type_identity<Grouping>) { return groupingNodes; }
+	const std::vector<Literal>& table(std::type_identity<Literal>) const { return literalNodes; }
+	std::vector<Literal>& table(std::type_identity<Literal>) { return literalNodes; }
+	const std::vector<Logical>& table(std::type_identity<Logical>) const { return logicalNodes; }
+	std::vector<Logical>& table(std::type_identity<Logical>) { return logicalNodes; }
+	const std::vector<Set>& table(std::type_identity<Set>) const { return setNodes; }
+	std::vector<Set>& table(std::type_identity<Set>) { return setNodes; }
+	const std::vector<Unary>& table(std::type_identity<Unary>) const { return unaryNodes; }
+	std::vector<Unary>& table(std::type_identity<Unary>) { return unaryNodes; }
+	const std::vector<ArrayAccess>& table(std::type_identity<ArrayAccess>) const { return arrayAccessNodes; }
+	std::vector<ArrayAccess>& table(std::type_identity<ArrayAccess>) { return arrayAccessNodes; }
+	const std::vector<ArrayType>& table(std::type_identity<ArrayType>) const { return arrayTypeNodes; }
+	std::vector<ArrayType>& table(std::type_identity<ArrayType>) { return arrayTypeNodes; }
+	const std::vector<TupleType>& table(std::type_identity<TupleType>) const { return tupleTypeNodes; }
+	std::vector<TupleType>& table(std::type_identity<TupleType>) { return tupleTypeNodes; }
+	const std::vector<PointerType>& table(std::type_identity<PointerType>) const { return pointerTypeNodes; }
+	std::vector<PointerType>& table(std::type_identity<PointerType>) { return pointerTypeNodes; }
+	const std::vector<NamedType>& table(std::type_identity<NamedType>) const { return namedTypeNodes; }
+	std::vector<NamedType>& table(std::type_identity<NamedType>) { return namedTypeNodes; }
+	const std::vector<Cast>& table(std::type_identity<Cast>) const { return castNodes; }
+	std::vector<Cast>& table(std::type_identity<Cast>) { return castNodes; }
+	const std::vector<Parameter>& table(std::type_identity<Parameter>) const { return parameterNodes; }
+	std::vector<Parameter>& table(std::type_identity<Parameter>) { return parameterNodes; }
+	const std::vector<Block>& table(std::type_identity<Block>) const { return blockNodes; }
+	std::vector<Block>& table(std::type_identity<Block>) { return blockNodes; }
+	const std::vector<TerminalExpr>& table(std::type_identity<TerminalExpr>) const { return terminalExprNodes; }
+	std::vector<TerminalExpr>& table(std::type_identity<TerminalExpr>) { return terminalExprNodes; }
+	const std::vector<ExpressionStmt>& table(std::type_identity<ExpressionStmt>) const { return expressionStmtNodes; }
+	std::vector<ExpressionStmt>& table(std::type_identity<ExpressionStmt>) { return expressionStmtNodes; }
+	const std::vector<Function>& table(std::type_identity<Function>) const { return functionNodes; }
+	std::vector<Function>& table(std::type_identity<Function>) { return functionNodes; }
+	const std::vector<If>& table(std::type_identity<If>) const { return ifNodes; }
+	std::vector<If>& table(std::type_identity<If>) { return ifNodes; }
+	const std::vector<Jump>& table(std::type_identity<Jump>) const { return jumpNodes; }
+	std::vector<Jump>& table(std::type_identity<Jump>) { return jumpNodes; }
+	const std::vector<VarDecl>& table(std::type_identity<VarDecl>) const { return varDeclNodes; }
+	std::vector<VarDecl>& table(std::type_identity<VarDecl>) { return varDeclNodes; }
+	const std::vector<Member>& table(std::type_identity<Member>) const { return memberNodes; }
+	std::vector<Member>& table(std::type_identity<Member>) { return memberNodes; }
+	const std::vector<While>& table(std::type_identity<While>) const { return whileNodes; }
+	std::vector<While>& table(std::type_identity<While>) { return whileNodes; }
+	const std::vector<Struct>& table(std::type_identity<Struct>) const { return structNodes; }
+	std::vector<Struct>& table(std::type_identity<Struct>) { return structNodes; }
+	const std::vector<CompDirective>& table(std::type_identity<CompDirective>) const { return compDirectiveNodes; }
+	std::vector<CompDirective>& table(std::type_identity<CompDirective>) { return compDirectiveNodes; }
+};
+
+// walks a Tree dispatching on the node kind, Derived implements the same
+// visit methods as the pointer tree visitors taking the node payloads
+template <typename Derived> class Visitor {
+	const Tree* currentTree = nullptr;
+
+  protected:
+	void bind(const Tree& tree) { currentTree = &tree; }
+	const Tree& tree() const {
+		assert(currentTree != nullptr);
+		return *currentTree;
+	}
+	const Token& token(TokenId id) const { return tree().token(id); }
+	const Token& getToken(NodeId id) const { return tree().getToken(id); }
+
+	void visit(NodeId id) {
+		Derived& derived = static_cast<Derived&>(*this);
+		const Tree& nodes = tree();
+		switch (nodes.kind(id)) {
+		case NodeKind::Variable:
+			derived.visitVariableExpression(nodes.get<Variable>(id));
+			break;
+		case NodeKind::Intrinsic:
+			derived.visitIntrinsicExpression(nodes.get<Intrinsic>(id));
+			break;
+		case NodeKind::Assign:
+			derived.visitAssignExpression(nodes.get<Assign>(id));
+			break;
+		case NodeKind::Binary:
+			derived.visitBinaryExpression(nodes.get<Binary>(id));
+			break;
+		case NodeKind::Call:
+			derived.visitCallExpression(nodes.get<Call>(id));
+			break;
+		case NodeKind::IntrinsicCall:
+			derived.visitIntrinsicCallExpression(nodes.get<IntrinsicCall>(id));
+			break;
+		case NodeKind::Get:
+			derived.visitGetExpression(nodes.get<Get>(id));
+			break;
+		case NodeKind::Grouping:
+			derived.visitGroupingExpression(nodes.get<Grouping>(id));
+			break;
+		case NodeKind::Literal:
+			derived.visitLiteralExpression(nodes.get<Literal>(id));
+			break;
+		case NodeKind::Logical:
+			derived.visitLogicalExpression(nodes.get<Logical>(id));
+			break;
+		case NodeKind::Set:
+			derived.visitSetExpression(nodes.get<Set>(id));
+			break;
+		case NodeKind::Unary:
+			derived.visitUnaryExpression(nodes.get<Unary>(id));
+			break;
+		case NodeKind::ArrayAccess:
+			derived.visitArrayAccessExpression(nodes.get<ArrayAccess>(id));
+			break;
+		case NodeKind::ArrayType:
+			derived.visitArrayTypeExpression(nodes.get<ArrayType>(id));
+			break;
+		case NodeKind::TupleType:
+			derived.visitTupleTypeExpression(nodes.get<TupleType>(id));
+			break;
+		case NodeKind::PointerType:
+			derived.visitPointerTypeExpression(nodes.get<PointerType>(id));
+			break;
+		case NodeKind::NamedType:
+			derived.visitNamedTypeExpression(nodes.get<NamedType>(id));
+			break;
+		case NodeKind::Cast:
+			derived.visitCastExpression(nodes.get<Cast>(id));
+			break;
+		case NodeKind::Parameter:
+			derived.visitParameterExpression(nodes.get<Parameter>(id));
+			break;
+		case NodeKind::Block:
+			derived.visitBlockStatement(nodes.get<Block>(id));
+			break;
+		case NodeKind::TerminalExpr:
+			derived.visitTerminalExprStatement(nodes.get<TerminalExpr>(id));
+			break;
+		case NodeKind::ExpressionStmt:
+			derived.visitExpressionStmtStatement(nodes.get<ExpressionStmt>(id));
+			break;
+		case NodeKind::Function:
+			derived.visitFunctionStatement(nodes.get<Function>(id));
+			break;
+		case NodeKind::If:
+			derived.visitIfStatement(nodes.get<If>(id));
+			break;
+		case NodeKind::Jump:
+			derived.visitJumpStatement(nodes.get<Jump>(id));
+			break;
+		case NodeKind::VarDecl:
+			derived.visitVarDeclStatement(nodes.get<VarDecl>(id));
+			break;
+		case NodeKind::Member:
+			derived.visitMemberStatement(nodes.get<Member>(id));
+			break;
+		case NodeKind::While:
+			derived.visitWhileStatement(nodes.get<While>(id));
+			break;
+		case NodeKind::Struct:
+			derived.visitStructStatement(nodes.get<Struct>(id));
+			break;
+		case NodeKind::CompDirective:
+			derived.visitCompDirectiveStatement(nodes.get<CompDirective>(id));
+			break;
+		}
+	}
+};
+
+} // namespace ray::compiler::ast::flat
@@ -0,0 +1,378 @@
+#pragma once
+#include <optional>
+#include <vector>
+#include <ray/compiler/ast/expression.hpp>
+#include <ray/compiler/ast/flat.hpp>
+#include <ray/compiler/ast/statement.hpp>
+#include <ray/util/counters.hpp>
+
+namespace ray::compiler::ast::flat {
+
+// lowers a pointer tree into a Tree, children are stored before their parent
+class Builder : public ast::ExpressionVisitor, public ast::StatementVisitor {
+	Tree tree;
+	NodeId lastNode;
+
+  public:
+	Tree build(const std::vector<NodePtr<ast::Statement>>& statements) {
+		tree = Tree();
+		NodeRange roots = lowerRange(statements);
+		tree.setRoots(roots);
+		util::threadCounters.astNodes += tree.size();
+		return std::move(tree);
+	}
+
+  private:
+	void visitVariableExpression(const ast::Variable& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId token = lowerToken(node.token);
+		lastNode = tree.add(Variable{
+		    .name = name,
+		    .token = token,
+		});
+	}
+	void visitIntrinsicExpression(const ast::Intrinsic& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId token = lowerToken(node.token);
+		lastNode = tree.add(Intrinsic{
+		    .name = name,
+		    .intrinsic = node.intrinsic,
+		    .token = token,
+		});
+	}
+	void visitAssignExpression(const ast::Assign& node) override {
+		TokenId assignmentOp = lowerToken(node.assignmentOp);
+		TokenId token = lowerToken(node.token);
+		NodeId lhs = lowerNode(node.lhs);
+		NodeId rhs = lowerNode(node.rhs);
+		lastNode = tree.add(Assign{
+		    .lhs = lhs,
+		    .assignmentOp = assignmentOp,
+		    .rhs = rhs,
+		    .token = token,
+		});
+	}
+	void visitBinaryExpression(const ast::Binary& node) override {
+		TokenId op = lowerToken(node.op);
+		TokenId token = lowerToken(node.token);
+		NodeId left = lowerNode(node.left);
+		NodeId right = lowerNode(node.right);
+		lastNode = tree.add(Binary{
+		    .left = left,
+		    .op = op,
+		    .right = right,
+		    .token = token,
+		});
+	}
+	void visitCallExpression(const ast::Call& node) override {
+		TokenId paren = lowerToken(node.paren);
+		TokenId token = lowerToken(node.token);
+		NodeId callee = lowerNode(node.callee);
+		NodeRange arguments = lowerRange(node.arguments);
+		lastNode = tree.add(Call{
+		    .callee = callee,
+		    .paren = paren,
+		    .arguments = arguments,
+		    .token = token,
+		});
+	}
+	void visitIntrinsicCallExpression(const ast::IntrinsicCall& node) override {
+		TokenId paren = lowerToken(node.paren);
+		TokenId token = lowerToken(node.token);
+		NodeId callee = lowerNode(node.callee);
+		NodeRange arguments = lowerRange(node.arguments);
+		lastNode = tree.add(IntrinsicCall{
+		    .callee = callee,
+		    .paren = paren,
+		    .arguments = arguments,
+		    .token = token,
+		});
+	}
+	void visitGetExpression(const ast::Get& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId token = lowerToken(node.token);
+		NodeId object = lowerNode(node.object);
+		lastNode = tree.add(Get{
+		    .object = object,
+		    .name = name,
+		    .token = token,
+		});
+	}
+	void visitGroupingExpression(const ast::Grouping& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeId expression = lowerNode(node.expression);
+		lastNode = tree.add(Grouping{
+		    .expression = expression,
+		    .token = token,
+		});
+	}
+	void visitLiteralExpression(const ast::Literal& node) override {
+		TokenId kind = lowerToken(node.kind);
+		TokenId token = lowerToken(node.token);
+		lastNode = tree.add(Literal{
+		    .kind = kind,
+		    .value = node.value,
+		    .token = token,
+		});
+	}
+	void visitLogicalExpression(const ast::Logical& node) override {
+		TokenId op = lowerToken(node.op);
+		TokenId token = lowerToken(node.token);
+		NodeId left = lowerNode(node.left);
+		NodeId right = lowerNode(node.right);
+		lastNode = tree.add(Logical{
+		    .left = left,
+		    .op = op,
+		    .right = right,
+		    .token = token,
+		});
+	}
+	void visitSetExpression(const ast::Set& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId assignmentOp = lowerToken(node.assignmentOp);
+		TokenId token = lowerToken(node.token);
+		NodeId object = lowerNode(node.object);
+		NodeId value = lowerNode(node.value);
+		lastNode = tree.add(Set{
+		    .object = object,
+		    .name = name,
+		    .assignmentOp = assignmentOp,
+		    .value = value,
+		    .token = token,
+		});
+	}
+	void visitUnaryExpression(const ast::Unary& node) override {
+		TokenId op = lowerToken(node.op);
+		TokenId token = lowerToken(node.token);
+		NodeId expr = lowerNode(node.expr);
+		lastNode = tree.add(Unary{
+		    .op = op,
+		    .isPrefix = node.isPrefix,
+		    .expr = expr,
+		    .token = token,
+		});
+	}
+	void visitArrayAccessExpression(const ast::ArrayAccess& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeId array = lowerNode(node.array);
+		NodeId index = lowerNode(node.index);
+		lastNode = tree.add(ArrayAccess{
+		    .array = array,
+		    .index = index,
+		    .token = token,
+		});
+	}
+	void visitArrayTypeExpression(const ast::ArrayType& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeId subType = lowerNode(node.subType);
+		lastNode = tree.add(ArrayType{
+		    .isMutable = node.isMutable,
+		    .subType = subType,
+		    .token = token,
+		});
+	}
+	void visitTupleTypeExpression(const ast::TupleType& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeRange expressions = lowerRange(node.expressions);
+		lastNode = tree.add(TupleType{
+		    .isMutable = node.isMutable,
+		    .expressions = expressions,
+		    .token = token,
+		});
+	}
+	void visitPointerTypeExpression(const ast::PointerType& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeId subtype = lowerNode(node.subtype);
+		lastNode = tree.add(PointerType{
+		    .isMutable = node.isMutable,
+		    .subtype = subtype,
+		    .token = token,
+		});
+	}
+	void visitNamedTypeExpression(const ast::NamedType& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId token = lowerToken(node.token);
+		lastNode = tree.add(NamedType{
+		    .name = name,
+		    .isMutable = node.isMutable,
+		    .token = token,
+		});
+	}
+	void visitCastExpression(const ast::Cast& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeId expression = lowerNode(node.expression);
+		NodeId type = lowerNode(node.type);
+		lastNode = tree.add(Cast{
+		    .expression = expression,
+		    .type = type,
+		    .token = token,
+		});
+	}
+	void visitParameterExpression(const ast::Parameter& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId token = lowerToken(node.token);
+		NodeId type = lowerNode(node.type);
+		lastNode = tree.add(Parameter{
+		    .name = name,
+		    .type = type,
+		    .token = token,
+		});
+	}
+	void visitBlockStatement(const ast::Block& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeRange statements = lowerRange(node.statements);
+		lastNode = tree.add(Block{
+		    .statements = statements,
+		    .token = token,
+		});
+	}
+	void visitTerminalExprStatement(const ast::TerminalExpr& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeId expression = lowerNode(node.expression);
+		lastNode = tree.add(TerminalExpr{
+		    .expression = expression,
+		    .token = token,
+		});
+	}
+	void visitExpressionStmtStatement(const ast::ExpressionStmt& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeId expression = lowerNode(node.expression);
+		lastNode = tree.add(ExpressionStmt{
+		    .expression = expression,
+		    .token = token,
+		});
+	}
+	void visitFunctionStatement(const ast::Function& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId token = lowerToken(node.token);
+		NodeRange params = lowerRange(node.params);
+		NodeId body = lowerNode(node.body);
+		NodeId returnType = lowerNode(node.returnType);
+		lastNode = tree.add(Function{
+		    .name = name,
+		    .publicVisibility = node.publicVisibility,
+		    .params = params,
+		    .body = body,
+		    .returnType = returnType,
+		    .token = token,
+		});
+	}
+	void visitIfStatement(const ast::If& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeId condition = lowerNode(node.condition);
+		NodeId thenBranch = lowerNode(node.thenBranch);
+		NodeId elseBranch = lowerNode(node.elseBranch);
+		lastNode = tree.add(If{
+		    .condition = condition,
+		    .thenBranch = thenBranch,
+		    .elseBranch = elseBranch,
+		    .token = token,
+		});
+	}
+	void visitJumpStatement(const ast::Jump& node) override {
+		TokenId keyword = lowerToken(node.keyword);
+		TokenId token = lowerToken(node.token);
+		NodeId returnValue = lowerNode(node.returnValue);
+		lastNode = tree.add(Jump{
+		    .keyword = keyword,
+		    .returnValue = returnValue,
+		    .token = token,
+		});
+	}
+	void visitVarDeclStatement(const ast::VarDecl& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId token = lowerToken(node.token);
+		NodeId type = lowerNode(node.type);
+		NodeId initializer = lowerNode(node.initializer);
+		lastNode = tree.add(VarDecl{
+		    .name = name,
+		    .type = type,
+		    .is_mutable = node.is_mutable,
+		    .initializer = initializer,
+		    .token = token,
+		});
+	}
+	void visitMemberStatement(const ast::Member& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId token = lowerToken(node.token);
+		NodeId type = lowerNode(node.type);
+		NodeId initializer = lowerNode(node.initializer);
+		lastNode = tree.add(Member{
+		    .name = name,
+		    .type = type,
+		    .is_mutable = node.is_mutable,
+		    .initializer = initializer,
+		    .token = token,
+		});
+	}
+	void visitWhileStatement(const ast::While& node) override {
+		TokenId token = lowerToken(node.token);
+		NodeId condition = lowerNode(node.condition);
+		NodeId body = lowerNode(node.body);
+		lastNode = tree.add(While{
+		    .condition = condition,
+		    .body = body,
+		    .token = token,
+		});
+	}
+	void visitStructStatement(const ast::Struct& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId token = lowerToken(node.token);
+		NodeRange members = lowerRange(node.members);
+		lastNode = tree.add(Struct{
+		    .name = name,
+		    .publicVisibility = node.publicVisibility,
+		    .declaration = node.declaration,
+		    .members = members,
+		    .memberVisibility = node.memberVisibility,
+		    .token = token,
+		});
+	}
+	void visitCompDirectiveStatement(const ast::CompDirective& node) override {
+		TokenId name = lowerToken(node.name);
+		TokenId token = lowerToken(node.token);
+		NodeId child = lowerNode(node.child);
+		lastNode = tree.add(CompDirective{
+		    .name = name,
+		    .values = node.values,
+		    .child = child,
+		    .token = token,
+		});
+	}
+
+	TokenId lowerToken(const Token& token) {
+		// nodes usually repeat one of their own tokens as location
+		if (tree.tokenCount() > 0) {
+			TokenId previous = static_cast<TokenId>(tree.tokenCount() - 1);
+			const Token& last = tree.token(previous);
+			if (last.type == token.type && last.line == token.line &&
+			    last.column == token.column &&
+			    last.lexeme.data() == token.lexeme.data() &&
+			    last.lexeme.size() == token.lexeme.size()) {
+				return previous;
+			}
+		}
+		return tree.addToken(token);
+	}
+	template <typename T> NodeId lowerNode(const T& node) {
+		node.visit(*this);
+		return lastNode;
+	}
+	template <typename T> NodeId lowerNode(const NodePtr<T>& node) {
+		return node ? lowerNode(*node) : NodeId();
+	}
+	template <typename T> NodeId lowerNode(const std::optional<T>& node) {
+		return node ? lowerNode(*node) : NodeId();
+	}
+	template <typename T> NodeRange lowerRange(const std::vector<T>& nodes) {
+		// children lower their own ranges first, collect before appending
+		std::vector<NodeId> ids;
+		ids.reserve(nodes.size());
+		for (const auto& node : nodes) {
+			ids.push_back(lowerNode(node));
+		}
+		return tree.addRange(ids);
+	}
+};
+
+} // namespace ray::compiler::ast::flat
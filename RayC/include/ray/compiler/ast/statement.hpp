@@ -4,6 +4,7 @@
 #include <vector>
 #include <optional>
 #include <ray/compiler/lexer/token.hpp>
+#include <ray/compiler/ast/arena.hpp>
 #include <ray/compiler/ast/expression.hpp>
 
 namespace ray::compiler::ast {
@@ -48,14 +49,20 @@ class Statement {
 
 class Block : public Statement {
   public:
-	std::vector<std::unique_ptr<Statement>> statements;
+	std::vector<NodePtr<Statement>> statements;
 	Token token;
 
-	Block(std::vector<std::unique_ptr<Statement>> statements,
+	Block(std::vector<NodePtr<Statement>> statements,
 	        Token token):
 		statements(std::move(statements)),
 		token(std::move(token)) {}
 
+	static NodePtr<Block> create(Arena& arena,
+	        std::vector<NodePtr<Statement>> statements,
+	        Token token) {
+		return arena.make<Block>(std::move(statements), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitBlockStatement(*this);
 	}
@@ -66,14 +73,20 @@ class Block : public Statement {
 };
 class TerminalExpr : public Statement {
   public:
-	std::optional<std::unique_ptr<Expression>> expression;
+	std::optional<NodePtr<Expression>> expression;
 	Token token;
 
-	TerminalExpr(std::optional<std::unique_ptr<Expression>> expression,
+	TerminalExpr(std::optional<NodePtr<Expression>> expression,
 	        Token token):
 		expression(std::move(expression)),
 		token(std::move(token)) {}
 
+	static NodePtr<TerminalExpr> create(Arena& arena,
+	        std::optional<NodePtr<Expression>> expression,
+	        Token token) {
+		return arena.make<TerminalExpr>(std::move(expression), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitTerminalExprStatement(*this);
 	}
@@ -84,14 +97,20 @@ class TerminalExpr : public Statement {
 };
 class ExpressionStmt : public Statement {
   public:
-	std::unique_ptr<Expression> expression;
+	NodePtr<Expression> expression;
 	Token token;
 
-	ExpressionStmt(std::unique_ptr<Expression> expression,
+	ExpressionStmt(NodePtr<Expression> expression,
 	        Token token):
 		expression(std::move(expression)),
 		token(std::move(token)) {}
 
+	static NodePtr<ExpressionStmt> create(Arena& arena,
+	        NodePtr<Expression> expression,
+	        Token token) {
+		return arena.make<ExpressionStmt>(std::move(expression), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitExpressionStmtStatement(*this);
 	}
@@ -106,14 +125,14 @@ class Function : public Statement {
 	bool publicVisibility;
 	std::vector<Parameter> params;
 	std::optional<Block> body;
-	std::unique_ptr<ast::Expression> returnType;
+	NodePtr<ast::Expression> returnType;
 	Token token;
 
 	Function(Token name,
 	        bool publicVisibility,
 	        std::vector<Parameter> params,
 	        std::optional<Block> body,
-	        std::unique_ptr<ast::Expression> returnType,
+	        NodePtr<ast::Expression> returnType,
 	        Token token):
 		name(std::move(name)),
 		publicVisibility(std::move(publicVisibility)),
@@ -122,6 +141,16 @@ class Function : public Statement {
 		returnType(std::move(returnType)),
 		token(std::move(token)) {}
 
+	static NodePtr<Function> create(Arena& arena,
+	        Token name,
+	        bool publicVisibility,
+	        std::vector<Parameter> params,
+	        std::optional<Block> body,
+	        NodePtr<ast::Expression> returnType,
+	        Token token) {
+		return arena.make<Function>(std::move(name), std::move(publicVisibility), std::move(params), std::move(body), std::move(returnType), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitFunctionStatement(*this);
 	}
@@ -132,20 +161,28 @@ class Function : public Statement {
 };
 class If : public Statement {
   public:
-	std::unique_ptr<Expression> condition;
-	std::unique_ptr<Statement> thenBranch;
-	std::optional<std::unique_ptr<Statement>> elseBranch;
+	NodePtr<Expression> condition;
+	NodePtr<Statement> thenBranch;
+	std::optional<NodePtr<Statement>> elseBranch;
 	Token token;
 
-	If(std::unique_ptr<Expression> condition,
-	        std::unique_ptr<Statement> thenBranch,
-	        std::optional<std::unique_ptr<Statement>> elseBranch,
+	If(NodePtr<Expression> condition,
+	        NodePtr<Statement> thenBranch,
+	        std::optional<NodePtr<Statement>> elseBranch,
 	        Token token):
 		condition(std::move(condition)),
 		thenBranch(std::move(thenBranch)),
 		elseBranch(std::move(elseBranch)),
 		token(std::move(token)) {}
 
+	static NodePtr<If> create(Arena& arena,
+	        NodePtr<Expression> condition,
+	        NodePtr<Statement> thenBranch,
+	        std::optional<NodePtr<Statement>> elseBranch,
+	        Token token) {
+		return arena.make<If>(std::move(condition), std::move(thenBranch), std::move(elseBranch), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitIfStatement(*this);
 	}
@@ -157,16 +194,23 @@ class If : public Statement {
 class Jump : public Statement {
   public:
 	Token keyword;
-	std::optional<std::unique_ptr<Expression>> returnValue;
+	std::optional<NodePtr<Expression>> returnValue;
 	Token token;
 
 	Jump(Token keyword,
-	        std::optional<std::unique_ptr<Expression>> returnValue,
+	        std::optional<NodePtr<Expression>> returnValue,
 	        Token token):
 		keyword(std::move(keyword)),
 		returnValue(std::move(returnValue)),
 		token(std::move(token)) {}
 
+	static NodePtr<Jump> create(Arena& arena,
+	        Token keyword,
+	        std::optional<NodePtr<Expression>> returnValue,
+	        Token token) {
+		return arena.make<Jump>(std::move(keyword), std::move(returnValue), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitJumpStatement(*this);
 	}
@@ -178,15 +222,15 @@ class Jump : public Statement {
 class VarDecl : public Statement {
   public:
 	Token name;
-	std::unique_ptr<Expression> type;
+	NodePtr<Expression> type;
 	bool is_mutable;
-	std::optional<std::unique_ptr<Expression>> initializer;
+	std::optional<NodePtr<Expression>> initializer;
 	Token token;
 
 	VarDecl(Token name,
-	        std::unique_ptr<Expression> type,
+	        NodePtr<Expression> type,
 	        bool is_mutable,
-	        std::optional<std::unique_ptr<Expression>> initializer,
+	        std::optional<NodePtr<Expression>> initializer,
 	        Token token):
 		name(std::move(name)),
 		type(std::move(type)),
@@ -194,6 +238,15 @@ class VarDecl : public Statement {
 		initializer(std::move(initializer)),
 		token(std::move(token)) {}
 
+	static NodePtr<VarDecl> create(Arena& arena,
+	        Token name,
+	        NodePtr<Expression> type,
+	        bool is_mutable,
+	        std::optional<NodePtr<Expression>> initializer,
+	        Token token) {
+		return arena.make<VarDecl>(std::move(name), std::move(type), std::move(is_mutable), std::move(initializer), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitVarDeclStatement(*this);
 	}
@@ -205,15 +258,15 @@ class VarDecl : public Statement {
 class Member : public Statement {
   public:
 	Token name;
-	std::unique_ptr<Expression> type;
+	NodePtr<Expression> type;
 	bool is_mutable;
-	std::optional<std::unique_ptr<Expression>> initializer;
+	std::optional<NodePtr<Expression>> initializer;
 	Token token;
 
 	Member(Token name,
-	        std::unique_ptr<Expression> type,
+	        NodePtr<Expression> type,
 	        bool is_mutable,
-	        std::optional<std::unique_ptr<Expression>> initializer,
+	        std::optional<NodePtr<Expression>> initializer,
 	        Token token):
 		name(std::move(name)),
 		type(std::move(type)),
@@ -221,6 +274,15 @@ class Member : public Statement {
 		initializer(std::move(initializer)),
 		token(std::move(token)) {}
 
+	static NodePtr<Member> create(Arena& arena,
+	        Token name,
+	        NodePtr<Expression> type,
+	        bool is_mutable,
+	        std::optional<NodePtr<Expression>> initializer,
+	        Token token) {
+		return arena.make<Member>(std::move(name), std::move(type), std::move(is_mutable), std::move(initializer), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitMemberStatement(*this);
 	}
@@ -231,17 +293,24 @@ class Member : public Statement {
 };
 class While : public Statement {
   public:
-	std::unique_ptr<Expression> condition;
-	std::unique_ptr<Statement> body;
+	NodePtr<Expression> condition;
+	NodePtr<Statement> body;
 	Token token;
 
-	While(std::unique_ptr<Expression> condition,
-	        std::unique_ptr<Statement> body,
+	While(NodePtr<Expression> condition,
+	        NodePtr<Statement> body,
 	        Token token):
 		condition(std::move(condition)),
 		body(std::move(body)),
 		token(std::move(token)) {}
 
+	static NodePtr<While> create(Arena& arena,
+	        NodePtr<Expression> condition,
+	        NodePtr<Statement> body,
+	        Token token) {
+		return arena.make<While>(std::move(condition), std::move(body), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitWhileStatement(*this);
 	}
@@ -272,6 +341,16 @@ class Struct : public Statement {
 		memberVisibility(std::move(memberVisibility)),
 		token(std::move(token)) {}
 
+	static NodePtr<Struct> create(Arena& arena,
+	        Token name,
+	        bool publicVisibility,
+	        bool declaration,
+	        std::vector<Member> members,
+	        std::vector<bool> memberVisibility,
+	        Token token) {
+		return arena.make<Struct>(std::move(name), std::move(publicVisibility), std::move(declaration), std::move(members), std::move(memberVisibility), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitStructStatement(*this);
 	}
@@ -284,18 +363,26 @@ class CompDirective : public Statement {
   public:
 	Token name;
 	CompDirectiveAttr values;
-	std::unique_ptr<Statement> child;
+	NodePtr<Statement> child;
 	Token token;
 
 	CompDirective(Token name,
 	        CompDirectiveAttr values,
-	        std::unique_ptr<Statement> child,
+	        NodePtr<Statement> child,
 	        Token token):
 		name(std::move(name)),
 		values(std::move(values)),
 		child(std::move(child)),
 		token(std::move(token)) {}
 
+	static NodePtr<CompDirective> create(Arena& arena,
+	        Token name,
+	        CompDirectiveAttr values,
+	        NodePtr<Statement> child,
+	        Token token) {
+		return arena.make<CompDirective>(std::move(name), std::move(values), std::move(child), std::move(token));
+	}
+
 	void visit(StatementVisitor& visitor) const override {
 		visitor.visitCompDirectiveStatement(*this);
 	}
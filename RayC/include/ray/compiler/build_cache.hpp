@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ray/compiler/environment/dataModel/dataModel.hpp>
+
+namespace ray::compiler {
+
+// the result of compiling a unit, replayed on a cache hit
+struct CachedUnit {
+	struct Dependency {
+		std::string importPath;
+		size_t line = 0;
+		size_t column = 0;
+		// interface hash of the module the import resolved to, the entry is
+		// stale once it changes
+		uint64_t interfaceHash = 0;
+	};
+
+	std::string sourceFile;
+	uint64_t contentHash = 0;
+	std::vector<Dependency> dependencies;
+	// units that failed type checking are cached as well, their errors are
+	// reported again without checking them
+	bool failed = false;
+	std::string diagnostics;
+	std::string output;
+};
+
+// content addressed store of compiled units. an entry is keyed by the source
+// hash of the unit along with everything else that changes its output: the
+// compiler version and the commit it was built from, the data model and the
+// target. the interfaces of its imports are validated by the caller as they
+// need the modules to be loaded
+class BuildCache {
+	std::filesystem::path directory;
+	uint64_t configurationHash;
+
+  public:
+	// bumped whenever the generated code or the entry layout changes
+	static constexpr uint32_t formatVersion = 1;
+
+	BuildCache(std::filesystem::path directory,
+	           const environment::DataModel &dataModel,
+	           std::string_view target);
+
+	std::optional<CachedUnit> find(std::string_view sourceFile,
+	                               uint64_t contentHash) const;
+	bool store(const CachedUnit &unit) const;
+
+  private:
+	std::filesystem::path entryPath(std::string_view sourceFile,
+	                                uint64_t contentHash) const;
+};
+
+} // namespace ray::compiler
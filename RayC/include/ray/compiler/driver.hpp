@@ -0,0 +1,36 @@
+#pragma once
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include <ray/cli/options.hpp>
+#include <ray/compiler/environment/dataModel/dataModel.hpp>
+#include <ray/compiler/lang/moduleStore.hpp>
+
+namespace ray::compiler {
+
+// runs a whole build, from reading the inputs to writing their C output.
+// imported modules are kept between builds so a long running server only
+// parses and checks again the modules whose files changed. names and types
+// interned by a build that loaded no module are released once it is done. a
+// driver runs one build at a time
+class Driver {
+	// keyed by the data model, packages and interface directory they were
+	// loaded with, any of them changes what a module resolves to
+	std::unordered_map<std::string, std::unique_ptr<lang::ModuleStore>>
+	    moduleStores;
+
+  public:
+	// parses the command line, errors in it are written to output and
+	// diagnostics of the build to diagnostics. returns the exit code
+	int run(int argc, char **argv, std::ostream &output,
+	        std::ostream &diagnostics);
+	int compile(cli::Options opts, std::ostream &diagnostics);
+
+  private:
+	lang::ModuleStore &moduleStoreFor(const cli::Options &opts,
+	                                  const environment::DataModel &dataModel);
+};
+
+} // namespace ray::compiler
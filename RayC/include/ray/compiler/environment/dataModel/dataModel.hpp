@@ -1,7 +1,11 @@
 #pragma once
 #include <cstddef>
 #include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
+#include <ray/compiler/lang/stringInterner.hpp>
 #include <ray/compiler/lang/type.hpp>
 
 namespace ray::compiler::environment {
@@ -10,16 +14,16 @@ class DataModel {
 	// allows to define a tuple type, its signature holds
 	lang::Type
 	defineTupleType(size_t tupleID,
-	                std::vector<util::copy_ptr<lang::Type>> signature,
+	                std::vector<lang::TypeRef> signature,
 	                size_t aproximatedSize) const;
 	// allows to define a struct type, if definition is external/unknown then
 	// the size is 0 and can only be referenced as a pointer
-	lang::Type defineStructType(size_t structID, std::string name,
+	lang::Type defineStructType(size_t structID, lang::InternedString name,
 	                            size_t aproximatedSize) const;
 	// defines a new function type
 	lang::Type
 	defineFunctionType(lang::Type returnType,
-	                   std::vector<util::copy_ptr<lang::Type>> signature) const;
+	                   std::vector<lang::TypeRef> signature) const;
 	// defines a type that specifies that it is an overloaded function type
 	lang::Type defineOverloadedFunctionType(lang::Type returnType) const;
 
@@ -28,8 +32,9 @@ class DataModel {
 
 	std::optional<lang::Type> findScalarType(const std::string_view name) const;
 
-	lang::Type defineScalarType(std::string name, size_t calculatedSize,
-	                            bool signedType, bool isMutable) const;
+	lang::Type defineScalarType(lang::InternedString name,
+	                            size_t calculatedSize, bool signedType,
+	                            bool isMutable) const;
 
 	lang::Type definePointerType(lang::Type returnType, bool isMutable) const;
 
@@ -47,33 +52,40 @@ class DataModel {
 
 	DataModel(const size_t charSize, const size_t shortIntSize,
 	          const size_t intSize, const size_t longIntSize,
-	          const size_t longLongSize, const size_t pointerSize)
-	    : charSize(charSize), shortIntSize(shortIntSize), intSize(intSize),
-	      longIntSize(longIntSize), longLongSize(longLongSize),
-	      pointerSize(pointerSize) {}
+	          const size_t longLongSize, const size_t pointerSize);
 
-	static DataModel &LLP64DataModel() {
+	static const DataModel &LLP64DataModel() {
 		static constexpr size_t CHAR_SIZE = 1;      // 8
 		static constexpr size_t SHORT_INT_SIZE = 2; // 16
 		static constexpr size_t INT_SIZE = 4;       // 32
 		static constexpr size_t LONG_INT_SIZE = 4;  // 32
 		static constexpr size_t LONG_LONG_SIZE = 8; // 64
 		static constexpr size_t POINTER_SIZE = 8;   // 64
-		static DataModel dataModel(CHAR_SIZE, SHORT_INT_SIZE, INT_SIZE,
-		                           LONG_INT_SIZE, LONG_LONG_SIZE, POINTER_SIZE);
+		static const DataModel dataModel(CHAR_SIZE, SHORT_INT_SIZE,
+		                                 INT_SIZE, LONG_INT_SIZE,
+		                                 LONG_LONG_SIZE, POINTER_SIZE);
 		return dataModel;
 	}
 
-	static DataModel &LP64DataModel() {
+	static const DataModel &LP64DataModel() {
 		static constexpr size_t CHAR_SIZE = 1;      // 8
 		static constexpr size_t SHORT_INT_SIZE = 2; // 16
 		static constexpr size_t INT_SIZE = 4;       // 32
 		static constexpr size_t LONG_INT_SIZE = 8;  // 64
 		static constexpr size_t LONG_LONG_SIZE = 8; // 64
 		static constexpr size_t POINTER_SIZE = 8;   // 64
-		static DataModel dataModel(CHAR_SIZE, SHORT_INT_SIZE, INT_SIZE,
-		                           LONG_INT_SIZE, LONG_LONG_SIZE, POINTER_SIZE);
+		static const DataModel dataModel(CHAR_SIZE, SHORT_INT_SIZE,
+		                                 INT_SIZE, LONG_INT_SIZE,
+		                                 LONG_LONG_SIZE, POINTER_SIZE);
 		return dataModel;
 	}
+
+  private:
+	// built once per data model as the sizes of some scalars depend on it, a
+	// data model is immutable afterwards so it can be shared between threads
+	const std::unordered_map<lang::InternedString, lang::Type> scalarTypes;
+
+	std::unordered_map<lang::InternedString, lang::Type>
+	defineScalarTypes() const;
 };
 } // namespace ray::compiler::environment
\ No newline at end of file
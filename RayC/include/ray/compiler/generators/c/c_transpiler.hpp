@@ -1,34 +1,40 @@
 #pragma once
 
 #include <cstddef>
+#include <filesystem>
 #include <functional>
+#include <optional>
 #include <memory>
-#include <sstream>
+#include <string>
 #include <string_view>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
-#include <ray/compiler/ast/expression.hpp>
-#include <ray/compiler/ast/statement.hpp>
+#include <ray/compiler/ast/flat.hpp>
 #include <ray/compiler/directives/compilerDirective.hpp>
 #include <ray/compiler/environment/dataModel/dataModel.hpp>
 #include <ray/compiler/lang/functionDefinition.hpp>
+#include <ray/compiler/lang/moduleStore.hpp>
 #include <ray/compiler/lang/sourceUnit.hpp>
 #include <ray/compiler/lang/struct.hpp>
 #include <ray/compiler/lang/symbol.hpp>
 #include <ray/compiler/lang/type.hpp>
 #include <ray/compiler/message_bag.hpp>
 #include <ray/compiler/passes/symbol_mangler.hpp>
+#include <ray/util/output_buffer.hpp>
 
 namespace ray::compiler::generator::c {
 
-class CTranspilerGenerator : public ast::StatementVisitor,
-                             public ast::ExpressionVisitor {
+class CTranspilerGenerator
+    : public ast::flat::Visitor<CTranspilerGenerator> {
+	friend class ast::flat::Visitor<CTranspilerGenerator>;
+
 	MessageBag messageBag;
-	std::stringstream output;
+	util::OutputBuffer output;
 	size_t ident = 0;
-
-	std::string currentIdent() const;
+	// functions with a smaller id were already declared in the output
+	size_t nextFunctionId = 0;
 
 	std::vector<std::string_view> namespaceStack;
 	std::vector<std::unique_ptr<directive::CompilerDirective>> directivesStack;
@@ -37,69 +43,93 @@ class CTranspilerGenerator : public ast::StatementVisitor,
 	passes::mangling::NameMangler nameMangler;
 
 	std::reference_wrapper<const lang::SourceUnit> currentSourceUnit;
-	std::reference_wrapper<const lang::Scope> currentScope;
 
 	std::reference_wrapper<const environment::DataModel> currentDataModel;
 
+	// imported modules, their public declarations are emitted with the unit
+	std::reference_wrapper<const lang::ModuleStore> moduleStore;
+	std::filesystem::path importer;
+
   public:
 	CTranspilerGenerator(std::string filePath,
+	                     const lang::ModuleStore &moduleStore,
+	                     std::filesystem::path importer,
 	                     const lang::SourceUnit &sourceUnit,
 	                     const environment::DataModel &dataModel);
 
-	void resolve(const std::vector<std::unique_ptr<ast::Statement>> &statement);
+	void resolve(const ast::flat::Tree &tree);
+	// emits the unit one root at a time instead, the type checker has to be
+	// done with a root before it is emitted. begin writes the struct
+	// definitions known from scanning, every root then declares the functions
+	// checked since the previous one before emitting itself
+	void begin(const ast::flat::Tree &tree);
+	void resolveRoot(ast::flat::NodeId root);
+	void end();
 
 	bool hasFailed() const;
 	const std::vector<std::string> getErrors() const;
 
 	std::string getOutput() const;
+	// hands the generated code over without joining it into one string, the
+	// code emitted afterwards starts a new buffer
+	util::OutputBuffer takeOutput() { return std::exchange(output, {}); }
+	size_t getOutputSize() const { return output.size(); }
 
 	// Statement
-	void visitBlockStatement(const ast::Block &value) override;
-	void visitTerminalExprStatement(const ast::TerminalExpr &value) override;
-	void
-	visitExpressionStmtStatement(const ast::ExpressionStmt &value) override;
-	void visitFunctionStatement(const ast::Function &value) override;
-	void visitIfStatement(const ast::If &value) override;
-	void visitJumpStatement(const ast::Jump &value) override;
-	void visitVarDeclStatement(const ast::VarDecl &value) override;
-	void visitMemberStatement(const ast::Member &value) override;
-	void visitWhileStatement(const ast::While &value) override;
-	void visitStructStatement(const ast::Struct &value) override;
-	void visitCompDirectiveStatement(const ast::CompDirective &value) override;
+	void visitBlockStatement(const ast::flat::Block &value);
+	void visitTerminalExprStatement(const ast::flat::TerminalExpr &value);
+	void visitExpressionStmtStatement(const ast::flat::ExpressionStmt &value);
+	void visitFunctionStatement(const ast::flat::Function &value);
+	void visitIfStatement(const ast::flat::If &value);
+	void visitJumpStatement(const ast::flat::Jump &value);
+	void visitVarDeclStatement(const ast::flat::VarDecl &value);
+	void visitMemberStatement(const ast::flat::Member &value);
+	void visitWhileStatement(const ast::flat::While &value);
+	void visitStructStatement(const ast::flat::Struct &value);
+	void visitCompDirectiveStatement(const ast::flat::CompDirective &value);
 	// Expression
-	void visitVariableExpression(const ast::Variable &value) override;
-	void visitIntrinsicExpression(const ast::Intrinsic &value) override;
-	void visitAssignExpression(const ast::Assign &value) override;
-	void visitBinaryExpression(const ast::Binary &value) override;
-	void visitCallExpression(const ast::Call &value) override;
-	void visitIntrinsicCallExpression(const ast::IntrinsicCall &value) override;
-	void visitGetExpression(const ast::Get &value) override;
-	void visitGroupingExpression(const ast::Grouping &value) override;
-	void visitLiteralExpression(const ast::Literal &value) override;
-	void visitLogicalExpression(const ast::Logical &value) override;
-	void visitSetExpression(const ast::Set &value) override;
-	void visitUnaryExpression(const ast::Unary &value) override;
-	void visitArrayAccessExpression(const ast::ArrayAccess &value) override;
-	void visitArrayTypeExpression(const ast::ArrayType &value) override;
-	void visitTupleTypeExpression(const ast::TupleType &value) override;
-	void visitPointerTypeExpression(const ast::PointerType &value) override;
-	void visitNamedTypeExpression(const ast::NamedType &value) override;
-	void visitCastExpression(const ast::Cast &value) override;
-	void visitParameterExpression(const ast::Parameter &value) override;
+	void visitVariableExpression(const ast::flat::Variable &value);
+	void visitIntrinsicExpression(const ast::flat::Intrinsic &value);
+	void visitAssignExpression(const ast::flat::Assign &value);
+	void visitBinaryExpression(const ast::flat::Binary &value);
+	void visitCallExpression(const ast::flat::Call &value);
+	void visitIntrinsicCallExpression(const ast::flat::IntrinsicCall &value);
+	void visitGetExpression(const ast::flat::Get &value);
+	void visitGroupingExpression(const ast::flat::Grouping &value);
+	void visitLiteralExpression(const ast::flat::Literal &value);
+	void visitLogicalExpression(const ast::flat::Logical &value);
+	void visitSetExpression(const ast::flat::Set &value);
+	void visitUnaryExpression(const ast::flat::Unary &value);
+	void visitArrayAccessExpression(const ast::flat::ArrayAccess &value);
+	void visitArrayTypeExpression(const ast::flat::ArrayType &value);
+	void visitTupleTypeExpression(const ast::flat::TupleType &value);
+	void visitPointerTypeExpression(const ast::flat::PointerType &value);
+	void visitNamedTypeExpression(const ast::flat::NamedType &value);
+	void visitCastExpression(const ast::flat::Cast &value);
+	void visitParameterExpression(const ast::flat::Parameter &value);
 
   private:
-	void visitType(const lang::Type &type);
-
-	std::string findCallableName(const ast::Call &callable,
-	                             const std::string_view name) const;
+	// declarations and types of a signature are looked up in the unit that
+	// declared them, which is not the current one for imported functions
+	void declareFunction(const lang::FunctionDeclaration &functionDeclaration,
+	                     const lang::SourceUnit &sourceUnit);
+	void visitType(const lang::Type &type, const lang::SourceUnit &sourceUnit);
+	void declareImports(const ast::flat::Tree &tree);
+
+	std::string findCallableName(const ast::flat::Call &callable,
+	                             const std::string_view name,
+	                             const lang::SourceUnit &sourceUnit) const;
+	// the module an expression names, either an @import call or a variable
+	// initialized by one
+	std::optional<lang::ModuleId> findModule(ast::flat::NodeId expression);
 	std::string findStructName(const std::string_view name) const;
 
 	std::optional<lang::Type> findScalarTypeInfo(const std::string_view lexeme);
 	std::optional<lang::Type> findTypeInfo(const std::string_view lexeme);
-	std::optional<lang::Type> getTypeExpression(const ast::Expression *);
+	std::optional<lang::Type> getTypeExpression(ast::flat::NodeId expression);
 
 	void defineStruct(std::unordered_set<size_t> &visitedStructs,
-	                  const lang::Struct &);
+	                  const lang::Struct &, const lang::SourceUnit &sourceUnit);
 };
 
 } // namespace ray::compiler::generator::c
@@ -1,18 +1,17 @@
 #pragma once
 #include <functional>
-#include <string>
 
-#include <ray/compiler/ast/statement.hpp>
+#include <ray/compiler/ast/flat.hpp>
 #include <ray/compiler/environment/dataModel/dataModel.hpp>
+#include <ray/compiler/lang/stringInterner.hpp>
 #include <ray/compiler/lang/type.hpp>
-#include <ray/util/copy_ptr.hpp>
 #include <vector>
 
 namespace ray::compiler::lang {
 
 class FunctionParameter {
   public:
-	std::string name;
+	InternedString name;
 	Type parameterType;
 
 	bool operator==(const FunctionParameter &other) const {
@@ -25,7 +24,7 @@ struct FunctionSignature {
 	std::vector<FunctionParameter> parameters;
 
 	Type getFunctionType(const environment::DataModel &dataModel) const {
-		std::vector<util::copy_ptr<Type>> signature;
+		std::vector<TypeRef> signature;
 		for (const auto &parameter : parameters) {
 			signature.push_back(parameter.parameterType);
 		}
@@ -39,15 +38,15 @@ struct FunctionSignature {
 
 struct FunctionDeclaration {
 	size_t functionID;
-	std::string name;
-	std::string mangledName;
+	InternedString name;
+	InternedString mangledName;
 	bool publicVisibility;
 	FunctionSignature signature;
 };
 
 struct FunctionDefinition {
 	FunctionDeclaration declaration;
-	std::reference_wrapper<const ast::Function> function;
+	std::reference_wrapper<const ast::flat::Function> function;
 };
 
 } // namespace ray::compiler::lang
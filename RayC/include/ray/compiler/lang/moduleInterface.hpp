@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ray/compiler/environment/dataModel/dataModel.hpp>
+#include <ray/compiler/lang/functionDefinition.hpp>
+#include <ray/compiler/lang/sourceUnit.hpp>
+#include <ray/compiler/lang/struct.hpp>
+
+namespace ray::compiler::lang {
+
+// FNV-1a of a module source, identifies its contents within and across builds
+uint64_t hashSource(std::string_view contents);
+
+// the declarations a module exposes to its importers. it is stored as a
+// msgpack encoded .rayi file so importers can declare them without lexing,
+// parsing and checking the module again
+struct ModuleInterface {
+	// bumped whenever the layout of the file changes
+	static constexpr uint32_t formatVersion = 2;
+
+	struct Import {
+		std::string path;
+		size_t line = 0;
+		size_t column = 0;
+	};
+
+	uint64_t contentHash = 0;
+	std::vector<Import> imports;
+	// every struct is kept as public ones may hold private ones by value,
+	// struct types reference them by their position starting at 1
+	std::vector<Struct> structs;
+	std::vector<FunctionDeclaration> functions;
+
+	// takes the public functions and the structs declared in the unit
+	static ModuleInterface fromSourceUnit(const SourceUnit &sourceUnit,
+	                                      uint64_t contentHash,
+	                                      std::vector<Import> imports);
+	// declares the interface in the root scope of an empty unit, struct ids
+	// are assigned again so every type referencing them is remapped
+	void declareInto(SourceUnit &sourceUnit) const;
+	// changes only when the declarations seen by importers change, unlike
+	// the source hash it ignores edits to bodies and private functions
+	uint64_t declarationsHash(const environment::DataModel &dataModel) const;
+
+	// everything besides the source that decides what an interface holds:
+	// the compiler version and the commit it was built from, the name
+	// mangler, the file layout and the data model. mangled names and type
+	// layouts written by another compiler are never read back
+	static uint64_t
+	configurationHash(const environment::DataModel &dataModel);
+
+	std::string serialize(const environment::DataModel &dataModel) const;
+	// nullopt when the data is not a valid interface for this compiler and
+	// data model
+	static std::optional<ModuleInterface>
+	deserialize(std::string_view data,
+	            const environment::DataModel &dataModel);
+
+	// the file name includes the content and configuration hashes so edited
+	// sources never match a stale interface and compilers sharing a
+	// directory do not overwrite each other
+	static std::filesystem::path
+	pathFor(const std::filesystem::path &directory,
+	        const std::filesystem::path &source, uint64_t contentHash,
+	        const environment::DataModel &dataModel);
+	static std::optional<ModuleInterface>
+	read(const std::filesystem::path &path,
+	     const environment::DataModel &dataModel);
+	// written to a temporary file first so concurrent builds never read a
+	// partial interface
+	bool write(const std::filesystem::path &path,
+	           const environment::DataModel &dataModel) const;
+};
+
+} // namespace ray::compiler::lang
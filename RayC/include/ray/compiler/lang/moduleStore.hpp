@@ -1,8 +1,143 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ray/compiler/ast/flat.hpp>
+#include <ray/compiler/environment/dataModel/dataModel.hpp>
+#include <ray/compiler/lang/sourceUnit.hpp>
+#include <ray/compiler/lexer/lexer.hpp>
+#include <ray/compiler/lexer/token.hpp>
+#include <ray/compiler/source_buffer.hpp>
 
 namespace ray::compiler::lang {
+
+using ModuleId = uint32_t;
+
+// an imported module parsed and checked once, the tree keeps views into the
+// source and the lexer literals so the module owns all of them. modules read
+// from an interface file have no lexer nor tree
+struct Module {
+	std::filesystem::path path;
+	uint64_t contentHash = 0;
+	// hash of the declarations importers see, see ModuleInterface
+	uint64_t interfaceHash = 0;
+	std::optional<SourceBuffer> source;
+	std::unique_ptr<Lexer> lexer;
+	ast::flat::Tree tree;
+	// declarations of the module, the interface seen by its importers
+	SourceUnit sourceUnit;
+	std::vector<ModuleId> dependencies;
+	// only imports prefixed by a package, so its interface does not depend on
+	// where the file lives and can be shared by equal contents
+	bool relocatable = true;
+	bool failed = false;
+};
+
+// loads the modules imported by a compilation unit, resolving
+// "package:path/file.ray" against the registered package roots and plain paths
+// against the importing file. modules are cached by path and by content so
+// each one is parsed and checked once no matter how many times it is imported,
+// with an interface directory later builds load their .rayi file instead
 class ModuleStore {
+	std::reference_wrapper<const environment::DataModel> dataModel;
+	std::unordered_map<std::string, std::filesystem::path> packages;
+	// where .rayi interfaces are read from and written to, if any
+	std::optional<std::filesystem::path> interfaceDirectory;
+
+	// modules never move so their trees and source units can be borrowed
+	std::vector<std::unique_ptr<Module>> modules;
+	std::unordered_map<std::string, ModuleId> pathIds;
+	std::unordered_map<uint64_t, ModuleId> contentIds;
+	// canonical paths of the files being loaded, starting with the unit that
+	// asked for its imports, importing any of them again is a cycle
+	std::vector<std::string> loadingPaths;
+
+	std::vector<std::string> errors;
 
   public:
+	struct Import {
+		std::string path;
+		// the @import intrinsic, used to report errors about the import
+		Token token;
+
+		// an import stored in a file, only the position of the call is kept
+		static Import at(std::string path, size_t line, size_t column) {
+			return {.path = std::move(path),
+			        .token = Token{.type = Token::TokenType::TOKEN_INTRINSIC,
+			                       .lexeme = "@import",
+			                       .line = line,
+			                       .column = column}};
+		}
+	};
+
+	explicit ModuleStore(const environment::DataModel &dataModel)
+	    : dataModel(dataModel) {}
+	ModuleStore(const ModuleStore &) = delete;
+	ModuleStore &operator=(const ModuleStore &) = delete;
+
+	void addPackage(std::string name, std::filesystem::path root);
+	void setInterfaceDirectory(std::filesystem::path directory);
+
+	std::optional<std::filesystem::path>
+	resolvePath(std::string_view importPath,
+	            const std::filesystem::path &importer) const;
+
+	// loads every module imported from the tree of the given file, errors
+	// found by this call are appended to getErrors. loading is not thread
+	// safe, once every unit loaded its imports the store is only read
+	[[nodiscard("must check if the imports could be loaded")]]
+	bool loadImports(const ast::flat::Tree &tree,
+	                 const std::filesystem::path &importer);
+	// same for imports that were already collected, as cached units do
+	[[nodiscard("must check if the imports could be loaded")]]
+	bool loadImports(const std::vector<Import> &imports,
+	                 const std::filesystem::path &importer);
+
+	std::optional<ModuleId>
+	findModule(std::string_view importPath,
+	           const std::filesystem::path &importer) const;
+	const Module &getModule(ModuleId id) const { return *modules[id]; }
+	size_t size() const { return modules.size(); }
+
+	// dependencies come before the modules importing them
+	std::vector<ModuleId> topologicalOrder() const;
+
+	// forgets the modules whose file changed since they were loaded, those
+	// importing them and those that failed, along with the errors reported so
+	// far. the next build loads them again while the rest stay checked
+	void refresh();
+
+	bool failed() const { return !errors.empty(); }
+	const std::vector<std::string> &getErrors() const { return errors; }
+
+	// @import calls with a literal path in the tree, in the order they appear
+	static std::vector<Import> collectImports(const ast::flat::Tree &tree);
+
+  private:
+	// loads the given imports, returns the ids of the loaded modules
+	std::vector<ModuleId> loadImportList(const std::vector<Import> &imports,
+	                                     const std::filesystem::path &importer,
+	                                     bool &relocatable);
+	std::optional<ModuleId> load(const std::filesystem::path &path);
+	// whether a module reachable from the dependencies failed to load
+	bool dependsOnFailed(const std::vector<ModuleId> &dependencies) const;
+	// declares the module from its interface file, returns the imports it
+	// had or nullopt when there is no usable interface
+	std::optional<std::vector<Import>> readInterface(Module &module);
+	// also sets the interface hash of the module
+	void writeInterface(Module &module,
+	                    const std::vector<Import> &imports) const;
+	void parse(Module &module);
+	void check(Module &module);
 };
-} // namespace ray::compiler::lang
\ No newline at end of file
+
+} // namespace ray::compiler::lang
@@ -1,13 +1,15 @@
 #pragma once
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
-#include <ray/util/copy_ptr.hpp>
 #include <ray/util/soft_reference.hpp>
 
 #include <ray/compiler/lang/functionDefinition.hpp>
+#include <ray/compiler/lang/stringInterner.hpp>
 #include <ray/compiler/lang/struct.hpp>
 #include <ray/compiler/lang/symbol.hpp>
 #include <ray/compiler/lang/type.hpp>
@@ -17,39 +19,42 @@ class Scope;
 class Scope {
 	std::string scopeName;
 	std::optional<std::reference_wrapper<Scope>> parentScope;
-	std::vector<util::copy_ptr<Scope>> innerScopes;
+	// children link back to their parent so scopes never move once created
+	std::vector<std::unique_ptr<Scope>> innerScopes;
 
-	std::unordered_map<std::string, util::soft_reference<Symbol>> variables;
-	std::unordered_map<std::string,
+	// keyed by interned name so lookups only hash and compare the id
+	std::unordered_map<InternedString, util::soft_reference<Symbol>> variables;
+	std::unordered_map<InternedString,
 	                   std::vector<util::soft_reference<FunctionDeclaration>>>
 	    functions;
-	std::unordered_map<std::string, util::soft_reference<Struct>> structs;
+	std::unordered_map<InternedString, util::soft_reference<Struct>> structs;
 
   public:
 	Scope(
 	    std::optional<std::reference_wrapper<Scope>> parentScope = std::nullopt)
 	    : parentScope(parentScope) {}
+	Scope(const Scope &) = delete;
+	Scope &operator=(const Scope &) = delete;
 
 	bool bindStruct(Struct &&structRef);
 	bool bindFunctionDeclaration(
-	    std::string_view name,
+	    InternedString name,
 	    util::soft_reference<FunctionDeclaration> &functionDeclarationRef);
 
 	bool declareStruct(const util::soft_reference<Struct> &structRef);
 	bool declareLocalVariable(const util::soft_reference<Symbol> symbolRef);
 
 	const std::optional<const util::soft_reference<Symbol>>
-	findVariable(const std::string_view name) const;
+	findVariable(const InternedString name) const;
 
-	const std::optional<
-	    const std::vector<util::soft_reference<FunctionDeclaration>>>
-	findLocalFunctionDeclaration(const std::string_view name) const;
+	std::span<const util::soft_reference<FunctionDeclaration>>
+	findLocalFunctionDeclaration(const InternedString name) const;
 
 	const std::optional<const util::soft_reference<Struct>>
-	findLocalStruct(const std::string_view name) const;
+	findLocalStruct(const InternedString name) const;
 
 	std::optional<util::soft_reference<Struct>>
-	findLocalStruct(const std::string_view name);
+	findLocalStruct(const InternedString name);
 
 	Scope &makeChildScope();
 	std::optional<std::reference_wrapper<Scope>> getParentScope() const {
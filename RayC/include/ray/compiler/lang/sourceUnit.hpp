@@ -2,17 +2,24 @@
 
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string_view>
 #include <unordered_map>
 
 #include <ray/compiler/lang/functionDefinition.hpp>
 #include <ray/compiler/lang/scope.hpp>
+#include <ray/compiler/lang/stringInterner.hpp>
 #include <ray/compiler/lang/struct.hpp>
 #include <ray/compiler/lang/symbol.hpp>
+#include <ray/compiler/lang/symbolTable.hpp>
 #include <ray/util/soft_reference.hpp>
 
 namespace ray::compiler::lang {
+// symbols, declarations and scopes of a compilation unit, it is created once
+// and every pass borrows it to read or extend it in place. soft references and
+// scopes point into it so it can be moved but never copied
 class SourceUnit {
 	size_t nextId = 1;
 
@@ -20,8 +27,26 @@ class SourceUnit {
 	std::unordered_map<size_t, FunctionDeclaration> functions;
 	std::unordered_map<size_t, Struct> structs;
 
+	// symbols visible from the innermost scope entered, declarations are
+	// expected to happen on that scope
+	SymbolTable symbols;
+
+	// heap allocated so child scopes keep a valid parent when the unit moves
+	std::unique_ptr<Scope> rootScope = std::make_unique<Scope>();
+
   public:
-	Scope rootScope;
+	SourceUnit() = default;
+	SourceUnit(const SourceUnit &) = delete;
+	SourceUnit &operator=(const SourceUnit &) = delete;
+	SourceUnit(SourceUnit &&) = default;
+	SourceUnit &operator=(SourceUnit &&) = default;
+
+	Scope &getRootScope() { return *rootScope; }
+	const Scope &getRootScope() const { return *rootScope; }
+
+	Scope &enterScope(Scope &parentScope);
+	// leaves the innermost scope entered, dropping its bindings from lookups
+	void leaveScope();
 
 	[[nodiscard("must check declaration result")]]
 	bool declareLocalVariable(const Symbol symbol, Scope &scope);
@@ -31,12 +56,21 @@ class SourceUnit {
 	[[nodiscard("must check struct declaration result")]]
 	bool declareStruct(const Struct &structobj, Scope &scope);
 
-	std::vector<util::soft_reference<FunctionDeclaration>>
-	findFunctionDeclarations(const std::string_view functionName,
-	                         const Scope &currentScope) const;
+	// lookups are resolved from the innermost scope entered
+	std::optional<util::soft_reference<Symbol>>
+	findVariable(const InternedString name) const;
+	std::span<const util::soft_reference<FunctionDeclaration>>
+	findFunctionDeclarations(const InternedString functionName) const;
+	std::optional<std::reference_wrapper<Struct>>
+	findStruct(const InternedString structName) const;
+	// the same lookups by source text, a name that was never interned is
+	// not declared anywhere and is not added by the lookup
+	std::optional<util::soft_reference<Symbol>>
+	findVariable(std::string_view name) const;
+	std::span<const util::soft_reference<FunctionDeclaration>>
+	findFunctionDeclarations(std::string_view functionName) const;
 	std::optional<std::reference_wrapper<Struct>>
-	findStruct(const std::string_view structName,
-	           const Scope &currentScope) const;
+	findStruct(std::string_view structName) const;
 
 	const std::unordered_map<size_t, FunctionDeclaration> &
 	getFunctions() const {
@@ -45,5 +79,8 @@ class SourceUnit {
 	const std::unordered_map<size_t, Struct> &getStructs() const {
 		return structs;
 	}
+	// ids are handed out in declaration order, everything declared later
+	// gets an id at least as large as this one
+	size_t getNextId() const { return nextId; }
 };
 } // namespace ray::compiler::lang
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ray::compiler::lang {
+
+// handle to a string owned by the StringInterner, equal strings always get the
+// same id so comparing and hashing names is an integer operation
+class InternedString {
+	// 0 is reserved for the empty string
+	uint32_t id = 0;
+
+	explicit InternedString(uint32_t id) : id(id) {}
+	friend class StringInterner;
+
+  public:
+	InternedString() = default;
+	// interns the value, lookups that must not add names use
+	// StringInterner::find instead
+	explicit InternedString(std::string_view value);
+	explicit InternedString(const std::string &value)
+	    : InternedString(std::string_view(value)) {}
+	explicit InternedString(const char *value)
+	    : InternedString(std::string_view(value)) {}
+
+	uint32_t getId() const { return id; }
+	bool empty() const { return id == 0; }
+	std::string_view view() const;
+	std::string str() const { return std::string(view()); }
+	operator std::string_view() const { return view(); }
+
+	bool operator==(const InternedString &other) const = default;
+};
+
+// compilation wide string table. strings are only released by releaseFrom,
+// which a long running driver calls between builds, so the views handed out
+// stay valid while anything interned before them is still in use
+class StringInterner {
+	// the views live in segments that double in size and never move, so
+	// view() can read them without taking the lock. segment k holds ids
+	// [2^k - 1, 2^(k+1) - 1)
+	static constexpr size_t segmentCount = 32;
+
+	mutable std::shared_mutex mutex;
+	// deque so growing never moves the strings the views point to
+	std::deque<std::string> storage;
+	std::array<std::atomic<std::string_view *>, segmentCount> segments{};
+	std::atomic<uint32_t> count = 0;
+	std::unordered_map<std::string_view, uint32_t> ids;
+
+	StringInterner();
+
+  public:
+	StringInterner(const StringInterner &) = delete;
+	StringInterner &operator=(const StringInterner &) = delete;
+	~StringInterner();
+
+	static StringInterner &global();
+
+	InternedString intern(std::string_view value);
+	// the id of an already interned string, never adds one
+	std::optional<InternedString> find(std::string_view value) const;
+	std::string_view view(InternedString value) const;
+	size_t size() const;
+	// drops every string interned once the table had the given size. the
+	// caller makes sure no id or view of them is used anymore and nothing is
+	// interned meanwhile
+	void releaseFrom(size_t size);
+};
+
+inline std::ostream &operator<<(std::ostream &os, const InternedString &value) {
+	return os << value.view();
+}
+
+} // namespace ray::compiler::lang
+
+template <> struct std::hash<ray::compiler::lang::InternedString> {
+	size_t operator()(const ray::compiler::lang::InternedString &value) const {
+		return std::hash<uint32_t>{}(value.getId());
+	}
+};
+
+template <>
+struct std::formatter<ray::compiler::lang::InternedString>
+    : std::formatter<std::string_view> {
+	auto format(const ray::compiler::lang::InternedString &value,
+	            std::format_context &ctx) const {
+		return std::formatter<std::string_view>::format(value.view(), ctx);
+	}
+};
@@ -1,20 +1,21 @@
 #pragma once
 #include <cstddef>
-#include <string>
+#include <vector>
 
+#include <ray/compiler/lang/stringInterner.hpp>
 #include <ray/compiler/lang/type.hpp>
 
 namespace ray::compiler::lang {
 class StructDeclaration {
   public:
-	std::string name;
-	std::string mangledName;
+	InternedString name;
+	InternedString mangledName;
 };
 class StructMember {
   public:
 	bool publicVisibility = false;
 	bool isMutable = false;
-	std::string name;
+	InternedString name;
 	Type type;
 
 	size_t calculateSize() const;
@@ -23,8 +24,8 @@ class Struct {
   public:
 	bool opaque;
 	size_t structID;
-	std::string name;
-	std::string mangledName;
+	InternedString name;
+	InternedString mangledName;
 	std::vector<StructMember> members;
 };
 
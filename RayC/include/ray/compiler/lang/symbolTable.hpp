@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <ray/compiler/lang/functionDefinition.hpp>
+#include <ray/compiler/lang/stringInterner.hpp>
+#include <ray/compiler/lang/struct.hpp>
+#include <ray/compiler/lang/symbol.hpp>
+#include <ray/util/soft_reference.hpp>
+
+namespace ray::compiler::lang {
+
+// flat view of the symbols visible from the innermost scope being walked,
+// every name maps to a stack of bindings with the innermost one on top so a
+// lookup is a single hash probe no matter how deep the scope chain is.
+// entering a scope records a mark in the undo log and leaving it pops every
+// binding made since that mark
+class SymbolTable {
+	template <typename T>
+	using Bindings =
+	    std::unordered_map<InternedString,
+	                       std::vector<util::soft_reference<T>>>;
+
+	enum class BindingKind : uint8_t { variable, function, structure };
+	struct UndoEntry {
+		BindingKind kind;
+		InternedString name;
+	};
+
+	Bindings<Symbol> variables;
+	// overloads accumulate instead of shadowing, the whole stack is the set
+	Bindings<FunctionDeclaration> functions;
+	Bindings<Struct> structs;
+
+	std::vector<UndoEntry> undoLog;
+	std::vector<size_t> scopeMarks;
+
+  public:
+	void pushScope();
+	// drops every binding made since the matching pushScope
+	void popScope();
+	size_t depth() const { return scopeMarks.size(); }
+
+	void bindVariable(InternedString name,
+	                  const util::soft_reference<Symbol> &symbolRef);
+	void bindFunction(
+	    InternedString name,
+	    const util::soft_reference<FunctionDeclaration> &functionRef);
+	void bindStruct(InternedString name,
+	                const util::soft_reference<Struct> &structRef);
+
+	std::optional<util::soft_reference<Symbol>>
+	findVariable(InternedString name) const;
+	// the span is invalidated by the next bind or pop
+	std::span<const util::soft_reference<FunctionDeclaration>>
+	findFunctions(InternedString name) const;
+	std::optional<util::soft_reference<Struct>>
+	findStruct(InternedString name) const;
+
+  private:
+	template <typename T>
+	static std::optional<util::soft_reference<T>>
+	findInnermost(const Bindings<T> &bindings, InternedString name);
+};
+
+} // namespace ray::compiler::lang
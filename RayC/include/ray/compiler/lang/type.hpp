@@ -1,16 +1,38 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <optional>
-#include <string>
 #include <vector>
 
-#include <ray/util/copy_ptr.hpp>
+#include <ray/compiler/lang/stringInterner.hpp>
 
 namespace ray::compiler::lang {
 
 enum class TypeKind { scalar, aggregate, pointer, abstract };
 class Type;
+
+// handle to a type owned by the TypeTable, each distinct type is stored once
+// so copying a handle is free and equal ids always mean identical types
+class TypeRef {
+	uint32_t id = 0;
+
+	explicit TypeRef(uint32_t id) : id(id) {}
+	friend class TypeTable;
+
+  public:
+	TypeRef() = default;
+	TypeRef(const Type &type);
+
+	uint32_t getId() const { return id; }
+	const Type &get() const;
+	const Type &operator*() const { return get(); }
+	const Type *operator->() const { return &get(); }
+
+	bool operator==(const TypeRef &other) const = default;
+};
+
 class Type {
 
 	bool initialized = false;
@@ -20,22 +42,22 @@ class Type {
 	// an internal id used to track additional type information
 	// such as struct or function data
 	size_t typeId = 0;
-	std::string name;
+	InternedString name;
 	size_t calculatedSize = 0;
 	bool isMutable = false;
 	bool signedType = false;
 	bool overloaded = false;
-	// TODO: make both the subtype and signature hold a soft_reference instead
-	// this would help to avoid duplicates of the same type while
-	// allowing for recursive types such as function pointers
-	std::optional<util::copy_ptr<Type>> subtype = std::nullopt;
-	std::optional<std::vector<util::copy_ptr<Type>>> signature = std::nullopt;
+	// nested types are interned, copying a type never copies the types it
+	// references
+	// TODO: allow for recursive types such as function pointers
+	std::optional<TypeRef> subtype = std::nullopt;
+	std::optional<std::vector<TypeRef>> signature = std::nullopt;
 
 	Type() = default;
-	Type(size_t typeId, bool initialized, TypeKind kind, std::string name,
+	Type(size_t typeId, bool initialized, TypeKind kind, InternedString name,
 	     size_t calculatedSize, bool isMutable, bool signedType,
-	     bool overloaded, std::optional<util::copy_ptr<Type>> subType,
-	     std::optional<std::vector<util::copy_ptr<Type>>> signature)
+	     bool overloaded, std::optional<TypeRef> subType,
+	     std::optional<std::vector<TypeRef>> signature)
 	    : initialized{initialized}, kind{kind}, typeId(typeId), name{name},
 	      calculatedSize{calculatedSize}, isMutable{isMutable},
 	      signedType{signedType}, overloaded{overloaded}, subtype{subType},
@@ -51,6 +73,12 @@ class Type {
 
 	bool operator==(const Type &other) const;
 
+	// whether the type was made by defineModuleType, its typeId is then the
+	// id of the module
+	bool isModule() const {
+		return kind == TypeKind::abstract && name.view() == "%<module>%";
+	}
+
 	// returns a type that is not instatiable and cannot be used
 	// used by statements in the type checker
 	static constexpr Type defineStmtType() {
@@ -61,7 +89,7 @@ class Type {
 		    false,
 		    TypeKind::abstract, // abstract kind (non valid at runtime)
 		    // name cannot be mangled nor referenced
-		    "%<stmt>%",
+		    InternedString("%<stmt>%"),
 		    // size is 0 so it cannot be passed
 		    0,
 		    false, // non mutable
@@ -82,7 +110,7 @@ class Type {
 		    false,
 		    TypeKind::abstract, // abstract (unknown type not valid)
 		    // name cannot be mangled nor referenced
-		    "%<unknown>%",
+		    InternedString("%<unknown>%"),
 		    // size is 0 so it cannot be passed
 		    0,
 		    false, // non mutable
@@ -93,16 +121,17 @@ class Type {
 		};
 	}
 
-	// defines an empty module type used by the type checker
-	static constexpr Type defineModuleType() {
+	// defines the type of an imported module, members are looked up in the
+	// module store entry it names
+	static constexpr Type defineModuleType(size_t moduleId) {
 		return Type{
-		    // modules do not have a defined typeID
-		    0,
+		    // the id of the module in the module store
+		    moduleId,
 		    // an statement does not even return an initialized type
 		    true,
 		    TypeKind::abstract, // abstract (module type)
 		    // name cannot be mangled nor referenced
-		    "%<module>%",
+		    InternedString("%<module>%"),
 		    // size is 0 so it cannot be passed
 		    0,
 		    false, // non mutable
@@ -122,7 +151,7 @@ class Type {
 		    // initialized
 		    true,
 		    lang::TypeKind::abstract,
-		    "%<tuple>%",
+		    InternedString("%<tuple>%"),
 		    0,         // its size is 0
 		    isMutable, // non mutable
 		    false,     // non signed
@@ -135,4 +164,10 @@ class Type {
   private:
 	bool baseMatches(const Type &other) const;
 };
-} // namespace ray::compiler::lang
\ No newline at end of file
+} // namespace ray::compiler::lang
+
+template <> struct std::hash<ray::compiler::lang::TypeRef> {
+	size_t operator()(const ray::compiler::lang::TypeRef &value) const {
+		return std::hash<uint32_t>{}(value.getId());
+	}
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <ray/compiler/lang/type.hpp>
+
+namespace ray::compiler::lang {
+
+// compilation wide table of hash-consed types, a type is stored once no matter
+// how many times it gets built so nested types compare by id. types are only
+// released by releaseFrom, which a long running driver calls between builds
+class TypeTable {
+	// hashes and compares every field of the pointed type, nested types are
+	// already interned so only their ids are looked at
+	struct TypeHash {
+		size_t operator()(const Type *type) const;
+	};
+	struct TypeEqual {
+		bool operator()(const Type *lhs, const Type *rhs) const;
+	};
+
+	mutable std::shared_mutex mutex;
+	// deque so growing never moves the types the references point to
+	std::deque<Type> types;
+	std::unordered_map<const Type *, uint32_t, TypeHash, TypeEqual> ids;
+	// results of Type::operator== and Type::coercercesInto keyed by both ids
+	std::unordered_map<uint64_t, bool> equalResults;
+	std::unordered_map<uint64_t, bool> coercionResults;
+
+	TypeTable();
+
+  public:
+	TypeTable(const TypeTable &) = delete;
+	TypeTable &operator=(const TypeTable &) = delete;
+
+	static TypeTable &global();
+
+	TypeRef intern(const Type &type);
+	const Type &get(TypeRef type) const;
+	size_t size() const;
+
+	// memoized versions of the Type comparisons for interned types
+	bool equals(TypeRef lhs, TypeRef rhs);
+	bool coercesInto(TypeRef type, TypeRef targetType);
+	// remembered results of equals and coercesInto
+	size_t comparisons() const;
+	void clearComparisons();
+
+	// drops every type interned once the table had the given size along with
+	// the comparisons remembered so far. the caller makes sure none of them
+	// is used anymore and nothing is interned meanwhile
+	void releaseFrom(size_t size);
+
+  private:
+	template <typename Compare>
+	bool memoized(std::unordered_map<uint64_t, bool> &results, TypeRef lhs,
+	              TypeRef rhs, Compare compare);
+};
+
+} // namespace ray::compiler::lang
@@ -0,0 +1,50 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+namespace ray::compiler::lexer {
+
+enum CharClass : uint8_t {
+	CHAR_CLASS_NONE = 0,
+	CHAR_CLASS_WHITESPACE = 1 << 0,       // ' ', '\t', '\r', '\n'
+	CHAR_CLASS_DIGIT = 1 << 1,            // 0-9
+	CHAR_CLASS_IDENTIFIER_START = 1 << 2, // a-z, A-Z, _
+	CHAR_CLASS_IDENTIFIER = 1 << 3,       // a-z, A-Z, 0-9, _
+};
+
+// ASCII only on purpose, it matches the std::is* functions on the "C" locale
+// without going through the locale tables for every character
+inline constexpr std::array<uint8_t, 256> charClassTable = [] {
+	std::array<uint8_t, 256> table{};
+	for (unsigned char c : {' ', '\t', '\r', '\n'}) {
+		table[c] |= CHAR_CLASS_WHITESPACE;
+	}
+	for (unsigned char c = '0'; c <= '9'; c++) {
+		table[c] |= CHAR_CLASS_DIGIT | CHAR_CLASS_IDENTIFIER;
+	}
+	for (unsigned char c = 'a'; c <= 'z'; c++) {
+		table[c] |= CHAR_CLASS_IDENTIFIER_START | CHAR_CLASS_IDENTIFIER;
+		table[c - 'a' + 'A'] |=
+		    CHAR_CLASS_IDENTIFIER_START | CHAR_CLASS_IDENTIFIER;
+	}
+	table['_'] |= CHAR_CLASS_IDENTIFIER_START | CHAR_CLASS_IDENTIFIER;
+	return table;
+}();
+
+constexpr bool hasCharClass(const char c, const uint8_t charClass) {
+	return (charClassTable[static_cast<unsigned char>(c)] & charClass) != 0;
+}
+constexpr bool isWhitespace(const char c) {
+	return hasCharClass(c, CHAR_CLASS_WHITESPACE);
+}
+constexpr bool isDigit(const char c) {
+	return hasCharClass(c, CHAR_CLASS_DIGIT);
+}
+constexpr bool isIdentifierStart(const char c) {
+	return hasCharClass(c, CHAR_CLASS_IDENTIFIER_START);
+}
+constexpr bool isIdentifier(const char c) {
+	return hasCharClass(c, CHAR_CLASS_IDENTIFIER);
+}
+
+} // namespace ray::compiler::lexer
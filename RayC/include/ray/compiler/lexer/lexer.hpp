@@ -4,37 +4,52 @@
 #include <ray/compiler/lexer/token.hpp>
 
 #include <cstddef>
+#include <deque>
+#include <optional>
+#include <string>
 #include <string_view>
 #include <vector>
 
 namespace ray::compiler {
 class Lexer {
 	std::string_view source;
-	std::vector<Token> tokens;
+	// token produced by the last scanToken call, if any
+	std::optional<Token> scannedToken;
 	std::vector<LexerError> errors;
+	// backing storage for literals that differ from their source text (ex:
+	// strings with escape sequences), deque keeps the views stable
+	std::deque<std::string> literalStorage;
 	size_t start = 0;
 	size_t startLine = 0;
 	size_t startColumn = 0;
 	size_t current = 0;
-	size_t line = 0;
+	size_t line = 1;
 	size_t column = 0;
 
   public:
 	Lexer(std::string_view source);
 
 	bool isAtEnd() const;
+	// scans the whole source from the start
 	std::vector<Token> scanTokens();
+	// pulls the next token from the current position, once the source is
+	// exhausted it keeps returning TOKEN_EOF
+	Token nextToken();
 
 	const std::vector<LexerError> &getErrors() const;
 
   private:
 	void scanToken();
 	char advance();
+	// consumes count characters keeping line and column in sync
+	void advanceBy(size_t count);
+	void skipWhitespace();
 
 	void addToken(Token::TokenType type);
-	void addToken(Token::TokenType type, std::string literal);
-	void addToken(Token::TokenType type, std::string literal, size_t line,
+	void addToken(Token::TokenType type, std::string_view literal);
+	void addToken(Token::TokenType type, std::string_view literal, size_t line,
 	              size_t column);
+	std::string_view storeLiteral(std::string literal);
 	bool match(char expected);
 	void string();
 	void number();
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+namespace ray::compiler::lexer {
+
+// length of the run of characters of the given kind that starts at position,
+// vectorized when the target supports it (SSE2/AVX2) with a table driven
+// scalar fallback for the tail and for other targets
+size_t whitespaceRun(std::string_view source, size_t position);
+size_t digitRun(std::string_view source, size_t position);
+size_t identifierRun(std::string_view source, size_t position);
+
+} // namespace ray::compiler::lexer
@@ -89,8 +89,10 @@ struct Token {
 		TOKEN_EOF    // EOF
 	};
 
-	TokenType type;
-	std::string lexeme;
+	TokenType type = TokenType::TOKEN_UNINITIALIZED;
+	// view into the source buffer or into the lexer literal storage, the
+	// owner must outlive every token (and AST node) that references it
+	std::string_view lexeme;
 	size_t line;
 	size_t column;
 
@@ -98,10 +100,10 @@ struct Token {
 	std::string_view getLexeme() const;
 	std::string_view getGlyph() const;
 
-	void merge(Token other);
-
 	static TokenType fromChar(const char c);
 	static TokenType fromString(std::string_view str);
+	// keyword lookup only, returns TOKEN_ERROR if str is not a keyword
+	static TokenType fromKeyword(std::string_view str);
 	static std::string_view toString(TokenType token);
 	static std::string_view glyph(TokenType token);
 	static constexpr Token makeEOFToken() {
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <functional>
+
+#include <ray/compiler/lexer/lexer.hpp>
+#include <ray/compiler/lexer/token.hpp>
+
+namespace ray::compiler {
+
+// pull based stream over a Lexer, tokens are scanned on demand and only a
+// bounded window around the current position is kept alive: the previous
+// token plus up to `lookahead` tokens ahead
+class TokenStream {
+  public:
+	static constexpr size_t lookahead = 2;
+
+  private:
+	// history + lookahead rounded up to a power of two
+	static constexpr size_t windowSize = 4;
+	static_assert(1 + lookahead <= windowSize);
+
+	std::reference_wrapper<Lexer> lexer;
+	// absolute index of the current token
+	size_t position = 0;
+	// the window is filled lazily on peek, which is logically const
+	mutable std::array<Token, windowSize> window;
+	// amount of tokens pulled from the lexer
+	mutable size_t scanned = 0;
+	mutable bool reachedEOF = false;
+
+  public:
+	TokenStream(Lexer &lexer) : lexer(lexer) {}
+
+	// offset 0 is the current token, past the EOF token a default EOF token is
+	// returned
+	const Token &peek(size_t offset = 0) const;
+	// last consumed token, a default token if nothing was consumed yet
+	const Token &previous() const;
+	void advance();
+	// pulls the remaining tokens so every lexer error gets reported
+	void drain();
+
+  private:
+	void fill(size_t index) const;
+};
+
+} // namespace ray::compiler
@@ -1,14 +1,16 @@
 #pragma once
 #include <cstddef>
 #include <exception>
-#include <memory>
+#include <functional>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include <ray/compiler/ast/arena.hpp>
 #include <ray/compiler/ast/expression.hpp>
 #include <ray/compiler/ast/statement.hpp>
 #include <ray/compiler/lexer/token.hpp>
+#include <ray/compiler/lexer/token_stream.hpp>
 #include <ray/compiler/message_bag.hpp>
 
 namespace ray::compiler {
@@ -17,54 +19,54 @@ class ParseException : public std::exception {};
 
 class Parser {
 	MessageBag messageBag;
-	std::vector<Token> tokens;
-	size_t current = 0;
+	TokenStream tokens;
+	// owns every node the parser creates, must outlive the returned AST
+	std::reference_wrapper<ast::Arena> arena;
 
   public:
-	Parser() : Parser("", {}) {};
-	Parser(std::string filepath, std::vector<Token> tokens);
+	Parser(std::string filepath, TokenStream tokens, ast::Arena &arena);
 
-	std::vector<std::unique_ptr<ast::Statement>> parse();
+	std::vector<ast::NodePtr<ast::Statement>> parse();
 
 	bool failed() const;
 	const std::vector<std::string> getErrors() const;
 
   private:
-	std::unique_ptr<ast::Expression> expression();
-	std::optional<std::unique_ptr<ast::Statement>> CompilerDirective();
-	std::optional<std::unique_ptr<ast::Statement>> declaration();
-	std::unique_ptr<ast::Statement> structDeclaration(bool publicVisibility);
-	std::unique_ptr<ast::Statement> statement();
-	std::unique_ptr<ast::Statement> forStatement();
-	std::unique_ptr<ast::Statement> ifStatement();
-	std::unique_ptr<ast::Statement> returnStatement();
-	std::unique_ptr<ast::Statement> continueStatement();
-	std::unique_ptr<ast::Statement> breakStatement();
-	std::unique_ptr<ast::Statement> whileStatement();
+	ast::NodePtr<ast::Expression> expression();
+	std::optional<ast::NodePtr<ast::Statement>> CompilerDirective();
+	std::optional<ast::NodePtr<ast::Statement>> declaration();
+	ast::NodePtr<ast::Statement> structDeclaration(bool publicVisibility);
+	ast::NodePtr<ast::Statement> statement();
+	ast::NodePtr<ast::Statement> forStatement();
+	ast::NodePtr<ast::Statement> ifStatement();
+	ast::NodePtr<ast::Statement> returnStatement();
+	ast::NodePtr<ast::Statement> continueStatement();
+	ast::NodePtr<ast::Statement> breakStatement();
+	ast::NodePtr<ast::Statement> whileStatement();
 	ast::VarDecl varDeclaration();
 	ast::Member memberDeclaration();
-	std::unique_ptr<ast::Statement> expressionStatement();
+	ast::NodePtr<ast::Statement> expressionStatement();
 	ast::Function function(std::string kind, bool publicVisibility);
-	std::vector<std::unique_ptr<ast::Statement>> block();
-	std::unique_ptr<ast::Expression> comma();
-	std::unique_ptr<ast::Expression> assignment();
-	std::unique_ptr<ast::Expression> orExpression();
-	std::unique_ptr<ast::Expression> andExpression();
-	std::unique_ptr<ast::Expression> equalityExpression();
-	std::unique_ptr<ast::Expression> comparisonExpression();
-	std::unique_ptr<ast::Expression> terminalExpression();
-	std::unique_ptr<ast::Expression> factorExpression();
-	std::unique_ptr<ast::Expression> unaryExpression();
-	std::unique_ptr<ast::Expression> arrayTypeExpression();
-	std::unique_ptr<ast::Expression> tupleTypeExpression();
-	std::unique_ptr<ast::Expression> pointerTypeExpression();
-	std::unique_ptr<ast::Expression> namedTypeExpression();
-	std::unique_ptr<ast::Expression>
-	finishArrayAccess(std::unique_ptr<ast::Expression> callee);
-	std::unique_ptr<ast::Expression>
-	finishCall(std::unique_ptr<ast::Expression> callee);
-	std::unique_ptr<ast::Expression> call();
-	std::unique_ptr<ast::Expression> primaryExpresion();
+	std::vector<ast::NodePtr<ast::Statement>> block();
+	ast::NodePtr<ast::Expression> comma();
+	ast::NodePtr<ast::Expression> assignment();
+	ast::NodePtr<ast::Expression> orExpression();
+	ast::NodePtr<ast::Expression> andExpression();
+	ast::NodePtr<ast::Expression> equalityExpression();
+	ast::NodePtr<ast::Expression> comparisonExpression();
+	ast::NodePtr<ast::Expression> terminalExpression();
+	ast::NodePtr<ast::Expression> factorExpression();
+	ast::NodePtr<ast::Expression> unaryExpression();
+	ast::NodePtr<ast::Expression> arrayTypeExpression();
+	ast::NodePtr<ast::Expression> tupleTypeExpression();
+	ast::NodePtr<ast::Expression> pointerTypeExpression();
+	ast::NodePtr<ast::Expression> namedTypeExpression();
+	ast::NodePtr<ast::Expression>
+	finishArrayAccess(ast::NodePtr<ast::Expression> callee);
+	ast::NodePtr<ast::Expression>
+	finishCall(ast::NodePtr<ast::Expression> callee);
+	ast::NodePtr<ast::Expression> call();
+	ast::NodePtr<ast::Expression> primaryExpresion();
 
 	bool match(std::vector<Token::TokenType> types);
 	bool check(Token::TokenType type);
@@ -77,12 +79,11 @@ class Parser {
 	Token previous();
 	Token consume(Token::TokenType type, std::string message);
 
-	static constexpr std::unique_ptr<ast::Expression>
-	makeUnitExpression(size_t line, size_t column) {
+	ast::NodePtr<ast::Expression> makeUnitExpression(size_t line,
+	                                                 size_t column) {
 		auto tupleNameToken = Token{Token::TokenType::TOKEN_LEFT_SQUARE_BRACE,
 		                            "%<tuple>%", line, column};
-		return std::make_unique<ast::TupleType>(
-		    ast::TupleType{false, {}, tupleNameToken});
+		return ast::TupleType::create(arena, false, {}, tupleNameToken);
 	}
 
 	ParseException error(Token token, std::string message);
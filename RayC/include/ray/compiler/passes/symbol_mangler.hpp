@@ -3,19 +3,19 @@
 #include <string>
 #include <string_view>
 
-#include <ray/compiler/ast/statement.hpp>
 #include <ray/compiler/directives/linkageDirective.hpp>
 
 namespace ray::compiler::passes::mangling {
 class NameMangler {
+  public:
+	// part of every mangled name, also keys the build cache
 	constexpr static std::string_view manglerVersion = "0";
 
-  public:
 	std::string mangleFunction(
-	    std::string_view module, const ast::Function &function,
+	    std::string_view module, std::string_view functionName,
 	    std::optional<directive::LinkageDirective> &linkageDirective);
 	std::string
-	mangleStruct(std::string_view module, const ast::Struct &structDefinition,
+	mangleStruct(std::string_view module, std::string_view structName,
 	             std::optional<directive::LinkageDirective> &linkageDirective);
 };
 } // namespace ray::compiler::passes::mangling
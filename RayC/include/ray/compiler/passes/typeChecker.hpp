@@ -1,10 +1,12 @@
 #pragma once
+#include <cstddef>
+#include <filesystem>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <utility>
 
-#include <ray/compiler/ast/expression.hpp>
-#include <ray/compiler/ast/statement.hpp>
+#include <ray/compiler/ast/flat.hpp>
 #include <ray/compiler/directives/compilerDirective.hpp>
 #include <ray/compiler/directives/linkageDirective.hpp>
 #include <ray/compiler/environment/dataModel/dataModel.hpp>
@@ -17,34 +19,46 @@
 
 namespace ray::compiler::passes {
 
-class TypeChecker : public ast::StatementVisitor,
-                    public ast::ExpressionVisitor {
+class TypeChecker : public ast::flat::Visitor<TypeChecker> {
+	friend class ast::flat::Visitor<TypeChecker>;
+
 	MessageBag messageBag;
 
 	std::vector<std::unique_ptr<directive::CompilerDirective>> directivesStack;
 	size_t directivesStackTop = 0;
 
 	std::vector<lang::Type> typeStack;
+	// deepest the type stack got since the last top level declaration
+	size_t typeStackPeak = 0;
 
-	lang::SourceUnit currentSourceUnit;
+	std::reference_wrapper<lang::SourceUnit> currentSourceUnit;
 	std::reference_wrapper<lang::Scope> currentScope;
 	std::reference_wrapper<const environment::DataModel> currentDataModel;
-	// lang::ModuleStore &moduleStore;
+	// imports of the unit, already loaded and checked
+	std::reference_wrapper<const lang::ModuleStore> moduleStore;
+	// the file being checked, relative imports are resolved against it
+	std::filesystem::path importer;
 
   public:
+	// the source unit is extended in place and has to outlive the checker
 	TypeChecker(std::string filePath, const lang::ModuleStore &moduleStore,
+	            std::filesystem::path importer,
 	            const environment::DataModel &dataModel,
-	            const lang::SourceUnit &sourceUnit)
+	            lang::SourceUnit &sourceUnit)
 	    : messageBag("TYPE-CHECKER", filePath), typeStack(),
 	      currentSourceUnit(sourceUnit),
-	      currentScope(currentSourceUnit.rootScope), currentDataModel(dataModel)
-	//,moduleStore(moduleStore)
-	{}
+	      currentScope(sourceUnit.getRootScope()), currentDataModel(dataModel),
+	      moduleStore(moduleStore), importer(std::move(importer)) {}
 
-	void resolve(const std::vector<std::unique_ptr<ast::Statement>> &statement);
+	void resolve(const ast::flat::Tree &tree);
+	// checks the unit one root at a time instead, so each declaration can be
+	// handed to the next pass as soon as it is checked
+	void begin(const ast::flat::Tree &tree);
+	void resolveRoot(ast::flat::NodeId root);
+	void end();
 
 	const lang::SourceUnit &getCurrentSourceUnit() const {
-		return currentSourceUnit;
+		return currentSourceUnit.get();
 	}
 
 	bool hasFailed() const;
@@ -52,49 +66,46 @@ class TypeChecker : public ast::StatementVisitor,
 	const std::vector<std::string> getWarnings() const;
 
   private:
-	void visitBlockStatement(const ast::Block &value) override;
-	void visitTerminalExprStatement(const ast::TerminalExpr &value) override;
-	void
-	visitExpressionStmtStatement(const ast::ExpressionStmt &value) override;
-	void visitFunctionStatement(const ast::Function &value) override;
-	void visitIfStatement(const ast::If &value) override;
-	void visitJumpStatement(const ast::Jump &value) override;
-	void visitVarDeclStatement(const ast::VarDecl &value) override;
-	void visitMemberStatement(const ast::Member &value) override;
-	void visitWhileStatement(const ast::While &value) override;
-	void visitStructStatement(const ast::Struct &value) override;
-	void visitCompDirectiveStatement(const ast::CompDirective &value) override;
+	void visitBlockStatement(const ast::flat::Block &value);
+	void visitTerminalExprStatement(const ast::flat::TerminalExpr &value);
+	void visitExpressionStmtStatement(const ast::flat::ExpressionStmt &value);
+	void visitFunctionStatement(const ast::flat::Function &value);
+	void visitIfStatement(const ast::flat::If &value);
+	void visitJumpStatement(const ast::flat::Jump &value);
+	void visitVarDeclStatement(const ast::flat::VarDecl &value);
+	void visitMemberStatement(const ast::flat::Member &value);
+	void visitWhileStatement(const ast::flat::While &value);
+	void visitStructStatement(const ast::flat::Struct &value);
+	void visitCompDirectiveStatement(const ast::flat::CompDirective &value);
 	// Expression
-	void visitVariableExpression(const ast::Variable &value) override;
-	void visitIntrinsicExpression(const ast::Intrinsic &value) override;
-	void visitAssignExpression(const ast::Assign &value) override;
-	void visitBinaryExpression(const ast::Binary &value) override;
-	void visitCallExpression(const ast::Call &value) override;
-	void visitIntrinsicCallExpression(const ast::IntrinsicCall &value) override;
-	void visitGetExpression(const ast::Get &value) override;
-	void visitGroupingExpression(const ast::Grouping &value) override;
-	void visitLiteralExpression(const ast::Literal &value) override;
-	void visitLogicalExpression(const ast::Logical &value) override;
-	void visitSetExpression(const ast::Set &value) override;
-	void visitUnaryExpression(const ast::Unary &value) override;
-	void visitArrayAccessExpression(const ast::ArrayAccess &value) override;
-	void visitArrayTypeExpression(const ast::ArrayType &value) override;
-	void visitTupleTypeExpression(const ast::TupleType &value) override;
-	void visitPointerTypeExpression(const ast::PointerType &value) override;
-	void visitNamedTypeExpression(const ast::NamedType &value) override;
-	void visitCastExpression(const ast::Cast &value) override;
-	void visitParameterExpression(const ast::Parameter &value) override;
-
-	std::optional<lang::Type> resolveType(const ast::Statement &statement);
-	std::optional<lang::Type> resolveType(const ast::Expression &expression);
-	std::vector<lang::Type> resolveTypes(const ast::Statement &statement);
-	std::vector<lang::Type> resolveTypes(const ast::Expression &expression);
+	void visitVariableExpression(const ast::flat::Variable &value);
+	void visitIntrinsicExpression(const ast::flat::Intrinsic &value);
+	void visitAssignExpression(const ast::flat::Assign &value);
+	void visitBinaryExpression(const ast::flat::Binary &value);
+	void visitCallExpression(const ast::flat::Call &value);
+	void visitIntrinsicCallExpression(const ast::flat::IntrinsicCall &value);
+	void visitGetExpression(const ast::flat::Get &value);
+	void visitGroupingExpression(const ast::flat::Grouping &value);
+	void visitLiteralExpression(const ast::flat::Literal &value);
+	void visitLogicalExpression(const ast::flat::Logical &value);
+	void visitSetExpression(const ast::flat::Set &value);
+	void visitUnaryExpression(const ast::flat::Unary &value);
+	void visitArrayAccessExpression(const ast::flat::ArrayAccess &value);
+	void visitArrayTypeExpression(const ast::flat::ArrayType &value);
+	void visitTupleTypeExpression(const ast::flat::TupleType &value);
+	void visitPointerTypeExpression(const ast::flat::PointerType &value);
+	void visitNamedTypeExpression(const ast::flat::NamedType &value);
+	void visitCastExpression(const ast::flat::Cast &value);
+	void visitParameterExpression(const ast::flat::Parameter &value);
+
+	std::optional<lang::Type> resolveType(ast::flat::NodeId node);
+	std::vector<lang::Type> resolveTypes(ast::flat::NodeId node);
 
 	std::optional<lang::Type> findScalarTypeInfo(const std::string_view lexeme);
 	std::optional<lang::Type> findTypeInfo(const std::string_view lexeme);
 
 	std::optional<lang::FunctionDeclaration>
-	resolveFunctionDeclaration(const ast::Function &functionExpr);
+	resolveFunctionDeclaration(const ast::flat::Function &functionExpr);
 
 	// gets the current scope
 	lang::Scope &getCurrentScope();
@@ -1,8 +1,7 @@
 #pragma once
 #include <cstddef>
 
-#include <ray/compiler/ast/expression.hpp>
-#include <ray/compiler/ast/statement.hpp>
+#include <ray/compiler/ast/flat.hpp>
 #include <ray/compiler/directives/compilerDirective.hpp>
 #include <ray/compiler/environment/dataModel/dataModel.hpp>
 #include <ray/compiler/lang/sourceUnit.hpp>
@@ -11,8 +10,9 @@
 #include <ray/compiler/message_bag.hpp>
 
 namespace ray::compiler::passes {
-class TypeScanner : public ast::StatementVisitor,
-                    public ast::ExpressionVisitor {
+class TypeScanner : public ast::flat::Visitor<TypeScanner> {
+	friend class ast::flat::Visitor<TypeScanner>;
+
 	MessageBag messageBag;
 
 	std::vector<std::unique_ptr<directive::CompilerDirective>> directivesStack;
@@ -23,19 +23,21 @@ class TypeScanner : public ast::StatementVisitor,
 
 	std::reference_wrapper<const environment::DataModel> currentDataModel;
 
-	lang::SourceUnit currentSourceUnit;
+	std::reference_wrapper<lang::SourceUnit> currentSourceUnit;
 	std::reference_wrapper<lang::Scope> currentScope;
 
   public:
-	TypeScanner(std::string filePath, const environment::DataModel &dataModel)
+	// the source unit is extended in place and has to outlive the scanner
+	TypeScanner(std::string filePath, const environment::DataModel &dataModel,
+	            lang::SourceUnit &sourceUnit)
 	    : messageBag("TYPE-SCANNER", filePath), directivesStack(),
-	      currentDataModel(dataModel), currentSourceUnit(),
-	      currentScope(currentSourceUnit.rootScope) {}
+	      currentDataModel(dataModel), currentSourceUnit(sourceUnit),
+	      currentScope(sourceUnit.getRootScope()) {}
 
-	void resolve(const std::vector<std::unique_ptr<ast::Statement>> &statement);
+	void resolve(const ast::flat::Tree &tree);
 
 	const lang::SourceUnit &getCurrentSourceUnit() const {
-		return currentSourceUnit;
+		return currentSourceUnit.get();
 	}
 
 	bool hasFailed() const;
@@ -43,49 +45,46 @@ class TypeScanner : public ast::StatementVisitor,
 	const std::vector<std::string> getWarnings() const;
 
   private:
-	void visitBlockStatement(const ast::Block &value) override;
-	void visitTerminalExprStatement(const ast::TerminalExpr &value) override;
-	void
-	visitExpressionStmtStatement(const ast::ExpressionStmt &value) override;
-	void visitFunctionStatement(const ast::Function &value) override;
-	void visitIfStatement(const ast::If &value) override;
-	void visitJumpStatement(const ast::Jump &value) override;
-	void visitVarDeclStatement(const ast::VarDecl &value) override;
-	void visitMemberStatement(const ast::Member &value) override;
-	void visitWhileStatement(const ast::While &value) override;
-	void visitStructStatement(const ast::Struct &value) override;
-	void visitCompDirectiveStatement(const ast::CompDirective &value) override;
+	void visitBlockStatement(const ast::flat::Block &value);
+	void visitTerminalExprStatement(const ast::flat::TerminalExpr &value);
+	void visitExpressionStmtStatement(const ast::flat::ExpressionStmt &value);
+	void visitFunctionStatement(const ast::flat::Function &value);
+	void visitIfStatement(const ast::flat::If &value);
+	void visitJumpStatement(const ast::flat::Jump &value);
+	void visitVarDeclStatement(const ast::flat::VarDecl &value);
+	void visitMemberStatement(const ast::flat::Member &value);
+	void visitWhileStatement(const ast::flat::While &value);
+	void visitStructStatement(const ast::flat::Struct &value);
+	void visitCompDirectiveStatement(const ast::flat::CompDirective &value);
 	// Expression
-	void visitVariableExpression(const ast::Variable &value) override;
-	void visitIntrinsicExpression(const ast::Intrinsic &value) override;
-	void visitAssignExpression(const ast::Assign &value) override;
-	void visitBinaryExpression(const ast::Binary &value) override;
-	void visitCallExpression(const ast::Call &value) override;
-	void visitIntrinsicCallExpression(const ast::IntrinsicCall &value) override;
-	void visitGetExpression(const ast::Get &value) override;
-	void visitGroupingExpression(const ast::Grouping &value) override;
-	void visitLiteralExpression(const ast::Literal &value) override;
-	void visitLogicalExpression(const ast::Logical &value) override;
-	void visitSetExpression(const ast::Set &value) override;
-	void visitUnaryExpression(const ast::Unary &value) override;
-	void visitArrayAccessExpression(const ast::ArrayAccess &value) override;
-	void visitArrayTypeExpression(const ast::ArrayType &value) override;
-	void visitTupleTypeExpression(const ast::TupleType &value) override;
-	void visitPointerTypeExpression(const ast::PointerType &value) override;
-	void visitNamedTypeExpression(const ast::NamedType &value) override;
-	void visitCastExpression(const ast::Cast &value) override;
-	void visitParameterExpression(const ast::Parameter &value) override;
-
-	lang::Type resolveType(const ast::Statement &statement);
-	lang::Type resolveType(const ast::Expression &expression);
-	std::vector<lang::Type> resolveTypes(const ast::Statement &statement);
-	std::vector<lang::Type> resolveTypes(const ast::Expression &expression);
+	void visitVariableExpression(const ast::flat::Variable &value);
+	void visitIntrinsicExpression(const ast::flat::Intrinsic &value);
+	void visitAssignExpression(const ast::flat::Assign &value);
+	void visitBinaryExpression(const ast::flat::Binary &value);
+	void visitCallExpression(const ast::flat::Call &value);
+	void visitIntrinsicCallExpression(const ast::flat::IntrinsicCall &value);
+	void visitGetExpression(const ast::flat::Get &value);
+	void visitGroupingExpression(const ast::flat::Grouping &value);
+	void visitLiteralExpression(const ast::flat::Literal &value);
+	void visitLogicalExpression(const ast::flat::Logical &value);
+	void visitSetExpression(const ast::flat::Set &value);
+	void visitUnaryExpression(const ast::flat::Unary &value);
+	void visitArrayAccessExpression(const ast::flat::ArrayAccess &value);
+	void visitArrayTypeExpression(const ast::flat::ArrayType &value);
+	void visitTupleTypeExpression(const ast::flat::TupleType &value);
+	void visitPointerTypeExpression(const ast::flat::PointerType &value);
+	void visitNamedTypeExpression(const ast::flat::NamedType &value);
+	void visitCastExpression(const ast::flat::Cast &value);
+	void visitParameterExpression(const ast::flat::Parameter &value);
+
+	lang::Type resolveType(ast::flat::NodeId node);
+	std::vector<lang::Type> resolveTypes(ast::flat::NodeId node);
 
 	std::optional<lang::Type> findScalarTypeInfo(const std::string_view lexeme);
 	lang::Type findTypeInfo(const std::string_view lexeme);
 
 	std::optional<lang::FunctionDeclaration>
-	resolveFunctionDeclaration(const ast::Function &functionExpr);
+	resolveFunctionDeclaration(const ast::flat::Function &functionExpr);
 
 	// gets the current scope
 	lang::Scope &getCurrentScope();
@@ -94,6 +93,6 @@ class TypeScanner : public ast::StatementVisitor,
 	// pops until located at the requested scope, if not found makes an error
 	bool returnScope(lang::Scope &scope);
 
-	void discoverStruct(const ast::Struct &structAst);
+	void discoverStruct(const ast::flat::Struct &structAst);
 };
 } // namespace ray::compiler::passes
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace ray::compiler {
+
+// read only contents of a source file, owns the bytes for the whole
+// compilation so tokens, the AST and diagnostics can keep views into it.
+// on POSIX systems the file is memory mapped, elsewhere (or if mapping is not
+// possible) it is read into an owned buffer
+class SourceBuffer {
+	std::filesystem::path path;
+	const char *mappedData = nullptr;
+	size_t mappedSize = 0;
+	std::string ownedData;
+
+	SourceBuffer(std::filesystem::path path, const char *mappedData,
+	             size_t mappedSize);
+	SourceBuffer(std::filesystem::path path, std::string ownedData);
+
+  public:
+	SourceBuffer(const SourceBuffer &) = delete;
+	SourceBuffer &operator=(const SourceBuffer &) = delete;
+	SourceBuffer(SourceBuffer &&other) noexcept;
+	SourceBuffer &operator=(SourceBuffer &&other) noexcept;
+	~SourceBuffer();
+
+	// returns nullopt if the file could not be opened
+	static std::optional<SourceBuffer> open(const std::filesystem::path &path);
+
+	std::string_view view() const;
+	const std::filesystem::path &getPath() const;
+
+  private:
+	void release();
+};
+
+} // namespace ray::compiler
@@ -0,0 +1,83 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ray/compiler/trace.hpp>
+#include <ray/util/counters.hpp>
+
+namespace ray::compiler {
+
+// wall and CPU time spent by the compiler phases along with what they
+// created, summed over every unit and module that went through them
+class TimeReport {
+  public:
+	struct Phase {
+		std::string name;
+		// times the phase ran, once per unit for most of them
+		uint64_t runs = 0;
+		std::chrono::nanoseconds wall{0};
+		std::chrono::nanoseconds cpu{0};
+		util::ThreadCounters counters;
+	};
+
+	// measures the phase from its construction to its destruction on the
+	// current thread, does nothing without a report. the phase is traced as
+	// well while a TraceRecorder is installed
+	class Scope {
+		TraceRecorder::Span span;
+		TimeReport *report;
+		std::string_view phase;
+		std::chrono::steady_clock::time_point wallStart;
+		std::chrono::nanoseconds cpuStart{0};
+		util::ThreadCounters countersStart;
+
+	  public:
+		// the detail names what went through the phase in the trace
+		Scope(TimeReport *report, std::string_view phase,
+		      std::string_view detail = {});
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+		~Scope();
+	};
+
+	// size of the global tables once the build is done, a long running
+	// server keeps them between builds so they have to stay flat
+	struct Tables {
+		uint64_t names = 0;
+		uint64_t types = 0;
+		// type comparisons remembered during the build
+		uint64_t comparisons = 0;
+	};
+
+  private:
+	std::chrono::steady_clock::time_point start =
+	    std::chrono::steady_clock::now();
+	mutable std::mutex mutex;
+	// in the order they first ran
+	std::vector<Phase> phases;
+	Tables tables;
+
+  public:
+	void add(std::string_view phase, std::chrono::nanoseconds wall,
+	         std::chrono::nanoseconds cpu,
+	         const util::ThreadCounters &counters);
+
+	// phases run in parallel so their times add up to more than the build
+	std::chrono::nanoseconds elapsed() const;
+	std::vector<Phase> getPhases() const;
+	void setTables(const Tables &sizes);
+	Tables getTables() const;
+
+	std::string toText() const;
+	std::string toJson() const;
+
+	// CPU time used by the current thread, or by the process where a thread
+	// clock is not available
+	static std::chrono::nanoseconds cpuTime();
+};
+
+} // namespace ray::compiler
@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ray/util/counters.hpp>
+
+namespace ray::compiler {
+
+// collects what the compiler does as Chrome trace events, the JSON it writes
+// loads in Perfetto and chrome://tracing. spans and counters are recorded
+// only while a recorder is installed, otherwise they cost an atomic load
+class TraceRecorder {
+	static std::atomic<TraceRecorder *> installed;
+
+	std::chrono::steady_clock::time_point start =
+	    std::chrono::steady_clock::now();
+	mutable std::mutex mutex;
+	// serialized events, in the order they ended
+	std::vector<std::string> events;
+
+  public:
+	// records a complete event from its construction to its destruction on
+	// the current thread, with the allocations made meanwhile as arguments
+	class Span {
+		TraceRecorder *recorder;
+		std::string_view category;
+		std::string_view name;
+		// copied only while recording, it usually names a file or symbol
+		std::string detail;
+		std::chrono::steady_clock::time_point begin;
+		util::ThreadCounters countersBegin;
+
+	  public:
+		Span(std::string_view category, std::string_view name,
+		     std::string_view detail = {});
+		Span(const Span &) = delete;
+		Span &operator=(const Span &) = delete;
+		~Span();
+	};
+
+	TraceRecorder() = default;
+	TraceRecorder(const TraceRecorder &) = delete;
+	TraceRecorder &operator=(const TraceRecorder &) = delete;
+	~TraceRecorder();
+
+	// one recorder at a time, builds are traced one after the other
+	void install();
+	void uninstall();
+	static TraceRecorder *current() {
+		return installed.load(std::memory_order_relaxed);
+	}
+
+	// a value over time, shown as its own track
+	void counter(std::string_view name, uint64_t value);
+
+	std::string toJson() const;
+
+  private:
+	double microseconds(std::chrono::steady_clock::time_point time) const;
+	void record(std::string event);
+};
+
+} // namespace ray::compiler
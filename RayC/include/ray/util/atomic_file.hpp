@@ -0,0 +1,24 @@
+#pragma once
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace ray::compiler::util {
+
+// writes into a temporary file next to the target and renames it, readers
+// running concurrently see either the old file or the complete new one
+bool writeFileAtomically(const std::filesystem::path &path,
+                         std::string_view contents);
+
+// a path next to the target no other thread or process picks, for writers
+// that fill the temporary file themselves
+std::filesystem::path temporaryPathFor(const std::filesystem::path &path);
+// renames the temporary file over the target, the temporary file is removed
+// when that fails
+bool replaceFile(const std::filesystem::path &temporary,
+                 const std::filesystem::path &path);
+
+std::optional<std::string> readFile(const std::filesystem::path &path);
+
+} // namespace ray::compiler::util
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+namespace ray::compiler::util {
+
+// events of the compiler counted on the current thread. they are always
+// counted as an increment costs next to nothing, reports take the difference
+// around a phase so units compiled in parallel do not mix their counts
+struct ThreadCounters {
+	uint64_t tokens = 0;
+	uint64_t astNodes = 0;
+	// new entries of the global TypeTable and StringInterner
+	uint64_t types = 0;
+	uint64_t names = 0;
+	// bindings made in a SymbolTable
+	uint64_t symbols = 0;
+	// calls to the global operator new and the bytes they asked for
+	uint64_t allocations = 0;
+	uint64_t allocatedBytes = 0;
+};
+
+extern thread_local constinit ThreadCounters threadCounters;
+
+} // namespace ray::compiler::util
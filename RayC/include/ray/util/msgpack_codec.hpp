@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <msgpack.hpp>
+
+namespace ray::compiler::util {
+
+// the subset of msgpack used by the compiler files, values are written in a
+// fixed order so readers only need arrays and scalars
+class MsgpackWriter {
+	msgpack::sbuffer buffer;
+	msgpack::packer<msgpack::sbuffer> packer{buffer};
+
+  public:
+	MsgpackWriter() = default;
+	MsgpackWriter(const MsgpackWriter &) = delete;
+	MsgpackWriter &operator=(const MsgpackWriter &) = delete;
+
+	void array(size_t size) { packer.pack_array(static_cast<uint32_t>(size)); }
+	void number(uint64_t value) { packer.pack(value); }
+	void boolean(bool value) { packer.pack(value); }
+	void nil() { packer.pack_nil(); }
+	void string(std::string_view value) {
+		packer.pack_str(static_cast<uint32_t>(value.size()));
+		packer.pack_str_body(value.data(), static_cast<uint32_t>(value.size()));
+	}
+
+	std::string data() const {
+		return std::string(buffer.data(), buffer.size());
+	}
+};
+
+// every accessor throws msgpack::type_error on unexpected data so a reader
+// can reject a whole file with a single catch
+struct MsgpackReader {
+	// a size of 0 accepts arrays of any size
+	static std::span<const msgpack::object> array(const msgpack::object &object,
+	                                              size_t size = 0) {
+		if (object.type != msgpack::type::ARRAY ||
+		    (size != 0 && object.via.array.size != size)) {
+			throw msgpack::type_error();
+		}
+		return {object.via.array.ptr, object.via.array.size};
+	}
+	static uint64_t number(const msgpack::object &object) {
+		return object.as<uint64_t>();
+	}
+	static bool boolean(const msgpack::object &object) {
+		return object.as<bool>();
+	}
+	static std::string string(const msgpack::object &object) {
+		return object.as<std::string>();
+	}
+};
+
+} // namespace ray::compiler::util
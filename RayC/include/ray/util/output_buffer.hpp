@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ray::compiler::util {
+
+// append only text made of chunks that never move once allocated, growing it
+// does not copy what was already written. it is written to a file with one
+// gathering write instead of being joined into a single string first
+class OutputBuffer {
+	struct Chunk {
+		std::unique_ptr<char[]> data;
+		size_t size = 0;
+		size_t capacity = 0;
+	};
+
+	std::vector<Chunk> chunks;
+	size_t totalSize = 0;
+
+  public:
+	// chunks double from the first size up to the last one
+	static constexpr size_t firstChunkSize = 16 * 1024;
+	static constexpr size_t maxChunkSize = 1024 * 1024;
+
+	// lets std::format_to write through std::back_inserter
+	using value_type = char;
+
+	OutputBuffer() = default;
+	OutputBuffer(OutputBuffer &&other) noexcept
+	    : chunks(std::move(other.chunks)),
+	      totalSize(std::exchange(other.totalSize, 0)) {}
+	OutputBuffer &operator=(OutputBuffer &&other) noexcept {
+		chunks = std::move(other.chunks);
+		totalSize = std::exchange(other.totalSize, 0);
+		return *this;
+	}
+	OutputBuffer(const OutputBuffer &) = delete;
+	OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+	void push_back(char c) {
+		if (chunks.empty() || chunks.back().size == chunks.back().capacity) {
+			grow(1);
+		}
+		auto &tail = chunks.back();
+		tail.data[tail.size++] = c;
+		totalSize++;
+	}
+	void append(std::string_view text);
+
+	OutputBuffer &operator<<(std::string_view text) {
+		append(text);
+		return *this;
+	}
+	OutputBuffer &operator<<(char c) {
+		push_back(c);
+		return *this;
+	}
+
+	// formats straight into the buffer without a temporary string
+	template <typename... Args>
+	void format(std::format_string<Args...> fmt, Args &&...args) {
+		std::format_to(std::back_inserter(*this), fmt,
+		               std::forward<Args>(args)...);
+	}
+
+	// appends the given number of tabs
+	void indent(size_t depth);
+
+	size_t size() const { return totalSize; }
+	bool empty() const { return totalSize == 0; }
+	void clear();
+
+	// joins the chunks, only for callers that need the text as a whole
+	std::string str() const;
+	// replaces the file contents, false if it could not be written
+	bool writeFile(const std::filesystem::path &path) const;
+
+  private:
+	friend class OutputFile;
+	void grow(size_t minimum);
+};
+
+// a file written piece by piece into a temporary file next to it, which
+// replaces the target once committed. a file that is dropped before being
+// committed is removed and leaves the previous target in place
+class OutputFile {
+	struct Handle;
+	std::unique_ptr<Handle> handle;
+	std::filesystem::path target;
+	std::filesystem::path temporary;
+
+  public:
+	explicit OutputFile(std::filesystem::path target);
+	OutputFile(const OutputFile &) = delete;
+	OutputFile &operator=(const OutputFile &) = delete;
+	~OutputFile();
+
+	// false once the temporary file could not be created or written
+	bool good() const;
+	bool write(const OutputBuffer &buffer);
+	bool commit();
+};
+
+} // namespace ray::compiler::util
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ray::compiler::util {
+
+// fixed set of workers with a task deque each. submitted tasks are spread
+// over the deques, a worker runs the newest task of its own deque and steals
+// the oldest one of another deque when it runs dry so uneven tasks still keep
+// every worker busy. tasks are claimed under the lock of their deque alone,
+// the pool wide mutex is only taken to sleep, wake up and report
+class ThreadPool {
+	struct TaskQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<TaskQueue>> queues;
+	// tasks waiting in any deque, changed under the lock of the deque so it
+	// never counts a task taken out before it was put in
+	std::atomic<size_t> queued = 0;
+	// tasks submitted and not finished yet
+	std::atomic<size_t> pending = 0;
+	std::atomic<size_t> nextQueue = 0;
+
+	// guards the rest, workers sleep on it while every deque is empty
+	std::mutex mutex;
+	std::condition_variable taskAvailable;
+	std::condition_variable allDone;
+	bool stopping = false;
+	// first exception thrown by a task, rethrown by wait
+	std::exception_ptr error;
+
+	// declared last so the workers are joined before the queues are released
+	std::vector<std::jthread> workers;
+
+  public:
+	// 0 uses a worker per hardware thread
+	explicit ThreadPool(size_t threadCount = 0);
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+	// runs the remaining tasks before joining the workers
+	~ThreadPool();
+
+	void submit(std::function<void()> task);
+	// blocks until every submitted task finished
+	void wait();
+	size_t size() const { return workers.size(); }
+
+  private:
+	void work(size_t index);
+	// the newest task of the own deque or the oldest of another one, empty
+	// when every deque is empty
+	std::function<void()> take(size_t index);
+};
+
+} // namespace ray::compiler::util
@@ -7,10 +7,14 @@
 #ifndef _MSC_VER
 #include <cstddef>
 #endif
+#include <charconv>
 #include <format>
 #include <string_view>
+#include <system_error>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 using namespace ray::compiler::terminal::literals;
 
@@ -21,8 +25,9 @@ std::variant<Options, std::vector<std::string>> parse_args(int argc,
 
 	std::unordered_set<std::string> flags;
 	std::unordered_map<std::string, std::string> options;
-	std::string_view input_file;
+	std::vector<std::string_view> input_files;
 	std::vector<std::string> options_stack;
+	std::vector<std::pair<std::string, std::string>> packages;
 	std::vector<std::string> errors;
 	for (int i = 1; i < argc; i++) {
 		std::string_view arg = argv[i];
@@ -41,6 +46,35 @@ std::variant<Options, std::vector<std::string>> parse_args(int argc,
 				options_stack.push_back(std::string(arg));
 				break;
 			}
+			case 'P': {
+				options_stack.push_back(std::string(arg));
+				break;
+			}
+			case 'j': {
+				options_stack.push_back(std::string(arg));
+				break;
+			}
+			case 'I': {
+				options_stack.push_back(std::string(arg));
+				break;
+			}
+			case 'C': {
+				options_stack.push_back(std::string(arg));
+				break;
+			}
+			case '-': {
+				if (arg == "--time-report") {
+					flags.insert("time-report");
+				} else if (arg == "--stream") {
+					flags.insert("stream");
+				} else if (arg == "--time-report-json" || arg == "--trace") {
+					options_stack.push_back(std::string(arg));
+				} else {
+					errors.push_back(std::format("{}: unknown flag '{}'",
+					                             "Error"_red, arg));
+				}
+				break;
+			}
 			default: {
 				errors.push_back(
 				    std::format("{}: unknown flag '{}'", "Error"_red, arg));
@@ -49,23 +83,29 @@ std::variant<Options, std::vector<std::string>> parse_args(int argc,
 			}
 		} else {
 			// common value
-			if (!options_stack.empty()) {
+			if (!options_stack.empty() && options_stack.back() == "-P") {
+				// packages can be given multiple times as name=path
+				auto separator = arg.find('=');
+				if (separator == std::string_view::npos || separator == 0) {
+					errors.push_back(std::format(
+					    "{}: expected name=path for package '{}'", "Error"_red,
+					    arg));
+				} else {
+					packages.emplace_back(arg.substr(0, separator),
+					                      arg.substr(separator + 1));
+				}
+				options_stack.pop_back();
+			} else if (!options_stack.empty()) {
 				// consume the value
 				options[options_stack.back()] = std::string(arg);
 				options_stack.pop_back();
 			} else {
-				// take the value as the main input
-				if (!input_file.empty()) {
-					errors.push_back(
-					    std::format("{}: only one input file can be specified",
-					                "Error"_red));
-					continue;
-				}
-				input_file = arg;
+				// every other value is an input file or module root
+				input_files.push_back(arg);
 			}
 		}
 	}
-	if (input_file.empty()) {
+	if (input_files.empty()) {
 		errors.push_back(
 		    std::format("{}: no input file specified", "Error"_red));
 	}
@@ -75,18 +115,54 @@ std::variant<Options, std::vector<std::string>> parse_args(int argc,
 		                             "Error"_red, option));
 	}
 
+	size_t jobs = 0;
+	if (options.contains("-j")) {
+		const auto &value = options.at("-j");
+		auto [ptr, ec] =
+		    std::from_chars(value.data(), value.data() + value.size(), jobs);
+		if (ec != std::errc() || ptr != value.data() + value.size()) {
+			errors.push_back(std::format(
+			    "{}: expected a number of jobs for '-j' but got '{}'",
+			    "Error"_red, value));
+		}
+	}
+
 	if (errors.size() > 0) {
 		return errors;
 	}
 
 	Options opts;
 	opts.assembly = flags.contains("assembly");
+	opts.timeReport = flags.contains("time-report");
+	opts.streamOutput = flags.contains("stream");
+	if (options.contains("--time-report-json")) {
+		opts.timeReportJson = options["--time-report-json"];
+	}
+	if (options.contains("--trace")) {
+		opts.traceFile = options["--trace"];
+	}
 	opts.target = opts.targetFromString(
 	    options.contains("-t") ? options.at("-t") : "none");
-	opts.input = input_file;
-	opts.output = options.contains("-o")
-	                  ? options["-o"]
-	                  : std::format("out.{}", opts.assembly ? "asm" : "bin");
+	opts.inputs.assign(input_files.begin(), input_files.end());
+	opts.jobs = jobs;
+	if (options.contains("-C")) {
+		opts.cacheDirectory = options["-C"];
+		// checking a cached unit loads its imports, keep that cheap too
+		opts.interfaceDirectory = opts.cacheDirectory / "interfaces";
+	}
+	if (options.contains("-I")) {
+		opts.interfaceDirectory = options["-I"];
+	}
+	if (options.contains("-o")) {
+		opts.output = options["-o"];
+	} else if (opts.compilesToDirectory()) {
+		opts.output = "out";
+	} else {
+		opts.output = std::format("out.{}", opts.assembly ? "asm" : "bin");
+	}
+	for (auto &[name, root] : packages) {
+		opts.packages.emplace_back(std::move(name), std::move(root));
+	}
 	return opts;
 }
 
@@ -1,50 +1,74 @@
 #include <ray/cli/options.hpp>
 #include <ray/cli/terminal.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <filesystem>
 #include <format>
-#include <iostream>
+#include <ostream>
+#include <string>
 #include <string_view>
-#include <unordered_map>
+#include <utility>
 
 namespace ray::compiler::cli {
 
 using namespace terminal::literals;
 
-bool Options::validate() const {
+bool Options::validate(std::ostream &errors) const {
 	bool success = true;
 
 	if (target == TargetEnum::ERROR) {
-		std::cerr << std::format(
+		errors << std::format(
 		    "{}: specified target is not an existing target\n", "Error"_red);
 		success = false;
 	}
 
-	// check if the input file is a valid file
-	if (!std::filesystem::exists(input)) {
-		std::cerr << std::format("{}: input file '{}' does not exist\n",
-		                         "Error"_red, input.string());
-		success = false;
-	} else if (std::filesystem::is_directory(input)) {
-		std::cerr << std::format(
-		    "{}: input file '{}' must be a file, not a directory\n",
-		    "Error"_red, input.string());
-		success = false;
-	} else if (!std::filesystem::is_regular_file(input)) {
-		std::cerr << std::format("{}: input file '{}' is not a regular file\n",
-		                         "Error"_red, input.string());
-		success = false;
+	// check if every input is a valid file, a module root when compiling
+	// into a directory
+	for (const auto &input : inputs) {
+		if (!std::filesystem::exists(input)) {
+			errors << std::format("{}: input file '{}' does not exist\n",
+			                      "Error"_red, input.string());
+			success = false;
+		} else if (std::filesystem::is_directory(input)) {
+			if (!compilesToDirectory()) {
+				errors << std::format(
+				    "{}: input file '{}' must be a file, not a directory\n",
+				    "Error"_red, input.string());
+				success = false;
+			}
+		} else if (!std::filesystem::is_regular_file(input)) {
+			errors << std::format(
+			    "{}: input file '{}' is not a regular file\n", "Error"_red,
+			    input.string());
+			success = false;
+		}
+	}
+
+	if (compilesToDirectory()) {
+		// the output directory is created if it does not exist yet
+		if (std::filesystem::exists(output) &&
+		    !std::filesystem::is_directory(output)) {
+			errors << std::format(
+			    "{}: output '{}' must be a directory when compiling several "
+			    "inputs\n",
+			    "Error"_red, output.string());
+			success = false;
+		}
+		return success;
 	}
 
 	// check if the output file is a valid location(not a path, or an exising
 	// file)
 	if (std::filesystem::exists(output)) {
 		if (std::filesystem::is_directory(output)) {
-			std::cerr << std::format(
+			errors << std::format(
 			    "{}: output file '{}' must be a file, not a directory\n",
 			    "Error"_red, output.string());
 			success = false;
 		} else if (!std::filesystem::is_regular_file(output)) {
-			std::cerr << std::format(
+			errors << std::format(
 			    "{}: output file '{}' is not a regular file\n", "Error"_red,
 			    output.string());
 			success = false;
@@ -54,14 +78,38 @@ bool Options::validate() const {
 	return success;
 }
 
+bool Options::compilesToDirectory() const {
+	return inputs.size() > 1 ||
+	       (inputs.size() == 1 && std::filesystem::is_directory(inputs[0]));
+}
+
+namespace {
+constexpr std::array<std::pair<std::string_view, Options::TargetEnum>, 2>
+    targets{{
+        {"none", Options::TargetEnum::NONE},
+        {"c_source", Options::TargetEnum::C_SOURCE},
+    }};
+} // namespace
+
 Options::TargetEnum Options::targetFromString(std::string_view str) {
-	static std::unordered_map<std::string, Options::TargetEnum> map{
-	    {"none", Options::TargetEnum::NONE},
-	    {"c_source", Options::TargetEnum::C_SOURCE}};
 	std::string key{str};
 	std::transform(key.begin(), key.end(), key.begin(),
 	               [](unsigned char c) { return std::tolower(c); });
-	return map.contains(key) ? map.at(key) : Options::TargetEnum::ERROR;
+	for (const auto &[name, target] : targets) {
+		if (name == key) {
+			return target;
+		}
+	}
+	return Options::TargetEnum::ERROR;
+}
+
+std::string_view Options::targetToString(TargetEnum target) {
+	for (const auto &[name, value] : targets) {
+		if (value == target) {
+			return name;
+		}
+	}
+	return "error";
 }
 
 } // namespace ray::compiler::cli
@@ -0,0 +1,356 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <msgpack.hpp>
+
+#include <ray/cli/server.hpp>
+#include <ray/cli/terminal.hpp>
+#include <ray/compiler/driver.hpp>
+#include <ray/util/msgpack_codec.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define RAYC_SERVER_SOCKETS 1
+#endif
+
+namespace ray::compiler::cli {
+
+using namespace terminal::literals;
+
+namespace {
+
+constexpr std::string_view magic = "RAYS";
+// bumped whenever the request or the response layout changes
+constexpr uint64_t protocolVersion = 1;
+// a request only holds arguments, anything bigger is not a client
+constexpr uint32_t maxRequestSize = 1 << 20;
+// builds run one at a time, a client that connects and stays silent is
+// dropped after this long instead of holding every other client up
+constexpr int requestTimeoutSeconds = 5;
+
+#ifdef RAYC_SERVER_SOCKETS
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) { stopRequested = 1; }
+
+class Socket {
+	int fd;
+
+  public:
+	explicit Socket(int fd) : fd(fd) {}
+	Socket(const Socket &) = delete;
+	Socket &operator=(const Socket &) = delete;
+	~Socket() {
+		if (fd >= 0) {
+			::close(fd);
+		}
+	}
+
+	int get() const { return fd; }
+	bool valid() const { return fd >= 0; }
+};
+
+std::optional<sockaddr_un> socketAddress(const std::filesystem::path &path) {
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	auto native = path.string();
+	if (native.size() >= sizeof(address.sun_path)) {
+		return std::nullopt;
+	}
+	std::memcpy(address.sun_path, native.c_str(), native.size() + 1);
+	return address;
+}
+
+bool connectTo(const Socket &socket, const sockaddr_un &address) {
+	return ::connect(socket.get(),
+	                 reinterpret_cast<const sockaddr *>(&address),
+	                 sizeof(address)) == 0;
+}
+
+// reads and writes on the socket fail once they wait longer than the timeout
+bool setTimeout(const Socket &socket, int seconds) {
+	timeval timeout{.tv_sec = seconds, .tv_usec = 0};
+	return ::setsockopt(socket.get(), SOL_SOCKET, SO_RCVTIMEO, &timeout,
+	                    sizeof(timeout)) == 0 &&
+	       ::setsockopt(socket.get(), SOL_SOCKET, SO_SNDTIMEO, &timeout,
+	                    sizeof(timeout)) == 0;
+}
+
+bool writeAll(int fd, const char *data, size_t size) {
+	while (size > 0) {
+		auto written = ::write(fd, data, size);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written <= 0) {
+			return false;
+		}
+		data += written;
+		size -= static_cast<size_t>(written);
+	}
+	return true;
+}
+
+bool readAll(int fd, char *data, size_t size) {
+	while (size > 0) {
+		auto received = ::read(fd, data, size);
+		if (received < 0 && errno == EINTR) {
+			continue;
+		}
+		if (received <= 0) {
+			return false;
+		}
+		data += received;
+		size -= static_cast<size_t>(received);
+	}
+	return true;
+}
+
+// messages are a little endian 32 bit size followed by a msgpack payload
+bool sendMessage(int fd, std::string_view payload) {
+	char header[4];
+	auto size = static_cast<uint32_t>(payload.size());
+	for (size_t i = 0; i < sizeof(header); i++) {
+		header[i] = static_cast<char>((size >> (8 * i)) & 0xff);
+	}
+	return writeAll(fd, header, sizeof(header)) &&
+	       writeAll(fd, payload.data(), payload.size());
+}
+
+std::optional<std::string> receiveMessage(int fd, uint32_t maxSize) {
+	unsigned char header[4];
+	if (!readAll(fd, reinterpret_cast<char *>(header), sizeof(header))) {
+		return std::nullopt;
+	}
+	uint32_t size = 0;
+	for (size_t i = 0; i < sizeof(header); i++) {
+		size |= static_cast<uint32_t>(header[i]) << (8 * i);
+	}
+	if (size > maxSize) {
+		return std::nullopt;
+	}
+	std::string payload(size, '\0');
+	if (!readAll(fd, payload.data(), payload.size())) {
+		return std::nullopt;
+	}
+	return payload;
+}
+
+// runs the build described by the request, nullopt for malformed requests
+std::optional<std::string> handleRequest(Driver &driver,
+                                         std::string_view request) {
+	using Reader = util::MsgpackReader;
+	std::string workingDirectory;
+	// the first argument stands for the program name, as in main
+	std::vector<std::string> arguments{"rayc"};
+	try {
+		auto handle = msgpack::unpack(request.data(), request.size());
+		auto root = Reader::array(handle.get(), 4);
+		if (Reader::string(root[0]) != magic ||
+		    Reader::number(root[1]) != protocolVersion) {
+			return std::nullopt;
+		}
+		workingDirectory = Reader::string(root[2]);
+		for (const auto &argument : Reader::array(root[3])) {
+			arguments.push_back(Reader::string(argument));
+		}
+	} catch (const std::exception &) {
+		return std::nullopt;
+	}
+
+	std::ostringstream output;
+	std::ostringstream diagnostics;
+	int status = 1;
+	// relative inputs and outputs are resolved against the client directory,
+	// builds run one at a time so the process directory can follow it
+	std::error_code error;
+	std::filesystem::current_path(workingDirectory, error);
+	if (error) {
+		diagnostics << std::format("{}: could not enter directory '{}'\n",
+		                           "Error"_red, workingDirectory);
+	} else {
+		std::vector<char *> argv;
+		for (auto &argument : arguments) {
+			argv.push_back(argument.data());
+		}
+		argv.push_back(nullptr);
+		status = driver.run(static_cast<int>(arguments.size()), argv.data(),
+		                    output, diagnostics);
+	}
+
+	util::MsgpackWriter writer;
+	writer.array(3);
+	// sent as the byte the process would have exited with
+	writer.number(static_cast<uint8_t>(status));
+	writer.string(output.str());
+	writer.string(diagnostics.str());
+	return writer.data();
+}
+
+#endif
+
+} // namespace
+
+int runServer(const std::filesystem::path &requestedPath) {
+#ifdef RAYC_SERVER_SOCKETS
+	// every build changes into the client directory, a relative path would
+	// name a different file by the time the server removes its socket
+	std::error_code error;
+	auto socketPath = std::filesystem::absolute(requestedPath, error);
+	if (error) {
+		std::cerr << std::format("{}: could not resolve socket path '{}'\n",
+		                         "Error"_red, requestedPath.string());
+		return 1;
+	}
+	auto address = socketAddress(socketPath);
+	if (!address) {
+		std::cerr << std::format("{}: socket path '{}' is too long\n",
+		                         "Error"_red, socketPath.string());
+		return 1;
+	}
+	{
+		// a socket file left by a server that did not shut down is reused
+		Socket probe(::socket(AF_UNIX, SOCK_STREAM, 0));
+		if (probe.valid() && connectTo(probe, *address)) {
+			std::cerr << std::format(
+			    "{}: a server is already listening on '{}'\n", "Error"_red,
+			    socketPath.string());
+			return 1;
+		}
+	}
+	std::filesystem::remove(socketPath, error);
+
+	Socket listener(::socket(AF_UNIX, SOCK_STREAM, 0));
+	if (!listener.valid() ||
+	    ::bind(listener.get(), reinterpret_cast<const sockaddr *>(&*address),
+	           sizeof(*address)) != 0 ||
+	    ::listen(listener.get(), SOMAXCONN) != 0) {
+		std::cerr << std::format("{}: could not listen on '{}': {}\n",
+		                         "Error"_red, socketPath.string(),
+		                         std::strerror(errno));
+		return 1;
+	}
+
+	// without SA_RESTART a signal interrupts accept so the loop can end
+	struct sigaction stopAction {};
+	stopAction.sa_handler = requestStop;
+	sigemptyset(&stopAction.sa_mask);
+	::sigaction(SIGINT, &stopAction, nullptr);
+	::sigaction(SIGTERM, &stopAction, nullptr);
+	// a client that went away must not take the server with it
+	std::signal(SIGPIPE, SIG_IGN);
+
+	Driver driver;
+	while (!stopRequested) {
+		Socket client(::accept(listener.get(), nullptr, nullptr));
+		if (!client.valid() || !setTimeout(client, requestTimeoutSeconds)) {
+			continue;
+		}
+		auto request = receiveMessage(client.get(), maxRequestSize);
+		if (!request) {
+			continue;
+		}
+		auto response = handleRequest(driver, *request);
+		if (response) {
+			(void)sendMessage(client.get(), *response);
+		}
+	}
+	std::filesystem::remove(socketPath, error);
+	return 0;
+#else
+	(void)requestedPath;
+	std::cerr << std::format(
+	    "{}: the compile server is not supported on this platform\n",
+	    "Error"_red);
+	return 1;
+#endif
+}
+
+std::optional<int> runClient(const std::filesystem::path &socketPath,
+                             std::span<char *const> arguments) {
+#ifdef RAYC_SERVER_SOCKETS
+	auto address = socketAddress(socketPath);
+	if (!address) {
+		return std::nullopt;
+	}
+	Socket server(::socket(AF_UNIX, SOCK_STREAM, 0));
+	if (!server.valid() || !connectTo(server, *address)) {
+		std::cerr << std::format(
+		    "{}: no compile server on '{}', building locally\n",
+		    "Warning"_yellow, socketPath.string());
+		return std::nullopt;
+	}
+	std::error_code error;
+	auto workingDirectory = std::filesystem::current_path(error);
+	if (error) {
+		std::cerr << std::format(
+		    "{}: could not get the working directory, building locally\n",
+		    "Warning"_yellow);
+		return std::nullopt;
+	}
+	// once the request is sent the server may build it even if no answer
+	// comes back, the local build then writes the same outputs again
+	auto lostResponse = [&] {
+		std::cerr << std::format(
+		    "{}: the compile server on '{}' did not answer, building "
+		    "locally. it may have run the same build\n",
+		    "Warning"_yellow, socketPath.string());
+		return std::nullopt;
+	};
+
+	util::MsgpackWriter writer;
+	writer.array(4);
+	writer.string(magic);
+	writer.number(protocolVersion);
+	writer.string(workingDirectory.string());
+	writer.array(arguments.size());
+	for (const char *argument : arguments) {
+		writer.string(argument);
+	}
+	std::signal(SIGPIPE, SIG_IGN);
+	if (!sendMessage(server.get(), writer.data())) {
+		return lostResponse();
+	}
+	// the C output is written by the server, only diagnostics come back
+	auto response = receiveMessage(server.get(), UINT32_MAX);
+	if (!response) {
+		return lostResponse();
+	}
+
+	using Reader = util::MsgpackReader;
+	try {
+		auto handle = msgpack::unpack(response->data(), response->size());
+		auto root = Reader::array(handle.get(), 3);
+		auto status = Reader::number(root[0]);
+		std::cout << Reader::string(root[1]);
+		std::cerr << Reader::string(root[2]);
+		return static_cast<int>(status);
+	} catch (const std::exception &) {
+		return lostResponse();
+	}
+#else
+	(void)socketPath;
+	(void)arguments;
+	return std::nullopt;
+#endif
+}
+
+} // namespace ray::compiler::cli
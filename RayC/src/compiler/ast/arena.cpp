@@ -0,0 +1,28 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+#include <ray/compiler/ast/arena.hpp>
+
+namespace ray::compiler::ast {
+
+void *Arena::allocateSlow(size_t size, size_t alignment) {
+	if (allocation == Allocation::perNode) {
+		// the cursor stays null so every node comes through here
+		chunks.push_back(
+		    std::make_unique_for_overwrite<std::byte[]>(size + alignment));
+		void *memory = chunks.back().get();
+		size_t space = size + alignment;
+		bytesUsed += size;
+		return std::align(alignment, size, memory, space);
+	}
+	// operator new[] only guarantees the default alignment, leave room to
+	// align the first node and give oversized nodes a chunk of their own
+	size_t capacity = std::max(chunkSize, size + alignment);
+	chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(capacity));
+	cursor = chunks.back().get();
+	chunkEnd = cursor + capacity;
+	return allocate(size, alignment);
+}
+
+} // namespace ray::compiler::ast
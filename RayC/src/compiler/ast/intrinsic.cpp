@@ -1,18 +1,26 @@
-#include <string>
-#include <unordered_map>
+#include <array>
+#include <string_view>
+#include <utility>
 
 #include <ray/compiler/ast/intrinsic.hpp>
 
 namespace ray::compiler::ast {
 
+namespace {
+constexpr std::array<std::pair<std::string_view, IntrinsicType>, 2>
+    intrinsics{{
+        {"@sizeOf", IntrinsicType::INTR_SIZEOF}, // @sizeOf
+        {"@import", IntrinsicType::INTR_IMPORT}, // @import
+    }};
+} // namespace
+
 IntrinsicType getintrinsicType(const std::string_view lexeme) {
-	static std::unordered_map<std::string, ray::compiler::ast::IntrinsicType>
-	    map = {
-	        {"@sizeOf", IntrinsicType::INTR_SIZEOF}, // @sizeOf
-	        {"@import", IntrinsicType::INTR_IMPORT}, // @import
-	    };
-	std::string key{lexeme};
-	return map.contains(key) ? map.at(key) : IntrinsicType::INTR_UNKNOWN;
+	for (const auto &[name, type] : intrinsics) {
+		if (name == lexeme) {
+			return type;
+		}
+	}
+	return IntrinsicType::INTR_UNKNOWN;
 }
 
-} // namespace ray::compiler::ast
\ No newline at end of file
+} // namespace ray::compiler::ast
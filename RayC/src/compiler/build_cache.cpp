@@ -0,0 +1,100 @@
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <msgpack.hpp>
+
+#include <ray/compiler/build_cache.hpp>
+#include <ray/compiler/environment/dataModel/dataModel.hpp>
+#include <ray/compiler/lang/moduleInterface.hpp>
+#include <ray/util/atomic_file.hpp>
+#include <ray/util/msgpack_codec.hpp>
+
+namespace ray::compiler {
+
+namespace {
+constexpr std::string_view magic = "RAYC";
+} // namespace
+
+BuildCache::BuildCache(std::filesystem::path directory,
+                       const environment::DataModel &dataModel,
+                       std::string_view target)
+    : directory(std::move(directory)),
+      // the compiler identity is the one interfaces are checked against
+      configurationHash(lang::hashSource(std::format(
+          "{}|{}|{}", formatVersion,
+          lang::ModuleInterface::configurationHash(dataModel), target))) {}
+
+std::optional<CachedUnit> BuildCache::find(std::string_view sourceFile,
+                                           uint64_t contentHash) const {
+	using Reader = util::MsgpackReader;
+	auto data = util::readFile(entryPath(sourceFile, contentHash));
+	if (!data) {
+		return std::nullopt;
+	}
+	try {
+		auto handle = msgpack::unpack(data->data(), data->size());
+		auto root = Reader::array(handle.get(), 8);
+		// the file name is only a hash, the key itself is checked as well
+		if (Reader::string(root[0]) != magic ||
+		    Reader::number(root[1]) != configurationHash ||
+		    Reader::string(root[2]) != sourceFile ||
+		    Reader::number(root[3]) != contentHash) {
+			return std::nullopt;
+		}
+		CachedUnit unit{.sourceFile = std::string(sourceFile),
+		                .contentHash = contentHash,
+		                .failed = Reader::boolean(root[5]),
+		                .diagnostics = Reader::string(root[6]),
+		                .output = Reader::string(root[7])};
+		for (const auto &object : Reader::array(root[4])) {
+			auto fields = Reader::array(object, 4);
+			unit.dependencies.push_back(
+			    {.importPath = Reader::string(fields[0]),
+			     .line = Reader::number(fields[1]),
+			     .column = Reader::number(fields[2]),
+			     .interfaceHash = Reader::number(fields[3])});
+		}
+		return unit;
+	} catch (const std::exception &) {
+		// a corrupted entry is a miss, storing the unit again replaces it
+		return std::nullopt;
+	}
+}
+
+bool BuildCache::store(const CachedUnit &unit) const {
+	util::MsgpackWriter writer;
+	writer.array(8);
+	writer.string(magic);
+	writer.number(configurationHash);
+	writer.string(unit.sourceFile);
+	writer.number(unit.contentHash);
+	writer.array(unit.dependencies.size());
+	for (const auto &dependency : unit.dependencies) {
+		writer.array(4);
+		writer.string(dependency.importPath);
+		writer.number(dependency.line);
+		writer.number(dependency.column);
+		writer.number(dependency.interfaceHash);
+	}
+	writer.boolean(unit.failed);
+	writer.string(unit.diagnostics);
+	writer.string(unit.output);
+	return util::writeFileAtomically(
+	    entryPath(unit.sourceFile, unit.contentHash), writer.data());
+}
+
+std::filesystem::path BuildCache::entryPath(std::string_view sourceFile,
+                                            uint64_t contentHash) const {
+	auto key = lang::hashSource(
+	    std::format("{:016x}|{:016x}|{}", configurationHash, contentHash,
+	                sourceFile));
+	return directory / std::format("{:016x}.rayc", key);
+}
+
+} // namespace ray::compiler
@@ -0,0 +1,660 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ray/cli/cli_args.hpp>
+#include <ray/cli/options.hpp>
+#include <ray/cli/terminal.hpp>
+
+#include <ray/compiler/build_cache.hpp>
+#include <ray/compiler/driver.hpp>
+#include <ray/compiler/environment/dataModel/dataModel.hpp>
+
+#include <ray/compiler/ast/arena.hpp>
+#include <ray/compiler/ast/flat.hpp>
+#include <ray/compiler/ast/flatBuilder.hpp>
+#include <ray/compiler/lexer/lexer.hpp>
+#include <ray/compiler/lexer/token_stream.hpp>
+#include <ray/compiler/parser/parser.hpp>
+
+#include <ray/compiler/passes/typeChecker.hpp>
+#include <ray/compiler/passes/typeScanner.hpp>
+
+#include <ray/compiler/generators/c/c_transpiler.hpp>
+
+#include <ray/compiler/lang/moduleInterface.hpp>
+#include <ray/compiler/lang/moduleStore.hpp>
+#include <ray/compiler/lang/sourceUnit.hpp>
+#include <ray/compiler/lang/stringInterner.hpp>
+#include <ray/compiler/lang/typeTable.hpp>
+
+#include <ray/compiler/source_buffer.hpp>
+#include <ray/compiler/time_report.hpp>
+#include <ray/compiler/trace.hpp>
+
+#include <ray/util/atomic_file.hpp>
+#include <ray/util/output_buffer.hpp>
+#include <ray/util/thread_pool.hpp>
+
+// wingdi.h is included somewhere and is defining ERROR and as macro...
+#ifdef ERROR
+#undef ERROR
+#endif
+
+namespace ray::compiler {
+
+using namespace ray::compiler::terminal::literals;
+
+namespace {
+
+// an input file compiled into its own output, diagnostics are kept until
+// every unit is done so units compiled in parallel are reported in order
+struct CompilationUnit {
+	std::filesystem::path input;
+	std::filesystem::path output;
+	std::string sourceFile;
+	// the source buffer owns the file contents for the whole compilation,
+	// tokens and the AST keep views into it
+	std::optional<SourceBuffer> source;
+	uint64_t contentHash = 0;
+	// the result of an earlier build, replayed instead of compiling the unit
+	// while the interfaces of its imports are unchanged
+	std::optional<CachedUnit> cached;
+	// the lexer also owns the unescaped literals referenced by the AST
+	std::unique_ptr<Lexer> lexer;
+	ast::flat::Tree tree;
+	bool parsed = false;
+	util::OutputBuffer generated;
+	// streamed units are already in their output file
+	bool written = false;
+	std::string diagnostics;
+	// exit code of the unit, 1 for errors in the source and -1 for bugs
+	int status = 0;
+};
+
+// expands module roots into the .ray files below them, each one is written
+// to the output directory under its path relative to the root
+std::vector<CompilationUnit> collectUnits(const cli::Options &opts) {
+	std::vector<CompilationUnit> units;
+	if (!opts.compilesToDirectory()) {
+		units.push_back({.input = opts.inputs.front(), .output = opts.output});
+		return units;
+	}
+	for (const auto &input : opts.inputs) {
+		if (!std::filesystem::is_directory(input)) {
+			units.push_back({.input = input,
+			                 .output = opts.output / input.filename()});
+			continue;
+		}
+		std::vector<std::filesystem::path> files;
+		for (const auto &entry :
+		     std::filesystem::recursive_directory_iterator(input)) {
+			if (entry.is_regular_file() &&
+			    entry.path().extension() == ".ray") {
+				files.push_back(entry.path());
+			}
+		}
+		// directory order is unspecified, keep diagnostics reproducible
+		std::ranges::sort(files);
+		for (auto &file : files) {
+			auto output = opts.output / file.lexically_relative(input);
+			units.push_back({.input = std::move(file), .output = output});
+		}
+	}
+	for (auto &unit : units) {
+		unit.output.replace_extension(".c");
+	}
+	return units;
+}
+
+void openUnit(CompilationUnit &unit, const BuildCache *cache,
+              TimeReport *report) {
+	TimeReport::Scope scope(report, "read");
+	unit.source = SourceBuffer::open(unit.input);
+	if (!unit.source) {
+		unit.diagnostics += std::format("{}: could not open file: {}\n",
+		                                "Error"_red, unit.input.string());
+		unit.status = 1;
+		return;
+	}
+
+	unit.sourceFile = unit.input.make_preferred().relative_path().string();
+	unit.contentHash = lang::hashSource(unit.source->view());
+	if (cache != nullptr) {
+		unit.cached = cache->find(unit.sourceFile, unit.contentHash);
+	}
+}
+
+void parseUnit(CompilationUnit &unit, TimeReport *report) {
+	TimeReport::Scope scope(report, "parse", unit.sourceFile);
+	unit.parsed = true;
+	// tokens are scanned on demand while parsing
+	unit.lexer = std::make_unique<Lexer>(unit.source->view());
+	// the parser builds a pointer tree inside the arena, the passes walk its
+	// flat lowering so the arena is released once lowered
+	ast::Arena astArena;
+	auto parser =
+	    Parser(unit.sourceFile, TokenStream(*unit.lexer), astArena);
+	auto statements = parser.parse();
+
+	if (unit.lexer->getErrors().size() > 0) {
+		for (auto &error : unit.lexer->getErrors()) {
+			unit.diagnostics += std::format(
+			    "{}: [{}:{}] {}\n", "LexerError"_red, unit.input.string(),
+			    error.positionString(), error.toString());
+		}
+		unit.status = 1;
+		return;
+	}
+	if (parser.failed()) {
+		for (auto parseError : parser.getErrors()) {
+			unit.diagnostics += parseError;
+		}
+		unit.status = 1;
+		return;
+	}
+	unit.tree = ast::flat::Builder().build(statements);
+}
+
+// lets later builds import this unit without parsing it
+void writeInterface(CompilationUnit &unit, const cli::Options &opts,
+                    const lang::SourceUnit &sourceUnit,
+                    const environment::DataModel &dataModel,
+                    TimeReport *report) {
+	TimeReport::Scope scope(report, "interface", unit.sourceFile);
+	std::vector<lang::ModuleInterface::Import> imports;
+	for (const auto &import : lang::ModuleStore::collectImports(unit.tree)) {
+		imports.push_back({.path = import.path,
+		                   .line = import.token.line,
+		                   .column = import.token.column});
+	}
+	auto interfacePath = lang::ModuleInterface::pathFor(
+	    opts.interfaceDirectory, unit.input, unit.contentHash, dataModel);
+	if (!lang::ModuleInterface::fromSourceUnit(sourceUnit, unit.contentHash,
+	                                           std::move(imports))
+	         .write(interfacePath, dataModel)) {
+		unit.diagnostics +=
+		    std::format("{}: could not write interface: {}\n",
+		                "Warning"_yellow, interfacePath.string());
+	}
+}
+
+// incremental output: checks and generates the unit one declaration at a
+// time, the generated C goes to a temporary file whenever a chunk of it is
+// ready. only the C text is released as it goes, the tree, the lexer and the
+// checker state stay until the unit ends. the output file is only replaced
+// once the whole unit compiled without errors
+void streamUnit(CompilationUnit &unit, const cli::Options &opts,
+                const lang::ModuleStore &moduleStore,
+                const lang::SourceUnit &sourceUnit,
+                passes::TypeChecker &typeChecker,
+                const environment::DataModel &dataModel,
+                TimeReport *report) {
+	util::OutputFile file(unit.output);
+	generator::c::CTranspilerGenerator CTranspilerGen(
+	    unit.sourceFile, moduleStore, unit.input, sourceUnit, dataModel);
+	{
+		TimeReport::Scope scope(report, "stream", unit.sourceFile);
+		typeChecker.begin(unit.tree);
+		CTranspilerGen.begin(unit.tree);
+		for (auto root : unit.tree.getRoots()) {
+			typeChecker.resolveRoot(root);
+			// what is generated after an error is never written
+			if (typeChecker.hasFailed()) {
+				continue;
+			}
+			CTranspilerGen.resolveRoot(root);
+			if (!CTranspilerGen.hasFailed() &&
+			    CTranspilerGen.getOutputSize() >=
+			        util::OutputBuffer::firstChunkSize) {
+				file.write(CTranspilerGen.takeOutput());
+			}
+		}
+		typeChecker.end();
+	}
+	if (typeChecker.hasFailed()) {
+		unit.diagnostics +=
+		    std::format("{}: {}\n", "Error"_red, "typeChecker failed");
+		for (auto typeCheckerError : typeChecker.getErrors()) {
+			unit.diagnostics += typeCheckerError;
+		}
+		unit.status = 1;
+		return;
+	}
+	for (auto typeCheckerWarning : typeChecker.getWarnings()) {
+		unit.diagnostics += typeCheckerWarning;
+	}
+
+	if (!opts.interfaceDirectory.empty()) {
+		writeInterface(unit, opts, sourceUnit, dataModel, report);
+	}
+
+	CTranspilerGen.end();
+	if (CTranspilerGen.hasFailed()) {
+		unit.diagnostics +=
+		    std::format("{}: {}\n", "Error"_red, "CSourceGen failed");
+		for (auto cError : CTranspilerGen.getErrors()) {
+			unit.diagnostics += cError;
+		}
+		unit.status = 1;
+		return;
+	}
+	TimeReport::Scope scope(report, "write", unit.sourceFile);
+	if (!file.write(CTranspilerGen.takeOutput()) || !file.commit()) {
+		unit.diagnostics += std::format("{}: could not write file: {}\n",
+		                                "Error"_red, unit.output.string());
+		unit.status = 1;
+		return;
+	}
+	unit.written = true;
+}
+
+void compileUnit(CompilationUnit &unit, const cli::Options &opts,
+                 const lang::ModuleStore &moduleStore,
+                 const environment::DataModel &dataModel,
+                 TimeReport *report) {
+	// owned here and borrowed by every pass below
+	lang::SourceUnit sourceUnit;
+
+	passes::TypeScanner typeScanner(unit.sourceFile, dataModel, sourceUnit);
+
+	{
+		TimeReport::Scope scope(report, "scan", unit.sourceFile);
+		typeScanner.resolve(unit.tree);
+	}
+	// TODO: once a propper typeScanner is set in place replace this so
+	// type checker errors can be reported along with the previous
+	// errors
+	if (typeScanner.hasFailed()) {
+		unit.diagnostics +=
+		    std::format("{}: {}\n", "Error"_red, "typeChecker failed");
+		for (auto typeScannerError : typeScanner.getErrors()) {
+			unit.diagnostics += typeScannerError;
+		}
+		unit.status = 1;
+		return;
+	}
+
+	passes::TypeChecker typeChecker(unit.sourceFile, moduleStore, unit.input,
+	                                dataModel, sourceUnit);
+
+	// a cached unit needs its whole output to store it
+	if (opts.streamOutput && opts.cacheDirectory.empty() &&
+	    opts.target == cli::Options::TargetEnum::C_SOURCE) {
+		streamUnit(unit, opts, moduleStore, sourceUnit, typeChecker, dataModel,
+		           report);
+		return;
+	}
+
+	{
+		TimeReport::Scope scope(report, "check", unit.sourceFile);
+		typeChecker.resolve(unit.tree);
+	}
+	if (typeChecker.hasFailed()) {
+		unit.diagnostics +=
+		    std::format("{}: {}\n", "Error"_red, "typeChecker failed");
+		for (auto typeCheckerError : typeChecker.getErrors()) {
+			unit.diagnostics += typeCheckerError;
+		}
+		unit.status = 1;
+		return;
+	}
+	for (auto typeCheckerWarning : typeChecker.getWarnings()) {
+		unit.diagnostics += typeCheckerWarning;
+	}
+
+	if (!opts.interfaceDirectory.empty()) {
+		writeInterface(unit, opts, sourceUnit, dataModel, report);
+	}
+
+	bool handled = false;
+	switch (opts.target) {
+	case cli::Options::TargetEnum::C_SOURCE: {
+		handled = true;
+		TimeReport::Scope scope(report, "codegen", unit.sourceFile);
+		generator::c::CTranspilerGenerator CTranspilerGen(
+		    unit.sourceFile, moduleStore, unit.input, sourceUnit, dataModel);
+
+		CTranspilerGen.resolve(unit.tree);
+		if (CTranspilerGen.hasFailed()) {
+			unit.diagnostics +=
+			    std::format("{}: {}\n", "Error"_red, "CSourceGen failed");
+			for (auto cError : CTranspilerGen.getErrors()) {
+				unit.diagnostics += cError;
+			}
+			unit.status = 1;
+			return;
+		}
+		unit.generated = CTranspilerGen.takeOutput();
+	}
+	// both cases should never show
+	case cli::Options::TargetEnum::NONE:
+	case cli::Options::TargetEnum::ERROR:
+		break;
+	}
+	if (!handled) {
+		unit.diagnostics += std::format(
+		    "{}: unhandled target option, this is a compiler bug\n",
+		    "COMPILER-ERROR"_red);
+		unit.status = -1;
+		return;
+	}
+}
+
+// the entry lists the interface each import resolved to, so it is only
+// replayed while the declarations it was checked against are the same
+void storeUnit(const CompilationUnit &unit, const BuildCache &cache,
+               const lang::ModuleStore &moduleStore, TimeReport *report) {
+	TimeReport::Scope scope(report, "cache", unit.sourceFile);
+	CachedUnit cached{.sourceFile = unit.sourceFile,
+	                  .contentHash = unit.contentHash,
+	                  .failed = unit.status != 0,
+	                  .diagnostics = unit.diagnostics,
+	                  .output = unit.generated.str()};
+	for (const auto &import : lang::ModuleStore::collectImports(unit.tree)) {
+		auto id = moduleStore.findModule(import.path, unit.input);
+		if (!id) {
+			// imports were loaded, but keep a broken entry out of the cache
+			return;
+		}
+		cached.dependencies.push_back(
+		    {.importPath = import.path,
+		     .line = import.token.line,
+		     .column = import.token.column,
+		     .interfaceHash = moduleStore.getModule(*id).interfaceHash});
+	}
+	// failing to store only costs compiling the unit again next time
+	(void)cache.store(cached);
+}
+
+// whether the imports of a cached unit still resolve to the same interfaces
+bool cachedImportsMatch(const CompilationUnit &unit,
+                        const lang::ModuleStore &moduleStore) {
+	for (const auto &dependency : unit.cached->dependencies) {
+		auto id = moduleStore.findModule(dependency.importPath, unit.input);
+		if (!id || moduleStore.getModule(*id).interfaceHash !=
+		               dependency.interfaceHash) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void writeUnit(CompilationUnit &unit, TimeReport *report) {
+	TimeReport::Scope scope(report, "write", unit.sourceFile);
+	if (!unit.generated.writeFile(unit.output)) {
+		unit.diagnostics += std::format("{}: could not write file: {}\n",
+		                                "Error"_red, unit.output.string());
+		unit.status = 1;
+	}
+}
+
+// reports the errors the last loadImports call appended to the store
+void reportImportErrors(CompilationUnit &unit,
+                        const lang::ModuleStore &moduleStore,
+                        size_t firstError) {
+	unit.diagnostics +=
+	    std::format("{}: {}\n", "Error"_red, "could not load imports");
+	const auto &moduleErrors = moduleStore.getErrors();
+	for (size_t i = firstError; i < moduleErrors.size(); i++) {
+		unit.diagnostics += moduleErrors[i];
+	}
+	unit.status = 1;
+}
+
+// runs the step for every unit that has not failed yet, an exception only
+// fails the unit that threw it
+template <typename Step>
+void runOnUnits(util::ThreadPool &pool, std::vector<CompilationUnit> &units,
+                Step step) {
+	for (auto &unit : units) {
+		if (unit.status != 0) {
+			continue;
+		}
+		pool.submit([&unit, &step] {
+			try {
+				step(unit);
+			} catch (std::exception &ex) {
+				unit.diagnostics += std::format(
+				    "{}: {}\n", "UNHANDLED_ERROR"_red, ex.what());
+				unit.status = -1;
+			}
+		});
+	}
+	pool.wait();
+}
+
+} // namespace
+
+int Driver::run(int argc, char **argv, std::ostream &output,
+                std::ostream &diagnostics) {
+	try {
+		auto result = cli::parse_args(argc, argv);
+		if (std::holds_alternative<std::vector<std::string>>(result)) {
+			for (const auto &error :
+			     std::get<std::vector<std::string>>(result)) {
+				output << error << '\n';
+			}
+			return 1;
+		}
+		return compile(std::get<cli::Options>(result), diagnostics);
+	} catch (std::exception &ex) {
+		diagnostics << std::format("{}: {}\n", "UNHANDLED_ERROR"_red,
+		                           ex.what());
+		return -1;
+	}
+}
+
+int Driver::compile(cli::Options opts, std::ostream &diagnostics) {
+	if (!opts.validate(diagnostics)) {
+		return 1;
+	}
+
+	const environment::DataModel *dataModel;
+	switch (opts.dataModel) {
+	case cli::Options::TargetDataModel::NONE: {
+		diagnostics << std::format("{}: no data model available\n",
+		                           "Error"_red);
+		return 1;
+	}
+	case cli::Options::TargetDataModel::LLP64: {
+		dataModel = &environment::DataModel::LLP64DataModel();
+		break;
+	}
+	case cli::Options::TargetDataModel::LP64: {
+		dataModel = &environment::DataModel::LP64DataModel();
+		break;
+	}
+	default: {
+		diagnostics << std::format(
+		    "{}: the selected data model is not supported\n", "Error"_red);
+		return 1;
+	}
+	}
+	if (opts.target == cli::Options::TargetEnum::NONE) {
+		opts.target = opts.defaultTarget;
+	}
+	// what gets interned from here on belongs to this build, the data
+	// models are process wide and intern their scalar types on first use
+	auto &names = lang::StringInterner::global();
+	auto &types = lang::TypeTable::global();
+	size_t namesBefore = names.size();
+	size_t typesBefore = types.size();
+
+	auto units = collectUnits(opts);
+	if (opts.compilesToDirectory()) {
+		std::set<std::filesystem::path> outputs;
+		for (const auto &unit : units) {
+			if (!outputs.insert(unit.output).second) {
+				diagnostics << std::format(
+				    "{}: several inputs would be written to '{}'\n",
+				    "Error"_red, unit.output.string());
+				return 1;
+			}
+			std::filesystem::create_directories(unit.output.parent_path());
+		}
+	}
+
+	std::optional<BuildCache> cache;
+	if (!opts.cacheDirectory.empty()) {
+		cache.emplace(opts.cacheDirectory, *dataModel,
+		              cli::Options::targetToString(opts.target));
+	}
+	const BuildCache *cachePtr = cache ? &*cache : nullptr;
+
+	std::optional<TimeReport> timeReport;
+	if (opts.timeReport || !opts.timeReportJson.empty()) {
+		timeReport.emplace();
+	}
+	TimeReport *report = timeReport ? &*timeReport : nullptr;
+	// spans are recorded only while the recorder is installed
+	std::optional<TraceRecorder> traceRecorder;
+	if (!opts.traceFile.empty()) {
+		traceRecorder.emplace().install();
+	}
+
+	// a single unit does not need more than one worker
+	util::ThreadPool pool(units.size() > 1 ? opts.jobs : 1);
+	runOnUnits(pool, units, [&](CompilationUnit &unit) {
+		openUnit(unit, cachePtr, report);
+		if (!unit.cached) {
+			parseUnit(unit, report);
+		}
+	});
+
+	// imported modules are parsed and scanned once before the units
+	// importing them, the store is only read once every unit loaded
+	lang::ModuleStore &moduleStore = moduleStoreFor(opts, *dataModel);
+	size_t modulesBefore = moduleStore.size();
+	// cached units load the imports recorded in their entry, they
+	// are compiled again when any of those interfaces changed
+	for (auto &unit : units) {
+		if (unit.status != 0 || !unit.cached) {
+			continue;
+		}
+		std::vector<lang::ModuleStore::Import> imports;
+		for (const auto &dependency : unit.cached->dependencies) {
+			imports.push_back(lang::ModuleStore::Import::at(
+			    dependency.importPath, dependency.line,
+			    dependency.column));
+		}
+		TimeReport::Scope scope(report, "imports", unit.sourceFile);
+		size_t firstError = moduleStore.getErrors().size();
+		if (!moduleStore.loadImports(imports, unit.input)) {
+			reportImportErrors(unit, moduleStore, firstError);
+		} else if (!cachedImportsMatch(unit, moduleStore)) {
+			unit.cached.reset();
+		}
+	}
+	runOnUnits(pool, units, [&](CompilationUnit &unit) {
+		if (!unit.cached && !unit.parsed) {
+			parseUnit(unit, report);
+		}
+	});
+	for (auto &unit : units) {
+		if (unit.status != 0 || unit.cached) {
+			continue;
+		}
+		TimeReport::Scope scope(report, "imports", unit.sourceFile);
+		size_t firstError = moduleStore.getErrors().size();
+		if (!moduleStore.loadImports(unit.tree, unit.input)) {
+			reportImportErrors(unit, moduleStore, firstError);
+		}
+	}
+
+	runOnUnits(pool, units, [&](CompilationUnit &unit) {
+		if (unit.cached) {
+			unit.diagnostics += unit.cached->diagnostics;
+			unit.generated.append(unit.cached->output);
+			unit.status = unit.cached->failed ? 1 : 0;
+		} else {
+			compileUnit(unit, opts, moduleStore, *dataModel, report);
+			// bugs in the compiler are not worth remembering
+			if (cache && unit.status != -1) {
+				storeUnit(unit, *cache, moduleStore, report);
+			}
+		}
+		if (unit.status == 0 && !unit.written) {
+			writeUnit(unit, report);
+		}
+	});
+
+	int status = 0;
+	for (const auto &unit : units) {
+		diagnostics << unit.diagnostics;
+		if (unit.status != 0 && status != -1) {
+			status = unit.status;
+		}
+	}
+	// the units and their source units are done with, only the modules kept
+	// for later builds still reference names and types. a build that loaded
+	// none of them leaves nothing behind, one that did keeps everything so
+	// the store stays valid and the growth is bounded by the modules
+	units.clear();
+	size_t comparisons = types.comparisons();
+	if (moduleStore.size() == modulesBefore) {
+		types.releaseFrom(typesBefore);
+		names.releaseFrom(namesBefore);
+	}
+	types.clearComparisons();
+	if (report) {
+		report->setTables({.names = names.size(),
+		                   .types = types.size(),
+		                   .comparisons = comparisons});
+	}
+	if (traceRecorder) {
+		traceRecorder->uninstall();
+		if (!util::writeFileAtomically(opts.traceFile,
+		                               traceRecorder->toJson())) {
+			diagnostics << std::format("{}: could not write trace: {}\n",
+			                           "Warning"_yellow,
+			                           opts.traceFile.string());
+		}
+	}
+	if (opts.timeReport) {
+		diagnostics << timeReport->toText();
+	}
+	if (!opts.timeReportJson.empty() &&
+	    !util::writeFileAtomically(opts.timeReportJson, timeReport->toJson())) {
+		diagnostics << std::format("{}: could not write time report: {}\n",
+		                           "Warning"_yellow,
+		                           opts.timeReportJson.string());
+	}
+	return status;
+}
+
+lang::ModuleStore &
+Driver::moduleStoreFor(const cli::Options &opts,
+                       const environment::DataModel &dataModel) {
+	std::string key = std::format("{}|{}", static_cast<int>(opts.dataModel),
+	                              opts.interfaceDirectory.string());
+	for (const auto &[name, root] : opts.packages) {
+		key += std::format("|{}={}", name, root.string());
+	}
+	auto &moduleStore = moduleStores[key];
+	if (moduleStore) {
+		// modules loaded by an earlier build are reused while unchanged
+		moduleStore->refresh();
+		return *moduleStore;
+	}
+	moduleStore = std::make_unique<lang::ModuleStore>(dataModel);
+	for (const auto &[name, root] : opts.packages) {
+		moduleStore->addPackage(name, root);
+	}
+	if (!opts.interfaceDirectory.empty()) {
+		moduleStore->setInterfaceDirectory(opts.interfaceDirectory);
+	}
+	return *moduleStore;
+}
+
+} // namespace ray::compiler
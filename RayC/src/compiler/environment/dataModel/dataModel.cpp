@@ -6,13 +6,14 @@
 #include <unordered_map>
 
 #include <ray/compiler/environment/dataModel/dataModel.hpp>
+#include <ray/compiler/lang/stringInterner.hpp>
 #include <ray/compiler/lang/type.hpp>
 
 namespace ray::compiler::environment {
 
 lang::Type
 DataModel::defineTupleType(size_t tupleID,
-                           std::vector<util::copy_ptr<lang::Type>> signature,
+                           std::vector<lang::TypeRef> signature,
                            size_t aproximatedSize) const {
 	return {
 	    // its type is the same as structID
@@ -20,7 +21,7 @@ DataModel::defineTupleType(size_t tupleID,
 	    // initialized
 	    true,
 	    lang::TypeKind::aggregate,
-	    "%<tuple>%",
+	    lang::InternedString("%<tuple>%"),
 	    aproximatedSize,
 	    false,     // non mutable
 	    false,     // non signed
@@ -31,7 +32,8 @@ DataModel::defineTupleType(size_t tupleID,
 	};
 }
 
-lang::Type DataModel::defineStructType(size_t structID, std::string name,
+lang::Type DataModel::defineStructType(size_t structID,
+                                       lang::InternedString name,
                                        size_t aproximatedSize) const {
 	return {
 	    // its type is the same as structID
@@ -52,10 +54,10 @@ lang::Type DataModel::defineStructType(size_t structID, std::string name,
 
 lang::Type DataModel::defineFunctionType(
     lang::Type returnType,
-    std::vector<util::copy_ptr<lang::Type>> signature) const {
+    std::vector<lang::TypeRef> signature) const {
 	auto fn = definePointerType(returnType, false);
 	// TODO: remove this ugly hack once the new type scanner is set in place
-	fn.name = "//fn";
+	fn.name = lang::InternedString("//fn");
 	fn.signature = signature;
 	return fn;
 }
@@ -71,7 +73,7 @@ DataModel::defineOverloadedFunctionType(lang::Type returnType) const {
 	    // that references an object
 	    lang::TypeKind::pointer,
 	    // define the name as pointer
-	    "//fn-overload",
+	    lang::InternedString("//fn-overload"),
 	    0,          // an overloaded function does not hold any size
 	    false,      // if the pointer type is const or not is decided later
 	    false,      // non signed, is a pointer
@@ -86,81 +88,103 @@ lang::Type DataModel::getUnitType(bool isMutable) const {
 	return lang::Type::defineUnitType(isMutable);
 }
 
+DataModel::DataModel(const size_t charSize, const size_t shortIntSize,
+                     const size_t intSize, const size_t longIntSize,
+                     const size_t longLongSize, const size_t pointerSize)
+    : charSize(charSize), shortIntSize(shortIntSize), intSize(intSize),
+      longIntSize(longIntSize), longLongSize(longLongSize),
+      pointerSize(pointerSize), scalarTypes(defineScalarTypes()) {}
+
 std::optional<lang::Type>
 DataModel::findScalarType(const std::string_view name) const {
-	static std::unordered_map<std::string, lang::Type> map = {
+	// a name that was never interned cannot be a scalar type
+	auto interned = lang::StringInterner::global().find(name);
+	if (!interned) {
+		return std::nullopt;
+	}
+	auto it = scalarTypes.find(*interned);
+	return it != scalarTypes.end() ? std::optional<lang::Type>(it->second)
+	                               : std::nullopt;
+}
+
+std::unordered_map<lang::InternedString, lang::Type>
+DataModel::defineScalarTypes() const {
+	return {
 	    {
-	        "bool",
-	        defineScalarType("bool", 1, false, false),
+	        lang::InternedString("bool"),
+	        defineScalarType(lang::InternedString("bool"), 1, false, false),
 	    }, // bool
 	    {
-	        "u8",
-	        defineScalarType("u8", 1, false, false),
+	        lang::InternedString("u8"),
+	        defineScalarType(lang::InternedString("u8"), 1, false, false),
 	    }, // u8
 	    {
-	        "s8",
-	        defineScalarType("s8", 1, true, false),
+	        lang::InternedString("s8"),
+	        defineScalarType(lang::InternedString("s8"), 1, true, false),
 	    }, // s8
 	    {
-	        "u16",
-	        defineScalarType("u16", 2, false, false),
+	        lang::InternedString("u16"),
+	        defineScalarType(lang::InternedString("u16"), 2, false, false),
 	    }, // u16
 	    {
-	        "s16",
-	        defineScalarType("s16", 2, true, false),
+	        lang::InternedString("s16"),
+	        defineScalarType(lang::InternedString("s16"), 2, true, false),
 	    }, // s16
 	    {
-	        "u32",
-	        defineScalarType("u32", 4, false, false),
+	        lang::InternedString("u32"),
+	        defineScalarType(lang::InternedString("u32"), 4, false, false),
 	    }, // u32
 	    {
-	        "s32",
-	        defineScalarType("s32", 4, true, false),
+	        lang::InternedString("s32"),
+	        defineScalarType(lang::InternedString("s32"), 4, true, false),
 	    }, // s32
 	    {
-	        "u64",
-	        defineScalarType("u64", 8, false, false),
+	        lang::InternedString("u64"),
+	        defineScalarType(lang::InternedString("u64"), 8, false, false),
 	    }, // u64
 	    {
-	        "s64",
-	        defineScalarType("s64", 8, true, false),
+	        lang::InternedString("s64"),
+	        defineScalarType(lang::InternedString("s64"), 8, true, false),
 	    }, // s64
 	    {
-	        "f32",
-	        defineScalarType("f32", 4, true, false),
+	        lang::InternedString("f32"),
+	        defineScalarType(lang::InternedString("f32"), 4, true, false),
 	    }, // f32
 	    {
-	        "f64",
-	        defineScalarType("f64", 8, true, false),
+	        lang::InternedString("f64"),
+	        defineScalarType(lang::InternedString("f64"), 8, true, false),
 	    }, // f64
 	    {
-	        "usize",
-	        defineScalarType("usize", pointerSize, false, false),
+	        lang::InternedString("usize"),
+	        defineScalarType(lang::InternedString("usize"), pointerSize,
+	                         false, false),
 	    }, // usize
 	    {
-	        "ssize",
-	        defineScalarType("ssize", pointerSize, true, false),
+	        lang::InternedString("ssize"),
+	        defineScalarType(lang::InternedString("ssize"), pointerSize,
+	                         true, false),
 	    }, // ssize
 	    {
-	        "c_char",
-	        defineScalarType("c_char", charSize, true, false),
+	        lang::InternedString("c_char"),
+	        defineScalarType(lang::InternedString("c_char"), charSize,
+	                         true, false),
 	    }, // c_char
 	    {
-	        "c_int",
-	        defineScalarType("c_int", intSize, true, false),
+	        lang::InternedString("c_int"),
+	        defineScalarType(lang::InternedString("c_int"), intSize,
+	                         true, false),
 	    }, // c_int
 	    {
-	        "c_size",
-	        defineScalarType("c_size", pointerSize, false, false),
+	        lang::InternedString("c_size"),
+	        defineScalarType(lang::InternedString("c_size"), pointerSize,
+	                         false, false),
 	    }, // c_size
 	};
-	std::string key{name};
-	return map.contains(key) ? std::optional<lang::Type>(map.at(key))
-	                         : std::nullopt;
 }
 
-lang::Type DataModel::defineScalarType(std::string name, size_t calculatedSize,
-                                       bool signedType, bool isMutable) const {
+lang::Type DataModel::defineScalarType(lang::InternedString name,
+                                       size_t calculatedSize, bool signedType,
+                                       bool isMutable) const {
 	return lang::Type{
 	    // scalars do not have typeID
 	    0,
@@ -183,7 +207,7 @@ lang::Type DataModel::definePointerType(lang::Type returnType,
 	    0,
 	    true,                    // initialized type
 	    lang::TypeKind::pointer, // it is an scalar type
-	    "%<pointer>%",           // specified name
+	    lang::InternedString("%<pointer>%"), // specified name
 	    pointerSize,             // varies depending on the data model
 	    isMutable,               // by default all scalar types are const
 	    true,                    // is not a pointer type
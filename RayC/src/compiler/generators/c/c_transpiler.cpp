@@ -6,6 +6,8 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <unordered_set>
+#include <utility>
 
 #include <ray/compiler/ast/expression.hpp>
 #include <ray/compiler/ast/intrinsic.hpp>
@@ -14,41 +16,59 @@
 #include <ray/compiler/directives/linkageDirective.hpp>
 #include <ray/compiler/generators/c/c_transpiler.hpp>
 #include <ray/compiler/lang/functionDefinition.hpp>
+#include <ray/compiler/lang/moduleStore.hpp>
 #include <ray/compiler/lang/struct.hpp>
 #include <ray/compiler/lang/type.hpp>
 #include <ray/compiler/lexer/token.hpp>
 #include <ray/compiler/message_bag.hpp>
 #include <ray/compiler/passes/symbol_mangler.hpp>
+#include <ray/compiler/trace.hpp>
 #include <ray/util/soft_reference.hpp>
 
 namespace ray::compiler::generator::c {
 
-std::string CTranspilerGenerator::currentIdent() const {
-	return std::string(ident, '\t');
-}
-
 CTranspilerGenerator::CTranspilerGenerator(
-    std::string filePath, const lang::SourceUnit &sourceUnit,
+    std::string filePath, const lang::ModuleStore &moduleStore,
+    std::filesystem::path importer, const lang::SourceUnit &sourceUnit,
     const environment::DataModel &dataModel)
     : messageBag("C-BACKEND", filePath), currentSourceUnit(sourceUnit),
-      currentScope(sourceUnit.rootScope), currentDataModel(dataModel) {}
+      currentDataModel(dataModel), moduleStore(moduleStore),
+      importer(std::move(importer)) {}
 
-void CTranspilerGenerator::resolve(
-    const std::vector<std::unique_ptr<ast::Statement>> &statement) {
+void CTranspilerGenerator::resolve(const ast::flat::Tree &tree) {
+	begin(tree);
+	output << "#pragma region function_declarations\n";
+	for (const auto &[functionId, functionDeclaration] :
+	     currentSourceUnit.get().getFunctions()) {
+		declareFunction(functionDeclaration, currentSourceUnit);
+	}
+	output << "#pragma endregion function_declarations\n";
+	// ident++;
+	for (auto stmt : tree.getRoots()) {
+		visit(stmt);
+	}
+	// ident--;
+	end();
+}
+
+void CTranspilerGenerator::begin(const ast::flat::Tree &tree) {
+	bind(tree);
 	output.clear();
+	nextFunctionId = currentSourceUnit.get().getNextId();
 
 	output << "#include <ray/ray_definitions.h>\n";
 	output << "#ifdef __cplusplus\n";
 	output << "RAY_C_LINKAGE {\n";
 	output << "#endif\n";
 
-	std::string currentModule;
+	declareImports(tree);
+
 	output << "#pragma region struct_declarations\n";
 	for (auto const &[structId, structDeclaration] :
 	     currentSourceUnit.get().getStructs()) {
-		output << std::format("{}typedef struct {}", currentIdent(),
-		                      structDeclaration.mangledName);
-		output << std::format(" {};\n", structDeclaration.mangledName);
+		output.indent(ident);
+		output.format("typedef struct {} {};\n", structDeclaration.mangledName,
+		              structDeclaration.mangledName);
 	}
 	output << "#pragma endregion struct_declarations\n";
 
@@ -58,42 +78,59 @@ void CTranspilerGenerator::resolve(
 	visitedStructs.reserve(currentSourceUnit.get().getStructs().size());
 	for (auto const &[structId, structDeclaration] :
 	     currentSourceUnit.get().getStructs()) {
-		defineStruct(visitedStructs, structDeclaration);
+		defineStruct(visitedStructs, structDeclaration, currentSourceUnit);
 	}
 	output << "#pragma endregion struct_definitions\n";
+}
 
-	output << "#pragma region function_declarations\n";
-	for (const auto &[functionId, functionDeclaration] :
-	     currentSourceUnit.get().getFunctions()) {
-		// main should be extern c++
-		if (functionDeclaration.mangledName == "main") {
-			output << "RAY_DEFAULT_LINKAGE ";
+void CTranspilerGenerator::declareImports(const ast::flat::Tree &tree) {
+	output << "#pragma region imported_declarations\n";
+	std::unordered_set<lang::ModuleId> declaredModules;
+	for (const auto &import : lang::ModuleStore::collectImports(tree)) {
+		auto moduleId = moduleStore.get().findModule(import.path, importer);
+		if (!moduleId.has_value() ||
+		    !declaredModules.insert(*moduleId).second) {
+			continue;
 		}
-		if (!functionDeclaration.publicVisibility) {
-			output << "RAYLANG_MACRO_LINK_LOCAL ";
-			output << "static ";
+		const auto &sourceUnit =
+		    moduleStore.get().getModule(*moduleId).sourceUnit;
+		for (auto const &[structId, structDeclaration] :
+		     sourceUnit.getStructs()) {
+			output.format("typedef struct {} {};\n",
+			              structDeclaration.mangledName,
+			              structDeclaration.mangledName);
 		}
-		visitType(functionDeclaration.signature.returnType);
-
-		output << std::format(" {}(", functionDeclaration.mangledName);
-		for (size_t index = 0;
-		     index < functionDeclaration.signature.parameters.size(); ++index) {
-			const auto &parameter =
-			    functionDeclaration.signature.parameters[index];
-			visitType(parameter.parameterType);
-			output << std::format(" {}", parameter.name);
-			if (index < functionDeclaration.signature.parameters.size() - 1) {
-				output << ", ";
+		std::unordered_set<size_t> visitedStructs;
+		for (auto const &[structId, structDeclaration] :
+		     sourceUnit.getStructs()) {
+			defineStruct(visitedStructs, structDeclaration, sourceUnit);
+		}
+		// only public functions can be called by the importer
+		for (const auto &[functionId, functionDeclaration] :
+		     sourceUnit.getFunctions()) {
+			if (functionDeclaration.publicVisibility) {
+				declareFunction(functionDeclaration, sourceUnit);
 			}
 		}
-		output << ");\n";
 	}
-	output << "#pragma endregion function_declarations\n";
-	// ident++;
-	for (const auto &stmt : statement) {
-		stmt->visit(*this);
+	output << "#pragma endregion imported_declarations\n";
+}
+
+void CTranspilerGenerator::resolveRoot(ast::flat::NodeId root) {
+	// functions are declared by the checker as it reaches them and can only
+	// be used after that, so declaring them right before the root is enough
+	const auto &functions = currentSourceUnit.get().getFunctions();
+	for (size_t id = nextFunctionId; id < currentSourceUnit.get().getNextId();
+	     id++) {
+		if (auto function = functions.find(id); function != functions.end()) {
+			declareFunction(function->second, currentSourceUnit);
+		}
 	}
-	// ident--;
+	nextFunctionId = currentSourceUnit.get().getNextId();
+	visit(root);
+}
+
+void CTranspilerGenerator::end() {
 	output << "#ifdef __cplusplus\n";
 	output << "}\n";
 	output << "#endif\n";
@@ -115,30 +152,32 @@ const std::vector<std::string> CTranspilerGenerator::getErrors() const {
 std::string CTranspilerGenerator::getOutput() const { return output.str(); }
 
 // Statement
-void CTranspilerGenerator::visitBlockStatement(const ast::Block &block) {
+void CTranspilerGenerator::visitBlockStatement(const ast::flat::Block &block) {
 	if (block.statements.size() > 0) {
-		for (auto &statement : block.statements) {
-			statement->visit(*this);
+		for (auto statement : tree().range(block.statements)) {
+			visit(statement);
 		}
 	}
 }
 void CTranspilerGenerator::visitTerminalExprStatement(
-    const ast::TerminalExpr &terminalExpr) {
-	if (terminalExpr.expression.has_value()) {
-		output << std::format("{}return ", currentIdent());
-		terminalExpr.expression->get()->visit(*this);
-		output << std::format(";\n");
+    const ast::flat::TerminalExpr &terminalExpr) {
+	if (terminalExpr.expression) {
+		output.indent(ident);
+		output << "return ";
+		visit(terminalExpr.expression);
+		output << ";\n";
 	}
 }
 void CTranspilerGenerator::visitExpressionStmtStatement(
-    const ast::ExpressionStmt &expression) {
-	output << currentIdent();
-	expression.expression->visit(*this);
-	output << std::format(";\n", currentIdent());
+    const ast::flat::ExpressionStmt &expression) {
+	output.indent(ident);
+	visit(expression.expression);
+	output << ";\n";
 }
 void CTranspilerGenerator::visitFunctionStatement(
-    const ast::Function &function) {
-	std::string identTabs = currentIdent();
+    const ast::flat::Function &function) {
+	TraceRecorder::Span span("declaration", "emit fn",
+	                         token(function.name).lexeme);
 	std::string currentModule;
 
 	std::optional<directive::LinkageDirective> linkageDirective;
@@ -157,12 +196,13 @@ void CTranspilerGenerator::visitFunctionStatement(
 		directivesStack.pop_back();
 	}
 	std::string functionName =
-	    nameMangler.mangleFunction(currentModule, function, linkageDirective);
+	    nameMangler.mangleFunction(currentModule, token(function.name).lexeme,
+	                               linkageDirective);
 
 	// ignore any function declaration
-	if (function.body.has_value()) {
+	if (function.body) {
 
-		output << identTabs;
+		output.indent(ident);
 		// main has special rules to linking that we must follow
 		if (functionName == "main") {
 			output << "RAY_DEFAULT_LINKAGE ";
@@ -175,120 +215,136 @@ void CTranspilerGenerator::visitFunctionStatement(
 			}
 		}
 
-		function.returnType->visit(*this);
+		visit(function.returnType);
 
-		output << std::format(" {}(", functionName);
-		for (size_t index = 0; index < function.params.size(); ++index) {
-			const auto &parameter = function.params[index];
-			parameter.visit(*this);
-			if (index < function.params.size() - 1) {
+		output << ' ' << functionName << '(';
+		auto params = tree().range(function.params);
+		for (size_t index = 0; index < params.size(); ++index) {
+			visit(params[index]);
+			if (index < params.size() - 1) {
 				output << ", ";
 			}
 		}
-		output << ")";
-		output << " {";
-		if (function.body->statements.size() > 0) {
-			auto statement = dynamic_cast<ast::TerminalExpr *>(
-			    function.body->statements[0].get());
-			if (!statement || statement->expression.has_value()) {
+		output << ") {";
+		const auto &body = tree().get<ast::flat::Block>(function.body);
+		if (body.statements.size() > 0) {
+			auto statement = tree().tryGet<ast::flat::TerminalExpr>(
+			    tree().range(body.statements)[0]);
+			if (!statement || statement->expression) {
 				output << "\n";
 				ident++;
-				function.body->visit(*this);
+				visit(function.body);
 				ident--;
 			}
 		}
-		output << std::format("{}}}\n", identTabs);
+		output.indent(ident);
+		output << "}\n";
 	}
 }
-void CTranspilerGenerator::visitIfStatement(const ast::If &ifStatement) {
-	output << std::format("{}if (", currentIdent());
-	ifStatement.condition->visit(*this);
+void CTranspilerGenerator::visitIfStatement(const ast::flat::If &ifStatement) {
+	output.indent(ident);
+	output << "if (";
+	visit(ifStatement.condition);
 	output << ") {\n";
 	ident++;
-	ifStatement.thenBranch->visit(*this);
+	visit(ifStatement.thenBranch);
 	ident--;
-	output << std::format("{}}}\n", currentIdent());
-	if (ifStatement.elseBranch.has_value()) {
-		output << std::format("{}else{{\n", currentIdent());
+	output.indent(ident);
+	output << "}\n";
+	if (ifStatement.elseBranch) {
+		output.indent(ident);
+		output << "else{\n";
 		ident++;
-		ifStatement.elseBranch->get()->visit(*this);
+		visit(ifStatement.elseBranch);
 		ident--;
-		output << std::format("{}}}\n", currentIdent());
+		output.indent(ident);
+		output << "}\n";
 	}
 }
-void CTranspilerGenerator::visitJumpStatement(const ast::Jump &jump) {
-	std::string identTab = currentIdent();
-	switch (jump.keyword.type) {
+void CTranspilerGenerator::visitJumpStatement(const ast::flat::Jump &jump) {
+	switch (token(jump.keyword).type) {
 	case Token::TokenType::TOKEN_BREAK:
-		output << std::format("{}br 0\n", identTab);
+		output.indent(ident);
+		output << "br 0\n";
 		break;
 	case Token::TokenType::TOKEN_CONTINUE:
-		output << std::format("{}br 1\n", identTab);
+		output.indent(ident);
+		output << "br 1\n";
 		break;
 	case Token::TokenType::TOKEN_RETURN:
-		output << std::format("{}return", identTab);
-		if (jump.returnValue.has_value()) {
+		output.indent(ident);
+		output << "return";
+		if (jump.returnValue) {
 			output << " ";
 			auto currentIdent = ident;
 			ident = 0;
-			jump.returnValue.value()->visit(*this);
+			visit(jump.returnValue);
 			ident = currentIdent;
 		}
 		output << ";\n";
 		break;
 	default:
-		messageBag.error(jump.getToken(),
+		messageBag.error(token(jump.token),
 		                 std::format("'{}' is not a supported jump type",
-		                             jump.keyword.getLexeme()));
+		                             token(jump.keyword).getLexeme()));
 		break;
 	}
 }
-void CTranspilerGenerator::visitVarDeclStatement(const ast::VarDecl &var) {
-	output << currentIdent();
+void CTranspilerGenerator::visitVarDeclStatement(
+    const ast::flat::VarDecl &var) {
+	// a module only exists for the checker, its members are called by name
+	if (var.initializer && findModule(var.initializer).has_value()) {
+		return;
+	}
+	output.indent(ident);
 
-	var.type->visit(*this);
-	output << std::format(" {}", var.name.lexeme);
+	visit(var.type);
+	output << ' ' << token(var.name).lexeme;
 
-	if (var.initializer.has_value()) {
+	if (var.initializer) {
 		output << " = ";
-		auto initializer = var.initializer->get();
+		auto initializer = var.initializer;
 		auto currentIdent = ident;
 		ident = 0;
-		initializer->visit(*this);
+		visit(initializer);
 		ident = currentIdent;
 	}
 	output << ";\n";
 }
-void CTranspilerGenerator::visitMemberStatement(const ast::Member &var) {
-	output << currentIdent();
+void CTranspilerGenerator::visitMemberStatement(const ast::flat::Member &var) {
+	output.indent(ident);
 
-	var.type->visit(*this);
-	output << std::format("{}", var.name.lexeme);
+	visit(var.type);
+	output << token(var.name).lexeme;
 
-	if (var.initializer.has_value()) {
+	if (var.initializer) {
 		output << " = ";
-		auto initializer = var.initializer->get();
+		auto initializer = var.initializer;
 		auto currentIdent = ident;
 		ident = 0;
-		initializer->visit(*this);
+		visit(initializer);
 		ident = currentIdent;
 	}
 	output << ";\n";
 }
-void CTranspilerGenerator::visitWhileStatement(const ast::While &value) {
-	auto identTab = currentIdent();
-	output << std::format("{}while (", identTab);
+void CTranspilerGenerator::visitWhileStatement(const ast::flat::While &value) {
+	output.indent(ident);
+	output << "while (";
 	auto currentIdent = ident;
 	ident = 0;
-	value.condition->visit(*this);
+	visit(value.condition);
 	ident = currentIdent;
 	output << ") {\n";
 	ident++;
-	value.body->visit(*this);
+	visit(value.body);
 	ident--;
-	output << std::format("{}}}\n", identTab);
+	output.indent(ident);
+	output << "}\n";
 }
-void CTranspilerGenerator::visitStructStatement(const ast::Struct &value) {
+void CTranspilerGenerator::visitStructStatement(
+    const ast::flat::Struct &value) {
+	TraceRecorder::Span span("declaration", "emit struct",
+	                         token(value.name).lexeme);
 	std::string currentModule;
 	std::optional<directive::LinkageDirective> linkageDirective;
 
@@ -310,18 +366,18 @@ void CTranspilerGenerator::visitStructStatement(const ast::Struct &value) {
 	// implemented
 	return;
 	const std::string mangledStructName =
-	    nameMangler.mangleStruct(currentModule, value, linkageDirective);
+	    nameMangler.mangleStruct(currentModule, token(value.name).lexeme,
+	                             linkageDirective);
 
 	// we just ignore any struct declaration
 	// as they were declared before
 	if (!value.declaration) {
 
-		output << std::format("{}typedef struct {}", currentIdent(),
-		                      mangledStructName);
-		output << " {\n";
+		output.indent(ident);
+		output.format("typedef struct {} {{\n", mangledStructName);
 		ident++;
-		for (auto &member : value.members) {
-			member.visit(*this);
+		for (auto member : tree().range(value.members)) {
+			visit(member);
 		}
 		if (value.members.empty()) {
 			// make a char field so on both C and C++ holds 1 byte
@@ -329,17 +385,17 @@ void CTranspilerGenerator::visitStructStatement(const ast::Struct &value) {
 			// and its fields should not be accesible
 			// TODO: make a method in the mangler to create reserved
 			// variable/member names
-			output << std::format("{}const u8 _rayREmptyStruct__;\n",
-			                      currentIdent());
+			output.indent(ident);
+			output << "const u8 _rayREmptyStruct__;\n";
 		}
 		ident--;
-		output << std::format("{}}}", currentIdent());
-		output << std::format(" {};\n", mangledStructName);
+		output.indent(ident);
+		output.format("}} {};\n", mangledStructName);
 	}
 }
 void CTranspilerGenerator::visitCompDirectiveStatement(
-    const ast::CompDirective &compDirective) {
-	auto directiveName = compDirective.name.getLexeme();
+    const ast::flat::CompDirective &compDirective) {
+	auto directiveName = token(compDirective.name).getLexeme();
 	if (directiveName == "Linkage") {
 		auto &attributes = compDirective.values;
 		auto directive = directive::LinkageDirective(
@@ -353,61 +409,61 @@ void CTranspilerGenerator::visitCompDirectiveStatement(
 		              ? directive::LinkageDirective::ManglingType::C
 		              : directive::LinkageDirective::ManglingType::Unknonw
 		        : directive::LinkageDirective::ManglingType::Default,
-		    compDirective.getToken());
+		    token(compDirective.token));
 		if (compDirective.child) {
-			auto childValue = compDirective.child.get();
-			if (dynamic_cast<ast::Function *>(childValue) ||
-			    dynamic_cast<ast::Struct *>(childValue)) {
+			auto childKind = tree().kind(compDirective.child);
+			if (childKind == ast::flat::NodeKind::Function ||
+			    childKind == ast::flat::NodeKind::Struct) {
 				size_t startDirectives = directivesStack.size();
 				size_t originalTop = top + 1;
 				top = startDirectives;
 				directivesStack.push_back(
 				    std::make_unique<directive::LinkageDirective>(directive));
-				compDirective.child->visit(*this);
+				visit(compDirective.child);
 				if (directivesStack.size() != startDirectives) {
-					messageBag.bug(childValue->getToken(),
+					messageBag.bug(getToken(compDirective.child),
 					               "unprocessed compiler directives");
 				}
 				top = originalTop;
 			} else {
 				messageBag.error(
-				    childValue->getToken(),
+				    getToken(compDirective.child),
 				    std::format(
 				        "{} child expression must be a function or a struct.",
 				        directive.directiveName()));
 			}
 		} else {
-			messageBag.error(compDirective.getToken(),
+			messageBag.error(token(compDirective.token),
 			                 std::format("{} must have a child expression.",
 			                             directive.directiveName()));
 		}
 	} else {
 		messageBag.error(
-		    compDirective.getToken(),
+		    token(compDirective.token),
 		    std::format("Unknown compiler directive '{}'.", directiveName));
 	}
 }
 // Expression
 void CTranspilerGenerator::visitVariableExpression(
-    const ast::Variable &variable) {
-	output << std::format("{}", variable.name.lexeme);
+    const ast::flat::Variable &variable) {
+	output << token(variable.name).lexeme;
 }
 void CTranspilerGenerator::visitIntrinsicExpression(
-    const ast::Intrinsic &intrinsic) {
-	messageBag.error(intrinsic.name,
+    const ast::flat::Intrinsic &intrinsic) {
+	messageBag.error(token(intrinsic.name),
 	                 "visitIntrinsicExpression not implemented");
 }
-void CTranspilerGenerator::visitAssignExpression(const ast::Assign &value) {
-	value.lhs->visit(*this);
-	output << std::format(" {} ", value.assignmentOp.getGlyph());
-	value.rhs->visit(*this);
+void CTranspilerGenerator::visitAssignExpression(
+    const ast::flat::Assign &value) {
+	visit(value.lhs);
+	output << ' ' << token(value.assignmentOp).getGlyph() << ' ';
+	visit(value.rhs);
 }
 void CTranspilerGenerator::visitBinaryExpression(
-    const ast::Binary &binaryExpression) {
-	std::string identTab = currentIdent();
-	binaryExpression.left->visit(*this);
+    const ast::flat::Binary &binaryExpression) {
+	visit(binaryExpression.left);
 
-	auto op = binaryExpression.op;
+	auto op = token(binaryExpression.op);
 	switch (op.type) {
 	case Token::TokenType::TOKEN_PLUS:
 	case Token::TokenType::TOKEN_MINUS:
@@ -425,102 +481,138 @@ void CTranspilerGenerator::visitBinaryExpression(
 	case Token::TokenType::TOKEN_GREAT:
 	case Token::TokenType::TOKEN_LESS_EQUAL:
 	case Token::TokenType::TOKEN_GREAT_EQUAL:
-		output << std::format(" {} ", op.getGlyph());
+		output << ' ' << op.getGlyph() << ' ';
 		break;
 	default:
-		messageBag.error(binaryExpression.op,
+		messageBag.error(op,
 		                 std::format("'{}' is not a supported binary operation",
 		                             op.getLexeme()));
 	}
 
-	binaryExpression.right->visit(*this);
+	visit(binaryExpression.right);
 }
-void CTranspilerGenerator::visitCallExpression(const ast::Call &callable) {
+void CTranspilerGenerator::visitCallExpression(
+    const ast::flat::Call &callable) {
 	// check if the callable contains a function
-	if (ast::Variable *var =
-	        dynamic_cast<ast::Variable *>(callable.callee.get())) {
+	if (const auto *var =
+	        tree().tryGet<ast::flat::Variable>(callable.callee)) {
+		const Token &name = token(var->name);
 		std::string callableName =
-		    findCallableName(callable, var->name.getLexeme());
+		    findCallableName(callable, name.getLexeme(), currentSourceUnit);
 		if (callableName.empty()) {
-			messageBag.error(var->name, std::format("undefined symbol '{}'",
-			                                        var->name.lexeme));
-			callableName = var->name.lexeme;
+			messageBag.error(name, std::format("undefined symbol '{}'",
+			                                   name.lexeme));
+			callableName = name.lexeme;
 		}
-		output << std::format("{}(", callableName);
-
-		for (size_t index = 0; index < callable.arguments.size(); ++index) {
-			auto const &argument = callable.arguments[index];
-			auto currentIdent = ident;
-			ident = 0;
-			argument->visit(*this);
-			ident = currentIdent;
-			if (index < callable.arguments.size() - 1) {
-				output << ", ";
-			}
+		output << callableName;
+	} else if (const auto *get =
+	               tree().tryGet<ast::flat::Get>(callable.callee);
+	           get != nullptr && findModule(get->object).has_value()) {
+		// the checker only lets public functions of the module through
+		const Token &name = token(get->name);
+		const auto &module =
+		    moduleStore.get().getModule(*findModule(get->object));
+		std::string callableName =
+		    findCallableName(callable, name.getLexeme(), module.sourceUnit);
+		if (callableName.empty()) {
+			messageBag.error(name, std::format("undefined symbol '{}'",
+			                                   name.lexeme));
+			callableName = name.lexeme;
 		}
-		output << ")";
+		output << callableName;
 	} else {
-		messageBag.error(callable.callee->getToken(),
+		messageBag.error(getToken(callable.callee),
 		                 std::format("'{}' is not a supported callable type",
-		                             callable.callee.get()->variantName()));
+		                             tree().variantName(callable.callee)));
+		return;
 	}
+
+	output << '(';
+	auto arguments = tree().range(callable.arguments);
+	for (size_t index = 0; index < arguments.size(); ++index) {
+		auto currentIdent = ident;
+		ident = 0;
+		visit(arguments[index]);
+		ident = currentIdent;
+		if (index < arguments.size() - 1) {
+			output << ", ";
+		}
+	}
+	output << ")";
 }
 void CTranspilerGenerator::visitIntrinsicCallExpression(
-    const ast::IntrinsicCall &value) {
+    const ast::flat::IntrinsicCall &value) {
 
-	switch (value.callee->intrinsic) {
+	const auto &callee = tree().get<ast::flat::Intrinsic>(value.callee);
+	switch (callee.intrinsic) {
 	case ray::compiler::ast::IntrinsicType::INTR_SIZEOF: {
 		if (value.arguments.size() != 1) {
-			messageBag.error(value.callee->name,
+			messageBag.error(token(callee.name),
 			                 std::format("@sizeOf intrinsic expects 1 "
 			                             "argument but {} got provided",
 			                             value.arguments.size()));
 		} else {
-			auto param = value.arguments[0].get();
+			auto param = tree().range(value.arguments)[0];
 			if (auto type = getTypeExpression(param)) {
-				output << std::format("((ssize){})", type->calculatedSize);
+				output.format("((ssize){})", type->calculatedSize);
 			} else {
-				messageBag.error(value.callee->name,
+				messageBag.error(token(callee.name),
 				                 std::format("'{}' is not a Type expression",
-				                             param->variantName()));
+				                             tree().variantName(param)));
 			}
 		}
 		break;
 	}
 	case ray::compiler::ast::IntrinsicType::INTR_IMPORT: {
 		messageBag.error(
-		    value.callee->name,
+		    token(callee.name),
 		    std::format("'{}' is not implemented yet for C backend",
-		                value.callee->name.lexeme));
+		                token(callee.name).lexeme));
 		break;
 	}
 	case ray::compiler::ast::IntrinsicType::INTR_UNKNOWN:
-		messageBag.error(value.callee->name,
+		messageBag.error(token(callee.name),
 		                 std::format("'{}' is not a valid intrinsic",
-		                             value.callee->name.lexeme));
+		                             token(callee.name).lexeme));
 		break;
 	}
 }
-void CTranspilerGenerator::visitGetExpression(const ast::Get &value) {
-	value.object->visit(*this);
-	output << std::format(".{}", value.name.lexeme);
+void CTranspilerGenerator::visitGetExpression(const ast::flat::Get &value) {
+	// a function of a module used as a value, the checker only lets it
+	// through when it is not overloaded
+	if (auto moduleId = findModule(value.object)) {
+		const auto &sourceUnit =
+		    moduleStore.get().getModule(*moduleId).sourceUnit;
+		for (const auto &function :
+		     sourceUnit.findFunctionDeclarations(token(value.name).lexeme)) {
+			output << function.getObject()->get().mangledName.str();
+			return;
+		}
+		messageBag.error(token(value.name),
+		                 std::format("undefined symbol '{}'",
+		                             token(value.name).lexeme));
+		return;
+	}
+	visit(value.object);
+	output << '.' << token(value.name).lexeme;
 }
 void CTranspilerGenerator::visitGroupingExpression(
-    const ast::Grouping &grouping) {
-	grouping.expression->visit(*this);
+    const ast::flat::Grouping &grouping) {
+	visit(grouping.expression);
 }
-void CTranspilerGenerator::visitLiteralExpression(const ast::Literal &literal) {
-	switch (literal.kind.type) {
+void CTranspilerGenerator::visitLiteralExpression(
+    const ast::flat::Literal &literal) {
+	switch (token(literal.kind).type) {
 	case Token::TokenType::TOKEN_TRUE:
 	case Token::TokenType::TOKEN_FALSE:
-		output << std::format(
-		    "{}", literal.kind.type == Token::TokenType::TOKEN_TRUE ? "true"
-		                                                            : "false");
+		output << (token(literal.kind).type == Token::TokenType::TOKEN_TRUE
+		               ? "true"
+		               : "false");
 		break;
 	case Token::TokenType::TOKEN_STRING: {
 		output << "(const u8[]){";
 		for (const char c : literal.value) {
-			output << std::format("0x{:02X}, ", c);
+			output.format("0x{:02X}, ", c);
 		}
 		output << "0x00}";
 		// comment string literal
@@ -586,67 +678,68 @@ void CTranspilerGenerator::visitLiteralExpression(const ast::Literal &literal) {
 
 		// read until no more digits found
 		value = value.substr(0, end_pos);
-		output << std::format("{}", value);
+		output << value;
 		break;
 	}
 	case Token::TokenType::TOKEN_CHAR: {
-		output << std::format("(const u8){{0x{:02X}}}", literal.value[0]);
+		output.format("(const u8){{0x{:02X}}}", literal.value[0]);
 		break;
 	}
 	default:
 		messageBag.error(
-		    literal.token,
+		    token(literal.token),
 		    std::format("'{}' ({}) is not a supported literal type",
-		                literal.kind.getLexeme(), literal.kind.getGlyph()));
+		                token(literal.kind).getLexeme(),
+		                token(literal.kind).getGlyph()));
 		break;
 	}
 }
 void CTranspilerGenerator::visitLogicalExpression(
-    const ast::Logical &logicalExpr) {
+    const ast::flat::Logical &logicalExpr) {
 	output << "(bool)(";
-	logicalExpr.left->visit(*this);
-	output << std::format(" {} ", logicalExpr.op.getGlyph());
-	logicalExpr.right->visit(*this);
+	visit(logicalExpr.left);
+	output << ' ' << token(logicalExpr.op).getGlyph() << ' ';
+	visit(logicalExpr.right);
 	output << ")";
 }
-void CTranspilerGenerator::visitSetExpression(const ast::Set &value) {
-	value.object->visit(*this);
-	output << std::format(".{} {} ", value.name.lexeme,
-	                      value.assignmentOp.getGlyph());
-	value.value->visit(*this);
+void CTranspilerGenerator::visitSetExpression(const ast::flat::Set &value) {
+	visit(value.object);
+	output << '.' << token(value.name).lexeme << ' '
+	       << token(value.assignmentOp).getGlyph() << ' ';
+	visit(value.value);
 }
-void CTranspilerGenerator::visitUnaryExpression(const ast::Unary &unary) {
+void CTranspilerGenerator::visitUnaryExpression(const ast::flat::Unary &unary) {
 	if (!unary.isPrefix) {
-		unary.expr->visit(*this);
+		visit(unary.expr);
 	}
-	switch (unary.op.type) {
+	switch (token(unary.op).type) {
 	case Token::TokenType::TOKEN_BANG:
 	case Token::TokenType::TOKEN_MINUS:
 	case Token::TokenType::TOKEN_MINUS_MINUS:
 	case Token::TokenType::TOKEN_PLUS_PLUS:
-		output << std::format("{}", unary.op.getLexeme());
+		output << token(unary.op).getLexeme();
 		break;
 	default:
-		messageBag.error(unary.op,
+		messageBag.error(token(unary.op),
 		                 std::format("'{}' is not a supported unary operation",
-		                             unary.op.getLexeme()));
+		                             token(unary.op).getLexeme()));
 	}
 	if (unary.isPrefix) {
-		unary.expr->visit(*this);
+		visit(unary.expr);
 	}
 }
 void CTranspilerGenerator::visitArrayAccessExpression(
-    const ast::ArrayAccess &value) {
-	value.array->visit(*this);
+    const ast::flat::ArrayAccess &value) {
+	visit(value.array);
 	output << "[";
-	value.index->visit(*this);
+	visit(value.index);
 	output << "]";
 }
 void CTranspilerGenerator::visitArrayTypeExpression(
-    const ast::ArrayType &arrayTypeAst) {
+    const ast::flat::ArrayType &arrayTypeAst) {
 	// TODO: once array type holds its size in the AST provide 
 	// a check to transpile it to C
-	arrayTypeAst.subType->visit(*this);
+	visit(arrayTypeAst.subType);
 
 	output << "*";
 	if (!arrayTypeAst.isMutable) {
@@ -654,7 +747,7 @@ void CTranspilerGenerator::visitArrayTypeExpression(
 	}
 }
 void CTranspilerGenerator::visitTupleTypeExpression(
-    const ast::TupleType &tupleAst) {
+    const ast::flat::TupleType &tupleAst) {
 	if (!tupleAst.isMutable) {
 		output << "const ";
 	}
@@ -662,13 +755,13 @@ void CTranspilerGenerator::visitTupleTypeExpression(
 		output << "void";
 		return;
 	}
-	messageBag.error(tupleAst.getToken(),
+	messageBag.error(token(tupleAst.token),
 	                 std::format("{} not implemented", __PRETTY_FUNCTION__));
 }
 void CTranspilerGenerator::visitPointerTypeExpression(
-    const ast::PointerType &pointerTypeAst) {
+    const ast::flat::PointerType &pointerTypeAst) {
 
-	pointerTypeAst.subtype->visit(*this);
+	visit(pointerTypeAst.subtype);
 
 	output << "*";
 	if (!pointerTypeAst.isMutable) {
@@ -676,54 +769,81 @@ void CTranspilerGenerator::visitPointerTypeExpression(
 	}
 }
 void CTranspilerGenerator::visitNamedTypeExpression(
-    const ast::NamedType &type) {
-	if (!type.isMutable && type.name.lexeme != "void"
+    const ast::flat::NamedType &type) {
+	if (!type.isMutable && token(type.name).lexeme != "void"
 	    // && !type.isPointer // TODO: make this section use the type checker
 	    // instead
 	) {
 		output << "const ";
 	}
-	if (type.name.lexeme == "void") {
+	if (token(type.name).lexeme == "void") {
 		output << "void ";
 	} else {
 		// TODO: replace this to a typeID System
-		std::string typeName = findStructName(type.name.lexeme);
+		std::string typeName = findStructName(token(type.name).lexeme);
 		if (typeName.empty()) {
-			auto typeInfo = findTypeInfo(type.name.lexeme);
+			auto typeInfo = findTypeInfo(token(type.name).lexeme);
 			if (typeInfo.has_value()) {
-				typeName = typeInfo->name;
+				typeName = typeInfo->name.str();
 			} else {
 				messageBag.warning(
-				    type.getToken(),
+				    token(type.token),
 				    std::format("could not find mangled name for '{}'",
-				                type.name.lexeme));
+				                token(type.name).lexeme));
 			}
 		}
-		typeName = typeName.empty() ? type.name.lexeme : typeName;
-		output << std::format("{} ", typeName);
+		typeName = typeName.empty() ? token(type.name).lexeme : typeName;
+		output << typeName << ' ';
 	}
 }
-void CTranspilerGenerator::visitCastExpression(const ast::Cast &value) {
+void CTranspilerGenerator::visitCastExpression(const ast::flat::Cast &value) {
 	output << "(";
-	value.type->visit(*this);
+	visit(value.type);
 	output << ")(";
-	value.expression->visit(*this);
+	visit(value.expression);
 	output << ")";
 }
 void CTranspilerGenerator::visitParameterExpression(
-    const ast::Parameter &param) {
-	param.type->visit(*this);
-	output << std::format("{}", param.name.lexeme);
+    const ast::flat::Parameter &param) {
+	visit(param.type);
+	output << token(param.name).lexeme;
+}
+
+void CTranspilerGenerator::declareFunction(
+    const lang::FunctionDeclaration &functionDeclaration,
+    const lang::SourceUnit &sourceUnit) {
+	// main should be extern c++
+	if (functionDeclaration.mangledName.view() == "main") {
+		output << "RAY_DEFAULT_LINKAGE ";
+	}
+	if (!functionDeclaration.publicVisibility) {
+		output << "RAYLANG_MACRO_LINK_LOCAL ";
+		output << "static ";
+	}
+	visitType(functionDeclaration.signature.returnType, sourceUnit);
+
+	output.format(" {}(", functionDeclaration.mangledName);
+	for (size_t index = 0;
+	     index < functionDeclaration.signature.parameters.size(); ++index) {
+		const auto &parameter = functionDeclaration.signature.parameters[index];
+		visitType(parameter.parameterType, sourceUnit);
+		output << ' ' << parameter.name;
+		if (index < functionDeclaration.signature.parameters.size() - 1) {
+			output << ", ";
+		}
+	}
+	output << ");\n";
 }
 
-void CTranspilerGenerator::visitType(const lang::Type &type) {
+void CTranspilerGenerator::visitType(const lang::Type &type,
+                                     const lang::SourceUnit &sourceUnit) {
 	// all types except pointer have const before its type
 	if (!type.isMutable && type.getKind() != lang::TypeKind::pointer) {
 		output << "const ";
 	}
 	switch (type.getKind()) {
 	case lang::TypeKind::pointer: {
-		visitType(*type.subtype.value());
+		visitType(*type.subtype.value(), sourceUnit);
 		output << "*";
 		if (!type.isMutable) {
 			output << "const";
@@ -736,12 +856,11 @@ void CTranspilerGenerator::visitType(const lang::Type &type) {
 	}
 	case lang::TypeKind::aggregate: {
 		// see if the type is a struct and get its mangled name
-		if (currentSourceUnit.get().getStructs().contains(type.typeId)) {
+		if (sourceUnit.getStructs().contains(type.typeId)) {
 			const lang::Struct &structObj =
-			    currentSourceUnit.get().getStructs().at(type.typeId);
+			    sourceUnit.getStructs().at(type.typeId);
 			output << structObj.mangledName;
-		} else if (currentSourceUnit.get().getFunctions().contains(
-		               type.typeId)) {
+		} else if (sourceUnit.getFunctions().contains(type.typeId)) {
 
 			messageBag.bug(
 			    Token::makeEOFToken(),
@@ -767,42 +886,55 @@ void CTranspilerGenerator::visitType(const lang::Type &type) {
 }
 
 std::string
-CTranspilerGenerator::findCallableName(const ast::Call &callable,
-                                       const std::string_view name) const {
+CTranspilerGenerator::findCallableName(
+    const ast::flat::Call &callable, const std::string_view name,
+    const lang::SourceUnit &sourceUnit) const {
 	// TODO: replace this to a resolved lookup done by the type checker
 	// once the type checker performs the binding
 
-	std::string key(name);
-	const std::string functionName =
-	    currentScope.get()
-	        .findLocalFunctionDeclaration(name)
-	        .transform(
-	            [&callable](
-	                const std::vector<
-	                    util::soft_reference<lang::FunctionDeclaration>>
-	                    &functionDeclarations) -> std::optional<std::string> {
-		            for (const auto &function : functionDeclarations) {
-			            const auto &functionObject = function.getObject();
-			            if (functionObject->get().signature.parameters.size() ==
-			                callable.arguments.size()) {
-				            return functionObject->get().mangledName;
-			            }
-		            }
-		            return std::nullopt;
-	            })
-	        ->value_or(std::string());
-
-	return functionName;
+	for (const auto &function : sourceUnit.findFunctionDeclarations(name)) {
+		const auto &functionObject = function.getObject();
+		if (functionObject->get().signature.parameters.size() ==
+		    callable.arguments.size()) {
+			return functionObject->get().mangledName.str();
+		}
+	}
+
+	return std::string();
+}
+std::optional<lang::ModuleId>
+CTranspilerGenerator::findModule(ast::flat::NodeId expression) {
+	if (auto var = tree().tryGet<ast::flat::Variable>(expression)) {
+		auto variable = currentSourceUnit.get().findVariable(
+		    token(var->name).lexeme);
+		if (variable.has_value() &&
+		    variable->getObject()->get().innerType.isModule()) {
+			return static_cast<lang::ModuleId>(
+			    variable->getObject()->get().innerType.typeId);
+		}
+		return std::nullopt;
+	}
+	auto call = tree().tryGet<ast::flat::IntrinsicCall>(expression);
+	if (call == nullptr || call->arguments.size() != 1 ||
+	    tree().get<ast::flat::Intrinsic>(call->callee).intrinsic !=
+	        ast::IntrinsicType::INTR_IMPORT) {
+		return std::nullopt;
+	}
+	auto path =
+	    tree().tryGet<ast::flat::Literal>(tree().range(call->arguments)[0]);
+	if (path == nullptr) {
+		return std::nullopt;
+	}
+	return moduleStore.get().findModule(path->value, importer);
 }
 std::string
 CTranspilerGenerator::findStructName(const std::string_view name) const {
-	auto queriedStruct =
-	    currentSourceUnit.get().findStruct(name, currentScope.get());
+	auto queriedStruct = currentSourceUnit.get().findStruct(name);
 	if (queriedStruct.has_value()) {
 		return queriedStruct
 		    .transform(
 		        [](const auto structValue) -> std::optional<std::string> {
-			        return structValue.get().mangledName;
+			        return structValue.get().mangledName.str();
 		        })
 		    ->value_or(std::string());
 	}
@@ -823,15 +955,16 @@ CTranspilerGenerator::findTypeInfo(const std::string_view lexeme) {
 	return {};
 }
 std::optional<lang::Type>
-CTranspilerGenerator::getTypeExpression(const ast::Expression *expression) {
-	if (auto var = dynamic_cast<const ast::Variable *>(expression)) {
-		return findTypeInfo(var->name.lexeme);
+CTranspilerGenerator::getTypeExpression(ast::flat::NodeId expression) {
+	if (auto var = tree().tryGet<ast::flat::Variable>(expression)) {
+		return findTypeInfo(token(var->name).lexeme);
 	}
 	return {};
 }
 
 void CTranspilerGenerator::defineStruct(
-    std::unordered_set<size_t> &visitedStructs, const lang::Struct &structObj) {
+    std::unordered_set<size_t> &visitedStructs, const lang::Struct &structObj,
+    const lang::SourceUnit &sourceUnit) {
 	if (visitedStructs.contains(structObj.structID)) {
 		return;
 	}
@@ -847,25 +980,25 @@ void CTranspilerGenerator::defineStruct(
 
 	for (auto const &structMember : structObj.members) {
 		auto typeId = structMember.type.typeId;
-		if (currentSourceUnit.get().getStructs().contains(typeId)) {
+		if (sourceUnit.getStructs().contains(typeId)) {
 			const lang::Struct structDeclaration =
-			    currentSourceUnit.get().getStructs().at(typeId);
-			defineStruct(visitedStructs, structDeclaration);
+			    sourceUnit.getStructs().at(typeId);
+			defineStruct(visitedStructs, structDeclaration, sourceUnit);
 		}
 	}
 
 	// TODO: read compiler directives from type checker
 
-	output << std::format("typedef struct {} {{\n", structObj.mangledName);
+	output.format("typedef struct {} {{\n", structObj.mangledName);
 	for (auto const &structMember : structObj.members) {
-		output << std::format("\t");
-		visitType(structMember.type);
-		output << std::format(" {}; {}\n", structMember.name,
-		                      structMember.publicVisibility ? "//#private"
-		                                                    : "//#public");
+		output << '\t';
+		visitType(structMember.type, sourceUnit);
+		output.format(" {}; {}\n", structMember.name,
+		              structMember.publicVisibility ? "//#private"
+		                                            : "//#public");
 	}
 
-	output << std::format("}} {};\n", structObj.mangledName);
+	output.format("}} {};\n", structObj.mangledName);
 }
 
 } // namespace ray::compiler::generator::c
@@ -0,0 +1,417 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <msgpack.hpp>
+
+#include <ray/compiler/environment/dataModel/dataModel.hpp>
+#include <ray/compiler/lang/functionDefinition.hpp>
+#include <ray/compiler/lang/moduleInterface.hpp>
+#include <ray/compiler/lang/sourceUnit.hpp>
+#include <ray/compiler/lang/struct.hpp>
+#include <ray/compiler/lang/type.hpp>
+#include <ray/compiler/passes/symbol_mangler.hpp>
+#include <ray/util/atomic_file.hpp>
+#include <ray/util/msgpack_codec.hpp>
+
+#include "build_id.hpp"
+
+namespace ray::compiler::lang {
+
+namespace {
+
+constexpr std::string_view magic = "RAYI";
+
+using Reader = util::MsgpackReader;
+
+InternedString name(const msgpack::object &object) {
+	return InternedString(Reader::string(object));
+}
+
+// types are written once in a table and referenced by index, nested types
+// come before the types holding them so they can be read in a single pass
+class TypeIndexer {
+	std::vector<TypeRef> order;
+	std::unordered_map<TypeRef, uint32_t> indices;
+
+  public:
+	uint32_t add(TypeRef type) {
+		if (auto it = indices.find(type); it != indices.end()) {
+			return it->second;
+		}
+		if (type->subtype) {
+			add(*type->subtype);
+		}
+		if (type->signature) {
+			for (const auto &param : *type->signature) {
+				add(param);
+			}
+		}
+		auto index = static_cast<uint32_t>(order.size());
+		order.push_back(type);
+		indices.emplace(type, index);
+		return index;
+	}
+	uint32_t indexOf(TypeRef type) const { return indices.at(type); }
+	const std::vector<TypeRef> &types() const { return order; }
+};
+
+// reads the type table, nested types are interned as soon as they are read
+class TypeReader {
+	std::vector<Type> types;
+
+  public:
+	const Type &type(const msgpack::object &object) const {
+		auto index = Reader::number(object);
+		if (index >= types.size()) {
+			throw msgpack::type_error();
+		}
+		return types[index];
+	}
+
+	void readType(const msgpack::object &object) {
+		auto fields = Reader::array(object, 10);
+		auto kind = Reader::number(fields[2]);
+		if (kind > static_cast<uint64_t>(TypeKind::abstract)) {
+			throw msgpack::type_error();
+		}
+		std::optional<TypeRef> subtype;
+		if (!fields[8].is_nil()) {
+			subtype = type(fields[8]);
+		}
+		std::optional<std::vector<TypeRef>> signature;
+		if (!fields[9].is_nil()) {
+			signature.emplace();
+			for (const auto &param : Reader::array(fields[9])) {
+				signature->push_back(type(param));
+			}
+		}
+		types.emplace_back(
+		    Reader::number(fields[0]), Reader::boolean(fields[1]),
+		    static_cast<TypeKind>(kind), name(fields[3]),
+		    Reader::number(fields[4]), Reader::boolean(fields[5]),
+		    Reader::boolean(fields[6]), Reader::boolean(fields[7]), subtype,
+		    signature);
+	}
+};
+
+// struct types refer to the struct by the id it has in its unit
+Type remapStructIds(Type type,
+                    const std::unordered_map<size_t, size_t> &structIds) {
+	if (type.getKind() == TypeKind::aggregate) {
+		if (auto it = structIds.find(type.typeId); it != structIds.end()) {
+			type.typeId = it->second;
+		}
+	}
+	if (type.subtype) {
+		type.subtype = remapStructIds(**type.subtype, structIds);
+	}
+	if (type.signature) {
+		for (auto &param : *type.signature) {
+			param = remapStructIds(*param, structIds);
+		}
+	}
+	return type;
+}
+
+} // namespace
+
+uint64_t hashSource(std::string_view contents) {
+	uint64_t hash = 0xcbf29ce484222325;
+	for (const char c : contents) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+ModuleInterface ModuleInterface::fromSourceUnit(const SourceUnit &sourceUnit,
+                                                uint64_t contentHash,
+                                                std::vector<Import> imports) {
+	ModuleInterface result{.contentHash = contentHash,
+	                       .imports = std::move(imports)};
+	for (const auto &[id, structObj] : sourceUnit.getStructs()) {
+		result.structs.push_back(structObj);
+	}
+	for (const auto &[id, function] : sourceUnit.getFunctions()) {
+		if (function.publicVisibility) {
+			result.functions.push_back(function);
+		}
+	}
+	std::ranges::sort(result.structs, {}, &Struct::structID);
+	std::ranges::sort(result.functions, {}, &FunctionDeclaration::functionID);
+
+	// structs are numbered by their position so private declarations added
+	// or removed elsewhere in the module do not change the interface
+	std::unordered_map<size_t, size_t> structIds;
+	for (auto &structObj : result.structs) {
+		structIds.emplace(structObj.structID, structIds.size() + 1);
+		structObj.structID = structIds.size();
+	}
+	for (auto &structObj : result.structs) {
+		for (auto &member : structObj.members) {
+			member.type = remapStructIds(member.type, structIds);
+		}
+	}
+	for (auto &function : result.functions) {
+		function.functionID = 0;
+		auto &signature = function.signature;
+		signature.returnType = remapStructIds(signature.returnType, structIds);
+		for (auto &param : signature.parameters) {
+			param.parameterType =
+			    remapStructIds(param.parameterType, structIds);
+		}
+	}
+	return result;
+}
+
+uint64_t ModuleInterface::declarationsHash(
+    const environment::DataModel &dataModel) const {
+	ModuleInterface declarations{.structs = structs, .functions = functions};
+	return hashSource(declarations.serialize(dataModel));
+}
+
+void ModuleInterface::declareInto(SourceUnit &sourceUnit) const {
+	auto &rootScope = sourceUnit.getRootScope();
+	std::unordered_map<size_t, size_t> structIds;
+	// declared opaque first so members can refer to any of them
+	for (const auto &structObj : structs) {
+		Struct declaration{.opaque = true,
+		                   .structID = 0,
+		                   .name = structObj.name,
+		                   .mangledName = structObj.mangledName,
+		                   .members = {}};
+		if (!sourceUnit.declareStruct(declaration, rootScope)) {
+			continue;
+		}
+		auto declared = rootScope.findLocalStruct(structObj.name);
+		structIds.emplace(structObj.structID, declared->getObjectId());
+	}
+	for (const auto &structObj : structs) {
+		auto declared = rootScope.findLocalStruct(structObj.name);
+		if (!declared) {
+			continue;
+		}
+		Struct &target = declared->getObject()->get();
+		target.opaque = structObj.opaque;
+		target.members = structObj.members;
+		for (auto &member : target.members) {
+			member.type = remapStructIds(member.type, structIds);
+		}
+	}
+	for (auto function : functions) {
+		auto &signature = function.signature;
+		signature.returnType =
+		    remapStructIds(signature.returnType, structIds);
+		for (auto &param : signature.parameters) {
+			param.parameterType =
+			    remapStructIds(param.parameterType, structIds);
+		}
+		// overloads with the same signature were rejected by the exporter
+		(void)sourceUnit.declareFunction(function, rootScope);
+	}
+}
+
+std::string
+ModuleInterface::serialize(const environment::DataModel &dataModel) const {
+	TypeIndexer typeIndexer;
+	for (const auto &structObj : structs) {
+		for (const auto &member : structObj.members) {
+			typeIndexer.add(member.type);
+		}
+	}
+	for (const auto &function : functions) {
+		typeIndexer.add(function.signature.returnType);
+		for (const auto &param : function.signature.parameters) {
+			typeIndexer.add(param.parameterType);
+		}
+	}
+
+	util::MsgpackWriter writer;
+	writer.array(8);
+	writer.string(magic);
+	writer.number(formatVersion);
+	writer.number(configurationHash(dataModel));
+	writer.number(contentHash);
+
+	writer.array(imports.size());
+	for (const auto &import : imports) {
+		writer.array(3);
+		writer.string(import.path);
+		writer.number(import.line);
+		writer.number(import.column);
+	}
+
+	writer.array(typeIndexer.types().size());
+	for (const auto typeRef : typeIndexer.types()) {
+		const Type &type = *typeRef;
+		writer.array(10);
+		writer.number(type.typeId);
+		writer.boolean(type.isInitialized());
+		writer.number(static_cast<uint64_t>(type.getKind()));
+		writer.string(type.name.view());
+		writer.number(type.calculatedSize);
+		writer.boolean(type.isMutable);
+		writer.boolean(type.signedType);
+		writer.boolean(type.overloaded);
+		if (type.subtype) {
+			writer.number(typeIndexer.indexOf(*type.subtype));
+		} else {
+			writer.nil();
+		}
+		if (type.signature) {
+			writer.array(type.signature->size());
+			for (const auto &param : *type.signature) {
+				writer.number(typeIndexer.indexOf(param));
+			}
+		} else {
+			writer.nil();
+		}
+	}
+
+	writer.array(structs.size());
+	for (const auto &structObj : structs) {
+		writer.array(5);
+		writer.number(structObj.structID);
+		writer.boolean(structObj.opaque);
+		writer.string(structObj.name.view());
+		writer.string(structObj.mangledName.view());
+		writer.array(structObj.members.size());
+		for (const auto &member : structObj.members) {
+			writer.array(4);
+			writer.boolean(member.publicVisibility);
+			writer.boolean(member.isMutable);
+			writer.string(member.name.view());
+			writer.number(typeIndexer.indexOf(member.type));
+		}
+	}
+
+	writer.array(functions.size());
+	for (const auto &function : functions) {
+		writer.array(5);
+		writer.string(function.name.view());
+		writer.string(function.mangledName.view());
+		writer.boolean(function.publicVisibility);
+		writer.number(typeIndexer.indexOf(function.signature.returnType));
+		writer.array(function.signature.parameters.size());
+		for (const auto &param : function.signature.parameters) {
+			writer.array(2);
+			writer.string(param.name.view());
+			writer.number(typeIndexer.indexOf(param.parameterType));
+		}
+	}
+	return writer.data();
+}
+
+std::optional<ModuleInterface>
+ModuleInterface::deserialize(std::string_view data,
+                             const environment::DataModel &dataModel) {
+	try {
+		auto handle = msgpack::unpack(data.data(), data.size());
+		auto root = Reader::array(handle.get(), 8);
+		if (Reader::string(root[0]) != magic ||
+		    Reader::number(root[1]) != formatVersion ||
+		    Reader::number(root[2]) != configurationHash(dataModel)) {
+			return std::nullopt;
+		}
+		ModuleInterface result{.contentHash = Reader::number(root[3])};
+
+		for (const auto &object : Reader::array(root[4])) {
+			auto fields = Reader::array(object, 3);
+			result.imports.push_back({.path = Reader::string(fields[0]),
+			                          .line = Reader::number(fields[1]),
+			                          .column = Reader::number(fields[2])});
+		}
+
+		TypeReader typeReader;
+		for (const auto &object : Reader::array(root[5])) {
+			typeReader.readType(object);
+		}
+
+		for (const auto &object : Reader::array(root[6])) {
+			auto fields = Reader::array(object, 5);
+			Struct structObj{.opaque = Reader::boolean(fields[1]),
+			                 .structID = Reader::number(fields[0]),
+			                 .name = name(fields[2]),
+			                 .mangledName = name(fields[3]),
+			                 .members = {}};
+			for (const auto &memberObject : Reader::array(fields[4])) {
+				auto member = Reader::array(memberObject, 4);
+				structObj.members.push_back(
+				    {.publicVisibility = Reader::boolean(member[0]),
+				     .isMutable = Reader::boolean(member[1]),
+				     .name = name(member[2]),
+				     .type = typeReader.type(member[3])});
+			}
+			result.structs.push_back(std::move(structObj));
+		}
+
+		for (const auto &object : Reader::array(root[7])) {
+			auto fields = Reader::array(object, 5);
+			FunctionDeclaration function{
+			    .functionID = 0,
+			    .name = name(fields[0]),
+			    .mangledName = name(fields[1]),
+			    .publicVisibility = Reader::boolean(fields[2]),
+			    .signature = {.returnType = typeReader.type(fields[3]),
+			                  .parameters = {}},
+			};
+			for (const auto &paramObject : Reader::array(fields[4])) {
+				auto param = Reader::array(paramObject, 2);
+				function.signature.parameters.push_back(
+				    {.name = name(param[0]),
+				     .parameterType = typeReader.type(param[1])});
+			}
+			result.functions.push_back(std::move(function));
+		}
+		return result;
+	} catch (const std::exception &) {
+		// truncated or foreign files are treated as a missing interface
+		return std::nullopt;
+	}
+}
+
+uint64_t
+ModuleInterface::configurationHash(const environment::DataModel &dataModel) {
+	return hashSource(std::format(
+	    "{}|{}|{}|{}|{},{},{},{},{},{}", RAYC_VERSION, RAYC_BUILD_ID,
+	    formatVersion, passes::mangling::NameMangler::manglerVersion,
+	    dataModel.charSize, dataModel.shortIntSize, dataModel.intSize,
+	    dataModel.longIntSize, dataModel.longLongSize, dataModel.pointerSize));
+}
+
+std::filesystem::path
+ModuleInterface::pathFor(const std::filesystem::path &directory,
+                         const std::filesystem::path &source,
+                         uint64_t contentHash,
+                         const environment::DataModel &dataModel) {
+	return directory / std::format("{}-{:016x}-{:016x}.rayi",
+	                               source.stem().string(), contentHash,
+	                               configurationHash(dataModel));
+}
+
+std::optional<ModuleInterface>
+ModuleInterface::read(const std::filesystem::path &path,
+                      const environment::DataModel &dataModel) {
+	auto data = util::readFile(path);
+	if (!data) {
+		return std::nullopt;
+	}
+	return deserialize(*data, dataModel);
+}
+
+bool ModuleInterface::write(const std::filesystem::path &path,
+                            const environment::DataModel &dataModel) const {
+	return util::writeFileAtomically(path, serialize(dataModel));
+}
+
+} // namespace ray::compiler::lang
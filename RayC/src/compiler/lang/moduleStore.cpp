@@ -0,0 +1,398 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <ray/cli/terminal.hpp>
+#include <ray/compiler/ast/arena.hpp>
+#include <ray/compiler/ast/flat.hpp>
+#include <ray/compiler/ast/flatBuilder.hpp>
+#include <ray/compiler/ast/intrinsic.hpp>
+#include <ray/compiler/lang/moduleInterface.hpp>
+#include <ray/compiler/lang/moduleStore.hpp>
+#include <ray/compiler/lexer/lexer.hpp>
+#include <ray/compiler/lexer/token.hpp>
+#include <ray/compiler/lexer/token_stream.hpp>
+#include <ray/compiler/message_bag.hpp>
+#include <ray/compiler/parser/parser.hpp>
+#include <ray/compiler/passes/typeChecker.hpp>
+#include <ray/compiler/passes/typeScanner.hpp>
+#include <ray/compiler/source_buffer.hpp>
+#include <ray/compiler/trace.hpp>
+
+namespace ray::compiler::lang {
+using namespace ray::compiler::terminal::literals;
+
+namespace {
+
+// the same file reached through different relative paths maps to one key
+std::string canonicalKey(const std::filesystem::path &path) {
+	std::error_code error;
+	auto canonicalPath = std::filesystem::weakly_canonical(path, error);
+	return (error ? path.lexically_normal() : canonicalPath).string();
+}
+
+} // namespace
+
+void ModuleStore::addPackage(std::string name, std::filesystem::path root) {
+	packages.insert_or_assign(std::move(name), std::move(root));
+}
+
+void ModuleStore::setInterfaceDirectory(std::filesystem::path directory) {
+	interfaceDirectory = std::move(directory);
+}
+
+std::optional<std::filesystem::path>
+ModuleStore::resolvePath(std::string_view importPath,
+                         const std::filesystem::path &importer) const {
+	auto separator = importPath.find(':');
+	if (separator == std::string_view::npos) {
+		return importer.parent_path() / importPath;
+	}
+	auto package = packages.find(std::string(importPath.substr(0, separator)));
+	if (package == packages.end()) {
+		return std::nullopt;
+	}
+	return package->second / importPath.substr(separator + 1);
+}
+
+bool ModuleStore::loadImports(const ast::flat::Tree &tree,
+                              const std::filesystem::path &importer) {
+	return loadImports(collectImports(tree), importer);
+}
+
+bool ModuleStore::loadImports(const std::vector<Import> &imports,
+                              const std::filesystem::path &importer) {
+	size_t previousErrors = errors.size();
+	loadingPaths.push_back(canonicalKey(importer));
+	bool relocatable = true;
+	auto dependencies = loadImportList(imports, importer, relocatable);
+	loadingPaths.pop_back();
+	// a module that failed for an earlier unit does not report its errors
+	// again, the unit still fails when it depends on it
+	return errors.size() == previousErrors && !dependsOnFailed(dependencies);
+}
+
+std::optional<ModuleId>
+ModuleStore::findModule(std::string_view importPath,
+                        const std::filesystem::path &importer) const {
+	auto path = resolvePath(importPath, importer);
+	if (!path) {
+		return std::nullopt;
+	}
+	auto it = pathIds.find(canonicalKey(*path));
+	if (it == pathIds.end()) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+std::vector<ModuleId> ModuleStore::topologicalOrder() const {
+	std::vector<ModuleId> order;
+	order.reserve(modules.size());
+	std::vector<bool> visited(modules.size(), false);
+	// module and index of the next dependency to visit
+	std::vector<std::pair<ModuleId, size_t>> stack;
+	for (ModuleId root = 0; root < modules.size(); root++) {
+		if (visited[root]) {
+			continue;
+		}
+		visited[root] = true;
+		stack.push_back({root, 0});
+		while (!stack.empty()) {
+			auto &[id, next] = stack.back();
+			const auto &dependencies = modules[id]->dependencies;
+			if (next < dependencies.size()) {
+				ModuleId dependency = dependencies[next++];
+				if (!visited[dependency]) {
+					visited[dependency] = true;
+					stack.push_back({dependency, 0});
+				}
+				continue;
+			}
+			order.push_back(id);
+			stack.pop_back();
+		}
+	}
+	return order;
+}
+
+bool ModuleStore::dependsOnFailed(
+    const std::vector<ModuleId> &dependencies) const {
+	std::vector<bool> visited(modules.size(), false);
+	std::vector<ModuleId> stack(dependencies.begin(), dependencies.end());
+	while (!stack.empty()) {
+		ModuleId id = stack.back();
+		stack.pop_back();
+		if (visited[id]) {
+			continue;
+		}
+		visited[id] = true;
+		if (modules[id]->failed) {
+			return true;
+		}
+		stack.insert(stack.end(), modules[id]->dependencies.begin(),
+		             modules[id]->dependencies.end());
+	}
+	return false;
+}
+
+void ModuleStore::refresh() {
+	// modules forgotten by an earlier refresh are no longer reachable by path
+	std::vector<bool> forgotten(modules.size(), true);
+	for (const auto &[key, id] : pathIds) {
+		forgotten[id] = false;
+	}
+	std::vector<bool> stale(modules.size(), false);
+	// dependencies come first so staleness reaches every importer
+	for (ModuleId id : topologicalOrder()) {
+		Module &module = *modules[id];
+		bool dependencyChanged =
+		    std::ranges::any_of(module.dependencies, [&](ModuleId dependency) {
+			    return stale[dependency];
+		    });
+		if (forgotten[id] || module.failed || dependencyChanged) {
+			stale[id] = true;
+			continue;
+		}
+		auto source = SourceBuffer::open(module.path);
+		stale[id] = !source || hashSource(source->view()) != module.contentHash;
+	}
+	auto isStale = [&](const auto &entry) { return stale[entry.second]; };
+	std::erase_if(pathIds, isStale);
+	std::erase_if(contentIds, isStale);
+	for (ModuleId id = 0; id < modules.size(); id++) {
+		if (stale[id] && !forgotten[id]) {
+			// the id stays taken, only the parsed contents are released
+			modules[id]->lexer.reset();
+			modules[id]->tree = {};
+			modules[id]->source.reset();
+		}
+	}
+	errors.clear();
+}
+
+std::vector<ModuleStore::Import>
+ModuleStore::collectImports(const ast::flat::Tree &tree) {
+	std::vector<Import> imports;
+	for (uint32_t index = 0; index < tree.size(); index++) {
+		const auto *call =
+		    tree.tryGet<ast::flat::IntrinsicCall>(ast::flat::NodeId{index});
+		if (call == nullptr || call->arguments.size() != 1) {
+			continue;
+		}
+		const auto *callee = tree.tryGet<ast::flat::Intrinsic>(call->callee);
+		if (callee == nullptr ||
+		    callee->intrinsic != ast::IntrinsicType::INTR_IMPORT) {
+			continue;
+		}
+		// the type checker reports imports that are not a literal path
+		const auto *path =
+		    tree.tryGet<ast::flat::Literal>(tree.range(call->arguments)[0]);
+		if (path == nullptr ||
+		    tree.token(path->kind).type != Token::TokenType::TOKEN_STRING) {
+			continue;
+		}
+		imports.push_back({.path = std::string(path->value),
+		                   .token = tree.token(callee->name)});
+	}
+	return imports;
+}
+
+std::vector<ModuleId>
+ModuleStore::loadImportList(const std::vector<Import> &imports,
+                            const std::filesystem::path &importer,
+                            bool &relocatable) {
+	MessageBag messageBag("MODULE-LOADER", importer.string());
+	std::vector<ModuleId> dependencies;
+	for (const auto &import : imports) {
+		const Token &importToken = import.token;
+		if (import.path.find(':') == std::string_view::npos) {
+			relocatable = false;
+		}
+		auto path = resolvePath(import.path, importer);
+		if (!path) {
+			messageBag.error(importToken,
+			                 std::format("unknown package in import '{}'",
+			                             import.path));
+			continue;
+		}
+
+		auto key = canonicalKey(*path);
+		auto cycleStart = std::ranges::find(loadingPaths, key);
+		if (cycleStart != loadingPaths.end()) {
+			std::string cycle;
+			for (auto it = cycleStart; it != loadingPaths.end(); ++it) {
+				cycle += std::format("{} -> ", *it);
+			}
+			cycle += key;
+			messageBag.error(importToken,
+			                 std::format("import cycle detected: {}", cycle));
+			continue;
+		}
+
+		auto id = load(*path);
+		if (!id) {
+			messageBag.error(importToken,
+			                 std::format("could not open module '{}'",
+			                             path->string()));
+			continue;
+		}
+		if (std::ranges::find(dependencies, *id) == dependencies.end()) {
+			dependencies.push_back(*id);
+		}
+	}
+	auto importErrors = messageBag.getErrors();
+	errors.insert(errors.end(), importErrors.begin(), importErrors.end());
+	return dependencies;
+}
+
+std::optional<ModuleId> ModuleStore::load(const std::filesystem::path &path) {
+	auto key = canonicalKey(path);
+	if (auto it = pathIds.find(key); it != pathIds.end()) {
+		return it->second;
+	}
+	TraceRecorder::Span span("module", "load", key);
+	auto source = SourceBuffer::open(path);
+	if (!source) {
+		return std::nullopt;
+	}
+
+	uint64_t contentHash = hashSource(source->view());
+	if (auto it = contentIds.find(contentHash); it != contentIds.end()) {
+		const Module &cached = *modules[it->second];
+		if (cached.relocatable && cached.source->view() == source->view()) {
+			pathIds.emplace(key, it->second);
+			return it->second;
+		}
+	}
+
+	auto id = static_cast<ModuleId>(modules.size());
+	Module &module = *modules.emplace_back(std::make_unique<Module>());
+	module.path = path;
+	module.contentHash = contentHash;
+	module.source = std::move(source);
+	pathIds.emplace(key, id);
+
+	std::vector<Import> imports;
+	auto interfaceImports = readInterface(module);
+	if (interfaceImports) {
+		imports = std::move(*interfaceImports);
+	} else {
+		parse(module);
+		if (!module.failed) {
+			imports = collectImports(module.tree);
+		}
+	}
+	if (!module.failed) {
+		// dependencies are checked before the module importing them
+		loadingPaths.push_back(key);
+		module.dependencies =
+		    loadImportList(imports, module.path, module.relocatable);
+		loadingPaths.pop_back();
+	}
+	if (!module.failed && !interfaceImports) {
+		check(module);
+		if (!module.failed) {
+			writeInterface(module, imports);
+		}
+	}
+	contentIds.emplace(contentHash, id);
+	return id;
+}
+
+void ModuleStore::parse(Module &module) {
+	module.lexer = std::make_unique<Lexer>(module.source->view());
+	ast::Arena astArena;
+	Parser parser(module.path.string(), TokenStream(*module.lexer), astArena);
+	auto statements = parser.parse();
+
+	for (const auto &error : module.lexer->getErrors()) {
+		errors.push_back(std::format("{}: [{}:{}] {}\n", "LexerError"_red,
+		                             module.path.string(),
+		                             error.positionString(), error.toString()));
+	}
+	if (parser.failed()) {
+		auto parseErrors = parser.getErrors();
+		errors.insert(errors.end(), parseErrors.begin(), parseErrors.end());
+	}
+	if (!module.lexer->getErrors().empty() || parser.failed()) {
+		module.failed = true;
+		return;
+	}
+	module.tree = ast::flat::Builder().build(statements);
+}
+
+void ModuleStore::check(Module &module) {
+	passes::TypeScanner typeScanner(module.path.string(), dataModel,
+	                                module.sourceUnit);
+	typeScanner.resolve(module.tree);
+	if (typeScanner.hasFailed()) {
+		module.failed = true;
+		auto scanErrors = typeScanner.getErrors();
+		errors.insert(errors.end(), scanErrors.begin(), scanErrors.end());
+		return;
+	}
+	// the checker declares the functions, which are part of the interface
+	passes::TypeChecker typeChecker(module.path.string(), *this, module.path,
+	                                dataModel, module.sourceUnit);
+	typeChecker.resolve(module.tree);
+	if (typeChecker.hasFailed()) {
+		module.failed = true;
+		auto checkErrors = typeChecker.getErrors();
+		errors.insert(errors.end(), checkErrors.begin(), checkErrors.end());
+	}
+}
+
+std::optional<std::vector<ModuleStore::Import>>
+ModuleStore::readInterface(Module &module) {
+	if (!interfaceDirectory) {
+		return std::nullopt;
+	}
+	auto moduleInterface = ModuleInterface::read(
+	    ModuleInterface::pathFor(*interfaceDirectory, module.path,
+	                             module.contentHash, dataModel),
+	    dataModel);
+	if (!moduleInterface ||
+	    moduleInterface->contentHash != module.contentHash) {
+		return std::nullopt;
+	}
+	moduleInterface->declareInto(module.sourceUnit);
+	module.interfaceHash = moduleInterface->declarationsHash(dataModel);
+	std::vector<Import> imports;
+	for (auto &import : moduleInterface->imports) {
+		imports.push_back(
+		    Import::at(std::move(import.path), import.line, import.column));
+	}
+	return imports;
+}
+
+void ModuleStore::writeInterface(Module &module,
+                                 const std::vector<Import> &imports) const {
+	std::vector<ModuleInterface::Import> interfaceImports;
+	for (const auto &import : imports) {
+		interfaceImports.push_back({.path = import.path,
+		                            .line = import.token.line,
+		                            .column = import.token.column});
+	}
+	auto moduleInterface = ModuleInterface::fromSourceUnit(
+	    module.sourceUnit, module.contentHash, std::move(interfaceImports));
+	module.interfaceHash = moduleInterface.declarationsHash(dataModel);
+	if (interfaceDirectory) {
+		// failing to write only costs checking the module again next time
+		(void)moduleInterface.write(
+		    ModuleInterface::pathFor(*interfaceDirectory, module.path,
+		                             module.contentHash, dataModel),
+		    dataModel);
+	}
+}
+
+} // namespace ray::compiler::lang
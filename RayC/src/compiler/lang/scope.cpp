@@ -1,13 +1,15 @@
 #include <cassert>
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <optional>
-#include <string_view>
+#include <span>
 #include <utility>
 #include <vector>
 
 #include <ray/compiler/lang/functionDefinition.hpp>
 #include <ray/compiler/lang/scope.hpp>
+#include <ray/compiler/lang/stringInterner.hpp>
 #include <ray/compiler/lang/struct.hpp>
 #include <ray/util/soft_reference.hpp>
 
@@ -28,7 +30,7 @@ bool Scope::bindStruct(Struct &&structObj) {
 }
 
 bool Scope::bindFunctionDeclaration(
-    std::string_view name,
+    InternedString name,
     util::soft_reference<FunctionDeclaration> &functionDeclarationRef) {
 	auto functionDeclaration = functionDeclarationRef.getObject()->get();
 	if (!functions.contains(functionDeclaration.name)) {
@@ -90,45 +92,45 @@ bool Scope::declareLocalVariable(const util::soft_reference<Symbol> symbolRef) {
 }
 
 const std::optional<const util::soft_reference<Symbol>>
-Scope::findVariable(const std::string_view name) const {
-	const std::string key(name);
-	if (variables.contains(key)) {
-		return variables.at(key);
+Scope::findVariable(const InternedString name) const {
+	auto it = variables.find(name);
+	if (it != variables.end()) {
+		return it->second;
 	}
 	return std::nullopt;
 }
 
-const std::optional<
-    const std::vector<util::soft_reference<FunctionDeclaration>>>
-Scope::findLocalFunctionDeclaration(const std::string_view functionName) const {
-	const std::string key(functionName);
-	if (functions.contains(key)) {
-		return functions.at(key);
+std::span<const util::soft_reference<FunctionDeclaration>>
+Scope::findLocalFunctionDeclaration(const InternedString functionName) const {
+	auto it = functions.find(functionName);
+	if (it != functions.end()) {
+		return it->second;
 	}
-	return std::nullopt;
+	return {};
 }
 
 const std::optional<const util::soft_reference<Struct>>
-Scope::findLocalStruct(const std::string_view name) const {
-	std::string key = std::string(name);
-	if (structs.contains(key)) {
-		return structs.at(key);
+Scope::findLocalStruct(const InternedString name) const {
+	auto it = structs.find(name);
+	if (it != structs.end()) {
+		return it->second;
 	}
 	return std::nullopt;
 }
 
 std::optional<util::soft_reference<Struct>>
-Scope::findLocalStruct(const std::string_view name) {
-	std::string key = std::string(name);
-	if (structs.contains(key)) {
-		return structs.at(key);
+Scope::findLocalStruct(const InternedString name) {
+	auto it = structs.find(name);
+	if (it != structs.end()) {
+		return it->second;
 	}
 	return std::nullopt;
 }
 
 Scope &Scope::makeChildScope() {
-	innerScopes.push_back(Scope(*this));
-	return *innerScopes.back().get();
+	std::optional<std::reference_wrapper<Scope>> parent = *this;
+	innerScopes.push_back(std::make_unique<Scope>(parent));
+	return *innerScopes.back();
 }
 
 } // namespace ray::compiler::lang
\ No newline at end of file
@@ -1,11 +1,13 @@
 #include <cassert>
 #include <functional>
 #include <optional>
+#include <span>
 #include <string_view>
 #include <utility>
 
 #include <ray/compiler/lang/functionDefinition.hpp>
 #include <ray/compiler/lang/sourceUnit.hpp>
+#include <ray/compiler/lang/stringInterner.hpp>
 #include <ray/compiler/lang/struct.hpp>
 #include <ray/compiler/lang/symbol.hpp>
 #include <ray/util/soft_reference.hpp>
@@ -13,6 +15,12 @@
 
 namespace ray::compiler::lang {
 
+Scope &SourceUnit::enterScope(Scope &parentScope) {
+	symbols.pushScope();
+	return parentScope.makeChildScope();
+}
+void SourceUnit::leaveScope() { symbols.popScope(); }
+
 bool SourceUnit::declareLocalVariable(const Symbol symbol, Scope &scope) {
 	auto val = this->variables.insert(std::make_pair(nextId, symbol));
 	assert(val.second);
@@ -21,7 +29,11 @@ bool SourceUnit::declareLocalVariable(const Symbol symbol, Scope &scope) {
 	auto variableSoftRef =
 	    util::soft_reference<lang::Symbol>{variableRef.symbolId, variableRef};
 
-	return scope.declareLocalVariable(variableSoftRef);
+	if (!scope.declareLocalVariable(variableSoftRef)) {
+		return false;
+	}
+	symbols.bindVariable(variableRef.mangledName, variableSoftRef);
+	return true;
 }
 bool SourceUnit::declareFunction(const FunctionDeclaration &functionDeclaration,
                                  Scope &scope) {
@@ -34,8 +46,12 @@ bool SourceUnit::declareFunction(const FunctionDeclaration &functionDeclaration,
 	    util::soft_reference<lang::FunctionDeclaration>{
 	        functionDeclarationRef.functionID, functionDeclarationRef};
 
-	return scope.bindFunctionDeclaration(functionDeclaration.name,
-	                                     functionDeclarationSoftRef);
+	if (!scope.bindFunctionDeclaration(functionDeclaration.name,
+	                                   functionDeclarationSoftRef)) {
+		return false;
+	}
+	symbols.bindFunction(functionDeclaration.name, functionDeclarationSoftRef);
+	return true;
 }
 bool SourceUnit::declareStruct(const Struct &structObj, Scope &scope) {
 	assert(structObj.opaque);
@@ -50,50 +66,45 @@ bool SourceUnit::declareStruct(const Struct &structObj, Scope &scope) {
 	auto structSoftRef =
 	    util::soft_reference<Struct>{structRef.structID, structRef};
 
-	return scope.declareStruct(structSoftRef);
-}
-
-std::vector<util::soft_reference<FunctionDeclaration>>
-SourceUnit::findFunctionDeclarations(const std::string_view functionName,
-                                     const Scope &scope) const {
-	std::vector<util::soft_reference<FunctionDeclaration>> functionDeclarations;
-
-	for (auto *currentScope = &scope; currentScope;
-	     currentScope =
-	         currentScope->getParentScope()
-	             .transform([](const std::reference_wrapper<Scope> &parentScope)
-	                            -> const Scope * { return &parentScope.get(); })
-	             .value_or(nullptr)) {
-
-		auto localDeclarations =
-		    currentScope->findLocalFunctionDeclaration(functionName)
-		        .value_or(
-		            std::vector<util::soft_reference<FunctionDeclaration>>());
-		functionDeclarations.reserve(functionDeclarations.size() +
-		                             localDeclarations.size());
-		functionDeclarations.insert(functionDeclarations.end(),
-		                            localDeclarations.begin(),
-		                            localDeclarations.end());
+	if (!scope.declareStruct(structSoftRef)) {
+		return false;
 	}
+	symbols.bindStruct(structRef.name, structSoftRef);
+	return true;
+}
 
-	return functionDeclarations;
+std::optional<util::soft_reference<Symbol>>
+SourceUnit::findVariable(const InternedString name) const {
+	return symbols.findVariable(name);
+}
+std::span<const util::soft_reference<FunctionDeclaration>>
+SourceUnit::findFunctionDeclarations(const InternedString functionName) const {
+	return symbols.findFunctions(functionName);
 }
 std::optional<std::reference_wrapper<Struct>>
-SourceUnit::findStruct(const std::string_view structName,
-                       const Scope &currentScope) const {
-
-	auto foundStruct = currentScope.findLocalStruct(structName);
-	return foundStruct
-	    .transform([](util::soft_reference<Struct> structRef) {
-		    std::reference_wrapper<const Struct> valueRef =
-		        structRef.getObject().value();
+SourceUnit::findStruct(const InternedString structName) const {
+	return symbols.findStruct(structName).transform(
+	    [](util::soft_reference<Struct> structRef) {
 		    return structRef.getObject().value();
-	    })
-	    .or_else([&] {
-		    return currentScope.getParentScope().and_then(
-		        [&](Scope &parentScope) {
-			        return this->findStruct(structName, parentScope);
-		        });
 	    });
 }
+
+std::optional<util::soft_reference<Symbol>>
+SourceUnit::findVariable(std::string_view name) const {
+	auto interned = StringInterner::global().find(name);
+	return interned ? findVariable(*interned) : std::nullopt;
+}
+std::span<const util::soft_reference<FunctionDeclaration>>
+SourceUnit::findFunctionDeclarations(std::string_view functionName) const {
+	auto interned = StringInterner::global().find(functionName);
+	if (!interned) {
+		return {};
+	}
+	return findFunctionDeclarations(*interned);
+}
+std::optional<std::reference_wrapper<Struct>>
+SourceUnit::findStruct(std::string_view structName) const {
+	auto interned = StringInterner::global().find(structName);
+	return interned ? findStruct(*interned) : std::nullopt;
+}
 } // namespace ray::compiler::lang
\ No newline at end of file
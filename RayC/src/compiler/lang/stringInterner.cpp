@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+
+#include <ray/compiler/lang/stringInterner.hpp>
+#include <ray/util/counters.hpp>
+
+namespace ray::compiler::lang {
+
+namespace {
+
+struct Slot {
+	size_t segment;
+	size_t offset;
+};
+
+Slot slotOf(uint32_t id) {
+	auto position = static_cast<uint64_t>(id) + 1;
+	auto segment = static_cast<size_t>(std::bit_width(position) - 1);
+	return {segment, static_cast<size_t>(position - (uint64_t(1) << segment))};
+}
+
+} // namespace
+
+InternedString::InternedString(std::string_view value)
+    : InternedString(StringInterner::global().intern(value)) {}
+
+std::string_view InternedString::view() const {
+	return StringInterner::global().view(*this);
+}
+
+StringInterner::StringInterner() {
+	std::unique_lock lock(mutex);
+	segments[0].store(new std::string_view[1](), std::memory_order_release);
+	count.store(1, std::memory_order_release);
+	ids.emplace(std::string_view(), 0);
+}
+
+StringInterner::~StringInterner() {
+	for (auto &segment : segments) {
+		delete[] segment.load(std::memory_order_relaxed);
+	}
+}
+
+StringInterner &StringInterner::global() {
+	static StringInterner interner;
+	return interner;
+}
+
+InternedString StringInterner::intern(std::string_view value) {
+	if (auto found = find(value)) {
+		return *found;
+	}
+	std::unique_lock lock(mutex);
+	// another thread might have inserted it while the lock was released
+	auto it = ids.find(value);
+	if (it != ids.end()) {
+		return InternedString(it->second);
+	}
+	auto id = count.load(std::memory_order_relaxed);
+	assert(id < std::numeric_limits<uint32_t>::max());
+	auto [segment, offset] = slotOf(id);
+	auto *strings = segments[segment].load(std::memory_order_relaxed);
+	if (strings == nullptr) {
+		strings = new std::string_view[size_t(1) << segment]();
+		segments[segment].store(strings, std::memory_order_release);
+	}
+	std::string_view stored = storage.emplace_back(value);
+	strings[offset] = stored;
+	ids.emplace(stored, id);
+	count.store(id + 1, std::memory_order_release);
+	util::threadCounters.names++;
+	return InternedString(id);
+}
+
+std::optional<InternedString> StringInterner::find(
+    std::string_view value) const {
+	std::shared_lock lock(mutex);
+	auto it = ids.find(value);
+	if (it == ids.end()) {
+		return std::nullopt;
+	}
+	return InternedString(it->second);
+}
+
+// an id is only handed out after its view is written, and reaches other
+// threads through the lock or whatever passed the id along
+std::string_view StringInterner::view(InternedString value) const {
+	assert(value.id < count.load(std::memory_order_acquire));
+	auto [segment, offset] = slotOf(value.id);
+	return segments[segment].load(std::memory_order_acquire)[offset];
+}
+
+size_t StringInterner::size() const {
+	return count.load(std::memory_order_acquire);
+}
+
+void StringInterner::releaseFrom(size_t size) {
+	std::unique_lock lock(mutex);
+	// the empty string is always kept
+	auto keep = static_cast<uint32_t>(std::max<size_t>(size, 1));
+	for (auto id = count.load(std::memory_order_relaxed); id > keep; id--) {
+		auto [segment, offset] = slotOf(id - 1);
+		auto *strings = segments[segment].load(std::memory_order_relaxed);
+		auto &stored = strings[offset];
+		ids.erase(stored);
+		stored = std::string_view();
+		// ids and storage grow together, the last string is the last id
+		storage.pop_back();
+	}
+	count.store(std::min(count.load(std::memory_order_relaxed), keep),
+	            std::memory_order_release);
+}
+
+} // namespace ray::compiler::lang
@@ -0,0 +1,92 @@
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <span>
+
+#include <ray/compiler/lang/functionDefinition.hpp>
+#include <ray/compiler/lang/stringInterner.hpp>
+#include <ray/compiler/lang/struct.hpp>
+#include <ray/compiler/lang/symbol.hpp>
+#include <ray/compiler/lang/symbolTable.hpp>
+#include <ray/util/counters.hpp>
+#include <ray/util/soft_reference.hpp>
+
+namespace ray::compiler::lang {
+
+void SymbolTable::pushScope() { scopeMarks.push_back(undoLog.size()); }
+
+void SymbolTable::popScope() {
+	assert(!scopeMarks.empty());
+	size_t mark = scopeMarks.back();
+	scopeMarks.pop_back();
+	while (undoLog.size() > mark) {
+		const auto &entry = undoLog.back();
+		// the stacks are kept even when empty, the same names tend to be
+		// bound again by the next sibling scope
+		switch (entry.kind) {
+		case BindingKind::variable:
+			variables.at(entry.name).pop_back();
+			break;
+		case BindingKind::function:
+			functions.at(entry.name).pop_back();
+			break;
+		case BindingKind::structure:
+			structs.at(entry.name).pop_back();
+			break;
+		}
+		undoLog.pop_back();
+	}
+}
+
+void SymbolTable::bindVariable(InternedString name,
+                               const util::soft_reference<Symbol> &symbolRef) {
+	variables[name].push_back(symbolRef);
+	undoLog.push_back({BindingKind::variable, name});
+	util::threadCounters.symbols++;
+}
+
+void SymbolTable::bindFunction(
+    InternedString name,
+    const util::soft_reference<FunctionDeclaration> &functionRef) {
+	functions[name].push_back(functionRef);
+	undoLog.push_back({BindingKind::function, name});
+	util::threadCounters.symbols++;
+}
+
+void SymbolTable::bindStruct(InternedString name,
+                             const util::soft_reference<Struct> &structRef) {
+	structs[name].push_back(structRef);
+	undoLog.push_back({BindingKind::structure, name});
+	util::threadCounters.symbols++;
+}
+
+std::optional<util::soft_reference<Symbol>>
+SymbolTable::findVariable(InternedString name) const {
+	return findInnermost(variables, name);
+}
+
+std::span<const util::soft_reference<FunctionDeclaration>>
+SymbolTable::findFunctions(InternedString name) const {
+	auto it = functions.find(name);
+	if (it == functions.end()) {
+		return {};
+	}
+	return it->second;
+}
+
+std::optional<util::soft_reference<Struct>>
+SymbolTable::findStruct(InternedString name) const {
+	return findInnermost(structs, name);
+}
+
+template <typename T>
+std::optional<util::soft_reference<T>>
+SymbolTable::findInnermost(const Bindings<T> &bindings, InternedString name) {
+	auto it = bindings.find(name);
+	if (it == bindings.end() || it->second.empty()) {
+		return std::nullopt;
+	}
+	return it->second.back();
+}
+
+} // namespace ray::compiler::lang
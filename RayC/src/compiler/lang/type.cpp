@@ -3,6 +3,7 @@
 #include <optional>
 
 #include <ray/compiler/lang/type.hpp>
+#include <ray/compiler/lang/typeTable.hpp>
 namespace ray::compiler::lang {
 
 bool Type::coercercesInto(const Type &targetType) const {
@@ -21,9 +22,10 @@ bool Type::coercercesInto(const Type &targetType) const {
 }
 
 bool Type::signatureEquals(const Type &targetType) const {
+	auto &table = TypeTable::global();
 	if (subtype.has_value() != targetType.subtype.has_value() ||
 	    (subtype.has_value() &&
-	     *subtype.value() != *targetType.subtype.value())) {
+	     !table.equals(subtype.value(), targetType.subtype.value()))) {
 		return false;
 	}
 	if (signature.has_value()) {
@@ -34,7 +36,7 @@ bool Type::signatureEquals(const Type &targetType) const {
 			return false;
 		}
 		for (size_t i = 0; i < lhsSignature.size(); i++) {
-			if (*lhsSignature[i] != *rhsSignature[i]) {
+			if (!table.equals(lhsSignature[i], rhsSignature[i])) {
 				return false;
 			}
 		}
@@ -43,9 +45,10 @@ bool Type::signatureEquals(const Type &targetType) const {
 }
 
 bool Type::signatureMatches(const Type &targetType) const {
+	auto &table = TypeTable::global();
 	if (subtype.has_value() != targetType.subtype.has_value() ||
 	    (subtype.has_value() &&
-	     !subtype.value()->coercercesInto(*targetType.subtype.value()))) {
+	     !table.coercesInto(subtype.value(), targetType.subtype.value()))) {
 		return false;
 	}
 	if (signature.has_value()) {
@@ -56,7 +59,7 @@ bool Type::signatureMatches(const Type &targetType) const {
 			return false;
 		}
 		for (size_t i = 0; i < lhsSignature.size(); i++) {
-			if (lhsSignature[i]->coercercesInto(*rhsSignature[i].get())) {
+			if (table.coercesInto(lhsSignature[i], rhsSignature[i])) {
 				return false;
 			}
 		}
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+
+#include <ray/compiler/lang/type.hpp>
+#include <ray/compiler/lang/typeTable.hpp>
+#include <ray/util/counters.hpp>
+
+namespace ray::compiler::lang {
+
+namespace {
+
+void hashCombine(size_t &seed, size_t value) {
+	seed ^= value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2);
+}
+
+uint64_t pairKey(TypeRef lhs, TypeRef rhs) {
+	return (static_cast<uint64_t>(lhs.getId()) << 32) | rhs.getId();
+}
+
+} // namespace
+
+TypeRef::TypeRef(const Type &type)
+    : TypeRef(TypeTable::global().intern(type)) {}
+
+const Type &TypeRef::get() const { return TypeTable::global().get(*this); }
+
+size_t TypeTable::TypeHash::operator()(const Type *type) const {
+	size_t seed = std::hash<size_t>{}(type->typeId);
+	hashCombine(seed, type->isInitialized());
+	hashCombine(seed, static_cast<size_t>(type->getKind()));
+	hashCombine(seed, type->name.getId());
+	hashCombine(seed, type->calculatedSize);
+	hashCombine(seed, type->isMutable);
+	hashCombine(seed, type->signedType);
+	hashCombine(seed, type->overloaded);
+	hashCombine(seed, type->subtype ? type->subtype->getId() + 1 : 0);
+	if (type->signature) {
+		hashCombine(seed, type->signature->size() + 1);
+		for (const auto &param : *type->signature) {
+			hashCombine(seed, param.getId());
+		}
+	}
+	return seed;
+}
+
+bool TypeTable::TypeEqual::operator()(const Type *lhs, const Type *rhs) const {
+	return lhs->typeId == rhs->typeId &&
+	       lhs->isInitialized() == rhs->isInitialized() &&
+	       lhs->getKind() == rhs->getKind() && lhs->name == rhs->name &&
+	       lhs->calculatedSize == rhs->calculatedSize &&
+	       lhs->isMutable == rhs->isMutable &&
+	       lhs->signedType == rhs->signedType &&
+	       lhs->overloaded == rhs->overloaded &&
+	       lhs->subtype == rhs->subtype && lhs->signature == rhs->signature;
+}
+
+TypeTable::TypeTable() {
+	// id 0 is the default constructed type, which a default TypeRef refers to
+	types.emplace_back();
+	ids.emplace(&types.back(), 0);
+}
+
+TypeTable &TypeTable::global() {
+	static TypeTable table;
+	return table;
+}
+
+TypeRef TypeTable::intern(const Type &type) {
+	{
+		std::shared_lock lock(mutex);
+		auto it = ids.find(&type);
+		if (it != ids.end()) {
+			return TypeRef(it->second);
+		}
+	}
+	std::unique_lock lock(mutex);
+	// another thread might have inserted it while the lock was released
+	auto it = ids.find(&type);
+	if (it != ids.end()) {
+		return TypeRef(it->second);
+	}
+	assert(types.size() < std::numeric_limits<uint32_t>::max());
+	auto id = static_cast<uint32_t>(types.size());
+	const Type *stored = &types.emplace_back(type);
+	ids.emplace(stored, id);
+	util::threadCounters.types++;
+	return TypeRef(id);
+}
+
+const Type &TypeTable::get(TypeRef type) const {
+	std::shared_lock lock(mutex);
+	assert(type.getId() < types.size());
+	return types[type.getId()];
+}
+
+size_t TypeTable::size() const {
+	std::shared_lock lock(mutex);
+	return types.size();
+}
+
+size_t TypeTable::comparisons() const {
+	std::shared_lock lock(mutex);
+	return equalResults.size() + coercionResults.size();
+}
+
+void TypeTable::clearComparisons() {
+	std::unique_lock lock(mutex);
+	equalResults.clear();
+	coercionResults.clear();
+}
+
+void TypeTable::releaseFrom(size_t size) {
+	std::unique_lock lock(mutex);
+	// the default type is always kept
+	size = std::max<size_t>(size, 1);
+	while (types.size() > size) {
+		ids.erase(&types.back());
+		types.pop_back();
+	}
+	// results are keyed by ids that may be handed out again
+	equalResults.clear();
+	coercionResults.clear();
+}
+
+bool TypeTable::equals(TypeRef lhs, TypeRef rhs) {
+	// interning is stricter than Type::operator== as it also looks at the
+	// typeId and overloaded flag, different ids can still compare equal
+	if (lhs == rhs) {
+		return true;
+	}
+	return memoized(equalResults, lhs, rhs, [](const Type &a, const Type &b) {
+		return a == b;
+	});
+}
+
+bool TypeTable::coercesInto(TypeRef type, TypeRef targetType) {
+	return memoized(coercionResults, type, targetType,
+	                [](const Type &a, const Type &b) {
+		                return a.coercercesInto(b);
+	                });
+}
+
+template <typename Compare>
+bool TypeTable::memoized(std::unordered_map<uint64_t, bool> &results,
+                         TypeRef lhs, TypeRef rhs, Compare compare) {
+	uint64_t key = pairKey(lhs, rhs);
+	{
+		std::shared_lock lock(mutex);
+		auto it = results.find(key);
+		if (it != results.end()) {
+			return it->second;
+		}
+	}
+	// the comparison may recurse into nested types, so it runs unlocked
+	bool result = compare(get(lhs), get(rhs));
+	std::unique_lock lock(mutex);
+	results.emplace(key, result);
+	return result;
+}
+
+} // namespace ray::compiler::lang
@@ -1,12 +1,16 @@
-#include <cctype>
+#include <algorithm>
 #include <cstddef>
 #include <format>
+#include <string>
 #include <string_view>
 #include <vector>
 
+#include <ray/compiler/lexer/char_class.hpp>
 #include <ray/compiler/lexer/lexer.hpp>
 #include <ray/compiler/lexer/lexer_error.hpp>
+#include <ray/compiler/lexer/scan.hpp>
 #include <ray/compiler/lexer/token.hpp>
+#include <ray/util/counters.hpp>
 
 namespace ray::compiler {
 
@@ -15,20 +19,41 @@ Lexer::Lexer(std::string_view source) : source(source) {}
 bool Lexer::isAtEnd() const { return current >= source.length(); };
 
 std::vector<Token> Lexer::scanTokens() {
-	tokens.clear();
 	errors.clear();
+	start = 0;
+	startLine = 0;
+	startColumn = 0;
 	current = 0;
 	line = 1;
 	column = 0;
 
+	std::vector<Token> tokens;
+	do {
+		tokens.push_back(nextToken());
+	} while (tokens.back().type != Token::TokenType::TOKEN_EOF);
+
+	return tokens;
+}
+
+Token Lexer::nextToken() {
 	while (!isAtEnd()) {
+		skipWhitespace();
+		if (isAtEnd()) {
+			break;
+		}
 		start = current;
 		scanToken();
+		if (scannedToken) {
+			Token token = *scannedToken;
+			scannedToken.reset();
+			util::threadCounters.tokens++;
+			return token;
+		}
 	}
-
-	addToken(Token::TokenType::TOKEN_EOF);
-
-	return tokens;
+	return Token{.type = Token::TokenType::TOKEN_EOF,
+	             .lexeme = "",
+	             .line = startLine,
+	             .column = startColumn};
 }
 
 const std::vector<LexerError> &Lexer::getErrors() const { return errors; }
@@ -190,7 +215,7 @@ void Lexer::scanToken() {
 	// access or number
 	case Token::TokenType::TOKEN_DOT: {
 		char next = peekNext();
-		if (std::isdigit(next)) {
+		if (lexer::isDigit(next)) {
 			number();
 		} else {
 			addToken(Token::TokenType::TOKEN_DOT);
@@ -199,9 +224,9 @@ void Lexer::scanToken() {
 	}
 	// not expected character
 	case Token::TokenType::TOKEN_ERROR: {
-		if (std::isalpha(c) || c == '_') {
+		if (lexer::isIdentifierStart(c)) {
 			identifier();
-		} else if (std::isdigit(c)) {
+		} else if (lexer::isDigit(c)) {
 			number();
 		} else if (c == '"') {
 			string();
@@ -212,7 +237,7 @@ void Lexer::scanToken() {
 		} else if (c == ' ' || c == '\r' || c == '\t' || c == '\n') {
 		} else {
 			Token errorToken =
-			    Token{type, std::string{std::string_view(&c, 1)}, line, column};
+			    Token{type, source.substr(current - 1, 1), line, column};
 			errors.push_back(
 			    {.category = LexerError::ErrorCategory::UnexpectedCharacter,
 			     .token = errorToken,
@@ -234,20 +259,51 @@ char Lexer::advance() {
 		line++;
 		column = 0;
 	}
-	return source[current++];
+	// unterminated literals advance past the end, there is nothing to read
+	char c = isAtEnd() ? '\0' : source[current];
+	current++;
+	return c;
 };
 
+void Lexer::advanceBy(size_t count) {
+	count = std::min(count, source.length() - current);
+	auto text = source.substr(current, count);
+	auto newLines = static_cast<size_t>(std::ranges::count(text, '\n'));
+	if (newLines > 0) {
+		line += newLines;
+		column = count - text.rfind('\n') - 1;
+	} else {
+		column += count;
+	}
+	current += count;
+}
+
+void Lexer::skipWhitespace() {
+	auto count = lexer::whitespaceRun(source, current);
+	if (count == 0) {
+		return;
+	}
+	advanceBy(count);
+	// trailing whitespace places the EOF token after the last character
+	startLine = line;
+	startColumn = column;
+}
+
 void Lexer::addToken(Token::TokenType type) { addToken(type, ""); }
-void Lexer::addToken(Token::TokenType type, std::string literal) {
-	tokens.push_back(Token{.type = type,
-	                       .lexeme = literal,
-	                       .line = startLine,
-	                       .column = startColumn});
+void Lexer::addToken(Token::TokenType type, std::string_view literal) {
+	scannedToken = Token{.type = type,
+	                     .lexeme = literal,
+	                     .line = startLine,
+	                     .column = startColumn};
 }
-void Lexer::addToken(Token::TokenType type, std::string literal, size_t line,
-                     size_t column) {
-	tokens.push_back(
-	    Token{.type = type, .lexeme = literal, .line = line, .column = column});
+void Lexer::addToken(Token::TokenType type, std::string_view literal,
+                     size_t line, size_t column) {
+	scannedToken =
+	    Token{.type = type, .lexeme = literal, .line = line, .column = column};
+}
+
+std::string_view Lexer::storeLiteral(std::string literal) {
+	return literalStorage.emplace_back(std::move(literal));
 }
 
 bool Lexer::match(char expected) {
@@ -259,14 +315,21 @@ bool Lexer::match(char expected) {
 }
 
 void Lexer::string() {
+	// the value is only materialized once an escape sequence is found, until
+	// then the literal is a view of the source
 	std::string value;
+	bool escaped = false;
 	while (peek() != '"' && !isAtEnd()) {
 		// escape characters starting with backslash
 		if (peek() == '\\') {
+			if (!escaped) {
+				value = source.substr(start + 1, current - start - 1);
+				escaped = true;
+			}
 			advance();
 			if (isAtEnd()) {
-				Token errorToken{Token::TokenType::TOKEN_STRING, value, line,
-				                 column};
+				Token errorToken{Token::TokenType::TOKEN_STRING,
+				                 storeLiteral(value), line, column};
 				errors.push_back(
 				    {.category = LexerError::ErrorCategory::UnterminatedString,
 				     .token = errorToken,
@@ -282,8 +345,8 @@ void Lexer::string() {
 				break;
 			}
 			default: {
-				Token errorToken{Token::TokenType::TOKEN_STRING, value, line,
-				                 column};
+				Token errorToken{Token::TokenType::TOKEN_STRING,
+				                 storeLiteral(value), line, column};
 				errors.push_back(
 				    {.category = LexerError::ErrorCategory::UnterminatedString,
 				     .token = errorToken,
@@ -295,12 +358,16 @@ void Lexer::string() {
 			advance();
 			continue;
 		}
-		value.push_back(peek());
+		if (escaped) {
+			value.push_back(peek());
+		}
 		advance();
 	}
 
+	auto literal = escaped ? storeLiteral(std::move(value))
+	                       : source.substr(start + 1, current - start - 1);
 	if (isAtEnd()) {
-		Token errorToken{Token::TokenType::TOKEN_STRING, value, line, column};
+		Token errorToken{Token::TokenType::TOKEN_STRING, literal, line, column};
 		errors.push_back(
 		    {.category = LexerError::ErrorCategory::UnterminatedString,
 		     .token = errorToken,
@@ -310,19 +377,15 @@ void Lexer::string() {
 
 	advance();
 
-	addToken(Token::TokenType::TOKEN_STRING, value);
+	addToken(Token::TokenType::TOKEN_STRING, literal);
 }
 
 void Lexer::number() {
-	while (std::isdigit(peek())) {
-		advance();
-	}
+	advanceBy(lexer::digitRun(source, current));
 
-	if (peek() == '.' && std::isdigit(peekNext())) {
+	if (peek() == '.' && lexer::isDigit(peekNext())) {
 		advance();
-		while (std::isdigit(peek())) {
-			advance();
-		}
+		advanceBy(lexer::digitRun(source, current));
 	}
 
 	auto number_literal = source.substr(start, current - start);
@@ -330,18 +393,23 @@ void Lexer::number() {
 	if (peek() == 'i' || peek() == 'u') {
 		size_t index = number_literal.length();
 		std::string_view new_literal = "";
+		// the suffix may be cut off by the end of the source
 		auto subType = source.substr(start + index, 3);
+		auto suffix = [&](size_t i) {
+			return i < subType.size() ? subType[i] : '\0';
+		};
 
-		if ((subType[1] == '1' && subType[2] == '6') ||
-		    (subType[1] == '3' && subType[2] == '2') ||
-		    (subType[1] == '6' && subType[2] == '4')) {
+		if ((suffix(1) == '1' && suffix(2) == '6') ||
+		    (suffix(1) == '3' && suffix(2) == '2') ||
+		    (suffix(1) == '6' && suffix(2) == '4')) {
 			new_literal = source.substr(start, current - start + 3);
-		} else if (subType[1] == '8') {
+		} else if (suffix(1) == '8') {
 			new_literal = source.substr(start, current - start + 2);
 		}
 
-		auto nextChar = source[start + new_literal.length()];
-		if (!std::isalnum(nextChar) && nextChar != '_') {
+		size_t next = start + new_literal.length();
+		auto nextChar = next < source.size() ? source[next] : '\0';
+		if (!lexer::isIdentifier(nextChar)) {
 			number_literal = new_literal;
 		}
 
@@ -352,26 +420,29 @@ void Lexer::number() {
 		}
 	}
 
-	addToken(Token::TokenType::TOKEN_NUMBER, std::string{number_literal});
+	addToken(Token::TokenType::TOKEN_NUMBER, number_literal);
 }
 void Lexer::charLiteral() {
-	char character = '\0';
+	// escaped values are views over static literals instead of the source
+	std::string_view character{"\0", 1};
 	if (peek() != '\\') {
-		character = peek();
+		if (!isAtEnd()) {
+			character = source.substr(current, 1);
+		}
 		advance();
 	} else {
 		advance();
 		switch (peek()) {
 		case 'n': {
-			character = '\n';
+			character = "\n";
 			break;
 		}
 		case '0':
-			character = '\0';
+			character = {"\0", 1};
 			break;
 		default: {
 			Token errorToken{
-			    Token::TokenType::TOKEN_STRING, {character}, line, column};
+			    Token::TokenType::TOKEN_STRING, character, line, column};
 			errors.push_back(
 			    {.category = LexerError::ErrorCategory::UnterminatedCharLiteral,
 			     .token = errorToken,
@@ -385,58 +456,45 @@ void Lexer::charLiteral() {
 
 	if (peek() != '\'') {
 		Token errorToken{
-		    Token::TokenType::TOKEN_CHAR, {character}, line, column};
+		    Token::TokenType::TOKEN_CHAR, character, line, column};
 		errors.push_back(
 		    {.category = LexerError::ErrorCategory::UnterminatedCharLiteral,
 		     .token = errorToken,
 		     .message = "Expected ' after char literal"});
 	}
 	advance();
-	addToken(Token::TokenType::TOKEN_CHAR, {character});
+	addToken(Token::TokenType::TOKEN_CHAR, character);
 }
 
 void Lexer::intrinsicFunction() {
 	auto startColumn = column;
 	auto startLine = line;
-	while (std::isalnum(peek()) || peek() == '_') {
-		advance();
-	}
+	advanceBy(lexer::identifierRun(source, current));
 	auto text = source.substr(start, current - start);
-	addToken(Token::TokenType::TOKEN_INTRINSIC, std::string(text), startLine,
-	         startColumn);
+	addToken(Token::TokenType::TOKEN_INTRINSIC, text, startLine, startColumn);
 }
 
 void Lexer::identifier() {
-	while (std::isalnum(peek()) || peek() == '_') {
-		advance();
-	}
+	advanceBy(lexer::identifierRun(source, current));
 	auto text = source.substr(start, current - start);
-	auto type = Token::fromString(text);
+	auto type = Token::fromKeyword(text);
 	addToken(type == Token::TokenType::TOKEN_ERROR
 	             ? Token::TokenType::TOKEN_IDENTIFIER
 	             : type,
-	         std::string{type == Token::TokenType::TOKEN_ERROR ? text : ""});
+	         type == Token::TokenType::TOKEN_ERROR ? text : "");
 }
 
 void Lexer::comment() {
-	while (!isAtEnd()) {
-		if (peek() == '\n') {
-			advance();
-			break;
-		}
-		advance();
-	}
+	// consumes up to and including the line break
+	auto end = source.find('\n', current);
+	advanceBy(end == std::string_view::npos ? source.length() - current
+	                                        : end - current + 1);
 }
 
 void Lexer::multiLineComment() {
-	while (!isAtEnd()) {
-		if (peek() == '*' && peekNext() == '/') {
-			advance();
-			advance();
-			break;
-		}
-		advance();
-	}
+	auto end = source.find("*/", current);
+	advanceBy(end == std::string_view::npos ? source.length() - current
+	                                        : end - current + 2);
 }
 
 char Lexer::peek() {
@@ -0,0 +1,126 @@
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <ray/compiler/lexer/char_class.hpp>
+#include <ray/compiler/lexer/scan.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define RAYC_LEXER_SCAN_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RAYC_LEXER_SCAN_SSE2 1
+#endif
+
+#if defined(RAYC_LEXER_SCAN_AVX2) || defined(RAYC_LEXER_SCAN_SSE2)
+#define RAYC_LEXER_SCAN_SIMD 1
+#endif
+
+namespace ray::compiler::lexer {
+
+namespace {
+
+#if defined(RAYC_LEXER_SCAN_AVX2)
+using Block = __m256i;
+constexpr size_t blockSize = sizeof(Block);
+
+Block loadBlock(const char *data) {
+	return _mm256_loadu_si256(reinterpret_cast<const Block *>(data));
+}
+Block splat(char c) { return _mm256_set1_epi8(c); }
+Block equals(Block a, Block b) { return _mm256_cmpeq_epi8(a, b); }
+Block greater(Block a, Block b) { return _mm256_cmpgt_epi8(a, b); }
+Block either(Block a, Block b) { return _mm256_or_si256(a, b); }
+Block both(Block a, Block b) { return _mm256_and_si256(a, b); }
+uint32_t maskOf(Block block) {
+	return static_cast<uint32_t>(_mm256_movemask_epi8(block));
+}
+constexpr uint32_t fullMask = 0xFFFFFFFF;
+#elif defined(RAYC_LEXER_SCAN_SSE2)
+using Block = __m128i;
+constexpr size_t blockSize = sizeof(Block);
+
+Block loadBlock(const char *data) {
+	return _mm_loadu_si128(reinterpret_cast<const Block *>(data));
+}
+Block splat(char c) { return _mm_set1_epi8(c); }
+Block equals(Block a, Block b) { return _mm_cmpeq_epi8(a, b); }
+Block greater(Block a, Block b) { return _mm_cmpgt_epi8(a, b); }
+Block either(Block a, Block b) { return _mm_or_si128(a, b); }
+Block both(Block a, Block b) { return _mm_and_si128(a, b); }
+uint32_t maskOf(Block block) {
+	return static_cast<uint32_t>(_mm_movemask_epi8(block));
+}
+constexpr uint32_t fullMask = 0xFFFF;
+#endif
+
+#ifdef RAYC_LEXER_SCAN_SIMD
+// the comparisons are signed, bytes >= 0x80 are negative and never fall in
+// an ASCII range so they are rejected the same way as the scalar table does
+Block inRange(Block chars, char first, char last) {
+	return both(greater(chars, splat(first - 1)),
+	            greater(splat(last + 1), chars));
+}
+
+Block whitespaceMask(Block chars) {
+	Block blanks =
+	    either(equals(chars, splat(' ')), equals(chars, splat('\t')));
+	Block breaks =
+	    either(equals(chars, splat('\r')), equals(chars, splat('\n')));
+	return either(blanks, breaks);
+}
+Block digitMask(Block chars) { return inRange(chars, '0', '9'); }
+Block identifierMask(Block chars) {
+	return either(either(inRange(chars, 'a', 'z'), inRange(chars, 'A', 'Z')),
+	              either(digitMask(chars), equals(chars, splat('_'))));
+}
+
+size_t vectorRun(std::string_view source, size_t position,
+                 Block (*maskFn)(Block)) {
+	while (position + blockSize <= source.size()) {
+		uint32_t mask = maskOf(maskFn(loadBlock(source.data() + position)));
+		if (mask != fullMask) {
+			return position + static_cast<size_t>(std::countr_one(mask));
+		}
+		position += blockSize;
+	}
+	return position;
+}
+#endif
+
+size_t scalarRun(std::string_view source, size_t position, uint8_t charClass) {
+	while (position < source.size() &&
+	       hasCharClass(source[position], charClass)) {
+		position++;
+	}
+	return position;
+}
+
+} // namespace
+
+size_t whitespaceRun(std::string_view source, size_t position) {
+	size_t end = position;
+#ifdef RAYC_LEXER_SCAN_SIMD
+	end = vectorRun(source, end, whitespaceMask);
+#endif
+	return scalarRun(source, end, CHAR_CLASS_WHITESPACE) - position;
+}
+size_t digitRun(std::string_view source, size_t position) {
+	size_t end = position;
+#ifdef RAYC_LEXER_SCAN_SIMD
+	end = vectorRun(source, end, digitMask);
+#endif
+	return scalarRun(source, end, CHAR_CLASS_DIGIT) - position;
+}
+size_t identifierRun(std::string_view source, size_t position) {
+	size_t end = position;
+#ifdef RAYC_LEXER_SCAN_SIMD
+	end = vectorRun(source, end, identifierMask);
+#endif
+	return scalarRun(source, end, CHAR_CLASS_IDENTIFIER) - position;
+}
+
+} // namespace ray::compiler::lexer
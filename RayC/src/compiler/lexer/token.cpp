@@ -1,10 +1,127 @@
 #include <ray/compiler/lexer/token.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <format>
 #include <string_view>
-#include <unordered_map>
 
 namespace ray::compiler {
+namespace {
+constexpr std::array<Token::TokenType, 256> singleCharTokens = [] {
+	std::array<Token::TokenType, 256> table{};
+	table.fill(Token::TokenType::TOKEN_ERROR);
+	// block tokens
+	table['('] = Token::TokenType::TOKEN_LEFT_PAREN;
+	table[')'] = Token::TokenType::TOKEN_RIGHT_PAREN;
+	table['{'] = Token::TokenType::TOKEN_LEFT_BRACE;
+	table['}'] = Token::TokenType::TOKEN_RIGHT_BRACE;
+	table['['] = Token::TokenType::TOKEN_LEFT_SQUARE_BRACE;
+	table[']'] = Token::TokenType::TOKEN_RIGHT_SQUARE_BRACE;
+	// assignment
+	table['='] = Token::TokenType::TOKEN_EQUAL;
+	// arithmetic
+	table['+'] = Token::TokenType::TOKEN_PLUS;
+	table['-'] = Token::TokenType::TOKEN_MINUS;
+	table['*'] = Token::TokenType::TOKEN_STAR;
+	table['/'] = Token::TokenType::TOKEN_SLASH;
+	table['%'] = Token::TokenType::TOKEN_PERCENT;
+	table['&'] = Token::TokenType::TOKEN_AMPERSAND;
+	table['|'] = Token::TokenType::TOKEN_PIPE;
+	table['^'] = Token::TokenType::TOKEN_CARET;
+	// logical
+	table['!'] = Token::TokenType::TOKEN_BANG;
+	// comparison
+	table['<'] = Token::TokenType::TOKEN_LESS;
+	table['>'] = Token::TokenType::TOKEN_GREAT;
+	// misc
+	table['.'] = Token::TokenType::TOKEN_DOT;
+	table[','] = Token::TokenType::TOKEN_COMMA;
+	table['?'] = Token::TokenType::TOKEN_QUESTION;
+	table[':'] = Token::TokenType::TOKEN_COLON;
+	table[';'] = Token::TokenType::TOKEN_SEMICOLON;
+	table['#'] = Token::TokenType::TOKEN_POUND;
+	return table;
+}();
+
+struct KeywordEntry {
+	std::string_view keyword;
+	Token::TokenType type = Token::TokenType::TOKEN_ERROR;
+};
+constexpr std::array<KeywordEntry, 16> keywords{{
+    {"if", Token::TokenType::TOKEN_IF},
+    {"else", Token::TokenType::TOKEN_ELSE},
+    {"true", Token::TokenType::TOKEN_TRUE},
+    {"false", Token::TokenType::TOKEN_FALSE},
+    {"for", Token::TokenType::TOKEN_FOR},
+    {"while", Token::TokenType::TOKEN_WHILE},
+    {"fn", Token::TokenType::TOKEN_FN},
+    {"let", Token::TokenType::TOKEN_LET},
+    {"return", Token::TokenType::TOKEN_RETURN},
+    {"continue", Token::TokenType::TOKEN_CONTINUE},
+    {"break", Token::TokenType::TOKEN_BREAK},
+    {"pub", Token::TokenType::TOKEN_PUB},
+    {"mut", Token::TokenType::TOKEN_MUT},
+    {"struct", Token::TokenType::TOKEN_STRUCT},
+    {"as", Token::TokenType::TOKEN_AS},
+    {"import", Token::TokenType::TOKEN_IMPORT},
+}};
+
+// perfect hash over the keyword set, first and last characters are enough to
+// tell every keyword apart, a new keyword may require new constants
+constexpr size_t keywordSlots = 32;
+constexpr size_t keywordHash(std::string_view str) {
+	return (static_cast<unsigned char>(str.front()) * 12 +
+	        static_cast<unsigned char>(str.back())) %
+	       keywordSlots;
+}
+constexpr std::array<KeywordEntry, keywordSlots> keywordTable = [] {
+	std::array<KeywordEntry, keywordSlots> table{};
+	for (const auto &entry : keywords) {
+		table[keywordHash(entry.keyword)] = entry;
+	}
+	return table;
+}();
+static_assert(static_cast<size_t>(std::ranges::count_if(
+                  keywordTable,
+                  [](const KeywordEntry &entry) {
+	                  return !entry.keyword.empty();
+                  })) == keywords.size(),
+              "keyword hash collision, update keywordHash");
+
+// tokens longer than a single character that are not keywords, the lexer
+// scans them directly so this is only used by fromString
+constexpr std::array<KeywordEntry, 21> operators{{
+    // assignment
+    {"+=", Token::TokenType::TOKEN_PLUS_EQUAL},
+    {"-=", Token::TokenType::TOKEN_MINUS_EQUAL},
+    {"*=", Token::TokenType::TOKEN_STAR_EQUAL},
+    {"/=", Token::TokenType::TOKEN_SLASH_EQUAL},
+    {"%=", Token::TokenType::TOKEN_PERCENT_EQUAL},
+    {"&=", Token::TokenType::TOKEN_AMPERSAND_EQUAL},
+    {"|=", Token::TokenType::TOKEN_PIPE_EQUAL},
+    {"^=", Token::TokenType::TOKEN_CARET_EQUAL},
+    {"<<=", Token::TokenType::TOKEN_LESS_LESS_EQUAL},
+    {">>=", Token::TokenType::TOKEN_GREAT_GREAT_EQUAL},
+    // increment, decrement
+    {"++", Token::TokenType::TOKEN_PLUS_PLUS},
+    {"--", Token::TokenType::TOKEN_MINUS_MINUS},
+    // arithmetic
+    {"<<", Token::TokenType::TOKEN_LESS_LESS},
+    {">>", Token::TokenType::TOKEN_GREAT_GREAT},
+    // logical
+    {"&&", Token::TokenType::TOKEN_AMPERSAND_AMPERSAND},
+    {"||", Token::TokenType::TOKEN_PIPE_PIPE},
+    // comparison
+    {"==", Token::TokenType::TOKEN_EQUAL_EQUAL},
+    {"!=", Token::TokenType::TOKEN_BANG_EQUAL},
+    {"<=", Token::TokenType::TOKEN_LESS_EQUAL},
+    {">=", Token::TokenType::TOKEN_GREAT_EQUAL},
+    // misc
+    {"->", Token::TokenType::TOKEN_ARROW},
+}};
+} // namespace
+
 std::string Token::toString() const {
 	return std::format(
 	    "Token{{type: {:<25},line: {:<4},char: {:<4},lexeme: '{}'}}",
@@ -16,90 +133,26 @@ std::string_view Token::getLexeme() const {
 }
 std::string_view Token::getGlyph() const { return glyph(type); }
 
-void Token::merge(Token other) { lexeme += other.lexeme; }
-
-Token::TokenType Token::fromChar(const char c) { return fromString({&c, 1}); }
+Token::TokenType Token::fromChar(const char c) {
+	return singleCharTokens[static_cast<unsigned char>(c)];
+}
+Token::TokenType Token::fromKeyword(std::string_view str) {
+	if (str.empty()) {
+		return TokenType::TOKEN_ERROR;
+	}
+	const auto &entry = keywordTable[keywordHash(str)];
+	return entry.keyword == str ? entry.type : TokenType::TOKEN_ERROR;
+}
 Token::TokenType Token::fromString(std::string_view str) {
-	static std::unordered_map<std::string, TokenType> map = {
-	    // block tokens
-	    {"(", Token::TokenType::TOKEN_LEFT_PAREN},         // (
-	    {")", Token::TokenType::TOKEN_RIGHT_PAREN},        // )
-	    {"{", Token::TokenType::TOKEN_LEFT_BRACE},         // {
-	    {"}", Token::TokenType::TOKEN_RIGHT_BRACE},        // }
-	    {"[", Token::TokenType::TOKEN_LEFT_SQUARE_BRACE},  // [
-	    {"]", Token::TokenType::TOKEN_RIGHT_SQUARE_BRACE}, // ]
-	    // assignment
-	    {"=", Token::TokenType::TOKEN_EQUAL},               // =
-	    {"+=", Token::TokenType::TOKEN_PLUS_EQUAL},         // +=
-	    {"-=", Token::TokenType::TOKEN_MINUS_EQUAL},        // -=
-	    {"*=", Token::TokenType::TOKEN_STAR_EQUAL},         // *=
-	    {"/=", Token::TokenType::TOKEN_SLASH_EQUAL},        // /=
-	    {"*=", Token::TokenType::TOKEN_PERCENT_EQUAL},      // *=
-	    {"&=", Token::TokenType::TOKEN_AMPERSAND_EQUAL},    // &=
-	    {"|=", Token::TokenType::TOKEN_PIPE_EQUAL},         // |=
-	    {"^=", Token::TokenType::TOKEN_CARET_EQUAL},        // ^=
-	    {"<<=", Token::TokenType::TOKEN_LESS_LESS_EQUAL},   // <<=
-	    {">>=", Token::TokenType::TOKEN_GREAT_GREAT_EQUAL}, // >>=
-	    // increment, decrement
-	    {"++", Token::TokenType::TOKEN_PLUS_PLUS},   // ++
-	    {"--", Token::TokenType::TOKEN_MINUS_MINUS}, // --
-	    // arithmetic
-	    {"+", Token::TokenType::TOKEN_PLUS},         // +
-	    {"-", Token::TokenType::TOKEN_MINUS},        // -
-	    {"*", Token::TokenType::TOKEN_STAR},         // *
-	    {"/", Token::TokenType::TOKEN_SLASH},        // /
-	    {"%", Token::TokenType::TOKEN_PERCENT},      // %
-	    {"&", Token::TokenType::TOKEN_AMPERSAND},    // &
-	    {"|", Token::TokenType::TOKEN_PIPE},         // |
-	    {"^", Token::TokenType::TOKEN_CARET},        // ^
-	    {"<<", Token::TokenType::TOKEN_LESS_LESS},   // <<
-	    {">>", Token::TokenType::TOKEN_GREAT_GREAT}, // >>
-	    // logical
-	    {"!", Token::TokenType::TOKEN_BANG},                 // !
-	    {"&&", Token::TokenType::TOKEN_AMPERSAND_AMPERSAND}, // &&
-	    {"||", Token::TokenType::TOKEN_PIPE_PIPE},           // ||
-	    // comparison
-	    {"==", Token::TokenType::TOKEN_EQUAL_EQUAL}, // ==
-	    {"!=", Token::TokenType::TOKEN_BANG_EQUAL},  // !=
-	    {"<", Token::TokenType::TOKEN_LESS},         // <
-	    {">", Token::TokenType::TOKEN_GREAT},        // >
-	    {"<=", Token::TokenType::TOKEN_LESS_EQUAL},  // <=
-	    {">=", Token::TokenType::TOKEN_GREAT_EQUAL}, // >=
-	    // misc
-	    {".", Token::TokenType::TOKEN_DOT},       // .
-	    {",", Token::TokenType::TOKEN_COMMA},     // ,
-	    {"?", Token::TokenType::TOKEN_QUESTION},  // ?
-	    {":", Token::TokenType::TOKEN_COLON},     // :
-	    {";", Token::TokenType::TOKEN_SEMICOLON}, // ;
-	    {"->", Token::TokenType::TOKEN_ARROW},    // ->
-	    {"#", Token::TokenType::TOKEN_POUND},     // #
-	    // literals
-	    //{"", Token::TokenType::TOKEN_IDENTIFIER}, // ex: foo, bar, baz, etc.
-	    //{"", Token::TokenType::TOKEN_STRING},     // ex: "Hello, world"
-	    //{"", Token::TokenType::TOKEN_NUMBER},     // ex: 0x01, 10, 10.2, -2,
-	    //.1
-	    //{"", Token::TokenType::TOKEN_CHAR},     	// ex: 'A', 'B'
-	    //{"", Token::TokenType::TOKEN_INTRINSIC},  // ex: @sizeOf
-	    // keywords
-	    {"if", Token::TokenType::TOKEN_IF},             // if
-	    {"else", Token::TokenType::TOKEN_ELSE},         // else
-	    {"true", Token::TokenType::TOKEN_TRUE},         // true
-	    {"false", Token::TokenType::TOKEN_FALSE},       // false
-	    {"for", Token::TokenType::TOKEN_FOR},           // for
-	    {"while", Token::TokenType::TOKEN_WHILE},       // while
-	    {"fn", Token::TokenType::TOKEN_FN},             // fn
-	    {"let", Token::TokenType::TOKEN_LET},           // let
-	    {"return", Token::TokenType::TOKEN_RETURN},     // return
-	    {"continue", Token::TokenType::TOKEN_CONTINUE}, // continue
-	    {"break", Token::TokenType::TOKEN_BREAK},       // break
-	    {"pub", Token::TokenType::TOKEN_PUB},           // pub
-	    {"mut", Token::TokenType::TOKEN_MUT},           // mut
-	    {"struct", Token::TokenType::TOKEN_STRUCT},     // struct
-	    {"as", Token::TokenType::TOKEN_AS},             // as
-	    {"import", Token::TokenType::TOKEN_IMPORT},     // import
-	};
-	std::string key{str};
-	return map.contains(key) ? map.at(key) : TokenType::TOKEN_ERROR;
+	if (str.size() == 1) {
+		return fromChar(str[0]);
+	}
+	for (const auto &entry : operators) {
+		if (entry.keyword == str) {
+			return entry.type;
+		}
+	}
+	return fromKeyword(str);
 }
 
 std::string_view Token::toString(TokenType token) {
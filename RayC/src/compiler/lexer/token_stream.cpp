@@ -0,0 +1,49 @@
+#include <cassert>
+#include <cstddef>
+
+#include <ray/compiler/lexer/token.hpp>
+#include <ray/compiler/lexer/token_stream.hpp>
+
+namespace ray::compiler {
+
+const Token &TokenStream::peek(size_t offset) const {
+	assert(offset < lookahead && "peek beyond the lookahead window");
+	fill(position + offset);
+	return window[(position + offset) % windowSize];
+}
+
+const Token &TokenStream::previous() const {
+	static const Token noToken{};
+	if (position == 0) {
+		return noToken;
+	}
+	return window[(position - 1) % windowSize];
+}
+
+void TokenStream::advance() {
+	fill(position);
+	position++;
+}
+
+void TokenStream::drain() {
+	while (!reachedEOF) {
+		reachedEOF =
+		    lexer.get().nextToken().type == Token::TokenType::TOKEN_EOF;
+	}
+}
+
+void TokenStream::fill(size_t index) const {
+	while (scanned <= index) {
+		Token &slot = window[scanned % windowSize];
+		// past the end behave like an exhausted token list
+		slot = reachedEOF ? Token{.type = Token::TokenType::TOKEN_EOF,
+		                          .lexeme = "",
+		                          .line = 0,
+		                          .column = 0}
+		                  : lexer.get().nextToken();
+		reachedEOF = slot.type == Token::TokenType::TOKEN_EOF;
+		scanned++;
+	}
+}
+
+} // namespace ray::compiler
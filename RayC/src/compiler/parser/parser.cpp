@@ -9,6 +9,7 @@
 
 #include <ray/cli/terminal.hpp>
 
+#include <ray/compiler/ast/arena.hpp>
 #include <ray/compiler/ast/expression.hpp>
 #include <ray/compiler/ast/intrinsic.hpp>
 #include <ray/compiler/ast/statement.hpp>
@@ -20,13 +21,12 @@ namespace ray::compiler {
 
 using namespace terminal::literals;
 
-Parser::Parser(std::string filepath, std::vector<Token> tokens)
-    : messageBag("parser", filepath), tokens(tokens) {}
+Parser::Parser(std::string filepath, TokenStream tokens, ast::Arena &arena)
+    : messageBag("parser", filepath), tokens(tokens), arena(arena) {}
 
-std::vector<std::unique_ptr<ast::Statement>> Parser::parse() {
-	current = 0;
+std::vector<ast::NodePtr<ast::Statement>> Parser::parse() {
 	try {
-		std::vector<std::unique_ptr<ast::Statement>> statements{};
+		std::vector<ast::NodePtr<ast::Statement>> statements{};
 		while (!isAtEnd()) {
 			auto stmts = CompilerDirective();
 			if (stmts.has_value()) {
@@ -35,6 +35,7 @@ std::vector<std::unique_ptr<ast::Statement>> Parser::parse() {
 		}
 		return statements;
 	} catch (ParseException &e) {
+		tokens.drain();
 		return {};
 	}
 }
@@ -44,7 +45,7 @@ const std::vector<std::string> Parser::getErrors() const {
 	return messageBag.getErrors();
 }
 
-std::optional<std::unique_ptr<ast::Statement>> Parser::CompilerDirective() {
+std::optional<ast::NodePtr<ast::Statement>> Parser::CompilerDirective() {
 	if (match({Token::TokenType::TOKEN_POUND})) {
 		consume(Token::TokenType::TOKEN_LEFT_SQUARE_BRACE,
 		        "expected '[' before compiler directive");
@@ -86,13 +87,14 @@ std::optional<std::unique_ptr<ast::Statement>> Parser::CompilerDirective() {
 		                   "expected ']' after compiler directive");
 		// all compiler directives expect a child statement
 		auto stmt = declaration();
-		return std::make_unique<ast::CompDirective>(
-		    name, attributes, stmt ? std::move(*stmt) : nullptr, name);
+		return arena.get().make<ast::CompDirective>(name, attributes,
+		                                      stmt ? std::move(*stmt) : nullptr,
+		                                      name);
 	}
 	return declaration();
 }
-std::unique_ptr<ast::Expression> Parser::expression() { return comma(); }
-std::optional<std::unique_ptr<ast::Statement>> Parser::declaration() {
+ast::NodePtr<ast::Expression> Parser::expression() { return comma(); }
+std::optional<ast::NodePtr<ast::Statement>> Parser::declaration() {
 	try {
 		Token pubToken;
 		if (match({Token::TokenType::TOKEN_PUB})) {
@@ -103,7 +105,7 @@ std::optional<std::unique_ptr<ast::Statement>> Parser::declaration() {
 			                         Token::TokenType::TOKEN_PUB);
 		}
 		if (match({Token::TokenType::TOKEN_FN})) {
-			return std::make_unique<ast::Function>(function(
+			return arena.get().make<ast::Function>(function(
 			    "function", pubToken.type == Token::TokenType::TOKEN_PUB));
 		}
 		if (match({Token::TokenType::TOKEN_LET})) {
@@ -111,7 +113,7 @@ std::optional<std::unique_ptr<ast::Statement>> Parser::declaration() {
 				error(pubToken,
 				      "pub token cannot be in a variable declaration");
 			}
-			return std::make_unique<ast::VarDecl>(varDeclaration());
+			return arena.get().make<ast::VarDecl>(varDeclaration());
 		}
 		return statement();
 	} catch (ParseException &e) {
@@ -119,7 +121,7 @@ std::optional<std::unique_ptr<ast::Statement>> Parser::declaration() {
 		return std::nullopt;
 	}
 }
-std::unique_ptr<ast::Statement>
+ast::NodePtr<ast::Statement>
 Parser::structDeclaration(bool publicVisibility) {
 	Token name =
 	    consume(Token::TokenType::TOKEN_IDENTIFIER, "Expect struct name.");
@@ -140,17 +142,11 @@ Parser::structDeclaration(bool publicVisibility) {
 		consume(Token::TokenType::TOKEN_RIGHT_BRACE,
 		        "Expect '}' after struct body.");
 	}
-	return std::make_unique<ast::Struct>(ast::Struct{
-	    name,
-	    publicVisibility,
-	    structDeclaration,
-	    std::move(members),
-	    memberVisibility,
-	    name,
-	});
+	return ast::Struct::create(arena, name, publicVisibility, structDeclaration,
+	                           std::move(members), memberVisibility, name);
 }
 
-std::unique_ptr<ast::Statement> Parser::statement() {
+ast::NodePtr<ast::Statement> Parser::statement() {
 	if (match({Token::TokenType::TOKEN_FOR})) {
 		return forStatement();
 	}
@@ -170,145 +166,112 @@ std::unique_ptr<ast::Statement> Parser::statement() {
 		return whileStatement();
 	}
 	if (match({Token::TokenType::TOKEN_LEFT_BRACE})) {
-		return std::make_unique<ast::Block>(ast::Block({
-		    block(),
-		    previous(),
-		}));
+		// block() consumes the closing brace that becomes the node token
+		auto statements = block();
+		return ast::Block::create(arena, std::move(statements), previous());
 	}
 
 	return expressionStatement();
 }
-std::unique_ptr<ast::Statement> Parser::forStatement() {
+ast::NodePtr<ast::Statement> Parser::forStatement() {
 	auto forExprToken = previous();
 	consume(Token::TokenType::TOKEN_LEFT_PAREN, "Expect '(' after 'for'.");
 
-	std::unique_ptr<ast::Statement> initializer;
+	ast::NodePtr<ast::Statement> initializer;
 	if (!match({Token::TokenType::TOKEN_SEMICOLON})) {
 		if (match({Token::TokenType::TOKEN_LET})) {
-			initializer = std::make_unique<ast::VarDecl>(varDeclaration());
+			initializer = arena.get().make<ast::VarDecl>(varDeclaration());
 		} else {
 			initializer = expressionStatement();
 		}
 	}
 
-	std::unique_ptr<ast::Expression> condition;
+	ast::NodePtr<ast::Expression> condition;
 	if (!check(Token::TokenType::TOKEN_SEMICOLON)) {
 		condition = expression();
 	}
 	consume(Token::TokenType::TOKEN_SEMICOLON,
 	        "Expect ';' after loop condition.");
 
-	std::unique_ptr<ast::Expression> increment;
+	ast::NodePtr<ast::Expression> increment;
 	if (!check(Token::TokenType::TOKEN_RIGHT_PAREN)) {
 		increment = expression();
 	}
 	consume(Token::TokenType::TOKEN_RIGHT_PAREN,
 	        "Expect ')' after for clauses.");
 
-	std::unique_ptr<ast::Statement> body = statement();
+	ast::NodePtr<ast::Statement> body = statement();
 
 	if (increment) {
-		std::vector<std::unique_ptr<ast::Statement>> bodyStatements;
+		std::vector<ast::NodePtr<ast::Statement>> bodyStatements;
 		bodyStatements.push_back(std::move(body));
 		auto incrementToken = increment->getToken();
 		bodyStatements.push_back(
-		    std::make_unique<ast::ExpressionStmt>(ast::ExpressionStmt{
-		        std::move(increment),
-		        incrementToken,
-		    }));
-		body = std::make_unique<ast::Block>(ast::Block{
-		    std::move(bodyStatements),
-		    incrementToken,
-		});
+		    ast::ExpressionStmt::create(arena, std::move(increment),
+		                                incrementToken));
+		body = ast::Block::create(arena, std::move(bodyStatements),
+		                          incrementToken);
 	}
 
 	if (!condition) {
 		Token token = Token(Token::TokenType::TOKEN_TRUE, "", 0, 0);
-		condition = std::make_unique<ast::Literal>(ast::Literal{
-		    token,
-		    "true",
-		    token,
-		});
+		condition = ast::Literal::create(arena, token, "true", token);
 	}
-	body = std::make_unique<ast::While>(ast::While{
-	    std::move(condition),
-	    std::move(body),
-	    forExprToken,
-	});
+	body = ast::While::create(arena, std::move(condition), std::move(body),
+	                          forExprToken);
 
 	if (initializer) {
-		std::vector<std::unique_ptr<ast::Statement>> bodyStatements;
+		std::vector<ast::NodePtr<ast::Statement>> bodyStatements;
 		auto initializerToken = initializer->getToken();
 		bodyStatements.push_back(std::move(initializer));
 		bodyStatements.push_back(std::move(body));
-		body = std::make_unique<ast::Block>(ast::Block{
-		    std::move(bodyStatements),
-		    initializerToken,
-		});
+		body = ast::Block::create(arena, std::move(bodyStatements),
+		                          initializerToken);
 	}
 
 	return body;
 }
-std::unique_ptr<ast::Statement> Parser::ifStatement() {
+ast::NodePtr<ast::Statement> Parser::ifStatement() {
 	auto ifToken = previous();
 	auto condition = expression();
 
 	auto thenBranch = statement();
-	std::optional<std::unique_ptr<ast::Statement>> elseBranch = std::nullopt;
+	std::optional<ast::NodePtr<ast::Statement>> elseBranch = std::nullopt;
 	if (match({Token::TokenType::TOKEN_ELSE})) {
 		elseBranch = statement();
 	}
 
-	return std::make_unique<ast::If>(ast::If{
-	    std::move(condition),
-	    std::move(thenBranch),
-	    std::move(elseBranch),
-	    ifToken,
-	});
+	return ast::If::create(arena, std::move(condition), std::move(thenBranch),
+	                       std::move(elseBranch), ifToken);
 }
-std::unique_ptr<ast::Statement> Parser::returnStatement() {
+ast::NodePtr<ast::Statement> Parser::returnStatement() {
 	Token keyword = previous();
-	std::unique_ptr<ast::Expression> value;
+	ast::NodePtr<ast::Expression> value;
 	if (!check(Token::TokenType::TOKEN_SEMICOLON)) {
 		value = expression();
 	}
 	consume(Token::TokenType::TOKEN_SEMICOLON,
 	        "Expect ';' after return value.");
-	return std::make_unique<ast::Jump>(ast::Jump{
-	    keyword,
-	    std::move(value),
-	    keyword,
-	});
+	return ast::Jump::create(arena, keyword, std::move(value), keyword);
 }
-std::unique_ptr<ast::Statement> Parser::continueStatement() {
+ast::NodePtr<ast::Statement> Parser::continueStatement() {
 	Token keyword = previous();
 	consume(Token::TokenType::TOKEN_SEMICOLON, "Expect ';' after continue.");
-	return std::make_unique<ast::Jump>(ast::Jump{
-	    keyword,
-	    nullptr,
-	    keyword,
-	});
+	return ast::Jump::create(arena, keyword, nullptr, keyword);
 }
-std::unique_ptr<ast::Statement> Parser::breakStatement() {
+ast::NodePtr<ast::Statement> Parser::breakStatement() {
 	Token keyword = previous();
 	consume(Token::TokenType::TOKEN_SEMICOLON, "Expect ';' after break.");
-	return std::make_unique<ast::Jump>(ast::Jump{
-	    keyword,
-	    nullptr,
-	    keyword,
-	});
+	return ast::Jump::create(arena, keyword, nullptr, keyword);
 }
-std::unique_ptr<ast::Statement> Parser::whileStatement() {
+ast::NodePtr<ast::Statement> Parser::whileStatement() {
 	auto token = previous();
 	auto condition = expression();
 
 	auto body = statement();
 
-	return std::make_unique<ast::While>(ast::While{
-	    std::move(condition),
-	    std::move(body),
-	    token,
-	});
+	return ast::While::create(arena, std::move(condition), std::move(body),
+	                          token);
 }
 ast::VarDecl Parser::varDeclaration() {
 	bool is_mutable = match({Token::TokenType::TOKEN_MUT});
@@ -316,22 +279,18 @@ ast::VarDecl Parser::varDeclaration() {
 	    consume(Token::TokenType::TOKEN_IDENTIFIER, "Expect variable name.");
 	auto typeToken = Token{
 	    Token::TokenType::TOKEN_UNINITIALIZED,
-	    std::string(Token::glyph(Token::TokenType::TOKEN_UNINITIALIZED)),
+	    Token::glyph(Token::TokenType::TOKEN_UNINITIALIZED),
 	    name.line,
 	    name.column,
 	};
-	std::unique_ptr<ast::Expression> type =
-	    std::make_unique<ast::NamedType>(ast::NamedType{
-	        typeToken,
-	        false,
-	        typeToken,
-	    });
+	ast::NodePtr<ast::Expression> type =
+	    ast::NamedType::create(arena, typeToken, false, typeToken);
 	if (match({Token::TokenType::TOKEN_COLON})) {
 		// array type
 		type = pointerTypeExpression();
 	}
 
-	std::optional<std::unique_ptr<ast::Expression>> initializer = std::nullopt;
+	std::optional<ast::NodePtr<ast::Expression>> initializer = std::nullopt;
 	if (match({Token::TokenType::TOKEN_EQUAL})) {
 		initializer = expression();
 	}
@@ -349,22 +308,18 @@ ast::Member Parser::memberDeclaration() {
 	    consume(Token::TokenType::TOKEN_IDENTIFIER, "Expect member name.");
 	auto typeToken = Token{
 	    Token::TokenType::TOKEN_UNINITIALIZED,
-	    std::string(Token::glyph(Token::TokenType::TOKEN_UNINITIALIZED)),
+	    Token::glyph(Token::TokenType::TOKEN_UNINITIALIZED),
 	    name.line,
 	    name.column,
 	};
-	std::unique_ptr<ast::Expression> type =
-	    std::make_unique<ast::NamedType>(ast::NamedType{
-	        typeToken,
-	        false,
-	        typeToken,
-	    });
+	ast::NodePtr<ast::Expression> type =
+	    ast::NamedType::create(arena, typeToken, false, typeToken);
 	if (match({Token::TokenType::TOKEN_COLON})) {
 		// array type
 		type = pointerTypeExpression();
 	}
 
-	std::optional<std::unique_ptr<ast::Expression>> initializer = std::nullopt;
+	std::optional<ast::NodePtr<ast::Expression>> initializer = std::nullopt;
 	if (match({Token::TokenType::TOKEN_EQUAL})) {
 		initializer = expression();
 	}
@@ -375,15 +330,13 @@ ast::Member Parser::memberDeclaration() {
 	    name, std::move(type), is_mutable, std::move(initializer), name,
 	};
 }
-std::unique_ptr<ast::Statement> Parser::expressionStatement() {
+ast::NodePtr<ast::Statement> Parser::expressionStatement() {
 	auto expr = expression();
 	auto exprToken = expr->getToken();
 	if (match({Token::TokenType::TOKEN_SEMICOLON})) {
-		return std::make_unique<ast::ExpressionStmt>(
-		    ast::ExpressionStmt(std::move(expr), exprToken));
+		return ast::ExpressionStmt::create(arena, std::move(expr), exprToken);
 	}
-	return std::make_unique<ast::TerminalExpr>(
-	    ast::TerminalExpr(std::move(expr), exprToken));
+	return ast::TerminalExpr::create(arena, std::move(expr), exprToken);
 }
 ast::Function Parser::function(std::string kind, bool publicVisiblity) {
 
@@ -399,7 +352,7 @@ ast::Function Parser::function(std::string kind, bool publicVisiblity) {
 			                              "Expect parameter name.");
 			consume(Token::TokenType::TOKEN_COLON,
 			        "Expect ':' after parameter name.");
-			std::unique_ptr<ast::Expression> parameterType =
+			ast::NodePtr<ast::Expression> parameterType =
 			    pointerTypeExpression();
 			auto parameter = ast::Parameter{
 			    attributeToken,
@@ -417,7 +370,7 @@ ast::Function Parser::function(std::string kind, bool publicVisiblity) {
 
 	size_t newColumn = previous().column + previous().getLexeme().size();
 
-	std::unique_ptr<ast::Expression> returnType =
+	ast::NodePtr<ast::Expression> returnType =
 	    makeUnitExpression(previous().line, newColumn);
 
 	if (match({Token::TokenType::TOKEN_ARROW})) {
@@ -438,8 +391,8 @@ ast::Function Parser::function(std::string kind, bool publicVisiblity) {
 	    std::move(body), std::move(returnType), Token(name),
 	};
 }
-std::vector<std::unique_ptr<ast::Statement>> Parser::block() {
-	std::vector<std::unique_ptr<ast::Statement>> statements;
+std::vector<ast::NodePtr<ast::Statement>> Parser::block() {
+	std::vector<ast::NodePtr<ast::Statement>> statements;
 
 	while (!check(Token::TokenType::TOKEN_RIGHT_BRACE) && !isAtEnd()) {
 		auto result = declaration();
@@ -458,19 +411,19 @@ std::vector<std::unique_ptr<ast::Statement>> Parser::block() {
 	}
 	return statements;
 }
-std::unique_ptr<ast::Expression> Parser::comma() {
+ast::NodePtr<ast::Expression> Parser::comma() {
 	auto expr = assignment();
 
 	while (match({Token::TokenType::TOKEN_COMMA})) {
 		Token op = previous();
 		auto right = expression();
-		expr = std::make_unique<ast::Binary>(
-		    ast::Binary(std::move(expr), op, std::move(right), op));
+		expr = ast::Binary::create(arena, std::move(expr), op, std::move(right),
+		                           op);
 	}
 
 	return expr;
 }
-std::unique_ptr<ast::Expression> Parser::assignment() {
+ast::NodePtr<ast::Expression> Parser::assignment() {
 	auto lhs_expr = orExpression();
 
 	if (match({
@@ -489,27 +442,15 @@ std::unique_ptr<ast::Expression> Parser::assignment() {
 		Token assignmentOp = previous();
 		auto rhs_expr = assignment();
 		if (dynamic_cast<ast::Variable *>(lhs_expr.get())) {
-			return std::make_unique<ast::Assign>(ast::Assign{
-			    std::move(lhs_expr),
-			    assignmentOp,
-			    std::move(rhs_expr),
-			    assignmentOp,
-			});
+			return ast::Assign::create(arena, std::move(lhs_expr), assignmentOp,
+			                           std::move(rhs_expr), assignmentOp);
 		} else if (auto get = dynamic_cast<ast::Get *>(lhs_expr.get())) {
-			return std::make_unique<ast::Set>(ast::Set{
-			    std::move(get->object),
-			    get->name,
-			    assignmentOp,
-			    std::move(rhs_expr),
-			    assignmentOp,
-			});
+			return ast::Set::create(arena, std::move(get->object), get->name,
+			                        assignmentOp, std::move(rhs_expr),
+			                        assignmentOp);
 		} else if (dynamic_cast<ast::ArrayAccess *>(lhs_expr.get())) {
-			return std::make_unique<ast::Assign>(ast::Assign{
-			    std::move(lhs_expr),
-			    assignmentOp,
-			    std::move(rhs_expr),
-			    assignmentOp,
-			});
+			return ast::Assign::create(arena, std::move(lhs_expr), assignmentOp,
+			                           std::move(rhs_expr), assignmentOp);
 		}
 		error(assignmentOp, std::format("Invalid assignment target '{}'.",
 		                                lhs_expr->variantName()));
@@ -517,56 +458,44 @@ std::unique_ptr<ast::Expression> Parser::assignment() {
 
 	return lhs_expr;
 }
-std::unique_ptr<ast::Expression> Parser::orExpression() {
+ast::NodePtr<ast::Expression> Parser::orExpression() {
 	auto expr = andExpression();
 
 	while (match({Token::TokenType::TOKEN_PIPE_PIPE})) {
 		Token op = previous();
 		auto right = andExpression();
-		expr = std::make_unique<ast::Logical>(ast::Logical{
-		    std::move(expr),
-		    op,
-		    std::move(right),
-		    op,
-		});
+		expr = ast::Logical::create(arena, std::move(expr), op,
+		                            std::move(right), op);
 	}
 
 	return expr;
 }
-std::unique_ptr<ast::Expression> Parser::andExpression() {
+ast::NodePtr<ast::Expression> Parser::andExpression() {
 	auto expr = equalityExpression();
 
 	while (match({Token::TokenType::TOKEN_AMPERSAND_AMPERSAND})) {
 		Token op = previous();
 		auto right = equalityExpression();
-		expr = std::make_unique<ast::Logical>(ast::Logical{
-		    std::move(expr),
-		    op,
-		    std::move(right),
-		    op,
-		});
+		expr = ast::Logical::create(arena, std::move(expr), op,
+		                            std::move(right), op);
 	}
 
 	return expr;
 }
-std::unique_ptr<ast::Expression> Parser::equalityExpression() {
+ast::NodePtr<ast::Expression> Parser::equalityExpression() {
 	auto expr = comparisonExpression();
 
 	while (match({Token::TokenType::TOKEN_BANG_EQUAL,
 	              Token::TokenType::TOKEN_EQUAL_EQUAL})) {
 		Token op = previous();
 		auto right = comparisonExpression();
-		expr = std::make_unique<ast::Binary>(ast::Binary{
-		    std::move(expr),
-		    op,
-		    std::move(right),
-		    op,
-		});
+		expr = ast::Binary::create(arena, std::move(expr), op, std::move(right),
+		                           op);
 	}
 
 	return expr;
 }
-std::unique_ptr<ast::Expression> Parser::comparisonExpression() {
+ast::NodePtr<ast::Expression> Parser::comparisonExpression() {
 	auto expr = terminalExpression();
 
 	while (match(
@@ -574,76 +503,56 @@ std::unique_ptr<ast::Expression> Parser::comparisonExpression() {
 	     Token::TokenType::TOKEN_LESS, Token::TokenType::TOKEN_LESS_EQUAL})) {
 		Token op = previous();
 		auto right = terminalExpression();
-		expr = std::make_unique<ast::Binary>(ast::Binary{
-		    std::move(expr),
-		    op,
-		    std::move(right),
-		    op,
-		});
+		expr = ast::Binary::create(arena, std::move(expr), op, std::move(right),
+		                           op);
 	}
 
 	return expr;
 }
-std::unique_ptr<ast::Expression> Parser::terminalExpression() {
+ast::NodePtr<ast::Expression> Parser::terminalExpression() {
 	auto expr = factorExpression();
 
 	while (
 	    match({Token::TokenType::TOKEN_MINUS, Token::TokenType::TOKEN_PLUS})) {
 		Token op = previous();
 		auto right = factorExpression();
-		expr = std::make_unique<ast::Binary>(ast::Binary{
-		    std::move(expr),
-		    op,
-		    std::move(right),
-		    op,
-		});
+		expr = ast::Binary::create(arena, std::move(expr), op, std::move(right),
+		                           op);
 	}
 
 	return expr;
 }
-std::unique_ptr<ast::Expression> Parser::factorExpression() {
+ast::NodePtr<ast::Expression> Parser::factorExpression() {
 	auto expr = unaryExpression();
 
 	while (match({Token::TokenType::TOKEN_SLASH, Token::TokenType::TOKEN_STAR,
 	              Token::TokenType::TOKEN_PERCENT})) {
 		Token op = previous();
 		auto right = unaryExpression();
-		expr = std::make_unique<ast::Binary>(ast::Binary{
-		    std::move(expr),
-		    op,
-		    std::move(right),
-		    op,
-		});
+		expr = ast::Binary::create(arena, std::move(expr), op, std::move(right),
+		                           op);
 	}
 
 	return expr;
 }
-std::unique_ptr<ast::Expression> Parser::unaryExpression() {
+ast::NodePtr<ast::Expression> Parser::unaryExpression() {
 	if (match({Token::TokenType::TOKEN_BANG, Token::TokenType::TOKEN_MINUS,
 	           Token::TokenType::TOKEN_PLUS_PLUS,
 	           Token::TokenType::TOKEN_MINUS_MINUS})) {
 		auto op = previous();
 		auto right = unaryExpression();
-		return std::make_unique<ast::Unary>(ast::Unary{
-		    op,
-		    true,
-		    std::move(right),
-		    op,
-		});
+		return ast::Unary::create(arena, op, true, std::move(right), op);
 	}
 	auto expr = call();
 	if (match({Token::TokenType::TOKEN_AS})) {
 		auto type = pointerTypeExpression();
 		auto typeToken = type->getToken();
-		expr = std::make_unique<ast::Cast>(ast::Cast{
-		    std::move(expr),
-		    std::move(type),
-		    typeToken,
-		});
+		expr = ast::Cast::create(arena, std::move(expr), std::move(type),
+		                         typeToken);
 	}
 	return expr;
 }
-std::unique_ptr<ast::Expression> Parser::arrayTypeExpression() {
+ast::NodePtr<ast::Expression> Parser::arrayTypeExpression() {
 	bool isMutable =
 	    peek().type == Token::TokenType::TOKEN_MUT &&
 	    peekNext().type == Token::TokenType::TOKEN_LEFT_SQUARE_BRACE;
@@ -657,13 +566,13 @@ std::unique_ptr<ast::Expression> Parser::arrayTypeExpression() {
 		consume(Token::TokenType::TOKEN_SEMICOLON, "Expect ';' after type.");
 		consume(Token::TokenType::TOKEN_RIGHT_SQUARE_BRACE,
 		        "Expect ']' after array type.");
-		return std::make_unique<ast::ArrayType>(
-		    ast::ArrayType{isMutable, std::move(arrayType), arrayStartToken});
+		return ast::ArrayType::create(arena, isMutable, std::move(arrayType),
+		                              arrayStartToken);
 	}
 
 	return namedTypeExpression();
 }
-std::unique_ptr<ast::Expression> Parser::tupleTypeExpression() {
+ast::NodePtr<ast::Expression> Parser::tupleTypeExpression() {
 	bool isMutable = peek().type == Token::TokenType::TOKEN_MUT &&
 	                 peekNext().type == Token::TokenType::TOKEN_LEFT_PAREN;
 	if (isMutable) {
@@ -672,11 +581,11 @@ std::unique_ptr<ast::Expression> Parser::tupleTypeExpression() {
 
 	if (match({Token::TokenType::TOKEN_LEFT_PAREN})) {
 		auto tupleStartToken = previous();
-		std::vector<std::unique_ptr<ast::Expression>> types;
+		std::vector<ast::NodePtr<ast::Expression>> types;
 		// parse the list of subtypes if we do not start with closing paren
 		if (!check(Token::TokenType::TOKEN_RIGHT_PAREN)) {
 			do {
-				std::unique_ptr<ast::Expression> subType =
+				ast::NodePtr<ast::Expression> subType =
 				    pointerTypeExpression();
 				types.push_back(std::move(subType));
 			} while (match({Token::TokenType::TOKEN_COMMA}));
@@ -688,13 +597,13 @@ std::unique_ptr<ast::Expression> Parser::tupleTypeExpression() {
 		auto tupleNameToken =
 		    Token{Token::TokenType::TOKEN_LEFT_SQUARE_BRACE, "%<tuple>%",
 		          tupleStartToken.line, tupleStartToken.column};
-		return std::make_unique<ast::TupleType>(
-		    ast::TupleType{isMutable, std::move(types), tupleStartToken});
+		return ast::TupleType::create(arena, isMutable, std::move(types),
+		                              tupleStartToken);
 	}
 
 	return arrayTypeExpression();
 }
-std::unique_ptr<ast::Expression> Parser::pointerTypeExpression() {
+ast::NodePtr<ast::Expression> Parser::pointerTypeExpression() {
 	bool isMutable = peek().type == Token::TokenType::TOKEN_MUT &&
 	                 peekNext().type == Token::TokenType::TOKEN_STAR;
 	if (isMutable) {
@@ -704,41 +613,34 @@ std::unique_ptr<ast::Expression> Parser::pointerTypeExpression() {
 	if (match({Token::TokenType::TOKEN_STAR})) {
 		auto token = previous();
 		auto subType = pointerTypeExpression();
-		return std::make_unique<ast::PointerType>(
-		    ast::PointerType{isMutable, std::move(subType), token});
+		return ast::PointerType::create(arena, isMutable, std::move(subType),
+		                                token);
 	}
 
 	return tupleTypeExpression();
 }
 
-std::unique_ptr<ast::Expression> Parser::namedTypeExpression() {
+ast::NodePtr<ast::Expression> Parser::namedTypeExpression() {
 	bool is_mutable = match({Token::TokenType::TOKEN_MUT});
 
 	auto typeToken =
 	    consume(Token::TokenType::TOKEN_IDENTIFIER, "Expect type signature");
 
-	return std::make_unique<ast::NamedType>(ast::NamedType{
-	    typeToken,
-	    is_mutable,
-	    typeToken,
-	});
+	return ast::NamedType::create(arena, typeToken, is_mutable, typeToken);
 }
 
-std::unique_ptr<ast::Expression>
-Parser::finishArrayAccess(std::unique_ptr<ast::Expression> callee) {
+ast::NodePtr<ast::Expression>
+Parser::finishArrayAccess(ast::NodePtr<ast::Expression> callee) {
 	auto index = expression();
 	auto paren = consume(Token::TokenType::TOKEN_RIGHT_SQUARE_BRACE,
 	                     "Expect ']' after array access");
 	auto token = index->getToken();
-	return std::make_unique<ast::ArrayAccess>(ast::ArrayAccess{
-	    std::move(callee),
-	    std::move(index),
-	    token,
-	});
-}
-std::unique_ptr<ast::Expression>
-Parser::finishCall(std::unique_ptr<ast::Expression> callee) {
-	std::vector<std::unique_ptr<ast::Expression>> arguments;
+	return ast::ArrayAccess::create(arena, std::move(callee), std::move(index),
+	                                token);
+}
+ast::NodePtr<ast::Expression>
+Parser::finishCall(ast::NodePtr<ast::Expression> callee) {
+	std::vector<ast::NodePtr<ast::Expression>> arguments;
 	if (!check(Token::TokenType::TOKEN_RIGHT_PAREN)) {
 		do {
 			auto argument = expression();
@@ -762,22 +664,19 @@ Parser::finishCall(std::unique_ptr<ast::Expression> callee) {
 	auto token = callee->getToken();
 	if (token.type == Token::TokenType::TOKEN_INTRINSIC) {
 		if (dynamic_cast<ast::Intrinsic *>(callee.get())) {
-			return std::make_unique<ast::IntrinsicCall>(
-			    std::unique_ptr<ast::Intrinsic>(
+			return ast::IntrinsicCall::create(
+			    arena,
+			    ast::NodePtr<ast::Intrinsic>(
 			        static_cast<ast::Intrinsic *>(callee.release())),
 			    paren, std::move(arguments), token);
 		} else {
 			error(peek(), std::format("<{}> Expect expression.", "BUG"_red));
 		}
 	}
-	return std::make_unique<ast::Call>(ast::Call{
-	    std::move(callee),
-	    paren,
-	    std::move(arguments),
-	    token,
-	});
+	return ast::Call::create(arena, std::move(callee), paren,
+	                         std::move(arguments), token);
 }
-std::unique_ptr<ast::Expression> Parser::call() {
+ast::NodePtr<ast::Expression> Parser::call() {
 	auto expr = primaryExpresion();
 	while (true) {
 		if (match({Token::TokenType::TOKEN_LEFT_PAREN})) {
@@ -785,21 +684,13 @@ std::unique_ptr<ast::Expression> Parser::call() {
 		} else if (match({Token::TokenType::TOKEN_DOT})) {
 			Token name = consume(Token::TokenType::TOKEN_IDENTIFIER,
 			                     "Expect property name after '.'.");
-			expr = std::make_unique<ast::Get>(ast::Get{
-			    std::move(expr),
-			    name,
-			    name,
-			});
+			expr = ast::Get::create(arena, std::move(expr), name, name);
 		} else if (match({Token::TokenType::TOKEN_LEFT_SQUARE_BRACE})) {
 			expr = finishArrayAccess(std::move(expr));
 		} else if (match({Token::TokenType::TOKEN_PLUS_PLUS,
 		                  Token::TokenType::TOKEN_MINUS_MINUS})) {
-			expr = std::make_unique<ast::Unary>(ast::Unary{
-			    previous(),
-			    false,
-			    std::move(expr),
-			    previous(),
-			});
+			expr = ast::Unary::create(arena, previous(), false, std::move(expr),
+			                          previous());
 		} else {
 			break;
 		}
@@ -808,56 +699,36 @@ std::unique_ptr<ast::Expression> Parser::call() {
 	return expr;
 }
 
-std::unique_ptr<ast::Expression> Parser::primaryExpresion() {
+ast::NodePtr<ast::Expression> Parser::primaryExpresion() {
 	Token kind = peek();
 	if (match({Token::TokenType::TOKEN_FALSE})) {
-		return std::make_unique<ast::Literal>(ast::Literal{
-		    kind,
-		    "false",
-		    kind,
-		});
+		return ast::Literal::create(arena, kind, "false", kind);
 	}
 	if (match({Token::TokenType::TOKEN_TRUE})) {
-		return std::make_unique<ast::Literal>(ast::Literal{
-		    kind,
-		    "true",
-		    kind,
-		});
+		return ast::Literal::create(arena, kind, "true", kind);
 	}
 
 	if (match({Token::TokenType::TOKEN_NUMBER, Token::TokenType::TOKEN_STRING,
 	           Token::TokenType::TOKEN_CHAR})) {
-		return std::make_unique<ast::Literal>(ast::Literal{
-		    kind,
-		    previous().lexeme,
-		    kind,
-		});
+		return ast::Literal::create(arena, kind, previous().lexeme, kind);
 	}
 
 	if (match({Token::TokenType::TOKEN_IDENTIFIER})) {
-		return std::make_unique<ast::Variable>(ast::Variable{
-		    previous(),
-		    kind,
-		});
+		return ast::Variable::create(arena, previous(), kind);
 	}
 
 	if (match({Token::TokenType::TOKEN_INTRINSIC})) {
 		Token token = previous();
-		return std::make_unique<ast::Intrinsic>(ast::Intrinsic{
-		    token,
-		    ast::getintrinsicType(token.lexeme),
-		    kind,
-		});
+		return ast::Intrinsic::create(arena, token,
+		                              ast::getintrinsicType(token.lexeme),
+		                              kind);
 	}
 
 	if (match({Token::TokenType::TOKEN_LEFT_PAREN})) {
 		auto expr = expression();
 		consume(Token::TokenType::TOKEN_RIGHT_PAREN,
 		        "Expect ')' after expression.");
-		return std::make_unique<ast::Grouping>(ast::Grouping{
-		    std::move(expr),
-		    kind,
-		});
+		return ast::Grouping::create(arena, std::move(expr), kind);
 	}
 
 	throw error(peek(), "Expect expression.");
@@ -875,7 +746,7 @@ bool Parser::check(Token::TokenType type) { return peek().type == type; }
 
 Token Parser::advance() {
 	if (!isAtEnd()) {
-		current++;
+		tokens.advance();
 	}
 	return previous();
 }
@@ -883,19 +754,11 @@ Token Parser::advance() {
 bool Parser::isAtEnd() const {
 	return peek().type == Token::TokenType::TOKEN_EOF;
 }
-Token Parser::peek() const {
-	return current < tokens.size() ? tokens[current]
-	                               : Token{Token::TokenType::TOKEN_EOF};
-}
+Token Parser::peek() const { return tokens.peek(); }
 // required to lookahead of expressions like "mut *(mut T)"
-Token Parser::peekNext() const {
-	return current + 1 < tokens.size() ? tokens[current + 1]
-	                                   : Token{Token::TokenType::TOKEN_EOF};
-}
+Token Parser::peekNext() const { return tokens.peek(1); }
 
-Token Parser::previous() {
-	return tokens.size() < 1 ? Token{} : tokens[current - 1];
-}
+Token Parser::previous() { return tokens.previous(); }
 Token Parser::consume(Token::TokenType type, std::string message) {
 	if (check(type)) {
 		return advance();
@@ -9,7 +9,7 @@ namespace ray::compiler::passes::mangling {
 using namespace terminal::literals;
 
 std::string NameMangler::mangleFunction(
-    std::string_view module, const ast::Function &function,
+    std::string_view module, std::string_view functionName,
     std::optional<directive::LinkageDirective> &linkageDirective) {
 	if (linkageDirective) {
 		if (!linkageDirective->overrideName.empty()) {
@@ -20,7 +20,7 @@ std::string NameMangler::mangleFunction(
 			break;
 		}
 		case directive::LinkageDirective::ManglingType::C: {
-			return function.name.lexeme;
+			return std::string(functionName);
 		}
 		case directive::LinkageDirective::ManglingType::Unknonw: {
 			// the ideal would be to return an optional
@@ -33,11 +33,11 @@ std::string NameMangler::mangleFunction(
 		}
 	}
 	return std::format("_rayMv{}_T{}_M{}_{}_N{}_{}", manglerVersion, "F",
-	                   module.size(), module, function.name.lexeme.size(),
-	                   function.name.lexeme);
+	                   module.size(), module, functionName.size(),
+	                   functionName);
 }
 std::string NameMangler::mangleStruct(
-    std::string_view module, const ast::Struct &structDefinition,
+    std::string_view module, std::string_view structName,
     std::optional<directive::LinkageDirective> &linkageDirective) {
 	if (linkageDirective) {
 		if (!linkageDirective->overrideName.empty()) {
@@ -48,7 +48,7 @@ std::string NameMangler::mangleStruct(
 			break;
 		}
 		case directive::LinkageDirective::ManglingType::C: {
-			return structDefinition.name.lexeme;
+			return std::string(structName);
 		}
 		case directive::LinkageDirective::ManglingType::Unknonw: {
 			// the ideal would be to return an optional
@@ -61,8 +61,6 @@ std::string NameMangler::mangleStruct(
 		}
 	}
 	return std::format("_rayMv{}_T{}_M{}_{}_N{}_{}", manglerVersion, "S",
-	                   module.size(), module,
-	                   structDefinition.name.lexeme.size(),
-	                   structDefinition.name.lexeme);
+	                   module.size(), module, structName.size(), structName);
 }
 } // namespace ray::compiler::passes::mangling
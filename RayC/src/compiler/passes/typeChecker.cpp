@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdio>
@@ -7,8 +8,7 @@
 #include <string_view>
 #include <vector>
 
-#include <ray/compiler/ast/expression.hpp>
-#include <ray/compiler/ast/statement.hpp>
+#include <ray/compiler/ast/flat.hpp>
 #include <ray/compiler/lang/functionDefinition.hpp>
 #include <ray/compiler/lang/scope.hpp>
 #include <ray/compiler/lang/struct.hpp>
@@ -17,36 +17,49 @@
 #include <ray/compiler/lexer/token.hpp>
 #include <ray/compiler/passes/symbol_mangler.hpp>
 #include <ray/compiler/passes/typeChecker.hpp>
-#include <ray/util/copy_ptr.hpp>
+#include <ray/compiler/trace.hpp>
 #include <ray/util/soft_reference.hpp>
 
 namespace ray::compiler::passes {
 
-void TypeChecker::resolve(
-    const std::vector<std::unique_ptr<ast::Statement>> &statements) {
+void TypeChecker::resolve(const ast::flat::Tree &tree) {
+	begin(tree);
+	for (auto stmt : tree.getRoots()) {
+		resolveRoot(stmt);
+	}
+	end();
+}
 
-	for (const auto &stmt : statements) {
-		auto stmtType = resolveType(*stmt);
-		// we need to check the added types to the stack to see if they are
-		// structs
-		if (stmtType.has_value()) {
-			auto type = stmtType.value();
-			if (type.getKind() != lang::TypeKind::scalar) {
-				// TODO: optimize this search
-				// the types could have a reference to the specific struct
-				/*
+void TypeChecker::begin(const ast::flat::Tree &tree) { bind(tree); }
 
+void TypeChecker::resolveRoot(ast::flat::NodeId stmt) {
+	typeStackPeak = typeStack.size();
+	auto stmtType = resolveType(stmt);
+	if (auto *recorder = TraceRecorder::current()) {
+		// deepest the stack got while checking the declaration
+		recorder->counter("typeStack", typeStackPeak);
+	}
+	// we need to check the added types to the stack to see if they are
+	// structs
+	if (stmtType.has_value()) {
+		auto type = stmtType.value();
+		if (type.getKind() != lang::TypeKind::scalar) {
+			// TODO: optimize this search
+			// the types could have a reference to the specific struct
+			/*
 
-				*/
-			} else {
-				messageBag.bug(
-				    stmt->getToken(),
-				    std::format("unevaluated type value in stack for '{}'",
-				                stmt->variantName()));
-			}
+
+			*/
+		} else {
+			messageBag.bug(
+			    getToken(stmt),
+			    std::format("unevaluated type value in stack for '{}'",
+			                tree().variantName(stmt)));
 		}
 	}
+}
 
+void TypeChecker::end() {
 	for (auto &directive : directivesStack) {
 		messageBag.warning(directive->getToken(),
 		                   std::format("unused compiler directive {}",
@@ -55,8 +68,7 @@ void TypeChecker::resolve(
 
 	if (typeStack.size() > 0) {
 		Token errorToken{Token::TokenType::TOKEN_EOF,
-		                 std::string(Token::glyph(Token::TokenType::TOKEN_EOF)),
-		                 0, 0};
+		                 Token::glyph(Token::TokenType::TOKEN_EOF), 0, 0};
 		messageBag.bug(errorToken, std::format("type stack evaluation error"));
 	}
 }
@@ -69,10 +81,11 @@ const std::vector<std::string> TypeChecker::getWarnings() const {
 	return messageBag.getWarnings();
 }
 
-void TypeChecker::visitBlockStatement(const ast::Block &block) {
+void TypeChecker::visitBlockStatement(const ast::flat::Block &block) {
+	auto &blockScope = makeChildScope();
 	std::vector<lang::Type> types;
-	for (const auto &statement : block.statements) {
-		auto stmtTypes = resolveTypes(*statement);
+	for (auto statement : tree().range(block.statements)) {
+		auto stmtTypes = resolveTypes(statement);
 		types.reserve(types.size() + stmtTypes.size());
 		for (const auto &type : stmtTypes) {
 			if (type != lang::Type::defineStmtType()) {
@@ -81,22 +94,24 @@ void TypeChecker::visitBlockStatement(const ast::Block &block) {
 		}
 	}
 
+	popScope(blockScope);
+
 	typeStack.reserve(typeStack.size() + types.size());
 	typeStack.insert(typeStack.end(), types.begin(), types.end());
 }
 void TypeChecker::visitTerminalExprStatement(
-    const ast::TerminalExpr &terminalExpr) {
-	if (terminalExpr.expression.has_value()) {
-		const auto &returnExpr = *terminalExpr.expression.value();
+    const ast::flat::TerminalExpr &terminalExpr) {
+	if (terminalExpr.expression) {
+		auto returnExpr = terminalExpr.expression;
 		auto returnType = resolveType(returnExpr);
 		if (returnType.has_value()) {
 			typeStack.push_back(returnType.value());
 		} else {
 			messageBag.error(
-			    returnExpr.getToken(),
+			    getToken(returnExpr),
 			    std::format("{} child expression did not yield a value '{}'",
 			                terminalExpr.variantName(),
-			                returnExpr.variantName()));
+			                tree().variantName(returnExpr)));
 		}
 		return;
 	}
@@ -104,26 +119,29 @@ void TypeChecker::visitTerminalExprStatement(
 	typeStack.push_back(lang::Type::defineStmtType());
 }
 void TypeChecker::visitExpressionStmtStatement(
-    const ast::ExpressionStmt &exprStmt) {
+    const ast::flat::ExpressionStmt &exprStmt) {
 	// an expression statement consumes the type and does not return a type
 	// so it is an type of size 0 that cannot even be instatiated nor used
-	resolveType(*exprStmt.expression);
+	resolveType(exprStmt.expression);
 
 	typeStack.push_back(lang::Type::defineStmtType());
 }
-void TypeChecker::visitFunctionStatement(const ast::Function &functionExprAst) {
+void TypeChecker::visitFunctionStatement(
+    const ast::flat::Function &functionExprAst) {
+	TraceRecorder::Span span("declaration", "check fn",
+	                         token(functionExprAst.name).lexeme);
 
 	auto declarationResult = resolveFunctionDeclaration(functionExprAst);
 	if (!declarationResult.has_value()) {
 		messageBag.error(
-		    functionExprAst.getToken(),
+		    token(functionExprAst.token),
 		    std::format("could not resolve function declaration for '{}'",
-		                functionExprAst.name.getLexeme()));
+		                token(functionExprAst.name).getLexeme()));
 	} else {
 		const auto functionDeclaration = declarationResult.value();
-		if (!currentSourceUnit.declareFunction(functionDeclaration,
-		                                       currentScope)) {
-			messageBag.error(functionExprAst.getToken(),
+		if (!currentSourceUnit.get().declareFunction(functionDeclaration,
+		                                             currentScope)) {
+			messageBag.error(token(functionExprAst.token),
 			                 "could not declare function");
 		}
 
@@ -131,15 +149,17 @@ void TypeChecker::visitFunctionStatement(const ast::Function &functionExprAst) {
 		    .declaration = functionDeclaration,
 		    .function = functionExprAst,
 		};
-		std::vector<util::copy_ptr<lang::Type>> paramTypes;
+		std::vector<lang::TypeRef> paramTypes;
 		for (const auto &param : functionDeclaration.signature.parameters) {
-			paramTypes.push_back(
-			    util::copy_ptr<lang::Type>(param.parameterType));
+			paramTypes.push_back(param.parameterType);
 		}
 
 		// declaration was already defined, so it does not require to be defined
 		// again, just the body
-		if (functionExprAst.body.has_value()) {
+		if (functionExprAst.body) {
+			// parameters live in their own scope so they do not clash with
+			// the ones of other functions
+			auto &functionScope = makeChildScope();
 
 			// add functions to the current scope and validate that each
 			for (const auto &param : functionDeclaration.signature.parameters) {
@@ -151,22 +171,23 @@ void TypeChecker::visitFunctionStatement(const ast::Function &functionExprAst) {
 				    .type = lang::Symbol::SymbolType::Parameter,
 				    .internal = false,
 				};
-				if (!currentSourceUnit.declareLocalVariable(
+				if (!currentSourceUnit.get().declareLocalVariable(
 				        paramSymbol, getCurrentScope())) {
 					messageBag.bug(
-					    functionExprAst.token,
+					    token(functionExprAst.token),
 					    std::format("parameter '{} 'could not be defined",
 					                paramSymbol.name));
 				}
 			}
 			const auto type =
-			    resolveType(functionExprAst.body.value())
+			    resolveType(functionExprAst.body)
 			        .value_or(currentDataModel.get().getUnitType());
+			popScope(functionScope);
 
 			if (!type.coercercesInto(
 			        functionDeclaration.signature.returnType)) {
 				messageBag.error(
-				    functionExprAst.body->getToken(),
+				    getToken(functionExprAst.body),
 				    std::format(
 				        "inner body return type does not match with function return: '{}' vs '{}'",
 				        type.name,
@@ -179,30 +200,30 @@ void TypeChecker::visitFunctionStatement(const ast::Function &functionExprAst) {
 		typeStack.push_back(functionType);
 	}
 }
-void TypeChecker::visitIfStatement(const ast::If &ifStmt) {
-	auto conditionType = resolveType(*ifStmt.condition);
+void TypeChecker::visitIfStatement(const ast::flat::If &ifStmt) {
+	auto conditionType = resolveType(ifStmt.condition);
 	if (!conditionType.has_value()) {
-		messageBag.error(ifStmt.condition->getToken(), "non boolean condition");
+		messageBag.error(getToken(ifStmt.condition), "non boolean condition");
 	} else {
 		auto boolType = findScalarTypeInfo("bool");
 		// for now lets just stricly validate if is the same
 		// TODO: enable coercions
 		if (!(conditionType->coercercesInto(boolType.value()))) {
-			messageBag.error(ifStmt.condition->getToken(),
+			messageBag.error(getToken(ifStmt.condition),
 			                 "condition does not coerce into a bool type");
 		}
 	}
-	auto thenRType = resolveType(*ifStmt.thenBranch);
+	auto thenRType = resolveType(ifStmt.thenBranch);
 	auto thenType = thenRType.has_value() ? thenRType.value()
 	                                      : lang::Type::defineStmtType();
-	if (ifStmt.elseBranch.has_value()) {
-		auto elseRType = resolveType(*ifStmt.elseBranch.value());
+	if (ifStmt.elseBranch) {
+		auto elseRType = resolveType(ifStmt.elseBranch);
 		auto elseType = elseRType.has_value() ? elseRType.value()
 		                                      : lang::Type::defineStmtType();
 		// the types should match
 		if (!(thenType == elseType)) {
 			messageBag.error(
-			    ifStmt.getToken(),
+			    token(ifStmt.token),
 			    std::format("code branches have different types ({}|{})",
 			                thenType.name, elseType.name));
 		}
@@ -212,12 +233,12 @@ void TypeChecker::visitIfStatement(const ast::If &ifStmt) {
 
 	typeStack.push_back(thenType);
 }
-void TypeChecker::visitJumpStatement(const ast::Jump &jumpStmt) {
+void TypeChecker::visitJumpStatement(const ast::flat::Jump &jumpStmt) {
 	// if our expression is a return we need to return its optional value
 	// for anything else we do not care about its type
-	if (jumpStmt.token.type == Token::TokenType::TOKEN_RETURN) {
-		if (jumpStmt.returnValue.has_value()) {
-			auto type = resolveType(*jumpStmt.returnValue.value());
+	if (token(jumpStmt.token).type == Token::TokenType::TOKEN_RETURN) {
+		if (jumpStmt.returnValue) {
+			auto type = resolveType(jumpStmt.returnValue);
 			if (type.has_value()) {
 				typeStack.push_back(type.value());
 				return;
@@ -226,59 +247,61 @@ void TypeChecker::visitJumpStatement(const ast::Jump &jumpStmt) {
 	}
 	typeStack.push_back(lang::Type::defineStmtType());
 }
-void TypeChecker::visitVarDeclStatement(const ast::VarDecl &variableDeclAst) {
+void TypeChecker::visitVarDeclStatement(
+    const ast::flat::VarDecl &variableDeclAst) {
 	auto variableType = lang::Type{};
 
-	if (variableDeclAst.type->getToken().type !=
+	if (getToken(variableDeclAst.type).type !=
 	    Token::TokenType::TOKEN_UNINITIALIZED) {
 		const auto &explicitType = variableDeclAst.type;
-		std::string_view typeName = explicitType->getToken().lexeme;
-		auto foundType = resolveType(*explicitType);
+		std::string_view typeName = getToken(explicitType).lexeme;
+		auto foundType = resolveType(explicitType);
 		if (!foundType.has_value()) {
 			messageBag.error(
-			    variableDeclAst.type->getToken(),
+			    getToken(variableDeclAst.type),
 			    std::format("'{}' does not name an existing type", typeName));
 		} else {
 			variableType = foundType.value();
 		}
 	}
 
-	if (variableDeclAst.initializer.has_value()) {
-		auto &initializer = *variableDeclAst.initializer.value().get();
+	if (variableDeclAst.initializer) {
+		auto initializer = variableDeclAst.initializer;
 		auto initType = resolveType(initializer);
 		if (!initType.has_value()) {
 			messageBag.error(
-			    initializer.getToken(),
+			    getToken(initializer),
 			    std::format(
 			        "inialization expression did not yield a type for '{}'",
-			        initializer.getToken().getLexeme()));
+			        getToken(initializer).getLexeme()));
 		} else {
 			const auto initializationType = initType.value();
 			if (!variableType.isInitialized()) {
 				variableType = initializationType;
 			} else if (!initializationType.coercercesInto(variableType)) {
 				messageBag.error(
-				    variableDeclAst.getToken(),
+				    token(variableDeclAst.token),
 				    std::format(
 				        "variable initialization type does not match with explicit type for '{}': '{}' vs '{}'",
-				        variableDeclAst.getToken().getLexeme(),
+				        token(variableDeclAst.token).getLexeme(),
 				        variableType.name, initializationType.name));
 			}
 		}
 	}
 
 	if (variableType.isInitialized()) {
+		lang::InternedString variableName(token(variableDeclAst.name).lexeme);
 		lang::Symbol variableSymbol{
-		    .name = variableDeclAst.name.lexeme,
-		    .mangledName = variableDeclAst.name.lexeme,
+		    .name = variableName,
+		    .mangledName = variableName,
 		    .innerType = variableType,
 		    .type = lang::Symbol::SymbolType::Parameter,
 		    .internal = false,
 		};
 
-		if (!currentSourceUnit.declareLocalVariable(variableSymbol,
-		                                            getCurrentScope())) {
-			messageBag.bug(variableDeclAst.getToken(),
+		if (!currentSourceUnit.get().declareLocalVariable(
+		        variableSymbol, getCurrentScope())) {
+			messageBag.bug(token(variableDeclAst.token),
 			               std::format("variable '{} 'could not be defined",
 			                           variableSymbol.name));
 		}
@@ -287,45 +310,45 @@ void TypeChecker::visitVarDeclStatement(const ast::VarDecl &variableDeclAst) {
 	}
 
 	messageBag.error(
-	    variableDeclAst.getToken(),
+	    token(variableDeclAst.token),
 	    "variable does not have a valid type assigned nor an valid initialization");
 }
-void TypeChecker::visitMemberStatement(const ast::Member &variable) {
+void TypeChecker::visitMemberStatement(const ast::flat::Member &variable) {
 	auto variableType = lang::Type{};
 
-	if (variable.type->getToken().type !=
+	if (getToken(variable.type).type !=
 	    Token::TokenType::TOKEN_UNINITIALIZED) {
 		const auto &explicitType = variable.type;
-		std::string_view typeName = explicitType->getToken().lexeme;
-		auto foundType = resolveType(*explicitType);
+		std::string_view typeName = getToken(explicitType).lexeme;
+		auto foundType = resolveType(explicitType);
 		if (!foundType.has_value()) {
 			messageBag.error(
-			    variable.type->getToken(),
+			    getToken(variable.type),
 			    std::format("'{}' does not name an existing type", typeName));
 		} else {
 			variableType = foundType.value();
 		}
 	}
 
-	if (variable.initializer.has_value()) {
-		auto &initializer = *variable.initializer.value().get();
+	if (variable.initializer) {
+		auto initializer = variable.initializer;
 		auto initType = resolveType(initializer);
 		if (!initType.has_value()) {
 			messageBag.error(
-			    initializer.getToken(),
+			    getToken(initializer),
 			    std::format(
 			        "inialization expression did not yield a type for '{}'",
-			        initializer.getToken().getLexeme()));
+			        getToken(initializer).getLexeme()));
 		} else {
 			const auto initializationType = initType.value();
 			if (!variableType.isInitialized()) {
 				variableType = initializationType;
 			} else if (!initializationType.coercercesInto(variableType)) {
 				messageBag.error(
-				    variable.getToken(),
+				    token(variable.token),
 				    std::format(
 				        "member initialization type does not match with explicit type for '{}': '{}' vs '{}'",
-				        variable.getToken().getLexeme(), variableType.name,
+				        token(variable.token).getLexeme(), variableType.name,
 				        initializationType.name));
 			}
 		}
@@ -333,8 +356,8 @@ void TypeChecker::visitMemberStatement(const ast::Member &variable) {
 
 	if (variableType.isInitialized()) {
 		lang::Symbol variableSymbol{
-		    .name = variable.name.lexeme,
-		    .mangledName = "",
+		    .name = lang::InternedString(token(variable.name).lexeme),
+		    .mangledName = {},
 		    .innerType = variableType,
 		    .type = lang::Symbol::SymbolType::Parameter,
 		    .internal = false,
@@ -344,30 +367,32 @@ void TypeChecker::visitMemberStatement(const ast::Member &variable) {
 	}
 
 	messageBag.error(
-	    variable.getToken(),
+	    token(variable.token),
 	    "variable does not have a type assigned nor an valid initialization");
 }
-void TypeChecker::visitWhileStatement(const ast::While &whileStmt) {
-	auto conditionType = resolveType(*whileStmt.condition);
+void TypeChecker::visitWhileStatement(const ast::flat::While &whileStmt) {
+	auto conditionType = resolveType(whileStmt.condition);
 	if (!conditionType.has_value()) {
-		messageBag.error(whileStmt.condition->getToken(),
+		messageBag.error(getToken(whileStmt.condition),
 		                 "non boolean condition");
 	} else {
 		auto boolType = findScalarTypeInfo("bool");
 		// for now lets just stricly validate if is the same
 		// TODO: enable coercions
 		if (!(conditionType->coercercesInto(boolType.value()))) {
-			messageBag.error(whileStmt.condition->getToken(),
+			messageBag.error(getToken(whileStmt.condition),
 			                 "condition does not coerce into a bool type");
 		}
 	}
 
 	const auto type =
-	    resolveType(*whileStmt.body).value_or(lang::Type::defineStmtType());
+	    resolveType(whileStmt.body).value_or(lang::Type::defineStmtType());
 
 	typeStack.push_back(type);
 }
-void TypeChecker::visitStructStatement(const ast::Struct &structObj) {
+void TypeChecker::visitStructStatement(const ast::flat::Struct &structObj) {
+	TraceRecorder::Span span("declaration", "check struct",
+	                         token(structObj.name).lexeme);
 
 	std::string currentModule;
 
@@ -387,29 +412,30 @@ void TypeChecker::visitStructStatement(const ast::Struct &structObj) {
 		directivesStack.pop_back();
 	}
 
-	std::string structName = std::string(structObj.name.getLexeme());
+	lang::InternedString structName(token(structObj.name).getLexeme());
 	std::string mangledStructName =
-	    passes::mangling::NameMangler().mangleStruct(currentModule, structObj,
-	                                                 linkageDirective);
+	    passes::mangling::NameMangler().mangleStruct(
+	        currentModule, token(structObj.name).lexeme, linkageDirective);
 
 	// TODO: rework this section to just verify the existing struct
 	return;
 	if (!structObj.declaration) {
 		std::vector<lang::StructMember> members;
-		for (const auto &member : structObj.members) {
-			auto memberType = resolveType(member);
+		for (auto memberId : tree().range(structObj.members)) {
+			const auto &member = tree().get<ast::flat::Member>(memberId);
+			auto memberType = resolveType(memberId);
 			if (!memberType.has_value()) {
 				messageBag.error(
-				    member.getToken(),
+				    token(member.token),
 				    std::format("could not get type information for '{}'",
-				                member.name.lexeme));
+				                token(member.name).lexeme));
 				memberType = lang::Type::defineUnknownType();
 			}
 
 			auto newMember = lang::StructMember{
 			    // for now set it as false, we will take care of it later
 			    .publicVisibility = false,
-			    .name = member.name.lexeme,
+			    .name = lang::InternedString(token(member.name).lexeme),
 			    .type = memberType.value(),
 			};
 			members.push_back(newMember);
@@ -417,20 +443,20 @@ void TypeChecker::visitStructStatement(const ast::Struct &structObj) {
 
 		auto newStruct = lang::Struct{
 		    .name = structName,
-		    .mangledName = mangledStructName,
+		    .mangledName = lang::InternedString(mangledStructName),
 		    .members = members,
 		};
 
 		// TODO: remove declaration sections for type checker
 		// if (currentSourceUnit.bindStruct(newStruct, currentScope.get())) {
-		//	messageBag.error(structObj.getToken(),
+		//	messageBag.error(token(structObj.token),
 		//	                 std::format("could not bind struct with name {}",
-		//	                             structObj.name.getLexeme()));
+		//	                             token(structObj.name).getLexeme()));
 		//}
 	}
 
 	size_t structId = 0;
-	auto foundStruct = currentSourceUnit.findStruct(structName, currentScope);
+	auto foundStruct = currentSourceUnit.get().findStruct(structName);
 	if (foundStruct.has_value()) {
 		structId = foundStruct.value().get().structID;
 	}
@@ -439,9 +465,9 @@ void TypeChecker::visitStructStatement(const ast::Struct &structObj) {
 	typeStack.push_back(structType);
 }
 void TypeChecker::visitCompDirectiveStatement(
-    const ast::CompDirective &compDirectiveAst) {
-	auto directiveToken = compDirectiveAst.name;
-	auto directiveName = compDirectiveAst.name.getLexeme();
+    const ast::flat::CompDirective &compDirectiveAst) {
+	auto directiveToken = token(compDirectiveAst.name);
+	auto directiveName = token(compDirectiveAst.name).getLexeme();
 	if (directiveName == "Linkage") {
 		auto &attributes = compDirectiveAst.values;
 		auto directive = directive::LinkageDirective(
@@ -457,47 +483,48 @@ void TypeChecker::visitCompDirectiveStatement(
 		        : directive::LinkageDirective::ManglingType::Default,
 		    directiveToken);
 		if (compDirectiveAst.child) {
-			auto childValue = compDirectiveAst.child.get();
-			if (dynamic_cast<ast::Function *>(childValue) ||
-			    dynamic_cast<ast::Struct *>(childValue)) {
+			auto childKind = tree().kind(compDirectiveAst.child);
+			if (childKind == ast::flat::NodeKind::Function ||
+			    childKind == ast::flat::NodeKind::Struct) {
 				size_t startDirectives = directivesStack.size();
 				size_t originalTop = directivesStackTop + 1;
 				directivesStackTop = startDirectives;
 				directivesStack.push_back(
 				    std::make_unique<directive::LinkageDirective>(directive));
-				auto directiveType = resolveType(*compDirectiveAst.child);
+				auto directiveType = resolveType(compDirectiveAst.child);
 				if (directiveType.has_value()) {
 					typeStack.push_back(directiveType.value());
 				}
 				if (directivesStack.size() != startDirectives) {
-					messageBag.bug(childValue->getToken(),
+					messageBag.bug(getToken(compDirectiveAst.child),
 					               "unprocessed compiler directives");
 				}
 
 				directivesStackTop = originalTop;
 			} else {
 				messageBag.error(
-				    childValue->getToken(),
+				    getToken(compDirectiveAst.child),
 				    std::format(
 				        "{} child expression must be a function or a struct.",
 				        directive.directiveName()));
 			}
 		} else {
-			messageBag.error(compDirectiveAst.getToken(),
+			messageBag.error(token(compDirectiveAst.token),
 			                 std::format("{} must have a child expression.",
 			                             directive.directiveName()));
 		}
 	} else {
 		messageBag.error(
-		    compDirectiveAst.getToken(),
+		    token(compDirectiveAst.token),
 		    std::format("Unknown compiler directive '{}'.", directiveName));
 	}
 }
 // Expression
-void TypeChecker::visitVariableExpression(const ast::Variable &variableExpr) {
+void TypeChecker::visitVariableExpression(
+    const ast::flat::Variable &variableExpr) {
 
 	auto foundVariable =
-	    getCurrentScope().findVariable(variableExpr.name.lexeme);
+	    currentSourceUnit.get().findVariable(token(variableExpr.name).lexeme);
 	if (foundVariable.has_value()) {
 		typeStack.push_back(foundVariable.value().getObject()->get().innerType);
 		return;
@@ -507,8 +534,8 @@ void TypeChecker::visitVariableExpression(const ast::Variable &variableExpr) {
 	// an overloadedFunction Type
 	lang::Type functionType;
 	for (const auto &functionDeclarationRef :
-	     currentSourceUnit.findFunctionDeclarations(variableExpr.name.lexeme,
-	                                                getCurrentScope())) {
+	     currentSourceUnit.get().findFunctionDeclarations(
+	         token(variableExpr.name).lexeme)) {
 		assert(functionDeclarationRef.getObject().has_value());
 		const auto &functionDeclaration =
 		    functionDeclarationRef.getObject()->get();
@@ -526,39 +553,39 @@ void TypeChecker::visitVariableExpression(const ast::Variable &variableExpr) {
 	if (functionType.isInitialized()) {
 		typeStack.push_back(functionType);
 	} else {
-		messageBag.error(variableExpr.getToken(),
+		messageBag.error(token(variableExpr.token),
 		                 std::format("unknown symbol '{}'",
-		                             variableExpr.getToken().getLexeme()));
+		                             token(variableExpr.token).getLexeme()));
 	}
 	// we did not find anything so do not bother and report an error
 	return;
 }
-void TypeChecker::visitIntrinsicExpression(const ast::Intrinsic &value) {
-	messageBag.bug(value.getToken(),
+void TypeChecker::visitIntrinsicExpression(const ast::flat::Intrinsic &value) {
+	messageBag.bug(token(value.token),
 	               std::format("visit method not implemented for {}",
 	                           value.variantName()));
 }
-void TypeChecker::visitAssignExpression(const ast::Assign &assignExpr) {
-	auto leftType = resolveType(*assignExpr.lhs);
-	auto rightType = resolveType(*assignExpr.rhs);
+void TypeChecker::visitAssignExpression(const ast::flat::Assign &assignExpr) {
+	auto leftType = resolveType(assignExpr.lhs);
+	auto rightType = resolveType(assignExpr.rhs);
 
 	if (!(leftType.has_value() && rightType.has_value())) {
 		if (!leftType.has_value()) {
 			messageBag.error(
-			    assignExpr.lhs->getToken(),
+			    getToken(assignExpr.lhs),
 			    std::format("left expression did not yield a value"));
 		}
 
 		if (!rightType.has_value()) {
 			messageBag.error(
-			    assignExpr.rhs->getToken(),
+			    getToken(assignExpr.rhs),
 			    std::format("right expression did not yield a value"));
 			return;
 		}
 		return;
 	}
 
-	auto op = assignExpr.assignmentOp;
+	auto op = token(assignExpr.assignmentOp);
 	// TODO: once we start supporting operator overload this should be done by
 	// lookup of the overloads and get the return type of it
 	switch (op.type) {
@@ -583,26 +610,26 @@ void TypeChecker::visitAssignExpression(const ast::Assign &assignExpr) {
 		break;
 	}
 }
-void TypeChecker::visitBinaryExpression(const ast::Binary &binaryExpr) {
-	auto leftType = resolveType(*binaryExpr.left);
-	auto rightType = resolveType(*binaryExpr.right);
+void TypeChecker::visitBinaryExpression(const ast::flat::Binary &binaryExpr) {
+	auto leftType = resolveType(binaryExpr.left);
+	auto rightType = resolveType(binaryExpr.right);
 
 	if (!(leftType.has_value() && rightType.has_value())) {
 		if (!leftType.has_value()) {
 			messageBag.error(
-			    binaryExpr.left->getToken(),
+			    getToken(binaryExpr.left),
 			    std::format("left expression did not yield a value"));
 		}
 
 		if (!rightType.has_value()) {
 			messageBag.error(
-			    binaryExpr.right->getToken(),
+			    getToken(binaryExpr.right),
 			    std::format("right expression did not yield a value"));
 		}
 		return;
 	}
 
-	auto op = binaryExpr.op;
+	auto op = token(binaryExpr.op);
 	// TODO: once we start supporting operator overload this should be done by
 	// lookup of the overloads and get the return type of it
 	switch (op.type) {
@@ -628,17 +655,17 @@ void TypeChecker::visitBinaryExpression(const ast::Binary &binaryExpr) {
 		typeStack.push_back(findScalarTypeInfo("bool").value());
 		break;
 	default:
-		messageBag.error(binaryExpr.op,
+		messageBag.error(op,
 		                 std::format("'{}' is not a supported binary operation",
 		                             op.getLexeme()));
 	}
 }
-void TypeChecker::visitCallExpression(const ast::Call &callExpr) {
-	auto calleeTypeResult = resolveType(*callExpr.callee);
+void TypeChecker::visitCallExpression(const ast::flat::Call &callExpr) {
+	auto calleeTypeResult = resolveType(callExpr.callee);
 	if (!calleeTypeResult.has_value()) {
-		messageBag.error(callExpr.getToken(),
+		messageBag.error(token(callExpr.token),
 		                 std::format("unknown callee type for {}",
-		                             callExpr.callee->getToken().getLexeme()));
+		                             getToken(callExpr.callee).getLexeme()));
 		return;
 	}
 	auto calleeType = calleeTypeResult.value();
@@ -648,38 +675,39 @@ void TypeChecker::visitCallExpression(const ast::Call &callExpr) {
 	case lang::TypeKind::pointer: {
 		if (!calleeType.signature.has_value()) {
 			messageBag.error(
-			    callExpr.getToken(),
+			    token(callExpr.token),
 			    std::format(
 			        "expression does not have a valid signature for '{}'",
-			        callExpr.getToken().getLexeme()));
+			        token(callExpr.token).getLexeme()));
 			break;
 		}
 		// valid signature
 		if (callExpr.arguments.size() != calleeType.signature->size()) {
 			messageBag.error(
-			    callExpr.getToken(),
+			    token(callExpr.token),
 			    std::format(
 			        "parameter number mismatch for '{}', provided {}, but {} were required",
-			        callExpr.getToken().getLexeme(), callExpr.arguments.size(),
+			        token(callExpr.token).getLexeme(),
+			        callExpr.arguments.size(),
 			        calleeType.signature->size()));
 		}
 		for (size_t i = 0; i < callExpr.arguments.size(); i++) {
-			const auto &callerParamExpr = *callExpr.arguments[i];
+			auto callerParamExpr = tree().range(callExpr.arguments)[i];
 			const auto callerParamTypeResult = resolveType(callerParamExpr);
 			const auto &calleeParamType = *calleeType.signature.value()[i];
 
 			if (!callerParamTypeResult.has_value()) {
 				messageBag.error(
-				    callerParamExpr.getToken(),
+				    getToken(callerParamExpr),
 				    std::format("argument does not yield a valid type for '{}'",
-				                callerParamExpr.getToken().getLexeme()));
+				                getToken(callerParamExpr).getLexeme()));
 				return;
 			}
 			const auto &callerParamType = callerParamTypeResult.value();
 
 			if (!callerParamType.coercercesInto(calleeParamType)) {
 				messageBag.error(
-				    callerParamExpr.getToken(),
+				    getToken(callerParamExpr),
 				    std::format(
 				        "argument #'{}' does not matches the expected type {} vs {}",
 				        i, callerParamType.name, calleeParamType.name));
@@ -691,86 +719,160 @@ void TypeChecker::visitCallExpression(const ast::Call &callExpr) {
 	}
 	case lang::TypeKind::scalar:
 	case lang::TypeKind::aggregate: {
-		messageBag.error(callExpr.getToken(), "not valid call expression");
+		messageBag.error(token(callExpr.token), "not valid call expression");
 		break;
 	}
 	case lang::TypeKind::abstract: {
 		if (calleeType.overloaded) {
 			messageBag.bug(
-			    callExpr.getToken(),
+			    token(callExpr.token),
 			    std::format("overloaded functions not supported yet"));
 			return;
 		}
 		break;
 	}
 	default: {
-		messageBag.bug(callExpr.getToken(), "unsupported type call");
+		messageBag.bug(token(callExpr.token), "unsupported type call");
 		break;
 	}
 	}
 	if (!calleeType.subtype.has_value()) {
 		messageBag.bug(
-		    callExpr.getToken(),
+		    token(callExpr.token),
 		    std::format("expression does not have a return type for '{}'",
-		                callExpr.getToken().getLexeme()));
+		                token(callExpr.token).getLexeme()));
 		return;
 	}
 	typeStack.push_back(*calleeType.subtype.value());
 }
 void TypeChecker::visitIntrinsicCallExpression(
-    const ast::IntrinsicCall &intrinsicCall) {
+    const ast::flat::IntrinsicCall &intrinsicCall) {
 
-	switch (intrinsicCall.callee->intrinsic) {
+	const auto &callee = tree().get<ast::flat::Intrinsic>(intrinsicCall.callee);
+	switch (callee.intrinsic) {
 	case ray::compiler::ast::IntrinsicType::INTR_SIZEOF: {
 		if (intrinsicCall.arguments.size() != 1) {
 			messageBag.error(
-			    intrinsicCall.callee->name,
+			    token(callee.name),
 			    std::format(
 			        "{} intrinsic expects 1 argument but {} got provided",
-			        intrinsicCall.callee->name.lexeme,
+			        token(callee.name).lexeme,
 			        intrinsicCall.arguments.size()));
 		} else {
-			auto param = intrinsicCall.arguments[0].get();
-			auto paramType = resolveType(*param);
-			if (paramType.has_value()) {
-				// TODO: check the type and then return the size type
+			// the argument names a type, the C backend emits its size as an
+			// ssize constant
+			auto param = tree().range(intrinsicCall.arguments)[0];
+			const auto *typeName = tree().tryGet<ast::flat::Variable>(param);
+			if (typeName == nullptr ||
+			    !findTypeInfo(token(typeName->name).lexeme).has_value()) {
+				messageBag.error(getToken(param),
+				                 std::format("'{}' does not name a type",
+				                             getToken(param).getLexeme()));
+				break;
 			}
+			typeStack.push_back(findScalarTypeInfo("ssize").value());
 		}
 		break;
 	}
 	case ray::compiler::ast::IntrinsicType::INTR_IMPORT: {
 		if (intrinsicCall.arguments.size() != 1) {
-			messageBag.error(intrinsicCall.callee->name,
+			messageBag.error(token(callee.name),
 			                 std::format("{} intrinsic expects 1 "
 			                             "argument but {} got provided",
-			                             intrinsicCall.callee->name.lexeme,
+			                             token(callee.name).lexeme,
 			                             intrinsicCall.arguments.size()));
 		} else {
-			auto moduleType = lang::Type::defineModuleType();
-			// TODO: create a module provided to idenity known module data
-			typeStack.push_back(moduleType);
+			// the store loaded every literal import before checking
+			auto param = tree().range(intrinsicCall.arguments)[0];
+			const auto *path = tree().tryGet<ast::flat::Literal>(param);
+			if (path == nullptr ||
+			    token(path->kind).type != Token::TokenType::TOKEN_STRING) {
+				messageBag.error(getToken(param),
+				                 std::format("{} expects a string literal path",
+				                             token(callee.name).lexeme));
+				break;
+			}
+			auto moduleId =
+			    moduleStore.get().findModule(path->value, importer);
+			if (!moduleId.has_value()) {
+				messageBag.error(token(callee.name),
+				                 std::format("module '{}' was not loaded",
+				                             path->value));
+				break;
+			}
+			typeStack.push_back(lang::Type::defineModuleType(*moduleId));
 		}
 
 		break;
 	}
 	case ray::compiler::ast::IntrinsicType::INTR_UNKNOWN:
-		messageBag.error(intrinsicCall.callee->name,
+		messageBag.error(token(callee.name),
 		                 std::format("'{}' is not a valid intrinsic",
-		                             intrinsicCall.callee->name.lexeme));
+		                             token(callee.name).lexeme));
 		break;
 	}
 }
-void TypeChecker::visitGetExpression(const ast::Get &getExpression) {}
-void TypeChecker::visitGroupingExpression(const ast::Grouping &groupingExpr) {
+void TypeChecker::visitGetExpression(const ast::flat::Get &getExpression) {
+	auto objectType = resolveType(getExpression.object);
+	if (!objectType.has_value()) {
+		messageBag.error(getToken(getExpression.object),
+		                 std::format("'{}' did not yield a value",
+		                             getToken(getExpression.object).lexeme));
+		return;
+	}
+	const Token &name = token(getExpression.name);
+	// TODO: struct members
+	if (!objectType->isModule()) {
+		messageBag.error(name,
+		                 std::format("'{}' has no member '{}'",
+		                             objectType->name, name.getLexeme()));
+		return;
+	}
+
+	// only the public functions of a module are visible to its importers,
+	// resolved the same way as a variable naming a function
+	const auto &module = moduleStore.get().getModule(
+	    static_cast<lang::ModuleId>(objectType->typeId));
+	lang::Type functionType;
+	for (const auto &functionDeclarationRef :
+	     module.sourceUnit.findFunctionDeclarations(name.lexeme)) {
+		assert(functionDeclarationRef.getObject().has_value());
+		const auto &functionDeclaration =
+		    functionDeclarationRef.getObject()->get();
+		if (!functionDeclaration.publicVisibility) {
+			continue;
+		}
+		if (!functionType.isInitialized()) {
+			functionType =
+			    functionDeclaration.signature.getFunctionType(currentDataModel);
+		} else {
+			functionType =
+			    functionDeclaration.signature.getOverloadedFunctionType(
+			        currentDataModel);
+			break;
+		}
+	}
+
+	if (functionType.isInitialized()) {
+		typeStack.push_back(functionType);
+	} else {
+		messageBag.error(name, std::format("module '{}' has no public member "
+		                                   "'{}'",
+		                                   module.path.string(),
+		                                   name.getLexeme()));
+	}
+}
+void TypeChecker::visitGroupingExpression(
+    const ast::flat::Grouping &groupingExpr) {
 	// the type of the grouping is just the child of the inner expression
-	auto innerType = resolveType(*groupingExpr.expression);
+	auto innerType = resolveType(groupingExpr.expression);
 
 	if (innerType.has_value()) {
 		typeStack.push_back(innerType.value());
 	}
 }
-void TypeChecker::visitLiteralExpression(const ast::Literal &literalAst) {
-	switch (literalAst.kind.type) {
+void TypeChecker::visitLiteralExpression(const ast::flat::Literal &literalAst) {
+	switch (token(literalAst.kind).type) {
 
 	case Token::TokenType::TOKEN_STRING: {
 		const auto baseType =
@@ -783,12 +885,12 @@ void TypeChecker::visitLiteralExpression(const ast::Literal &literalAst) {
 	}
 	case Token::TokenType::TOKEN_NUMBER: {
 		auto type = currentDataModel.get().getNumberLiteralType(
-		    literalAst.token.lexeme);
+		    token(literalAst.token).lexeme);
 		if (!type.has_value()) {
 			messageBag.error(
-			    literalAst.getToken(),
+			    token(literalAst.token),
 			    std::format("'{}' cannot be hold in any scalar number type",
-			                literalAst.getToken().getLexeme()));
+			                token(literalAst.token).getLexeme()));
 			return;
 		}
 		typeStack.push_back(type.value());
@@ -800,9 +902,9 @@ void TypeChecker::visitLiteralExpression(const ast::Literal &literalAst) {
 		const std::string_view character = literalAst.value;
 		if (character.size() > 1) {
 			messageBag.error(
-			    literalAst.getToken(),
+			    token(literalAst.token),
 			    std::format("'{}' is not a valid char literal type",
-			                literalAst.getToken().getLexeme()));
+			                token(literalAst.token).getLexeme()));
 			break;
 		}
 		typeStack.push_back(
@@ -810,32 +912,33 @@ void TypeChecker::visitLiteralExpression(const ast::Literal &literalAst) {
 		break;
 	}
 	default:
-		messageBag.error(literalAst.getToken(),
+		messageBag.error(token(literalAst.token),
 		                 std::format("'{}' is not a valid literal type",
-		                             literalAst.getToken().getLexeme()));
+		                             token(literalAst.token).getLexeme()));
 		break;
 	}
 }
-void TypeChecker::visitLogicalExpression(const ast::Logical &logicalExpr) {
-	auto leftType = resolveType(*logicalExpr.left);
-	auto rightType = resolveType(*logicalExpr.right);
+void TypeChecker::visitLogicalExpression(
+    const ast::flat::Logical &logicalExpr) {
+	auto leftType = resolveType(logicalExpr.left);
+	auto rightType = resolveType(logicalExpr.right);
 
 	if (!(leftType.has_value() && rightType.has_value())) {
 		if (!leftType.has_value()) {
 			messageBag.error(
-			    logicalExpr.left->getToken(),
+			    getToken(logicalExpr.left),
 			    std::format("left expression did not yield a value"));
 		}
 
 		if (!rightType.has_value()) {
 			messageBag.error(
-			    logicalExpr.right->getToken(),
+			    getToken(logicalExpr.right),
 			    std::format("right expression did not yield a value"));
 		}
 		return;
 	}
 
-	auto op = logicalExpr.op;
+	auto op = token(logicalExpr.op);
 	// TODO: once we start supporting operator overload this should be done by
 	// lookup of the overloads and get the return type of it
 	switch (op.type) {
@@ -846,60 +949,61 @@ void TypeChecker::visitLogicalExpression(const ast::Logical &logicalExpr) {
 		break;
 	default:
 		messageBag.error(
-		    logicalExpr.op,
+		    op,
 		    std::format("'{}' is not a supported logical operation",
 		                op.getLexeme()));
 	}
 }
-void TypeChecker::visitSetExpression(const ast::Set &value) {
-	messageBag.bug(value.getToken(),
+void TypeChecker::visitSetExpression(const ast::flat::Set &value) {
+	messageBag.bug(token(value.token),
 	               std::format("visit method not implemented for {}",
 	                           value.variantName()));
 }
-void TypeChecker::visitUnaryExpression(const ast::Unary &unaryExpr) {
+void TypeChecker::visitUnaryExpression(const ast::flat::Unary &unaryExpr) {
 	// assume that it returns the same type until we implement operator overload
 	// where we will treat each operator a a function
 
-	auto innerType = resolveType(*unaryExpr.expr);
+	auto innerType = resolveType(unaryExpr.expr);
 	if (!innerType.has_value()) {
-		messageBag.error(unaryExpr.getToken(),
+		messageBag.error(token(unaryExpr.token),
 		                 "inner expression did not yield a type");
 		return;
 	}
 	typeStack.push_back(innerType.value());
 }
 void TypeChecker::visitArrayAccessExpression(
-    const ast::ArrayAccess &arrayExpr) {
-	const auto accessedTypeR = resolveType(*arrayExpr.array);
+    const ast::flat::ArrayAccess &arrayExpr) {
+	const auto accessedTypeR = resolveType(arrayExpr.array);
 	if (!accessedTypeR.has_value()) {
-		messageBag.error(arrayExpr.array->getToken(),
+		messageBag.error(getToken(arrayExpr.array),
 		                 std::format("could not evaluate type for {}",
-		                             arrayExpr.array->getToken().getLexeme()));
+		                             getToken(arrayExpr.array).getLexeme()));
 		return;
 	}
 	const auto accessedType = accessedTypeR.value();
 	// TODO: actually resolve with operator overload its return type
 	if (!accessedType.subtype.has_value()) {
-		messageBag.error(arrayExpr.array->getToken(),
+		messageBag.error(getToken(arrayExpr.array),
 		                 std::format("could not evaluate sub type for {}",
-		                             arrayExpr.array->getToken().getLexeme()));
+		                             getToken(arrayExpr.array).getLexeme()));
 		return;
 	}
 	const auto subType = accessedType.subtype.value();
 
 	typeStack.push_back(*subType);
 }
-void TypeChecker::visitArrayTypeExpression(const ast::ArrayType &arrayTypeAst) {
-	auto innerType = resolveType(*arrayTypeAst.subType)
+void TypeChecker::visitArrayTypeExpression(
+    const ast::flat::ArrayType &arrayTypeAst) {
+	auto innerType = resolveType(arrayTypeAst.subType)
 	                     .value_or(lang::Type::defineUnknownType());
 	if (innerType == lang::Type::defineUnknownType()) {
-		messageBag.bug(arrayTypeAst.subType->getToken(),
+		messageBag.bug(getToken(arrayTypeAst.subType),
 		               std::format("inner array type is unknown for '{}'",
-		                           arrayTypeAst.subType->getToken().lexeme));
+		                           getToken(arrayTypeAst.subType).lexeme));
 		return;
 	}
 	if (innerType.getKind() == lang::TypeKind::abstract) {
-		messageBag.error(arrayTypeAst.subType->getToken(),
+		messageBag.error(getToken(arrayTypeAst.subType),
 		                 "arrays cannot hold abstract types");
 		return;
 	}
@@ -907,7 +1011,8 @@ void TypeChecker::visitArrayTypeExpression(const ast::ArrayType &arrayTypeAst) {
 	    innerType, arrayTypeAst.isMutable);
 	typeStack.push_back(arrayType);
 }
-void TypeChecker::visitTupleTypeExpression(const ast::TupleType &tupleAst) {
+void TypeChecker::visitTupleTypeExpression(
+    const ast::flat::TupleType &tupleAst) {
 	if (tupleAst.expressions.empty()) {
 		auto unitType = currentDataModel.get().getUnitType();
 		unitType.isMutable = tupleAst.isMutable;
@@ -915,121 +1020,106 @@ void TypeChecker::visitTupleTypeExpression(const ast::TupleType &tupleAst) {
 		return;
 	}
 
-	messageBag.bug(tupleAst.getToken(),
+	messageBag.bug(token(tupleAst.token),
 	               std::format("{} not implemented for non empty tuples",
 	                           __PRETTY_FUNCTION__));
 }
 
 void TypeChecker::visitPointerTypeExpression(
-    const ast::PointerType &pointerTypeAst) {
-	auto subTypeResult = resolveType(*pointerTypeAst.subtype);
+    const ast::flat::PointerType &pointerTypeAst) {
+	auto subTypeResult = resolveType(pointerTypeAst.subtype);
 	if (!subTypeResult.has_value()) {
-		messageBag.error(pointerTypeAst.token, "pointer subtype is unknown");
+		messageBag.error(token(pointerTypeAst.token),
+		                 "pointer subtype is unknown");
 		return;
 	}
 
 	typeStack.push_back(currentDataModel.get().definePointerType(
 	    subTypeResult.value(), pointerTypeAst.isMutable));
 }
-void TypeChecker::visitNamedTypeExpression(const ast::NamedType &typeAst) {
-	auto result = findTypeInfo(typeAst.name.lexeme);
+void TypeChecker::visitNamedTypeExpression(
+    const ast::flat::NamedType &typeAst) {
+	auto result = findTypeInfo(token(typeAst.name).lexeme);
 	if (result.has_value()) {
 		lang::Type obtainedType = result.value();
 		obtainedType.isMutable = typeAst.isMutable;
 		typeStack.push_back(obtainedType);
 	} else {
 		messageBag.error(
-		    typeAst.getToken(),
-		    std::format("type not found for {}", typeAst.name.lexeme));
+		    token(typeAst.token),
+		    std::format("type not found for {}", token(typeAst.name).lexeme));
 		typeStack.push_back(lang::Type::defineUnknownType());
 	}
 }
-void TypeChecker::visitCastExpression(const ast::Cast &castExpr) {
+void TypeChecker::visitCastExpression(const ast::flat::Cast &castExpr) {
 	// TODO: remove cast expression and make it a compiler intrinsic for scalars
 	// additionally make the propper checks, for now we just blindly cast the
 	// expression
-	auto type = resolveType(*castExpr.type);
+	auto type = resolveType(castExpr.type);
 	if (!type.has_value()) {
 		messageBag.error(
-		    castExpr.getToken(),
+		    token(castExpr.token),
 		    std::format("cast expression type '{}' did not yield a known type",
-		                castExpr.getToken().getLexeme()));
+		                token(castExpr.token).getLexeme()));
 		return;
 	}
 	typeStack.push_back(type.value());
 }
-void TypeChecker::visitParameterExpression(const ast::Parameter &parameter) {
-	const auto type = resolveType(*parameter.type.get());
+void TypeChecker::visitParameterExpression(
+    const ast::flat::Parameter &parameter) {
+	const auto type = resolveType(parameter.type);
 	if (!type.has_value()) {
 		messageBag.error(
-		    parameter.getToken(),
+		    token(parameter.token),
 		    std::format("parameter '{}' does not have a known type",
-		                parameter.name.getLexeme()));
+		                token(parameter.name).getLexeme()));
 		return;
 	}
 
 	typeStack.push_back(type.value());
 }
 
-std::optional<lang::Type>
-TypeChecker::resolveType(const ast::Statement &statement) {
-	auto types = resolveTypes(statement);
+std::optional<lang::Type> TypeChecker::resolveType(ast::flat::NodeId node) {
+	auto types = resolveTypes(node);
 
 	if (types.size() > 1) {
-		// check wether the return types coerce
-		for (size_t i = 1; i < types.size(); i++) {
-			if (!types[0].coercercesInto(types[i])) {
-				messageBag.bug(
-				    statement.getToken(),
-				    std::format(
-				        "'{}' return types does not match for '{}' vs '{}'",
-				        statement.variantName(), types[0].name, types[i].name));
+		if (ast::flat::isStatement(tree().kind(node))) {
+			// check wether the return types coerce
+			for (size_t i = 1; i < types.size(); i++) {
+				if (!types[0].coercercesInto(types[i])) {
+					messageBag.bug(
+					    getToken(node),
+					    std::format(
+					        "'{}' return types does not match for '{}' vs '{}'",
+					        tree().variantName(node), types[0].name,
+					        types[i].name));
+				}
 			}
+		} else {
+			messageBag.bug(getToken(node),
+			               std::format("'{}' yield multiple values",
+			                           tree().variantName(node)));
 		}
 	}
 
 	return types.size() > 0 ? std::optional<lang::Type>(types[0])
 	                        : std::nullopt;
 }
-std::optional<lang::Type>
-TypeChecker::resolveType(const ast::Expression &expression) {
-	auto types = resolveTypes(expression);
-
-	if (types.size() > 1) {
-		messageBag.bug(expression.getToken(),
-		               std::format("'{}' yield multiple values",
-		                           expression.variantName()));
-	}
-
-	return types.size() > 0 ? std::optional<lang::Type>(types[0])
-	                        : std::nullopt;
-}
-std::vector<lang::Type>
-TypeChecker::resolveTypes(const ast::Statement &statement) {
-	std::vector<lang::Type> returnTypes;
-	size_t tsSize = typeStack.size();
-	statement.visit(*this);
-	while (typeStack.size() > tsSize) {
-		auto returnType = typeStack.back();
-		typeStack.pop_back();
-		returnTypes.push_back(returnType);
-	}
-	return returnTypes;
-}
-std::vector<lang::Type>
-TypeChecker::resolveTypes(const ast::Expression &expression) {
+std::vector<lang::Type> TypeChecker::resolveTypes(ast::flat::NodeId node) {
 	std::vector<lang::Type> returnTypes;
 	size_t tsSize = typeStack.size();
-	expression.visit(*this);
+	visit(node);
+	typeStackPeak = std::max(typeStackPeak, typeStack.size());
 	while (typeStack.size() > tsSize) {
 		auto returnType = typeStack.back();
 		typeStack.pop_back();
 		returnTypes.push_back(returnType);
 	}
-	if (returnTypes.size() < 1) {
-		messageBag.bug(expression.getToken(),
+	// statements are not required to yield a type
+	if (returnTypes.size() < 1 && ast::flat::isExpression(tree().kind(node))) {
+		messageBag.bug(getToken(node),
 		               std::format("'{}' did not resolve a type",
-		                           expression.variantName()));
+		                           tree().variantName(node)));
 		typeStack.push_back(lang::Type::defineUnknownType());
 	}
 	return returnTypes;
@@ -1046,7 +1136,7 @@ TypeChecker::findTypeInfo(const std::string_view typeName) {
 		return scalarType;
 	}
 	// a defined type in the source unit cannot shadow a primitive/scalar type
-	auto foundStruct = currentSourceUnit.findStruct(typeName, currentScope);
+	auto foundStruct = currentSourceUnit.get().findStruct(typeName);
 	if (foundStruct.has_value()) {
 		return currentDataModel.get().defineStructType(
 		    foundStruct.value().get().structID, foundStruct.value().get().name,
@@ -1057,7 +1147,8 @@ TypeChecker::findTypeInfo(const std::string_view typeName) {
 }
 
 std::optional<lang::FunctionDeclaration>
-TypeChecker::resolveFunctionDeclaration(const ast::Function &functionAst) {
+TypeChecker::resolveFunctionDeclaration(
+    const ast::flat::Function &functionAst) {
 	std::string currentModule;
 
 	std::optional<directive::LinkageDirective> linkageDirective;
@@ -1072,30 +1163,32 @@ TypeChecker::resolveFunctionDeclaration(const ast::Function &functionAst) {
 			    directive->getToken(),
 			    std::format(
 			        "unmatched compiler directive '{}' for function '{}'",
-			        directive->directiveName(), functionAst.name.getLexeme()));
+			        directive->directiveName(),
+			        token(functionAst.name).getLexeme()));
 		}
 		directivesStack.pop_back();
 	}
 	std::string mangledFunctionName =
 	    passes::mangling::NameMangler().mangleFunction(
-	        currentModule, functionAst, linkageDirective);
+	        currentModule, token(functionAst.name).lexeme, linkageDirective);
 
 	std::vector<lang::FunctionParameter> parameters;
 	bool failed = false;
-	for (const auto &parameter : functionAst.params) {
-		auto paramType = resolveType(parameter);
+	for (auto parameterId : tree().range(functionAst.params)) {
+		const auto &parameter = tree().get<ast::flat::Parameter>(parameterId);
+		auto paramType = resolveType(parameterId);
 		if (!paramType.has_value()) {
 			messageBag.bug(
-			    parameter.getToken(),
+			    token(parameter.token),
 			    std::format("could not inspect type for {}",
-			                parameter.type.get()->getToken().lexeme));
+			                getToken(parameter.type).lexeme));
 			failed = true;
 			continue;
 		}
 		auto parameterType = paramType.value();
 		if (parameterType.calculatedSize == 0) {
 			messageBag.error(
-			    parameter.type->getToken(),
+			    getToken(parameter.type),
 			    std::format(
 			        "cannot pass parameter type with unknown size for '{}'",
 			        parameterType.name));
@@ -1104,12 +1197,12 @@ TypeChecker::resolveFunctionDeclaration(const ast::Function &functionAst) {
 		}
 
 		parameters.push_back({
-		    .name = parameter.name.lexeme,
+		    .name = lang::InternedString(token(parameter.name).lexeme),
 		    .parameterType = parameterType,
 		});
 	}
 
-	auto functionReturnType = resolveType(*functionAst.returnType);
+	auto functionReturnType = resolveType(functionAst.returnType);
 	if (!functionReturnType.has_value()) {
 		return std::nullopt;
 	}
@@ -1122,7 +1215,7 @@ TypeChecker::resolveFunctionDeclaration(const ast::Function &functionAst) {
 			// TODO: review this in the future if we ever decide to return
 			// abstract types at compile/evaluation time
 			messageBag.error(
-			    functionAst.returnType->getToken(),
+			    getToken(functionAst.returnType),
 			    "abstract types cannot be returned from a function");
 		}
 		break;
@@ -1136,7 +1229,7 @@ TypeChecker::resolveFunctionDeclaration(const ast::Function &functionAst) {
 		// TODO: replace this for a known type checker
 		if (returnType.calculatedSize == 0) {
 			messageBag.error(
-			    functionAst.returnType->getToken(),
+			    getToken(functionAst.returnType),
 			    std::format("cannot return a type with unknown size for '{}'",
 			                returnType.name));
 			failed = true;
@@ -1151,7 +1244,7 @@ TypeChecker::resolveFunctionDeclaration(const ast::Function &functionAst) {
 	default: {
 		failed = true;
 		messageBag.bug(
-		    functionAst.returnType->getToken(),
+		    getToken(functionAst.returnType),
 		    std::format("unsupported return type for function with name '{}'",
 		                returnType.name));
 		break;
@@ -1163,8 +1256,8 @@ TypeChecker::resolveFunctionDeclaration(const ast::Function &functionAst) {
 	}
 
 	auto declaration = lang::FunctionDeclaration{
-	    .name = std::string(functionAst.name.getLexeme()),
-	    .mangledName = mangledFunctionName,
+	    .name = lang::InternedString(token(functionAst.name).getLexeme()),
+	    .mangledName = lang::InternedString(mangledFunctionName),
 	    .publicVisibility = functionAst.publicVisibility,
 	    .signature =
 	        lang::FunctionSignature{
@@ -1177,14 +1270,18 @@ TypeChecker::resolveFunctionDeclaration(const ast::Function &functionAst) {
 
 lang::Scope &TypeChecker::getCurrentScope() { return currentScope.get(); }
 lang::Scope &TypeChecker::makeChildScope() {
-	currentScope = currentScope.get().makeChildScope();
+	currentScope = currentSourceUnit.get().enterScope(currentScope.get());
 	return currentScope;
 }
 bool TypeChecker::popScope(lang::Scope &targetScope) {
 	lang::Scope *scope = &getCurrentScope();
+	size_t depth = 0;
 	while (scope != nullptr) {
 		if (scope == &targetScope) {
 			if (scope->getParentScope().has_value()) {
+				for (size_t i = 0; i <= depth; i++) {
+					currentSourceUnit.get().leaveScope();
+				}
 				currentScope = scope->getParentScope()->get();
 			} else {
 				currentScope = *scope;
@@ -1201,16 +1298,18 @@ bool TypeChecker::popScope(lang::Scope &targetScope) {
 		                       -> lang::Scope * { return &scopeRef.get(); })
 		        .value_or(nullptr);
 		scope = parentScope;
+		depth++;
 	}
 
 	messageBag.bug({},
 	               "could not pop current scope, pop to first parent scope");
 	if (currentScope.get().getParentScope().has_value()) {
+		currentSourceUnit.get().leaveScope();
 		currentScope = currentScope.get().getParentScope().value();
 	} else {
 		messageBag.bug({},
 		               "parent scope not found, setting scope to root scope");
-		currentScope = currentSourceUnit.rootScope;
+		currentScope = currentSourceUnit.get().getRootScope();
 	}
 	return false;
 }
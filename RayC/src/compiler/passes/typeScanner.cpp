@@ -1,5 +1,4 @@
 #include "ray/compiler/lang/symbol.hpp"
-#include "ray/util/copy_ptr.hpp"
 #include <cassert>
 #include <cstddef>
 #include <format>
@@ -7,8 +6,7 @@
 #include <optional>
 #include <string_view>
 
-#include <ray/compiler/ast/expression.hpp>
-#include <ray/compiler/ast/statement.hpp>
+#include <ray/compiler/ast/flat.hpp>
 #include <ray/compiler/lang/functionDefinition.hpp>
 #include <ray/compiler/lang/scope.hpp>
 #include <ray/compiler/lang/struct.hpp>
@@ -19,19 +17,18 @@
 
 namespace ray::compiler::passes {
 
-void TypeScanner::resolve(
-    const std::vector<std::unique_ptr<ast::Statement>> &statements) {
+void TypeScanner::resolve(const ast::flat::Tree &tree) {
+	bind(tree);
 	// search first for structs, then go throught the statements
-	for (const auto &statement : statements) {
+	for (auto statement : tree.getRoots()) {
 		// TODO: refactor the compiler directives so they can be attached to
 		// the related AST instead
-		if (const auto *structAst =
-		        dynamic_cast<const ast::Struct *>(statement.get())) {
+		if (const auto *structAst = tree.tryGet<ast::flat::Struct>(statement)) {
 			discoverStruct(*structAst);
 		}
 	}
-	for (const auto &statement : statements) {
-		statement->visit(*this);
+	for (auto statement : tree.getRoots()) {
+		visit(statement);
 	}
 }
 
@@ -43,27 +40,29 @@ const std::vector<std::string> TypeScanner::getWarnings() const {
 	return messageBag.getWarnings();
 }
 
-void TypeScanner::visitBlockStatement(const ast::Block &blockAst) {
+void TypeScanner::visitBlockStatement(const ast::flat::Block &blockAst) {
 	auto &parentScope = currentScope.get();
-	currentScope = parentScope.makeChildScope();
+	currentScope = currentSourceUnit.get().enterScope(parentScope);
 
-	for (const auto &astStatement : blockAst.statements) {
-		astStatement->visit(*this);
+	for (auto astStatement : tree().range(blockAst.statements)) {
+		visit(astStatement);
 	}
 
+	currentSourceUnit.get().leaveScope();
 	currentScope = parentScope;
 }
 void TypeScanner::visitTerminalExprStatement(
-    const ast::TerminalExpr &terminalExprAst) {
-	if (terminalExprAst.expression.has_value()) {
-		terminalExprAst.expression->get()->visit(*this);
+    const ast::flat::TerminalExpr &terminalExprAst) {
+	if (terminalExprAst.expression) {
+		visit(terminalExprAst.expression);
 	}
 }
 void TypeScanner::visitExpressionStmtStatement(
-    const ast::ExpressionStmt &expressionStmtAst) {
-	expressionStmtAst.expression->visit(*this);
+    const ast::flat::ExpressionStmt &expressionStmtAst) {
+	visit(expressionStmtAst.expression);
 }
-void TypeScanner::visitFunctionStatement(const ast::Function &functionAst) {
+void TypeScanner::visitFunctionStatement(
+    const ast::flat::Function &functionAst) {
 	std::string currentModule;
 
 	std::optional<directive::LinkageDirective> linkageDirective;
@@ -78,42 +77,43 @@ void TypeScanner::visitFunctionStatement(const ast::Function &functionAst) {
 			    directive->getToken(),
 			    std::format(
 			        "unmatched compiler directive '{}' for function '{}'",
-			        directive->directiveName(), functionAst.name.getLexeme()));
+			        directive->directiveName(),
+			        token(functionAst.name).getLexeme()));
 		}
 		directivesStack.pop_back();
 	}
 	std::string mangledFunctionName =
 	    passes::mangling::NameMangler().mangleFunction(
-	        currentModule, functionAst, linkageDirective);
+	        currentModule, token(functionAst.name).lexeme, linkageDirective);
 
-	auto type = resolveType(*functionAst.returnType);
-	if (functionAst.body.has_value()) {
-		resolveTypes(*functionAst.body);
+	auto type = resolveType(functionAst.returnType);
+	if (functionAst.body) {
+		resolveTypes(functionAst.body);
 	}
 	typeStack.push_back(type);
 }
-void TypeScanner::visitIfStatement(const ast::If &ifExprAst) {
+void TypeScanner::visitIfStatement(const ast::flat::If &ifExprAst) {
 	// we do not care for the condition, only the inner body of the expression
 	// and the else body if applies
-	ifExprAst.thenBranch->visit(*this);
-	if (ifExprAst.elseBranch.has_value()) {
-		ifExprAst.elseBranch->get()->visit(*this);
+	visit(ifExprAst.thenBranch);
+	if (ifExprAst.elseBranch) {
+		visit(ifExprAst.elseBranch);
 	}
 }
-void TypeScanner::visitJumpStatement(const ast::Jump &jumpAst) {
-	if (jumpAst.returnValue.has_value()) {
-		jumpAst.returnValue->get()->visit(*this);
+void TypeScanner::visitJumpStatement(const ast::flat::Jump &jumpAst) {
+	if (jumpAst.returnValue) {
+		visit(jumpAst.returnValue);
 	}
 }
-void TypeScanner::visitVarDeclStatement(const ast::VarDecl &varDeclAst) {
+void TypeScanner::visitVarDeclStatement(const ast::flat::VarDecl &varDeclAst) {
 	// TODO: revisit this section once we implement abstract values such as
 	// modules
 	// TODO: review wether we should discover variables here before type checker
 }
-void TypeScanner::visitMemberStatement(const ast::Member &memberAst) {
-	std::string memberName = memberAst.name.lexeme;
+void TypeScanner::visitMemberStatement(const ast::flat::Member &memberAst) {
+	lang::InternedString memberName(token(memberAst.name).lexeme);
 
-	auto memberTypeObj = resolveType(*memberAst.type);
+	auto memberTypeObj = resolveType(memberAst.type);
 	lang::StructMember structMember{
 	    // we do not care about this
 	    .publicVisibility = false,
@@ -125,11 +125,11 @@ void TypeScanner::visitMemberStatement(const ast::Member &memberAst) {
 
 	structMemberStack.push_back(structMember);
 }
-void TypeScanner::visitWhileStatement(const ast::While &whileAst) {
-	resolveType(*whileAst.body);
+void TypeScanner::visitWhileStatement(const ast::flat::While &whileAst) {
+	resolveType(whileAst.body);
 	typeStack.push_back(lang::Type::defineStmtType());
 }
-void TypeScanner::visitStructStatement(const ast::Struct &structAst) {
+void TypeScanner::visitStructStatement(const ast::flat::Struct &structAst) {
 	// process all the linkage directives to ensure they are not dangling after
 	std::optional<directive::LinkageDirective> linkageDirective;
 
@@ -147,11 +147,11 @@ void TypeScanner::visitStructStatement(const ast::Struct &structAst) {
 		directivesStack.pop_back();
 	}
 
-	auto structName = structAst.name.getLexeme();
+	lang::InternedString structName(token(structAst.name).getLexeme());
 	std::string currentModule;
 	std::string mangledStructName =
-	    passes::mangling::NameMangler().mangleStruct(currentModule, structAst,
-	                                                 linkageDirective);
+	    passes::mangling::NameMangler().mangleStruct(
+	        currentModule, token(structAst.name).lexeme, linkageDirective);
 
 	auto &scope = currentScope.get();
 	auto structObjRes = scope.findLocalStruct(structName)
@@ -162,14 +162,14 @@ void TypeScanner::visitStructStatement(const ast::Struct &structAst) {
 	// this is an ugly workarround to declare structs that have compiler
 	// directives and were not discovered due to it
 
-	if (!currentSourceUnit.declareStruct(
+	if (!currentSourceUnit.get().declareStruct(
 	        lang::Struct{
 	            .opaque = true,                   // unknown implementation
-	            .name = std::string(structName),  //
-	            .mangledName = mangledStructName, //
+	            .name = structName,               //
+	            .mangledName = lang::InternedString(mangledStructName), //
 	        },
 	        scope)) {
-		messageBag.error(structAst.getToken(), "could not declare struct");
+		messageBag.error(token(structAst.token), "could not declare struct");
 	}
 
 	if (structAst.declaration) {
@@ -177,15 +177,15 @@ void TypeScanner::visitStructStatement(const ast::Struct &structAst) {
 	}
 
 	if (!structObjRes.has_value()) {
-		messageBag.bug(structAst.getToken(),
+		messageBag.bug(token(structAst.token),
 		               std::format("could not find internal reference for {}",
 		                           structName));
 		return;
 	}
 	auto &structObj = structObjRes.value().get();
 	std::vector<lang::StructMember> members;
-	for (const auto &member : structAst.members) {
-		member.visit(*this);
+	for (auto member : tree().range(structAst.members)) {
+		visit(member);
 		assert(!structMemberStack.empty());
 		auto memberObj = structMemberStack.back();
 		structMemberStack.pop_back();
@@ -196,9 +196,9 @@ void TypeScanner::visitStructStatement(const ast::Struct &structAst) {
 	structObj.members = members;
 }
 void TypeScanner::visitCompDirectiveStatement(
-    const ast::CompDirective &compDirectiveAst) {
-	auto directiveToken = compDirectiveAst.name;
-	auto directiveName = compDirectiveAst.name.getLexeme();
+    const ast::flat::CompDirective &compDirectiveAst) {
+	auto directiveToken = token(compDirectiveAst.name);
+	auto directiveName = token(compDirectiveAst.name).getLexeme();
 	if (directiveName == "Linkage") {
 		auto &attributes = compDirectiveAst.values;
 		auto directive = directive::LinkageDirective(
@@ -214,49 +214,49 @@ void TypeScanner::visitCompDirectiveStatement(
 		        : directive::LinkageDirective::ManglingType::Default,
 		    directiveToken);
 		if (compDirectiveAst.child) {
-			auto childValue = compDirectiveAst.child.get();
-			if (dynamic_cast<ast::Function *>(childValue) ||
-			    dynamic_cast<ast::Struct *>(childValue)) {
+			auto childKind = tree().kind(compDirectiveAst.child);
+			if (childKind == ast::flat::NodeKind::Function ||
+			    childKind == ast::flat::NodeKind::Struct) {
 				size_t startDirectives = directivesStack.size();
 				size_t originalTop = directivesStackTop + 1;
 				directivesStackTop = startDirectives;
 				directivesStack.push_back(
 				    std::make_unique<directive::LinkageDirective>(directive));
-				auto directiveType = resolveType(*compDirectiveAst.child);
+				auto directiveType = resolveType(compDirectiveAst.child);
 				typeStack.push_back(directiveType);
 
 				if (directivesStack.size() != startDirectives) {
-					messageBag.bug(childValue->getToken(),
+					messageBag.bug(getToken(compDirectiveAst.child),
 					               "unprocessed compiler directives");
 				}
 
 				directivesStackTop = originalTop;
 			} else {
 				messageBag.error(
-				    childValue->getToken(),
+				    getToken(compDirectiveAst.child),
 				    std::format(
 				        "{} child expression must be a function or a struct.",
 				        directive.directiveName()));
 			}
 		} else {
-			messageBag.error(compDirectiveAst.getToken(),
+			messageBag.error(token(compDirectiveAst.token),
 			                 std::format("{} must have a child expression.",
 			                             directive.directiveName()));
 		}
 	} else {
 		messageBag.error(
-		    compDirectiveAst.getToken(),
+		    token(compDirectiveAst.token),
 		    std::format("Unknown compiler directive '{}'.", directiveName));
 	}
 }
 // Expression
-void TypeScanner::visitVariableExpression(const ast::Variable &varExprAst) {
+void TypeScanner::visitVariableExpression(
+    const ast::flat::Variable &varExprAst) {
 	// TODO: once we have modules support(and maybe a template system?)
 	// revisit this section so we can determine if abstract variables can hold
 	// values required to them
 	auto foundVariable =
-	    currentScope.get()
-	        .findVariable(varExprAst.name.lexeme)
+	    currentSourceUnit.get().findVariable(token(varExprAst.name).lexeme)
 	        .transform([](const util::soft_reference<lang::Symbol> &symbolRef)
 	                       -> lang::Symbol {
 		        lang::Symbol returnSymbol =
@@ -272,39 +272,40 @@ void TypeScanner::visitVariableExpression(const ast::Variable &varExprAst) {
 	        .value_or(lang::Symbol::defineUnknownSymbol());
 	typeStack.push_back(foundVariable.innerType);
 }
-void TypeScanner::visitIntrinsicExpression(const ast::Intrinsic &value) {
-	messageBag.error(value.getToken(),
+void TypeScanner::visitIntrinsicExpression(const ast::flat::Intrinsic &value) {
+	messageBag.error(token(value.token),
 	                 std::format("{} not implemented", __PRETTY_FUNCTION__));
 }
-void TypeScanner::visitAssignExpression(const ast::Assign &assignAst) {
-	assignAst.rhs->visit(*this);
+void TypeScanner::visitAssignExpression(const ast::flat::Assign &assignAst) {
+	visit(assignAst.rhs);
 }
-void TypeScanner::visitBinaryExpression(const ast::Binary &binaryExprAst) {
+void TypeScanner::visitBinaryExpression(
+    const ast::flat::Binary &binaryExprAst) {
 	// we do not care about binary expressions as they cannot yield a new type
 }
-void TypeScanner::visitCallExpression(const ast::Call &callAst) {
+void TypeScanner::visitCallExpression(const ast::flat::Call &callAst) {
 	// the type checker is responsible for verifying the types
-	for (const auto &argument : callAst.arguments) {
-		argument->visit(*this);
+	for (auto argument : tree().range(callAst.arguments)) {
+		visit(argument);
 	}
 }
 void TypeScanner::visitIntrinsicCallExpression(
-    const ast::IntrinsicCall &intrinsicCallAst) {
+    const ast::flat::IntrinsicCall &intrinsicCallAst) {
 	// TODO: review this section later for a module system
-	for (auto &argument : intrinsicCallAst.arguments) {
-		argument->visit(*this);
+	for (auto argument : tree().range(intrinsicCallAst.arguments)) {
+		visit(argument);
 	}
 }
-void TypeScanner::visitGetExpression(const ast::Get &value) {
-	messageBag.error(value.getToken(),
+void TypeScanner::visitGetExpression(const ast::flat::Get &value) {
+	messageBag.error(token(value.token),
 	                 std::format("{} not implemented", __PRETTY_FUNCTION__));
 }
-void TypeScanner::visitGroupingExpression(const ast::Grouping &value) {
-	messageBag.error(value.getToken(),
+void TypeScanner::visitGroupingExpression(const ast::flat::Grouping &value) {
+	messageBag.error(token(value.token),
 	                 std::format("{} not implemented", __PRETTY_FUNCTION__));
 }
-void TypeScanner::visitLiteralExpression(const ast::Literal &literalAst) {
-	switch (literalAst.kind.type) {
+void TypeScanner::visitLiteralExpression(const ast::flat::Literal &literalAst) {
+	switch (token(literalAst.kind).type) {
 
 	case Token::TokenType::TOKEN_STRING: {
 		const auto baseType =
@@ -317,12 +318,12 @@ void TypeScanner::visitLiteralExpression(const ast::Literal &literalAst) {
 	}
 	case Token::TokenType::TOKEN_NUMBER: {
 		auto type = currentDataModel.get().getNumberLiteralType(
-		    literalAst.token.lexeme);
+		    token(literalAst.token).lexeme);
 		if (!type.has_value()) {
 			messageBag.error(
-			    literalAst.getToken(),
+			    token(literalAst.token),
 			    std::format("'{}' cannot be hold in any scalar number type",
-			                literalAst.getToken().getLexeme()));
+			                token(literalAst.token).getLexeme()));
 			return;
 		}
 		typeStack.push_back(type.value());
@@ -334,9 +335,9 @@ void TypeScanner::visitLiteralExpression(const ast::Literal &literalAst) {
 		const std::string_view character = literalAst.value;
 		if (character.size() > 1) {
 			messageBag.error(
-			    literalAst.getToken(),
+			    token(literalAst.token),
 			    std::format("'{}' is not a valid char literal type",
-			                literalAst.getToken().getLexeme()));
+			                token(literalAst.token).getLexeme()));
 			break;
 		}
 		typeStack.push_back(
@@ -344,139 +345,124 @@ void TypeScanner::visitLiteralExpression(const ast::Literal &literalAst) {
 		break;
 	}
 	default:
-		messageBag.error(literalAst.getToken(),
+		messageBag.error(token(literalAst.token),
 		                 std::format("'{}' is not a valid literal type",
-		                             literalAst.getToken().getLexeme()));
+		                             token(literalAst.token).getLexeme()));
 		break;
 	}
 }
-void TypeScanner::visitLogicalExpression(const ast::Logical &value) {
-	messageBag.error(value.getToken(),
+void TypeScanner::visitLogicalExpression(const ast::flat::Logical &value) {
+	messageBag.error(token(value.token),
 	                 std::format("{} not implemented", __PRETTY_FUNCTION__));
 }
-void TypeScanner::visitSetExpression(const ast::Set &value) {
-	messageBag.error(value.getToken(),
+void TypeScanner::visitSetExpression(const ast::flat::Set &value) {
+	messageBag.error(token(value.token),
 	                 std::format("{} not implemented", __PRETTY_FUNCTION__));
 }
-void TypeScanner::visitUnaryExpression(const ast::Unary &unaryAst) {
+void TypeScanner::visitUnaryExpression(const ast::flat::Unary &unaryAst) {
 	// TODO: rework this section once operator overload is implemented
 	// for now we assume the same type is returned
-	auto innerType = resolveType(*unaryAst.expr);
+	auto innerType = resolveType(unaryAst.expr);
 	return typeStack.push_back(innerType);
 }
 void TypeScanner::visitArrayAccessExpression(
-    const ast::ArrayAccess &arrayAccessAst) {
+    const ast::flat::ArrayAccess &arrayAccessAst) {
 	// TODO: remove this hack in the future once we convert to an cleaner AST
-	auto arrayType = resolveType(*arrayAccessAst.array);
-	auto indexType = resolveType(*arrayAccessAst.index);
+	auto arrayType = resolveType(arrayAccessAst.array);
+	auto indexType = resolveType(arrayAccessAst.index);
 	lang::Type innerType =
 	    arrayType.subtype
-	        .transform([](util::copy_ptr<lang::Type> &typePtr) -> lang::Type {
-		        assert(typePtr.get() != nullptr);
-		        return *typePtr.get();
-	        })
+	        .transform(
+	            [](lang::TypeRef subtype) -> lang::Type { return *subtype; })
 	        .value_or(lang::Type::defineUnknownType());
 	typeStack.push_back(innerType);
 }
-void TypeScanner::visitArrayTypeExpression(const ast::ArrayType &arrayTypeAst) {
-	auto innerType = resolveType(*arrayTypeAst.subType);
+void TypeScanner::visitArrayTypeExpression(
+    const ast::flat::ArrayType &arrayTypeAst) {
+	auto innerType = resolveType(arrayTypeAst.subType);
 
 	typeStack.push_back(currentDataModel.get().definePointerType(
 	    innerType, arrayTypeAst.isMutable));
 }
-void TypeScanner::visitTupleTypeExpression(const ast::TupleType &tupleAst) {
+void TypeScanner::visitTupleTypeExpression(
+    const ast::flat::TupleType &tupleAst) {
 	if (tupleAst.expressions.empty()) {
 		typeStack.push_back(currentDataModel.get().getUnitType());
 		return;
 	}
 	messageBag.error(
-	    tupleAst.getToken(),
+	    token(tupleAst.token),
 	    std::format("{} not implemented for tuples", __PRETTY_FUNCTION__));
 }
 void TypeScanner::visitPointerTypeExpression(
-    const ast::PointerType &pointerTypeAst) {
-	auto innerType = resolveType(*pointerTypeAst.subtype);
+    const ast::flat::PointerType &pointerTypeAst) {
+	auto innerType = resolveType(pointerTypeAst.subtype);
 	typeStack.push_back(currentDataModel.get().definePointerType(
 	    innerType, pointerTypeAst.isMutable));
 }
-void TypeScanner::visitNamedTypeExpression(const ast::NamedType &typeAst) {
-	auto queriedType = findTypeInfo(typeAst.name.lexeme);
+void TypeScanner::visitNamedTypeExpression(
+    const ast::flat::NamedType &typeAst) {
+	auto queriedType = findTypeInfo(token(typeAst.name).lexeme);
 	if (queriedType != lang::Type::defineUnknownType()) {
 		lang::Type obtainedType = queriedType;
 		obtainedType.isMutable = typeAst.isMutable;
 		typeStack.push_back(obtainedType);
 	} else {
 		messageBag.error(
-		    typeAst.getToken(),
-		    std::format("type not found for {}", typeAst.name.lexeme));
+		    token(typeAst.token),
+		    std::format("type not found for {}", token(typeAst.name).lexeme));
 		typeStack.push_back(lang::Type::defineUnknownType());
 	}
 }
-void TypeScanner::visitCastExpression(const ast::Cast &castAst) {
-	castAst.expression->visit(*this);
-	typeStack.push_back(resolveType(*castAst.type));
+void TypeScanner::visitCastExpression(const ast::flat::Cast &castAst) {
+	visit(castAst.expression);
+	typeStack.push_back(resolveType(castAst.type));
 }
-void TypeScanner::visitParameterExpression(const ast::Parameter &value) {
-	messageBag.error(value.getToken(),
+void TypeScanner::visitParameterExpression(const ast::flat::Parameter &value) {
+	messageBag.error(token(value.token),
 	                 std::format("{} not implemented", __PRETTY_FUNCTION__));
 }
 
-lang::Type TypeScanner::resolveType(const ast::Statement &statement) {
-	auto types = resolveTypes(statement);
+lang::Type TypeScanner::resolveType(ast::flat::NodeId node) {
+	auto types = resolveTypes(node);
 
 	if (types.size() > 1) {
-		// check wether the return types coerce
-		for (size_t i = 1; i < types.size(); i++) {
-			if (!types[0].coercercesInto(types[i])) {
-				messageBag.bug(
-				    statement.getToken(),
-				    std::format(
-				        "'{}' return types does not match for '{}' vs '{}'",
-				        statement.variantName(), types[0].name, types[i].name));
+		if (ast::flat::isStatement(tree().kind(node))) {
+			// check wether the return types coerce
+			for (size_t i = 1; i < types.size(); i++) {
+				if (!types[0].coercercesInto(types[i])) {
+					messageBag.bug(
+					    getToken(node),
+					    std::format(
+					        "'{}' return types does not match for '{}' vs '{}'",
+					        tree().variantName(node), types[0].name,
+					        types[i].name));
+				}
 			}
+		} else {
+			messageBag.bug(getToken(node),
+			               std::format("'{}' yield multiple values",
+			                           tree().variantName(node)));
 		}
 	}
 
 	return types.size() > 0 ? types[0] : lang::Type::defineUnknownType();
 }
-lang::Type TypeScanner::resolveType(const ast::Expression &expression) {
-	auto types = resolveTypes(expression);
-
-	if (types.size() > 1) {
-		messageBag.bug(expression.getToken(),
-		               std::format("'{}' yield multiple values",
-		                           expression.variantName()));
-	}
-
-	return types.size() > 0 ? types[0] : lang::Type::defineUnknownType();
-}
-std::vector<lang::Type>
-TypeScanner::resolveTypes(const ast::Statement &statement) {
+std::vector<lang::Type> TypeScanner::resolveTypes(ast::flat::NodeId node) {
 	std::vector<lang::Type> returnTypes;
 	size_t tsSize = typeStack.size();
-	statement.visit(*this);
+	visit(node);
 	while (typeStack.size() > tsSize) {
 		auto returnType = typeStack.back();
 		typeStack.pop_back();
 		returnTypes.push_back(returnType);
 	}
-	return returnTypes;
-}
-std::vector<lang::Type>
-TypeScanner::resolveTypes(const ast::Expression &expression) {
-	std::vector<lang::Type> returnTypes;
-	size_t tsSize = typeStack.size();
-	expression.visit(*this);
-	while (typeStack.size() > tsSize) {
-		auto returnType = typeStack.back();
-		typeStack.pop_back();
-		returnTypes.push_back(returnType);
-	}
-	if (returnTypes.size() < 1) {
+	// statements are not required to yield a type
+	if (returnTypes.size() < 1 && ast::flat::isExpression(tree().kind(node))) {
 		messageBag.bug(
-		    expression.getToken(),
+		    getToken(node),
 		    std::format("'{}' did not resolve a type, assuming statement",
-		                expression.variantName()));
+		                tree().variantName(node)));
 		typeStack.push_back(lang::Type::defineStmtType());
 	}
 	return returnTypes;
@@ -492,7 +478,7 @@ lang::Type TypeScanner::findTypeInfo(const std::string_view typeName) {
 		return scalarType.value();
 	}
 	// a defined type in the source unit cannot shadow a primitive/scalar type
-	auto foundStruct = currentSourceUnit.findStruct(typeName, currentScope);
+	auto foundStruct = currentSourceUnit.get().findStruct(typeName);
 	return foundStruct
 	    .transform([&](auto &structObj) {
 		    return currentDataModel.get().defineStructType(
@@ -503,34 +489,40 @@ lang::Type TypeScanner::findTypeInfo(const std::string_view typeName) {
 
 lang::Scope &TypeScanner::getCurrentScope() { return currentScope.get(); }
 lang::Scope &TypeScanner::makeChildScope() {
-	currentScope = currentScope.get().makeChildScope();
+	currentScope = currentSourceUnit.get().enterScope(currentScope.get());
 	return currentScope;
 }
 bool TypeScanner::returnScope(lang::Scope &targetScope) {
 	lang::Scope *scope = &getCurrentScope();
+	size_t depth = 0;
 	while (scope != nullptr) {
 		if (scope == &targetScope) {
+			for (size_t i = 0; i < depth; i++) {
+				currentSourceUnit.get().leaveScope();
+			}
 			currentScope = *scope;
 			return true;
 		}
 		scope = scope->getParentScope()
 		            .transform([](auto v) { return &v.get(); })
 		            .value_or(nullptr);
+		depth++;
 	}
 
 	messageBag.bug({},
 	               "could not pop current scope, pop to first parent scope");
 	if (currentScope.get().getParentScope().has_value()) {
+		currentSourceUnit.get().leaveScope();
 		currentScope = currentScope.get().getParentScope().value();
 	} else {
 		messageBag.bug({},
 		               "parent scope not found, setting scope to root scope");
-		currentScope = currentSourceUnit.rootScope;
+		currentScope = currentSourceUnit.get().getRootScope();
 	}
 	return false;
 }
 
-void TypeScanner::discoverStruct(const ast::Struct &structAst) {
+void TypeScanner::discoverStruct(const ast::flat::Struct &structAst) {
 	std::optional<directive::LinkageDirective> linkageDirective;
 
 	for (size_t i = directivesStack.size(); i > directivesStackTop; i--) {
@@ -547,23 +539,23 @@ void TypeScanner::discoverStruct(const ast::Struct &structAst) {
 		directivesStack.pop_back();
 	}
 
-	std::string structName = std::string(structAst.name.getLexeme());
+	lang::InternedString structName(token(structAst.name).getLexeme());
 	std::string currentModule;
 	std::string mangledStructName =
-	    passes::mangling::NameMangler().mangleStruct(currentModule, structAst,
-	                                                 linkageDirective);
+	    passes::mangling::NameMangler().mangleStruct(
+	        currentModule, token(structAst.name).lexeme, linkageDirective);
 
 	auto &scope = currentScope.get();
 
 	// declare the struct first so we can bind the definition later
-	if (!currentSourceUnit.declareStruct(
+	if (!currentSourceUnit.get().declareStruct(
 	        lang::Struct{
 	            .opaque = true,                   // unknown implementation
 	            .name = structName,               //
-	            .mangledName = mangledStructName, //
+	            .mangledName = lang::InternedString(mangledStructName), //
 	        },
 	        scope)) {
-		messageBag.error(structAst.getToken(), "could not declare struct");
+		messageBag.error(token(structAst.token), "could not declare struct");
 	}
 	// do not bother with declarations
 	if (structAst.declaration) {
@@ -577,7 +569,7 @@ void TypeScanner::discoverStruct(const ast::Struct &structAst) {
 		assert(foundStruct->getObjectId() != 0);
 		if (!foundStruct->getObject()->get().opaque) {
 			messageBag.error(
-			    structAst.getToken(),
+			    token(structAst.token),
 			    std::format("{} is defined multiple times", structName));
 		}
 	}
@@ -587,10 +579,10 @@ void TypeScanner::discoverStruct(const ast::Struct &structAst) {
 	        .structID =
 	            structID, // make sure to pass the struct ID to avoid loosing it
 	        .name = structName,               //
-	        .mangledName = mangledStructName, //
+	        .mangledName = lang::InternedString(mangledStructName), //
 	        .members = {}                     //
 	    })) {
-		messageBag.error(structAst.getToken(),
+		messageBag.error(token(structAst.token),
 		                 std::format("could not bind struct '{}'", structName));
 		return;
 	}
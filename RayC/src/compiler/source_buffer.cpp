@@ -0,0 +1,98 @@
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <ray/compiler/source_buffer.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RAYC_SOURCE_BUFFER_MMAP 1
+#endif
+
+namespace ray::compiler {
+
+SourceBuffer::SourceBuffer(std::filesystem::path path, const char *mappedData,
+                           size_t mappedSize)
+    : path(std::move(path)), mappedData(mappedData), mappedSize(mappedSize) {}
+
+SourceBuffer::SourceBuffer(std::filesystem::path path, std::string ownedData)
+    : path(std::move(path)), ownedData(std::move(ownedData)) {}
+
+SourceBuffer::SourceBuffer(SourceBuffer &&other) noexcept
+    : path(std::move(other.path)),
+      mappedData(std::exchange(other.mappedData, nullptr)),
+      mappedSize(std::exchange(other.mappedSize, 0)),
+      ownedData(std::move(other.ownedData)) {}
+
+SourceBuffer &SourceBuffer::operator=(SourceBuffer &&other) noexcept {
+	if (this != &other) {
+		release();
+		path = std::move(other.path);
+		mappedData = std::exchange(other.mappedData, nullptr);
+		mappedSize = std::exchange(other.mappedSize, 0);
+		ownedData = std::move(other.ownedData);
+	}
+	return *this;
+}
+
+SourceBuffer::~SourceBuffer() { release(); }
+
+std::optional<SourceBuffer>
+SourceBuffer::open(const std::filesystem::path &path) {
+#ifdef RAYC_SOURCE_BUFFER_MMAP
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return std::nullopt;
+	}
+	struct stat fileInfo{};
+	// empty and non regular files (pipes, devices) cannot be mapped, those
+	// go through the read fallback
+	if (fstat(fd, &fileInfo) == 0 && S_ISREG(fileInfo.st_mode) &&
+	    fileInfo.st_size > 0) {
+		size_t size = static_cast<size_t>(fileInfo.st_size);
+		void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping != MAP_FAILED) {
+			close(fd);
+			// the lexer reads the file front to back
+			madvise(mapping, size, MADV_SEQUENTIAL);
+			return SourceBuffer(path, static_cast<const char *>(mapping),
+			                    size);
+		}
+	}
+	close(fd);
+#endif
+	std::ifstream input(path, std::ios::binary);
+	if (!input) {
+		return std::nullopt;
+	}
+	std::string contents{std::istreambuf_iterator<char>(input),
+	                     std::istreambuf_iterator<char>()};
+	return SourceBuffer(path, std::move(contents));
+}
+
+std::string_view SourceBuffer::view() const {
+	return mappedData ? std::string_view(mappedData, mappedSize)
+	                  : std::string_view(ownedData);
+}
+
+const std::filesystem::path &SourceBuffer::getPath() const { return path; }
+
+void SourceBuffer::release() {
+#ifdef RAYC_SOURCE_BUFFER_MMAP
+	if (mappedData) {
+		munmap(const_cast<char *>(mappedData), mappedSize);
+	}
+#endif
+	mappedData = nullptr;
+	mappedSize = 0;
+}
+
+} // namespace ray::compiler
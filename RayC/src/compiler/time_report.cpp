@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <format>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ray/compiler/time_report.hpp>
+#include <ray/util/counters.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#define RAYC_THREAD_CPU_CLOCK 1
+#endif
+
+namespace ray::compiler {
+
+namespace {
+
+util::ThreadCounters operator-(const util::ThreadCounters &end,
+                               const util::ThreadCounters &start) {
+	return {.tokens = end.tokens - start.tokens,
+	        .astNodes = end.astNodes - start.astNodes,
+	        .types = end.types - start.types,
+	        .names = end.names - start.names,
+	        .symbols = end.symbols - start.symbols,
+	        .allocations = end.allocations - start.allocations,
+	        .allocatedBytes = end.allocatedBytes - start.allocatedBytes};
+}
+
+void accumulate(util::ThreadCounters &total,
+                const util::ThreadCounters &counters) {
+	total.tokens += counters.tokens;
+	total.astNodes += counters.astNodes;
+	total.types += counters.types;
+	total.names += counters.names;
+	total.symbols += counters.symbols;
+	total.allocations += counters.allocations;
+	total.allocatedBytes += counters.allocatedBytes;
+}
+
+double milliseconds(std::chrono::nanoseconds duration) {
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+TimeReport::Scope::Scope(TimeReport *report, std::string_view phase,
+                         std::string_view detail)
+    : span("phase", phase, detail), report(report), phase(phase) {
+	if (report == nullptr) {
+		return;
+	}
+	wallStart = std::chrono::steady_clock::now();
+	cpuStart = cpuTime();
+	countersStart = util::threadCounters;
+}
+
+TimeReport::Scope::~Scope() {
+	if (report == nullptr) {
+		return;
+	}
+	auto counters = util::threadCounters - countersStart;
+	report->add(phase, std::chrono::steady_clock::now() - wallStart,
+	            cpuTime() - cpuStart, counters);
+}
+
+void TimeReport::add(std::string_view phase, std::chrono::nanoseconds wall,
+                     std::chrono::nanoseconds cpu,
+                     const util::ThreadCounters &counters) {
+	std::lock_guard lock(mutex);
+	auto it = std::ranges::find(phases, phase, &Phase::name);
+	if (it == phases.end()) {
+		it = phases.insert(phases.end(), Phase{.name = std::string(phase)});
+	}
+	it->runs++;
+	it->wall += wall;
+	it->cpu += cpu;
+	accumulate(it->counters, counters);
+}
+
+std::chrono::nanoseconds TimeReport::elapsed() const {
+	return std::chrono::steady_clock::now() - start;
+}
+
+std::vector<TimeReport::Phase> TimeReport::getPhases() const {
+	std::lock_guard lock(mutex);
+	return phases;
+}
+
+void TimeReport::setTables(const Tables &sizes) {
+	std::lock_guard lock(mutex);
+	tables = sizes;
+}
+
+TimeReport::Tables TimeReport::getTables() const {
+	std::lock_guard lock(mutex);
+	return tables;
+}
+
+std::string TimeReport::toText() const {
+	auto phases = getPhases();
+	std::string text = std::format(
+	    "{:<10} {:>6} {:>10} {:>10} {:>9} {:>9} {:>7} {:>7} {:>8} {:>9} "
+	    "{:>10}\n",
+	    "phase", "runs", "wall ms", "cpu ms", "tokens", "nodes", "types",
+	    "names", "symbols", "allocs", "alloc KiB");
+	Phase total{.name = "total"};
+	for (const auto &phase : phases) {
+		text += std::format(
+		    "{:<10} {:>6} {:>10.3f} {:>10.3f} {:>9} {:>9} {:>7} {:>7} {:>8} "
+		    "{:>9} {:>10.1f}\n",
+		    phase.name, phase.runs, milliseconds(phase.wall),
+		    milliseconds(phase.cpu), phase.counters.tokens,
+		    phase.counters.astNodes, phase.counters.types,
+		    phase.counters.names, phase.counters.symbols,
+		    phase.counters.allocations,
+		    static_cast<double>(phase.counters.allocatedBytes) / 1024);
+		total.wall += phase.wall;
+		total.cpu += phase.cpu;
+	}
+	text += std::format("{:<10} {:>6} {:>10.3f} {:>10.3f}  (build wall "
+	                    "{:.3f} ms)\n",
+	                    total.name, "", milliseconds(total.wall),
+	                    milliseconds(total.cpu), milliseconds(elapsed()));
+	auto sizes = getTables();
+	text += std::format("kept after the build: {} names, {} types, {} type "
+	                    "comparisons remembered during it\n",
+	                    sizes.names, sizes.types, sizes.comparisons);
+	return text;
+}
+
+std::string TimeReport::toJson() const {
+	auto phases = getPhases();
+	std::string json = std::format("{{\"version\":1,\"wallNs\":{},\"phases\":[",
+	                               elapsed().count());
+	for (size_t i = 0; i < phases.size(); i++) {
+		const auto &phase = phases[i];
+		json += std::format(
+		    "{}{{\"name\":\"{}\",\"runs\":{},\"wallNs\":{},\"cpuNs\":{},"
+		    "\"tokens\":{},\"astNodes\":{},\"types\":{},\"names\":{},"
+		    "\"symbols\":{},\"allocations\":{},\"allocatedBytes\":{}}}",
+		    i == 0 ? "" : ",", phase.name, phase.runs, phase.wall.count(),
+		    phase.cpu.count(), phase.counters.tokens, phase.counters.astNodes,
+		    phase.counters.types, phase.counters.names,
+		    phase.counters.symbols, phase.counters.allocations,
+		    phase.counters.allocatedBytes);
+	}
+	auto sizes = getTables();
+	json += std::format(
+	    "],\"tables\":{{\"names\":{},\"types\":{},\"comparisons\":{}}}}}\n",
+	    sizes.names, sizes.types, sizes.comparisons);
+	return json;
+}
+
+std::chrono::nanoseconds TimeReport::cpuTime() {
+#ifdef RAYC_THREAD_CPU_CLOCK
+	timespec time{};
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+	return std::chrono::seconds(time.tv_sec) +
+	       std::chrono::nanoseconds(time.tv_nsec);
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+	    std::chrono::duration<double>(static_cast<double>(std::clock()) /
+	                                  CLOCKS_PER_SEC));
+#endif
+}
+
+} // namespace ray::compiler
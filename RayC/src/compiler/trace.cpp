@@ -0,0 +1,130 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <ray/compiler/trace.hpp>
+#include <ray/util/counters.hpp>
+
+namespace ray::compiler {
+
+namespace {
+
+std::string escapeJson(std::string_view value) {
+	std::string escaped;
+	escaped.reserve(value.size());
+	for (char c : value) {
+		switch (c) {
+		case '"':
+			escaped += "\\\"";
+			break;
+		case '\\':
+			escaped += "\\\\";
+			break;
+		case '\n':
+			escaped += "\\n";
+			break;
+		case '\t':
+			escaped += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20) {
+				escaped += std::format("\\u{:04x}", static_cast<int>(c));
+			} else {
+				escaped += c;
+			}
+		}
+	}
+	return escaped;
+}
+
+// small stable ids are easier to read in the viewer than native handles
+uint32_t currentThreadId() {
+	static std::atomic<uint32_t> nextId{1};
+	thread_local uint32_t id = nextId.fetch_add(1);
+	return id;
+}
+
+} // namespace
+
+std::atomic<TraceRecorder *> TraceRecorder::installed{nullptr};
+
+TraceRecorder::Span::Span(std::string_view category, std::string_view name,
+                          std::string_view detail)
+    : recorder(TraceRecorder::current()), category(category), name(name) {
+	if (recorder == nullptr) {
+		return;
+	}
+	this->detail = detail;
+	begin = std::chrono::steady_clock::now();
+	countersBegin = util::threadCounters;
+}
+
+TraceRecorder::Span::~Span() {
+	if (recorder == nullptr) {
+		return;
+	}
+	auto end = std::chrono::steady_clock::now();
+	const auto &counters = util::threadCounters;
+	std::string fullName =
+	    detail.empty() ? std::string(name) : std::format("{} {}", name, detail);
+	recorder->record(std::format(
+	    "{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},"
+	    "\"dur\":{:.3f},\"pid\":1,\"tid\":{},\"args\":{{\"allocations\":{},"
+	    "\"allocatedBytes\":{}}}}}",
+	    escapeJson(fullName), escapeJson(category),
+	    recorder->microseconds(begin),
+	    recorder->microseconds(end) - recorder->microseconds(begin),
+	    currentThreadId(),
+	    counters.allocations - countersBegin.allocations,
+	    counters.allocatedBytes - countersBegin.allocatedBytes));
+	// the thread totals make an allocation track per thread
+	recorder->record(std::format(
+	    "{{\"name\":\"allocated bytes\",\"ph\":\"C\",\"ts\":{:.3f},\"pid\":1,"
+	    "\"id\":{},\"args\":{{\"thread {}\":{}}}}}",
+	    recorder->microseconds(end), currentThreadId(), currentThreadId(),
+	    counters.allocatedBytes));
+}
+
+TraceRecorder::~TraceRecorder() { uninstall(); }
+
+void TraceRecorder::install() { installed.store(this); }
+
+void TraceRecorder::uninstall() {
+	TraceRecorder *expected = this;
+	installed.compare_exchange_strong(expected, nullptr);
+}
+
+void TraceRecorder::counter(std::string_view name, uint64_t value) {
+	record(std::format("{{\"name\":\"{}\",\"ph\":\"C\",\"ts\":{:.3f},"
+	                   "\"pid\":1,\"args\":{{\"value\":{}}}}}",
+	                   escapeJson(name),
+	                   microseconds(std::chrono::steady_clock::now()), value));
+}
+
+std::string TraceRecorder::toJson() const {
+	std::lock_guard lock(mutex);
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	for (size_t i = 0; i < events.size(); i++) {
+		json += events[i];
+		json += i + 1 < events.size() ? ",\n" : "\n";
+	}
+	json += "]}\n";
+	return json;
+}
+
+double TraceRecorder::microseconds(
+    std::chrono::steady_clock::time_point time) const {
+	return std::chrono::duration<double, std::micro>(time - start).count();
+}
+
+void TraceRecorder::record(std::string event) {
+	std::lock_guard lock(mutex);
+	events.push_back(std::move(event));
+}
+
+} // namespace ray::compiler
@@ -0,0 +1,84 @@
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <ray/util/atomic_file.hpp>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ray::compiler::util {
+
+namespace {
+
+int processId() {
+#ifdef _WIN32
+	return ::_getpid();
+#else
+	return static_cast<int>(::getpid());
+#endif
+}
+
+} // namespace
+
+bool writeFileAtomically(const std::filesystem::path &path,
+                         std::string_view contents) {
+	std::error_code error;
+	std::filesystem::create_directories(path.parent_path(), error);
+	auto temporaryPath = temporaryPathFor(path);
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (file) {
+			file.write(contents.data(),
+			           static_cast<std::streamsize>(contents.size()));
+			file.close();
+		}
+		if (!file) {
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+	}
+	return replaceFile(temporaryPath, path);
+}
+
+std::filesystem::path temporaryPathFor(const std::filesystem::path &path) {
+	// the process id keeps rayc processes sharing a directory apart, the
+	// counter the threads and files of one process
+	static std::atomic<uint64_t> nextTemporary = 0;
+	auto temporaryPath = path;
+	temporaryPath += std::format(".{}.{}.tmp", processId(),
+	                             nextTemporary.fetch_add(1));
+	return temporaryPath;
+}
+
+bool replaceFile(const std::filesystem::path &temporary,
+                 const std::filesystem::path &path) {
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	if (error) {
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+	return true;
+}
+
+std::optional<std::string> readFile(const std::filesystem::path &path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return std::nullopt;
+	}
+	return std::string{std::istreambuf_iterator<char>(file),
+	                   std::istreambuf_iterator<char>()};
+}
+
+} // namespace ray::compiler::util
@@ -0,0 +1,35 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include <ray/util/counters.hpp>
+
+namespace ray::compiler::util {
+
+thread_local constinit ThreadCounters threadCounters;
+
+} // namespace ray::compiler::util
+
+// the replacements live next to the counters so linking anything that counts
+// links them too. the other forms of new and delete forward to these ones
+void *operator new(std::size_t size) {
+	auto &counters = ray::compiler::util::threadCounters;
+	counters.allocations++;
+	counters.allocatedBytes += size;
+	// malloc(0) may return null, new must still return a unique pointer
+	void *pointer;
+	while ((pointer = std::malloc(size == 0 ? 1 : size)) == nullptr) {
+		auto handler = std::get_new_handler();
+		if (handler == nullptr) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+	return pointer;
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <ray/util/atomic_file.hpp>
+#include <ray/util/output_buffer.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define RAYC_OUTPUT_WRITEV 1
+#endif
+
+namespace ray::compiler::util {
+
+namespace {
+
+constexpr std::string_view tabs = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+                                  "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+
+#ifdef RAYC_OUTPUT_WRITEV
+
+#ifdef IOV_MAX
+constexpr size_t maxIovecs = IOV_MAX;
+#else
+constexpr size_t maxIovecs = 1024;
+#endif
+
+class FileDescriptor {
+	int fd;
+
+  public:
+	explicit FileDescriptor(int fd) : fd(fd) {}
+	FileDescriptor(const FileDescriptor &) = delete;
+	FileDescriptor &operator=(const FileDescriptor &) = delete;
+	~FileDescriptor() {
+		if (fd >= 0) {
+			::close(fd);
+		}
+	}
+
+	int get() const { return fd; }
+	bool valid() const { return fd >= 0; }
+	// close reports the errors of writes the kernel deferred
+	bool close() {
+		int closing = fd;
+		fd = -1;
+		return ::close(closing) == 0;
+	}
+};
+
+// writes every vector, continuing after partial writes and interruptions
+bool writeAll(int fd, std::vector<iovec> &vectors) {
+	size_t first = 0;
+	while (first < vectors.size()) {
+		size_t count = std::min(vectors.size() - first, maxIovecs);
+		auto written =
+		    ::writev(fd, vectors.data() + first, static_cast<int>(count));
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written < 0) {
+			return false;
+		}
+		auto remaining = static_cast<size_t>(written);
+		while (first < vectors.size() && remaining >= vectors[first].iov_len) {
+			remaining -= vectors[first].iov_len;
+			first++;
+		}
+		if (remaining > 0) {
+			vectors[first].iov_base =
+			    static_cast<char *>(vectors[first].iov_base) + remaining;
+			vectors[first].iov_len -= remaining;
+		}
+	}
+	return true;
+}
+
+#endif
+
+} // namespace
+
+void OutputBuffer::append(std::string_view text) {
+	while (!text.empty()) {
+		if (chunks.empty() || chunks.back().size == chunks.back().capacity) {
+			grow(text.size());
+		}
+		auto &tail = chunks.back();
+		size_t count = std::min(text.size(), tail.capacity - tail.size);
+		std::memcpy(tail.data.get() + tail.size, text.data(), count);
+		tail.size += count;
+		totalSize += count;
+		text.remove_prefix(count);
+	}
+}
+
+void OutputBuffer::indent(size_t depth) {
+	while (depth > 0) {
+		size_t count = std::min(depth, tabs.size());
+		append(tabs.substr(0, count));
+		depth -= count;
+	}
+}
+
+void OutputBuffer::clear() {
+	chunks.clear();
+	totalSize = 0;
+}
+
+std::string OutputBuffer::str() const {
+	std::string text;
+	text.reserve(totalSize);
+	for (const auto &chunk : chunks) {
+		text.append(chunk.data.get(), chunk.size);
+	}
+	return text;
+}
+
+bool OutputBuffer::writeFile(const std::filesystem::path &path) const {
+	OutputFile file(path);
+	return file.write(*this) && file.commit();
+}
+
+void OutputBuffer::grow(size_t minimum) {
+	size_t capacity =
+	    chunks.empty() ? firstChunkSize
+	                   : std::min(chunks.back().capacity * 2, maxChunkSize);
+	capacity = std::max(capacity, std::min(minimum, maxChunkSize));
+	chunks.push_back({.data = std::make_unique_for_overwrite<char[]>(capacity),
+	                  .size = 0,
+	                  .capacity = capacity});
+}
+
+#ifdef RAYC_OUTPUT_WRITEV
+
+struct OutputFile::Handle {
+	FileDescriptor file;
+	bool failed = false;
+
+	explicit Handle(const std::filesystem::path &path)
+	    : file(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+	                  0666)) {}
+
+	bool good() const { return file.valid() && !failed; }
+	bool write(std::vector<iovec> &vectors) {
+		failed = failed || !writeAll(file.get(), vectors);
+		return !failed;
+	}
+	bool close() { return file.close() && !failed; }
+};
+
+#else
+
+struct OutputFile::Handle {
+	// text mode keeps the line endings of the platform
+	std::ofstream file;
+
+	explicit Handle(const std::filesystem::path &path)
+	    : file(path, std::ios::trunc) {}
+
+	bool good() const { return static_cast<bool>(file); }
+	bool close() {
+		file.close();
+		return static_cast<bool>(file);
+	}
+};
+
+#endif
+
+OutputFile::OutputFile(std::filesystem::path target)
+    : target(std::move(target)), temporary(temporaryPathFor(this->target)) {
+	handle = std::make_unique<Handle>(temporary);
+}
+
+OutputFile::~OutputFile() {
+	if (handle) {
+		handle.reset();
+		std::error_code error;
+		std::filesystem::remove(temporary, error);
+	}
+}
+
+bool OutputFile::good() const { return handle && handle->good(); }
+
+bool OutputFile::write(const OutputBuffer &buffer) {
+	if (!good()) {
+		return false;
+	}
+#ifdef RAYC_OUTPUT_WRITEV
+	std::vector<iovec> vectors;
+	vectors.reserve(buffer.chunks.size());
+	for (const auto &chunk : buffer.chunks) {
+		vectors.push_back(
+		    {.iov_base = chunk.data.get(), .iov_len = chunk.size});
+	}
+	return handle->write(vectors);
+#else
+	for (const auto &chunk : buffer.chunks) {
+		handle->file.write(chunk.data.get(),
+		                   static_cast<std::streamsize>(chunk.size));
+	}
+	return handle->good();
+#endif
+}
+
+bool OutputFile::commit() {
+	// the destructor removes the temporary file when this fails
+	if (!good() || !handle->close()) {
+		return false;
+	}
+	handle.reset();
+	return replaceFile(temporary, target);
+}
+
+} // namespace ray::compiler::util
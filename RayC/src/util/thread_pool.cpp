@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <ray/util/thread_pool.hpp>
+
+namespace ray::compiler::util {
+
+ThreadPool::ThreadPool(size_t threadCount) {
+	if (threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (size_t i = 0; i < threadCount; i++) {
+		queues.push_back(std::make_unique<TaskQueue>());
+	}
+	workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; i++) {
+		workers.emplace_back([this, i] { work(i); });
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(mutex);
+		stopping = true;
+	}
+	taskAvailable.notify_all();
+	workers.clear();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+	// counted before a worker can finish it so wait never misses it
+	pending++;
+	auto &queue = *queues[nextQueue++ % queues.size()];
+	{
+		std::lock_guard lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+		queued++;
+	}
+	// a worker that found every deque empty either sees the task once it
+	// holds the mutex or is already waiting for this notification
+	{
+		std::lock_guard lock(mutex);
+	}
+	taskAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::unique_lock lock(mutex);
+	allDone.wait(lock, [this] { return pending == 0; });
+	if (error) {
+		std::rethrow_exception(std::exchange(error, nullptr));
+	}
+}
+
+void ThreadPool::work(size_t index) {
+	while (true) {
+		auto task = take(index);
+		if (!task) {
+			std::unique_lock lock(mutex);
+			if (stopping && queued == 0) {
+				return;
+			}
+			taskAvailable.wait(lock, [this] { return stopping || queued > 0; });
+			continue;
+		}
+		try {
+			task();
+		} catch (...) {
+			std::lock_guard lock(mutex);
+			if (!error) {
+				error = std::current_exception();
+			}
+		}
+		if (--pending == 0) {
+			std::lock_guard lock(mutex);
+			allDone.notify_all();
+		}
+	}
+}
+
+std::function<void()> ThreadPool::take(size_t index) {
+	{
+		auto &own = *queues[index];
+		std::lock_guard lock(own.mutex);
+		if (!own.tasks.empty()) {
+			auto task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			queued--;
+			return task;
+		}
+	}
+	for (size_t offset = 1; offset < queues.size(); offset++) {
+		auto &victim = *queues[(index + offset) % queues.size()];
+		std::lock_guard lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			auto task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			queued--;
+			return task;
+		}
+	}
+	return {};
+}
+
+} // namespace ray::compiler::util
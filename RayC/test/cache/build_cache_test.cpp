@@ -0,0 +1,173 @@
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <ray/compiler/driver.hpp>
+#include <ray/compiler/source_buffer.hpp>
+
+using namespace ray::compiler;
+
+namespace {
+
+// the public function of the cstd copy whose signature gets changed, the
+// example calls it
+constexpr std::string_view signature = "pub fn floor(number: mut f64)";
+constexpr std::string_view changedSignature = "pub fn floor(number: f64)";
+
+struct Build {
+	std::string output;
+	// whether the build type checked the unit instead of replaying it
+	bool checked = false;
+};
+
+std::optional<std::string> readFile(const std::filesystem::path &path) {
+	auto file = SourceBuffer::open(path);
+	if (!file) {
+		return std::nullopt;
+	}
+	return std::string(file->view());
+}
+
+// compiles the example into the cache the way rayc -C does, the time report
+// tells whether the type checker ran
+std::optional<Build> build(const std::filesystem::path &work,
+                           const std::filesystem::path &input,
+                           std::string_view name) {
+	auto output = work / std::format("{}.c", name);
+	auto report = work / std::format("{}.json", name);
+	std::vector<std::string> arguments = {
+	    "rayc",
+	    "-P",
+	    std::format("cstd={}", (work / "cstd").string()),
+	    "-C",
+	    (work / "cache").string(),
+	    "--time-report-json",
+	    report.string(),
+	    "-o",
+	    output.string(),
+	    input.string()};
+	std::vector<char *> argv;
+	for (auto &argument : arguments) {
+		argv.push_back(argument.data());
+	}
+	argv.push_back(nullptr);
+	std::ostringstream out;
+	std::ostringstream diagnostics;
+	if (Driver().run(static_cast<int>(arguments.size()), argv.data(), out,
+	                 diagnostics) != 0) {
+		std::cerr << std::format("{} build does not compile\n{}{}", name,
+		                         out.str(), diagnostics.str());
+		return std::nullopt;
+	}
+	auto code = readFile(output);
+	auto json = readFile(report);
+	if (!code || !json) {
+		std::cerr << std::format("{} build wrote no output or no report\n",
+		                         name);
+		return std::nullopt;
+	}
+	return Build{.output = std::move(*code),
+	             .checked = json->find("\"name\":\"check\"") !=
+	                        std::string::npos};
+}
+
+// copies the example and the cstd modules so they can be edited
+bool prepare(const std::filesystem::path &work,
+             const std::filesystem::path &example,
+             const std::filesystem::path &cstd) {
+	std::error_code error;
+	std::filesystem::remove_all(work, error);
+	std::filesystem::create_directories(work, error);
+	std::filesystem::copy(cstd, work / "cstd",
+	                      std::filesystem::copy_options::recursive, error);
+	if (!error) {
+		std::filesystem::copy_file(example, work / example.filename(), error);
+	}
+	if (error) {
+		std::cerr << std::format("could not copy the sources into {}: {}\n",
+		                         work.string(), error.message());
+		return false;
+	}
+	return true;
+}
+
+bool changeSignature(const std::filesystem::path &module) {
+	auto source = readFile(module);
+	size_t at = source ? source->find(signature) : std::string::npos;
+	if (at == std::string::npos) {
+		std::cerr << std::format("{} does not declare '{}'\n",
+		                         module.string(), signature);
+		return false;
+	}
+	source->replace(at, signature.size(), changedSignature);
+	std::ofstream(module, std::ios::binary | std::ios::trunc) << *source;
+	return true;
+}
+
+} // namespace
+
+// builds the example twice into a fresh cache and expects the second build to
+// replay the first one byte for byte without checking it. then a public
+// signature of an imported module changes and the unit has to be checked
+// again, after which the new entry is replayed
+int main(int argc, char **argv) {
+	if (argc != 4) {
+		std::cerr << std::format(
+		    "Usage: {} <work dir> <example.ray> <cstd dir>\n", argv[0]);
+		return 1;
+	}
+	std::filesystem::path work = argv[1];
+	std::filesystem::path example = argv[2];
+	if (!prepare(work, example, argv[3])) {
+		return 1;
+	}
+	auto input = work / example.filename();
+
+	auto first = build(work, input, "first");
+	auto second = build(work, input, "second");
+	if (!first || !second) {
+		return 1;
+	}
+	if (!first->checked) {
+		std::cerr << "first build replayed from an empty cache\n";
+		return 1;
+	}
+	if (second->checked) {
+		std::cerr << "second build checked an unchanged unit again\n";
+		return 1;
+	}
+	if (second->output != first->output) {
+		std::cerr << "second build replayed different output\n";
+		return 1;
+	}
+
+	if (!changeSignature(work / "cstd" / "math.ray")) {
+		return 1;
+	}
+	auto changed = build(work, input, "changed");
+	auto replayed = build(work, input, "replayed");
+	if (!changed || !replayed) {
+		return 1;
+	}
+	if (!changed->checked) {
+		std::cerr << "build after the signature change replayed a stale "
+		             "entry\n";
+		return 1;
+	}
+	if (replayed->checked || replayed->output != changed->output) {
+		std::cerr << "build after the recompile did not replay it\n";
+		return 1;
+	}
+	std::cout << std::format("{}: replayed, recompiled after a signature "
+	                         "change\n",
+	                         example.string());
+	return 0;
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ray/compiler/lexer/lexer.hpp>
+#include <ray/compiler/lexer/lexer_error.hpp>
+#include <ray/compiler/lexer/token.hpp>
+#include <ray/compiler/source_buffer.hpp>
+
+#include "reference_lexer.hpp"
+
+using namespace ray::compiler;
+
+namespace {
+
+bool sameToken(const Token &expected, const Token &actual) {
+	return expected.type == actual.type &&
+	       expected.lexeme == actual.lexeme &&
+	       expected.line == actual.line && expected.column == actual.column;
+}
+
+bool sameError(const LexerError &expected, const LexerError &actual) {
+	return expected.category == actual.category &&
+	       expected.message == actual.message &&
+	       sameToken(expected.token, actual.token);
+}
+
+// lexes source with both lexers, prints the first difference
+bool compare(std::string_view name, std::string_view source) {
+	test::ReferenceLexer reference(source);
+	Lexer lexer(source);
+	auto expected = reference.scanTokens();
+	auto actual = lexer.scanTokens();
+
+	size_t count = std::min(expected.size(), actual.size());
+	for (size_t i = 0; i < count; i++) {
+		if (!sameToken(expected[i], actual[i])) {
+			std::cerr << std::format("{}: token {} differs\n  expected {}\n"
+			                         "  actual   {}\n",
+			                         name, i, expected[i].toString(),
+			                         actual[i].toString());
+			return false;
+		}
+	}
+	if (expected.size() != actual.size()) {
+		std::cerr << std::format("{}: expected {} tokens, got {}\n", name,
+		                         expected.size(), actual.size());
+		return false;
+	}
+
+	const auto &expectedErrors = reference.getErrors();
+	const auto &actualErrors = lexer.getErrors();
+	if (expectedErrors.size() != actualErrors.size()) {
+		std::cerr << std::format("{}: expected {} errors, got {}\n", name,
+		                         expectedErrors.size(), actualErrors.size());
+		return false;
+	}
+	for (size_t i = 0; i < expectedErrors.size(); i++) {
+		if (!sameError(expectedErrors[i], actualErrors[i])) {
+			std::cerr << std::format(
+			    "{}: error {} differs\n  expected {} {}\n  actual   {} {}\n",
+			    name, i, expectedErrors[i].positionString(),
+			    expectedErrors[i].toString(), actualErrors[i].positionString(),
+			    actualErrors[i].toString());
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+// lexes every given file with the lexer and with the reference lexer it
+// replaced, and fails on the first token or error they disagree on. every
+// prefix of a file is lexed as well, so each token is also seen cut off by
+// the end of the input
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		std::cerr << std::format("Usage: {} <file.ray>...\n", argv[0]);
+		return 1;
+	}
+	for (int i = 1; i < argc; i++) {
+		auto file = SourceBuffer::open(argv[i]);
+		if (!file) {
+			std::cerr << std::format("could not open file: {}\n", argv[i]);
+			return 1;
+		}
+		auto source = file->view();
+		for (size_t length = 0; length <= source.size(); length++) {
+			auto name = length == source.size()
+			                ? std::string(argv[i])
+			                : std::format("{} (first {} bytes)", argv[i],
+			                              length);
+			if (!compare(name, source.substr(0, length))) {
+				return 1;
+			}
+		}
+		std::cout << std::format("{}: {} bytes, same tokens\n", argv[i],
+		                         source.size());
+	}
+	return 0;
+}
@@ -0,0 +1,543 @@
+#include <cctype>
+#include <cstddef>
+#include <format>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <ray/compiler/lexer/lexer_error.hpp>
+#include <ray/compiler/lexer/token.hpp>
+
+#include "reference_lexer.hpp"
+
+namespace ray::compiler::test {
+namespace {
+// the lookup the lexer used before the tables, single characters and keywords
+// are the only strings it asked for
+Token::TokenType tokenType(std::string_view str) {
+	static const std::unordered_map<std::string_view, Token::TokenType> map = {
+	    // block tokens
+	    {"(", Token::TokenType::TOKEN_LEFT_PAREN},
+	    {")", Token::TokenType::TOKEN_RIGHT_PAREN},
+	    {"{", Token::TokenType::TOKEN_LEFT_BRACE},
+	    {"}", Token::TokenType::TOKEN_RIGHT_BRACE},
+	    {"[", Token::TokenType::TOKEN_LEFT_SQUARE_BRACE},
+	    {"]", Token::TokenType::TOKEN_RIGHT_SQUARE_BRACE},
+	    // assignment
+	    {"=", Token::TokenType::TOKEN_EQUAL},
+	    // arithmetic
+	    {"+", Token::TokenType::TOKEN_PLUS},
+	    {"-", Token::TokenType::TOKEN_MINUS},
+	    {"*", Token::TokenType::TOKEN_STAR},
+	    {"/", Token::TokenType::TOKEN_SLASH},
+	    {"%", Token::TokenType::TOKEN_PERCENT},
+	    {"&", Token::TokenType::TOKEN_AMPERSAND},
+	    {"|", Token::TokenType::TOKEN_PIPE},
+	    {"^", Token::TokenType::TOKEN_CARET},
+	    // logical
+	    {"!", Token::TokenType::TOKEN_BANG},
+	    // comparison
+	    {"<", Token::TokenType::TOKEN_LESS},
+	    {">", Token::TokenType::TOKEN_GREAT},
+	    // misc
+	    {".", Token::TokenType::TOKEN_DOT},
+	    {",", Token::TokenType::TOKEN_COMMA},
+	    {"?", Token::TokenType::TOKEN_QUESTION},
+	    {":", Token::TokenType::TOKEN_COLON},
+	    {";", Token::TokenType::TOKEN_SEMICOLON},
+	    {"#", Token::TokenType::TOKEN_POUND},
+	    // keywords
+	    {"if", Token::TokenType::TOKEN_IF},
+	    {"else", Token::TokenType::TOKEN_ELSE},
+	    {"true", Token::TokenType::TOKEN_TRUE},
+	    {"false", Token::TokenType::TOKEN_FALSE},
+	    {"for", Token::TokenType::TOKEN_FOR},
+	    {"while", Token::TokenType::TOKEN_WHILE},
+	    {"fn", Token::TokenType::TOKEN_FN},
+	    {"let", Token::TokenType::TOKEN_LET},
+	    {"return", Token::TokenType::TOKEN_RETURN},
+	    {"continue", Token::TokenType::TOKEN_CONTINUE},
+	    {"break", Token::TokenType::TOKEN_BREAK},
+	    {"pub", Token::TokenType::TOKEN_PUB},
+	    {"mut", Token::TokenType::TOKEN_MUT},
+	    {"struct", Token::TokenType::TOKEN_STRUCT},
+	    {"as", Token::TokenType::TOKEN_AS},
+	    {"import", Token::TokenType::TOKEN_IMPORT},
+	};
+	auto it = map.find(str);
+	return it != map.end() ? it->second : Token::TokenType::TOKEN_ERROR;
+}
+} // namespace
+
+ReferenceLexer::ReferenceLexer(std::string_view source) : source(source) {}
+
+bool ReferenceLexer::isAtEnd() const { return current >= source.length(); };
+
+std::vector<Token> ReferenceLexer::scanTokens() {
+	tokens.clear();
+	errors.clear();
+	current = 0;
+	line = 1;
+	column = 0;
+
+	while (!isAtEnd()) {
+		start = current;
+		scanToken();
+	}
+
+	addToken(Token::TokenType::TOKEN_EOF);
+
+	return tokens;
+}
+
+const std::vector<LexerError> &ReferenceLexer::getErrors() const {
+	return errors;
+}
+
+void ReferenceLexer::scanToken() {
+	char c = advance();
+	Token::TokenType type = tokenType({&c, 1});
+	startLine = line;
+	startColumn = column;
+	switch (type) {
+	// multi char tokens
+	case Token::TokenType::TOKEN_PLUS: {
+		char next = peek();
+		if (next == '+') {
+			advance();
+			addToken(Token::TokenType::TOKEN_PLUS_PLUS);
+		} else if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_PLUS_EQUAL);
+		} else {
+			addToken(Token::TokenType::TOKEN_PLUS);
+		}
+		break;
+	}
+	case Token::TokenType::TOKEN_MINUS: {
+		char next = peek();
+		if (next == '>') {
+			advance();
+			addToken(Token::TokenType::TOKEN_ARROW);
+		} else if (next == '-') {
+			advance();
+			addToken(Token::TokenType::TOKEN_MINUS_MINUS);
+		} else if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_MINUS_EQUAL);
+		} else {
+			addToken(Token::TokenType::TOKEN_MINUS);
+		}
+		break;
+	}
+	case Token::TokenType::TOKEN_STAR: {
+		char next = peek();
+		if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_STAR_EQUAL);
+		} else {
+			addToken(Token::TokenType::TOKEN_STAR);
+		}
+		break;
+	}
+	case Token::TokenType::TOKEN_SLASH: {
+		char next = peek();
+		if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_SLASH_EQUAL);
+		} else if (next == '/') {
+			advance();
+			comment();
+		} else if (next == '*') {
+			advance();
+			multiLineComment();
+		} else {
+			addToken(Token::TokenType::TOKEN_SLASH);
+		}
+		break;
+	}
+	case Token::TokenType::TOKEN_PERCENT: {
+		char next = peek();
+		if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_PERCENT_EQUAL);
+		} else {
+			addToken(Token::TokenType::TOKEN_PERCENT);
+		}
+		break;
+	}
+	case Token::TokenType::TOKEN_AMPERSAND: {
+		char next = peek();
+		if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_AMPERSAND_EQUAL);
+		} else if (next == '&') {
+			advance();
+			addToken(Token::TokenType::TOKEN_AMPERSAND_AMPERSAND);
+		} else {
+			addToken(Token::TokenType::TOKEN_AMPERSAND);
+		}
+		break;
+	}
+	case Token::TokenType::TOKEN_PIPE: {
+		char next = peek();
+		if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_PIPE_EQUAL);
+		} else if (next == '|') {
+			advance();
+			addToken(Token::TokenType::TOKEN_PIPE_PIPE);
+		} else {
+			addToken(Token::TokenType::TOKEN_PIPE);
+		}
+		break;
+	}
+	case Token::TokenType::TOKEN_CARET: {
+		char next = peek();
+		if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_CARET_EQUAL);
+		} else {
+			addToken(Token::TokenType::TOKEN_CARET);
+		}
+		break;
+	}
+	case Token::TokenType::TOKEN_BANG: {
+		char next = peek();
+		if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_BANG_EQUAL);
+		} else {
+			addToken(Token::TokenType::TOKEN_BANG);
+		}
+		break;
+	}
+	case Token::TokenType::TOKEN_LESS: {
+		char next = peek();
+		if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_LESS_EQUAL);
+		} else if (next == '<') {
+			advance();
+			if (peek() == '=') {
+				advance();
+				addToken(Token::TokenType::TOKEN_LESS_LESS_EQUAL);
+			} else {
+				addToken(Token::TokenType::TOKEN_LESS_LESS);
+			}
+		} else {
+			addToken(Token::TokenType::TOKEN_LESS);
+		}
+		break;
+	}
+	case Token::TokenType::TOKEN_GREAT: {
+		char next = peek();
+		if (next == '=') {
+			advance();
+			addToken(Token::TokenType::TOKEN_GREAT_EQUAL);
+		} else if (next == '>') {
+			advance();
+			if (peek() == '=') {
+				advance();
+				addToken(Token::TokenType::TOKEN_GREAT_GREAT_EQUAL);
+			} else {
+				addToken(Token::TokenType::TOKEN_GREAT_GREAT);
+			}
+		} else {
+			addToken(Token::TokenType::TOKEN_LESS);
+		}
+		break;
+	}
+	// access or number
+	case Token::TokenType::TOKEN_DOT: {
+		char next = peekNext();
+		if (std::isdigit(next)) {
+			number();
+		} else {
+			addToken(Token::TokenType::TOKEN_DOT);
+		}
+		break;
+	}
+	// not expected character
+	case Token::TokenType::TOKEN_ERROR: {
+		if (std::isalpha(c) || c == '_') {
+			identifier();
+		} else if (std::isdigit(c)) {
+			number();
+		} else if (c == '"') {
+			string();
+		} else if (c == '\'') {
+			charLiteral();
+		} else if (c == '@') {
+			intrinsicFunction();
+		} else if (c == ' ' || c == '\r' || c == '\t' || c == '\n') {
+		} else {
+			Token errorToken =
+			    Token{type, source.substr(current - 1, 1), line, column};
+			errors.push_back(
+			    {.category = LexerError::ErrorCategory::UnexpectedCharacter,
+			     .token = errorToken,
+			     .message = "Unexpected character"});
+		}
+		break;
+	}
+	// any other token
+	default: {
+		addToken(type);
+		break;
+	}
+	}
+}
+
+char ReferenceLexer::advance() {
+	column++;
+	if (peek() == '\n') {
+		line++;
+		column = 0;
+	}
+	// unterminated literals advance past the end, there is nothing to read
+	char c = isAtEnd() ? '\0' : source[current];
+	current++;
+	return c;
+};
+
+void ReferenceLexer::addToken(Token::TokenType type) { addToken(type, ""); }
+void ReferenceLexer::addToken(Token::TokenType type, std::string_view literal) {
+	tokens.push_back(Token{.type = type,
+	                       .lexeme = literal,
+	                       .line = startLine,
+	                       .column = startColumn});
+}
+void ReferenceLexer::addToken(Token::TokenType type, std::string_view literal,
+                     size_t line, size_t column) {
+	tokens.push_back(
+	    Token{.type = type, .lexeme = literal, .line = line, .column = column});
+}
+
+std::string_view ReferenceLexer::storeLiteral(std::string literal) {
+	return literalStorage.emplace_back(std::move(literal));
+}
+
+bool ReferenceLexer::match(char expected) {
+	if (isAtEnd() || source[current] != expected) {
+		return false;
+	}
+	current++;
+	return true;
+}
+
+void ReferenceLexer::string() {
+	// the value is only materialized once an escape sequence is found, until
+	// then the literal is a view of the source
+	std::string value;
+	bool escaped = false;
+	while (peek() != '"' && !isAtEnd()) {
+		// escape characters starting with backslash
+		if (peek() == '\\') {
+			if (!escaped) {
+				value = source.substr(start + 1, current - start - 1);
+				escaped = true;
+			}
+			advance();
+			if (isAtEnd()) {
+				Token errorToken{Token::TokenType::TOKEN_STRING,
+				                 storeLiteral(value), line, column};
+				errors.push_back(
+				    {.category = LexerError::ErrorCategory::UnterminatedString,
+				     .token = errorToken,
+				     .message = "Unterminated string"});
+			}
+			switch (peek()) {
+			case 'n': {
+				value.push_back('\n');
+				break;
+			}
+			case '0': {
+				value.push_back('\0');
+				break;
+			}
+			default: {
+				Token errorToken{Token::TokenType::TOKEN_STRING,
+				                 storeLiteral(value), line, column};
+				errors.push_back(
+				    {.category = LexerError::ErrorCategory::UnterminatedString,
+				     .token = errorToken,
+				     .message = std::format("Unknown escape sequence '\\{}'",
+				                            peek())});
+				return;
+			}
+			}
+			advance();
+			continue;
+		}
+		if (escaped) {
+			value.push_back(peek());
+		}
+		advance();
+	}
+
+	auto literal = escaped ? storeLiteral(std::move(value))
+	                       : source.substr(start + 1, current - start - 1);
+	if (isAtEnd()) {
+		Token errorToken{Token::TokenType::TOKEN_STRING, literal, line, column};
+		errors.push_back(
+		    {.category = LexerError::ErrorCategory::UnterminatedString,
+		     .token = errorToken,
+		     .message = "Unterminated string"});
+		return;
+	}
+
+	advance();
+
+	addToken(Token::TokenType::TOKEN_STRING, literal);
+}
+
+void ReferenceLexer::number() {
+	while (std::isdigit(peek())) {
+		advance();
+	}
+
+	if (peek() == '.' && std::isdigit(peekNext())) {
+		advance();
+		while (std::isdigit(peek())) {
+			advance();
+		}
+	}
+
+	auto number_literal = source.substr(start, current - start);
+
+	if (peek() == 'i' || peek() == 'u') {
+		size_t index = number_literal.length();
+		std::string_view new_literal = "";
+		// the suffix may be cut off by the end of the source
+		auto subType = source.substr(start + index, 3);
+		auto suffix = [&](size_t i) {
+			return i < subType.size() ? subType[i] : '\0';
+		};
+
+		if ((suffix(1) == '1' && suffix(2) == '6') ||
+		    (suffix(1) == '3' && suffix(2) == '2') ||
+		    (suffix(1) == '6' && suffix(2) == '4')) {
+			new_literal = source.substr(start, current - start + 3);
+		} else if (suffix(1) == '8') {
+			new_literal = source.substr(start, current - start + 2);
+		}
+
+		size_t next = start + new_literal.length();
+		auto nextChar = next < source.size() ? source[next] : '\0';
+		if (!std::isalnum(nextChar) && nextChar != '_') {
+			number_literal = new_literal;
+		}
+
+		if (number_literal.length() != current - start) {
+			for (size_t i = current - start; i < number_literal.length(); i++) {
+				advance();
+			}
+		}
+	}
+
+	addToken(Token::TokenType::TOKEN_NUMBER, number_literal);
+}
+void ReferenceLexer::charLiteral() {
+	// escaped values are views over static literals instead of the source
+	std::string_view character{"\0", 1};
+	if (peek() != '\\') {
+		if (!isAtEnd()) {
+			character = source.substr(current, 1);
+		}
+		advance();
+	} else {
+		advance();
+		switch (peek()) {
+		case 'n': {
+			character = "\n";
+			break;
+		}
+		case '0':
+			character = {"\0", 1};
+			break;
+		default: {
+			Token errorToken{
+			    Token::TokenType::TOKEN_STRING, character, line, column};
+			errors.push_back(
+			    {.category = LexerError::ErrorCategory::UnterminatedCharLiteral,
+			     .token = errorToken,
+			     .message =
+			         std::format("Unknown escape sequence '\\{}'", peek())});
+			return;
+		}
+		}
+		advance();
+	}
+
+	if (peek() != '\'') {
+		Token errorToken{
+		    Token::TokenType::TOKEN_CHAR, character, line, column};
+		errors.push_back(
+		    {.category = LexerError::ErrorCategory::UnterminatedCharLiteral,
+		     .token = errorToken,
+		     .message = "Expected ' after char literal"});
+	}
+	advance();
+	addToken(Token::TokenType::TOKEN_CHAR, character);
+}
+
+void ReferenceLexer::intrinsicFunction() {
+	auto startColumn = column;
+	auto startLine = line;
+	while (std::isalnum(peek()) || peek() == '_') {
+		advance();
+	}
+	auto text = source.substr(start, current - start);
+	addToken(Token::TokenType::TOKEN_INTRINSIC, text, startLine, startColumn);
+}
+
+void ReferenceLexer::identifier() {
+	while (std::isalnum(peek()) || peek() == '_') {
+		advance();
+	}
+	auto text = source.substr(start, current - start);
+	auto type = tokenType(text);
+	addToken(type == Token::TokenType::TOKEN_ERROR
+	             ? Token::TokenType::TOKEN_IDENTIFIER
+	             : type,
+	         type == Token::TokenType::TOKEN_ERROR ? text : "");
+}
+
+void ReferenceLexer::comment() {
+	while (!isAtEnd()) {
+		if (peek() == '\n') {
+			advance();
+			break;
+		}
+		advance();
+	}
+}
+
+void ReferenceLexer::multiLineComment() {
+	while (!isAtEnd()) {
+		if (peek() == '*' && peekNext() == '/') {
+			advance();
+			advance();
+			break;
+		}
+		advance();
+	}
+}
+
+char ReferenceLexer::peek() {
+	if (isAtEnd()) {
+		return '\0';
+	}
+	return source[current];
+}
+
+char ReferenceLexer::peekNext() {
+	if (current + 1 >= source.length()) {
+		return '\0';
+	}
+	return source[current + 1];
+}
+
+} // namespace ray::compiler::test
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <ray/compiler/lexer/lexer_error.hpp>
+#include <ray/compiler/lexer/token.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ray::compiler::test {
+// the lexer as it was before the table driven fast paths: one advance() per
+// character, std::is* classification and a hash map for every token type.
+// kept only to check the real lexer produces the same tokens and errors. the
+// one change is the bounds check on number suffixes cut off by the end of the
+// source, which both lexers used to read past
+class ReferenceLexer {
+	std::string_view source;
+	std::vector<Token> tokens;
+	std::vector<LexerError> errors;
+	std::deque<std::string> literalStorage;
+	size_t start = 0;
+	size_t startLine = 0;
+	size_t startColumn = 0;
+	size_t current = 0;
+	size_t line = 1;
+	size_t column = 0;
+
+  public:
+	ReferenceLexer(std::string_view source);
+
+	bool isAtEnd() const;
+	std::vector<Token> scanTokens();
+
+	const std::vector<LexerError> &getErrors() const;
+
+  private:
+	void scanToken();
+	char advance();
+
+	void addToken(Token::TokenType type);
+	void addToken(Token::TokenType type, std::string_view literal);
+	void addToken(Token::TokenType type, std::string_view literal, size_t line,
+	              size_t column);
+	std::string_view storeLiteral(std::string literal);
+	bool match(char expected);
+	void string();
+	void number();
+	void charLiteral();
+	void intrinsicFunction();
+	void identifier();
+	void comment();
+	void multiLineComment();
+
+	char peek();
+	char peekNext();
+};
+
+} // namespace ray::compiler::test
@@ -0,0 +1,64 @@
+#include <ray/ray_definitions.h>
+#ifdef __cplusplus
+RAY_C_LINKAGE {
+#endif
+#pragma region imported_declarations
+f64 log10(f64 number);
+f64 floor(f64 number);
+typedef struct FILE FILE;
+c_size fwrite(const void*const buffer, c_size size, c_size count, const FILE* stream);
+const FILE* ray_libc_stdio_get_stdout();
+c_int atoi(const c_char*const buffer);
+const void free(const void* size);
+const void* malloc(const c_size size);
+c_size strlen(const c_char*const buffer);
+#pragma endregion imported_declarations
+#pragma region struct_declarations
+#pragma endregion struct_declarations
+#pragma region struct_definitions
+#pragma endregion struct_definitions
+#pragma region function_declarations
+RAY_DEFAULT_LINKAGE s32 main(s32 argc, const c_char** argv);
+RAYLANG_MACRO_LINK_LOCAL static const s32 _rayMv0_TF_M0__N3_fib(const s32 n);
+RAYLANG_MACRO_LINK_LOCAL static u8*const _rayMv0_TF_M0__N11_s32toString(const s32 num);
+RAYLANG_MACRO_LINK_LOCAL static const void _rayMv0_TF_M0__N5_print(const u8*const buffer);
+#pragma endregion function_declarations
+RAYLANG_MACRO_LINK_LOCAL static const void _rayMv0_TF_M0__N5_print(const u8 * const buffer) {
+	fwrite((const void*)(buffer), (c_size )(((ssize)1)), strlen((const c_char * const )(buffer)), ray_libc_stdio_get_stdout());
+}
+RAYLANG_MACRO_LINK_LOCAL static u8 * const  _rayMv0_TF_M0__N11_s32toString(const s32 num) {
+	const usize  floorResult = (const usize )(floor(log10((f64 )(num))));
+	const usize  size = floorResult + 1;
+	const s32  n = num;
+	u8 * const  array = (u8 * const )(malloc(size + 1));
+	const usize  i = size - 1;
+	array[size] = (const u8){0x00};
+	while (n != 0) {
+		array[i--] = n % 10 + (const u8){0x30};
+		n /= 10;
+	}
+	return array;
+}
+RAYLANG_MACRO_LINK_LOCAL static const s32  _rayMv0_TF_M0__N3_fib(const s32 n) {
+	if (n <= 2) {
+		return 1;
+	}
+	return _rayMv0_TF_M0__N3_fib(n - 1) + _rayMv0_TF_M0__N3_fib(n - 2);
+}
+RAY_DEFAULT_LINKAGE s32  main(s32 argc, const c_char **argv) {
+	if (argc != 2) {
+		_rayMv0_TF_M0__N5_print((const u8[]){0x75, 0x73, 0x61, 0x67, 0x65, 0x3A, 0x20, 0x00}/*"usage: "*/);
+		_rayMv0_TF_M0__N5_print((const u8 * const )(argv[0]));
+		_rayMv0_TF_M0__N5_print((const u8[]){0x20, 0x6E, 0x75, 0x6D, 0x62, 0x65, 0x72, 0x0A, 0x00}/*" number\n"*/);
+		return -1;
+	}
+	const s32  result = _rayMv0_TF_M0__N3_fib((const s32 )(atoi(argv[1])));
+	u8 * const  resultStr = _rayMv0_TF_M0__N11_s32toString(result);
+	_rayMv0_TF_M0__N5_print(resultStr);
+	free((const void*)(resultStr));
+	_rayMv0_TF_M0__N5_print((const u8[]){0x0A, 0x00}/*"\n"*/);
+	return 0;
+}
+#ifdef __cplusplus
+}
+#endif
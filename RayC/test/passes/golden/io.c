@@ -0,0 +1,18 @@
+#include <ray/ray_definitions.h>
+#ifdef __cplusplus
+RAY_C_LINKAGE {
+#endif
+#pragma region imported_declarations
+#pragma endregion imported_declarations
+#pragma region struct_declarations
+typedef struct FILE FILE;
+#pragma endregion struct_declarations
+#pragma region struct_definitions
+#pragma endregion struct_definitions
+#pragma region function_declarations
+c_size fwrite(const void*const buffer, c_size size, c_size count, const FILE* stream);
+const FILE* ray_libc_stdio_get_stdout();
+#pragma endregion function_declarations
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,17 @@
+#include <ray/ray_definitions.h>
+#ifdef __cplusplus
+RAY_C_LINKAGE {
+#endif
+#pragma region imported_declarations
+#pragma endregion imported_declarations
+#pragma region struct_declarations
+#pragma endregion struct_declarations
+#pragma region struct_definitions
+#pragma endregion struct_definitions
+#pragma region function_declarations
+f64 log10(f64 number);
+f64 floor(f64 number);
+#pragma endregion function_declarations
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,18 @@
+#include <ray/ray_definitions.h>
+#ifdef __cplusplus
+RAY_C_LINKAGE {
+#endif
+#pragma region imported_declarations
+#pragma endregion imported_declarations
+#pragma region struct_declarations
+#pragma endregion struct_declarations
+#pragma region struct_definitions
+#pragma endregion struct_definitions
+#pragma region function_declarations
+c_int atoi(const c_char*const buffer);
+const void free(const void* size);
+const void* malloc(const c_size size);
+#pragma endregion function_declarations
+#ifdef __cplusplus
+}
+#endif
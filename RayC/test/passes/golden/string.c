@@ -0,0 +1,16 @@
+#include <ray/ray_definitions.h>
+#ifdef __cplusplus
+RAY_C_LINKAGE {
+#endif
+#pragma region imported_declarations
+#pragma endregion imported_declarations
+#pragma region struct_declarations
+#pragma endregion struct_declarations
+#pragma region struct_definitions
+#pragma endregion struct_definitions
+#pragma region function_declarations
+c_size strlen(const c_char*const buffer);
+#pragma endregion function_declarations
+#ifdef __cplusplus
+}
+#endif
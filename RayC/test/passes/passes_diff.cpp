@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ray/compiler/driver.hpp>
+#include <ray/compiler/source_buffer.hpp>
+
+using namespace ray::compiler;
+
+namespace {
+
+std::vector<std::string_view> splitLines(std::string_view text) {
+	std::vector<std::string_view> lines;
+	while (!text.empty()) {
+		auto end = text.find('\n');
+		if (end == std::string_view::npos) {
+			lines.push_back(text);
+			break;
+		}
+		lines.push_back(text.substr(0, end));
+		text.remove_prefix(end + 1);
+	}
+	return lines;
+}
+
+// compares the C a build wrote against the golden file, prints the first
+// line they disagree on
+bool compare(std::string_view name, const std::filesystem::path &golden,
+             const std::filesystem::path &output) {
+	auto expectedFile = SourceBuffer::open(golden);
+	if (!expectedFile) {
+		std::cerr << std::format("{}: could not open golden file {}\n", name,
+		                         golden.string());
+		return false;
+	}
+	auto actualFile = SourceBuffer::open(output);
+	if (!actualFile) {
+		std::cerr << std::format("{}: no output written to {}\n", name,
+		                         output.string());
+		return false;
+	}
+	auto expected = splitLines(expectedFile->view());
+	auto actual = splitLines(actualFile->view());
+	size_t count = std::min(expected.size(), actual.size());
+	for (size_t i = 0; i < count; i++) {
+		if (expected[i] != actual[i]) {
+			std::cerr << std::format("{}: line {} differs\n  expected {}\n"
+			                         "  actual   {}\n",
+			                         name, i + 1, expected[i], actual[i]);
+			return false;
+		}
+	}
+	if (expected.size() != actual.size()) {
+		std::cerr << std::format("{}: expected {} lines, got {}\n", name,
+		                         expected.size(), actual.size());
+		return false;
+	}
+	// the lines only disagree on the newline at the very end
+	if (expectedFile->view() != actualFile->view()) {
+		std::cerr << std::format("{}: last line ends differently\n", name);
+		return false;
+	}
+	return true;
+}
+
+// runs a build the way rayc does with the given command line
+bool build(std::vector<std::string> arguments, std::string_view name) {
+	std::vector<char *> argv;
+	for (auto &argument : arguments) {
+		argv.push_back(argument.data());
+	}
+	argv.push_back(nullptr);
+	std::ostringstream output;
+	std::ostringstream diagnostics;
+	int status = Driver().run(static_cast<int>(arguments.size()),
+	                          argv.data(), output, diagnostics);
+	if (status != 0) {
+		std::cerr << std::format("{}: does not compile\n{}{}", name,
+		                         output.str(), diagnostics.str());
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+// compiles every given file through the flat tree passes and fails when the
+// C differs from <golden dir>/<stem>.c, -P packages are passed on to the
+// builds
+int main(int argc, char **argv) {
+	if (argc < 4) {
+		std::cerr << std::format("Usage: {} <golden dir> <work dir> "
+		                         "[-P name=root]... <file.ray>...\n",
+		                         argv[0]);
+		return 1;
+	}
+	std::filesystem::path goldenDirectory = argv[1];
+	std::filesystem::path workDirectory = argv[2];
+	std::vector<std::string> packages;
+	std::vector<std::string> inputs;
+	for (int i = 3; i < argc; i++) {
+		std::string_view arg = argv[i];
+		if (arg == "-P" && i + 1 < argc) {
+			packages.push_back(std::string(arg));
+			packages.push_back(argv[++i]);
+		} else {
+			inputs.push_back(std::string(arg));
+		}
+	}
+	std::filesystem::create_directories(workDirectory);
+
+	for (const auto &input : inputs) {
+		auto stem = std::filesystem::path(input).stem().string();
+		auto golden = goldenDirectory / (stem + ".c");
+		auto output = workDirectory / (stem + ".c");
+		std::vector<std::string> arguments = {"rayc"};
+		arguments.insert(arguments.end(), packages.begin(), packages.end());
+		arguments.insert(arguments.end(), {"-o", output.string(), input});
+		if (!build(std::move(arguments), input) ||
+		    !compare(input, golden, output)) {
+			return 1;
+		}
+		std::cout << std::format("{}: same C as {}\n", input,
+		                         golden.string());
+	}
+	return 0;
+}
@@ -0,0 +1,218 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <ray/util/thread_pool.hpp>
+
+using ray::compiler::util::ThreadPool;
+
+namespace {
+
+constexpr size_t workerCount = 4;
+
+// keeps the worker busy for a while without sleeping, so uneven tasks hold
+// on to their worker the way a big unit would
+void spin(size_t rounds) {
+	volatile uint64_t value = 0;
+	for (size_t i = 0; i < rounds; i++) {
+		value = value + i;
+	}
+}
+
+// thousands of tasks of very different length, some of them submitting more
+// tasks from a worker, over several rounds on the same pool. every task has
+// to run exactly once and wait must not return before the nested ones ran
+std::optional<std::string> unevenTasks() {
+	constexpr size_t rounds = 20;
+	constexpr size_t tasks = 2000;
+	constexpr size_t nestedPerTask = 3;
+	ThreadPool pool(workerCount);
+	for (size_t round = 0; round < rounds; round++) {
+		size_t total = tasks + (tasks / 10) * nestedPerTask;
+		auto runs = std::make_unique<std::atomic<uint32_t>[]>(total);
+		std::atomic<size_t> nextNested = tasks;
+		for (size_t i = 0; i < tasks; i++) {
+			pool.submit([&, i] {
+				spin(i % 97 == 0 ? 200000 : (i % 7) * 1000);
+				runs[i]++;
+				if (i % 10 != 0) {
+					return;
+				}
+				for (size_t j = 0; j < nestedPerTask; j++) {
+					size_t slot = nextNested++;
+					pool.submit([&, slot] {
+						spin(slot % 5 * 2000);
+						runs[slot]++;
+					});
+				}
+			});
+		}
+		pool.wait();
+		for (size_t i = 0; i < total; i++) {
+			if (runs[i] != 1) {
+				return std::format("round {}: task {} ran {} times", round, i,
+				                   runs[i].load());
+			}
+		}
+	}
+	return std::nullopt;
+}
+
+// the first task blocks its worker until every other task finished, which
+// only happens when the tasks spread to its deque are taken by the others
+std::optional<std::string> stealing() {
+	constexpr size_t tasks = 400;
+	ThreadPool pool(workerCount);
+	std::atomic<size_t> finished = 0;
+	std::atomic<bool> starved = false;
+	pool.submit([&] {
+		auto deadline = std::chrono::steady_clock::now() +
+		                std::chrono::seconds(30);
+		while (finished < tasks - 1) {
+			if (std::chrono::steady_clock::now() > deadline) {
+				starved = true;
+				return;
+			}
+			std::this_thread::yield();
+		}
+	});
+	for (size_t i = 1; i < tasks; i++) {
+		pool.submit([&] {
+			spin(1000);
+			finished++;
+		});
+	}
+	pool.wait();
+	if (starved) {
+		return std::format("only {} of {} tasks ran while a worker was busy",
+		                   finished.load(), tasks - 1);
+	}
+	return std::nullopt;
+}
+
+// wait rethrows the first exception a task threw once every task finished,
+// and the pool keeps working afterwards
+std::optional<std::string> exceptions() {
+	constexpr size_t tasks = 500;
+	ThreadPool pool(workerCount);
+	std::atomic<size_t> finished = 0;
+	for (size_t i = 0; i < tasks; i++) {
+		pool.submit([&, i] {
+			spin(i % 3 * 1000);
+			if (i % 50 == 7) {
+				throw std::runtime_error(std::format("task {} failed", i));
+			}
+			finished++;
+		});
+	}
+	try {
+		pool.wait();
+		return "wait returned normally after tasks threw";
+	} catch (const std::runtime_error &error) {
+		if (std::string_view(error.what()).find("failed") ==
+		    std::string_view::npos) {
+			return std::format("wait threw '{}'", error.what());
+		}
+	}
+	if (finished != tasks - tasks / 50) {
+		return std::format("{} tasks finished besides the failing ones, "
+		                   "expected {}",
+		                   finished.load(), tasks - tasks / 50);
+	}
+
+	finished = 0;
+	for (size_t i = 0; i < tasks; i++) {
+		pool.submit([&] { finished++; });
+	}
+	try {
+		pool.wait();
+	} catch (const std::exception &error) {
+		return std::format("the exception was thrown again: {}", error.what());
+	}
+	if (finished != tasks) {
+		return std::format("{} of {} tasks ran after the exception",
+		                   finished.load(), tasks);
+	}
+	return std::nullopt;
+}
+
+// destroying the pool without waiting still runs every task it was given,
+// including the ones submitted while it is shutting down. an exception
+// nobody waits for is dropped
+std::optional<std::string> destruction() {
+	constexpr size_t tasks = 1000;
+	std::atomic<size_t> finished = 0;
+	std::atomic<size_t> expected = tasks;
+	{
+		ThreadPool pool(workerCount);
+		for (size_t i = 0; i < tasks; i++) {
+			pool.submit([&, i] {
+				spin(i < workerCount ? 500000 : 200);
+				if (i == tasks / 2) {
+					expected++;
+					pool.submit([&] { finished++; });
+				}
+				if (i == tasks / 3) {
+					throw std::runtime_error("nobody waits for this");
+				}
+				finished++;
+			});
+		}
+	}
+	// the throwing task does not count itself
+	if (finished != expected - 1) {
+		return std::format("{} of {} tasks ran before the pool was gone",
+		                   finished.load(), expected.load() - 1);
+	}
+	return std::nullopt;
+}
+
+} // namespace
+
+// runs the pool through uneven and nested tasks, a worker blocked until the
+// others drained its deque, tasks throwing and a pool destroyed with tasks
+// still queued. every scenario runs a few times to shake out races
+int main() {
+	struct Case {
+		std::string_view name;
+		std::function<std::optional<std::string>()> run;
+	};
+	const Case cases[] = {
+	    {"uneven tasks", unevenTasks},
+	    {"stealing", stealing},
+	    {"exceptions", exceptions},
+	    {"destruction", destruction},
+	};
+
+	constexpr size_t repetitions = 5;
+	int failed = 0;
+	for (const auto &test : cases) {
+		std::optional<std::string> error;
+		for (size_t i = 0; i < repetitions && !error; i++) {
+			error = test.run();
+		}
+		if (error) {
+			std::cerr << std::format("{}: {}\n", test.name, *error);
+			failed++;
+			continue;
+		}
+		std::cout << std::format("{}: ok\n", test.name);
+	}
+	if (failed != 0) {
+		std::cerr << std::format("{} of {} scenarios failed\n", failed,
+		                         std::size(cases));
+		return 1;
+	}
+	return 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <filesystem>
 
 namespace ray::vmapp {
@@ -9,6 +10,14 @@ struct Options {
 	bool disassembly = false;
 	std::filesystem::path output;
 	std::filesystem::path input;
+	// bytes of memory given to a program that is run, the stack starts at
+	// its end
+	std::size_t memory = 1024 * 1024;
+	// compile the hot functions of a program that is run, -i only interprets
+	bool jit = true;
+	// fuse and fold the instructions of a program that is assembled, -O0
+	// keeps them as written
+	bool optimize = true;
 
 	bool validate() const;
 };
@@ -2,9 +2,11 @@
 #include <rayvmapp/options.hpp>
 #include <rayvmapp/terminal.hpp>
 
+#include <charconv>
 #include <cstddef>
 #include <format>
 #include <string_view>
+#include <system_error>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -33,10 +35,29 @@ std::variant<Options, std::vector<std::string>> parse_args(int argc,
 				flags.insert("disassembly");
 				break;
 			}
+			case 'i': {
+				flags.insert("interpret");
+				break;
+			}
+			case 'O': {
+				// -O1, the default, fuses and folds instructions, -O0 keeps
+				// them as written
+				if (arg == "-O0") {
+					flags.insert("unoptimized");
+				} else if (arg != "-O1") {
+					errors.push_back(
+					    std::format("{}: unknown flag '{}'", "Error"_red, arg));
+				}
+				break;
+			}
 			case 'o': {
 				options_stack.push_back(std::string(arg));
 				break;
 			}
+			case 'm': {
+				options_stack.push_back(std::string(arg));
+				break;
+			}
 			default: {
 				errors.push_back(
 				    std::format("{}: unknown flag '{}'", "Error"_red, arg));
@@ -78,10 +99,21 @@ std::variant<Options, std::vector<std::string>> parse_args(int argc,
 	ray::vmapp::Options opts;
 	opts.assembly = flags.contains("assembly");
 	opts.disassembly = flags.contains("disassembly");
+	opts.jit = !flags.contains("interpret");
+	opts.optimize = !flags.contains("unoptimized");
 	opts.input = input_file;
 	opts.output = options.contains("-o")
 	                  ? options["-o"]
-	                  : std::format("out.{}", opts.assembly ? "asm" : "bin");
+	                  : std::format("out.{}", opts.disassembly ? "asm" : "bin");
+	if (options.contains("-m")) {
+		const auto &value = options["-m"];
+		auto [last, error] = std::from_chars(
+		    value.data(), value.data() + value.size(), opts.memory);
+		if (error != std::errc() || last != value.data() + value.size()) {
+			return std::vector<std::string>{std::format(
+			    "{}: invalid memory size '{}'", "Error"_red, value)};
+		}
+	}
 	return opts;
 }
 
@@ -3,12 +3,18 @@
 #include <rayvmapp/terminal.hpp>
 
 #include <ray/vm/assembler.hpp>
+#include <ray/vm/bytecode.hpp>
+#include <ray/vm/vm.hpp>
 
+#include <cstddef>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <span>
 #include <sstream>
+#include <vector>
 
 using namespace ray::vmapp::terminal::literals;
 
@@ -36,6 +42,7 @@ int main(int argc, char **argv) {
 
 		if (opts.assembly) {
 			ray::vm::Assembler assembler;
+			assembler.set_optimize(opts.optimize);
 			std::ifstream file(opts.input, std::ios::binary);
 			if (!file.is_open()) {
 				std::cerr << std::format("{}: Failed to open file '{}'\n",
@@ -64,6 +71,65 @@ int main(int argc, char **argv) {
 				output.write(reinterpret_cast<const char *>(bytecode.data()),
 				             bytecode.size());
 			}
+		} else if (opts.disassembly) {
+			std::ifstream file(opts.input, std::ios::binary);
+			if (!file.is_open()) {
+				std::cerr << std::format("{}: Failed to open file '{}'\n",
+				                         "Error"_red,
+				                         opts.input.relative_path().string());
+				return 1;
+			}
+			std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+			                        std::istreambuf_iterator<char>());
+			auto result = ray::vm::Program::deserialize(std::as_bytes(
+			    std::span<const char>(bytes.data(), bytes.size())));
+			if (std::holds_alternative<std::vector<std::string>>(result)) {
+				for (const auto &error :
+				     std::get<std::vector<std::string>>(result)) {
+					std::cerr << std::format("{}: {}\n", "Error"_red, error);
+				}
+				return 1;
+			}
+			std::ofstream output(opts.output);
+			if (!output.is_open()) {
+				std::cerr << std::format("{}: Failed to open file '{}'\n",
+				                         "Error"_red,
+				                         opts.output.relative_path().string());
+				return 1;
+			}
+			output << std::get<ray::vm::Program>(result).disassemble();
+		} else {
+			std::ifstream file(opts.input, std::ios::binary);
+			if (!file.is_open()) {
+				std::cerr << std::format("{}: Failed to open file '{}'\n",
+				                         "Error"_red,
+				                         opts.input.relative_path().string());
+				return 1;
+			}
+			std::vector<std::byte> program(
+			    std::filesystem::file_size(opts.input));
+			file.read(reinterpret_cast<char *>(program.data()),
+			          static_cast<std::streamsize>(program.size()));
+			ray::vm::VM vm(opts.memory);
+			vm.set_jit(opts.jit);
+			vm.load_program(program);
+			if (!vm.get_errors().empty()) {
+				for (const auto &error : vm.get_errors()) {
+					std::cerr << std::format("{}: {}\n", "Error"_red, error);
+				}
+				return 1;
+			}
+			vm.run();
+			const auto &cpu = vm.get_cpu();
+			if (cpu.inv_addr_f || cpu.of) {
+				auto trap = cpu.of ? "division by zero or overflow"
+				                   : "invalid address";
+				std::cerr << std::format("{}: {} at instruction {}\n",
+				                         "Error"_red, trap, cpu.pc);
+				return 1;
+			}
+			// the program leaves its result in r0
+			return static_cast<int>(cpu.gpr[0].qword);
 		}
 	}
 }
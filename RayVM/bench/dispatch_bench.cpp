@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <ray/vm/assembler.hpp>
+#include <ray/vm/bytecode.hpp>
+#include <ray/vm/vm.hpp>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view usage =
+    "Usage: {} [options]\n"
+    "  --iterations N   runs of every program, the best one is kept "
+    "(default 5)\n"
+    "  --loops N        iterations of the loop in every program "
+    "(default 10000000)\n"
+    "  --json FILE      write the results to FILE as JSON\n";
+
+struct Arguments {
+	size_t iterations = 5;
+	size_t loops = 10'000'000;
+	std::string jsonFile;
+};
+
+std::optional<Arguments> parseArguments(int argc, char **argv) {
+	Arguments arguments;
+	for (int i = 1; i < argc; i++) {
+		std::string_view name = argv[i];
+		if (i + 1 >= argc) {
+			return std::nullopt;
+		}
+		std::string_view value = argv[++i];
+		auto number = [&]() {
+			return static_cast<size_t>(
+			    std::strtoull(value.data(), nullptr, 10));
+		};
+		if (name == "--iterations") {
+			arguments.iterations = std::max<size_t>(number(), 1);
+		} else if (name == "--loops") {
+			arguments.loops = std::max<size_t>(number(), 1);
+		} else if (name == "--json") {
+			arguments.jsonFile = value;
+		} else {
+			return std::nullopt;
+		}
+	}
+	return arguments;
+}
+
+// a loop stressing one kind of instruction, its body runs after main loads
+// the iteration count into r1
+struct Workload {
+	std::string_view name;
+	std::string_view body;
+};
+
+constexpr Workload workloads[] = {
+    {"loop", "loop:\n"
+             "\tsub r1, r1, 1\n"
+             "\tjmpif r1, loop\n"
+             "\thalt\n"},
+    {"arithmetic", "\tload r2, 1\n"
+                   "\tload r3, 7\n"
+                   "loop:\n"
+                   "\tmul r2, r2, 3\n"
+                   "\tadd r2, r2, r3\n"
+                   "\tmod r2, r2, 1000003\n"
+                   "\tand r4, r2, 255\n"
+                   "\tor r5, r4, 1\n"
+                   "\tdiv r6, r2, r5\n"
+                   "\tsub r1, r1, 1\n"
+                   "\tgt r7, r1, 0\n"
+                   "\tjmpif r7, loop\n"
+                   "\thalt\n"},
+    {"calls", "loop:\n"
+              "\tcall leaf\n"
+              "\tsub r1, r1, 1\n"
+              "\tjmpif r1, loop\n"
+              "\thalt\n"
+              "leaf:\n"
+              "\tadd r2, r2, r1\n"
+              "\tret\n"},
+    {"memory", "loop:\n"
+               "\tload r2, [r6 + 64]\n"
+               "\tadd r2, r2, r1\n"
+               "\tstore r2, [r6 + 64]\n"
+               "\tsub r1, r1, 1\n"
+               "\tjmpif r1, loop\n"
+               "\thalt\n"},
+    {"nested", "loop:\n"
+               "\tcall outer\n"
+               "\tsub r1, r1, 1\n"
+               "\tjmpif r1, loop\n"
+               "\thalt\n"
+               "outer:\n"
+               "\tcall inner\n"
+               "\tcall inner\n"
+               "\tret\n"
+               "inner:\n"
+               "\tadd r2, r2, r1\n"
+               "\tmul r3, r2, 3\n"
+               "\tret\n"},
+    // the registers past r7 are not kept in host registers by the JIT
+    {"registers", "\tload r9, 3\n"
+                  "loop:\n"
+                  "\tadd r10, r10, r9\n"
+                  "\tmul r11, r10, 7\n"
+                  "\tmod r12, r11, 1000\n"
+                  "\tsub r13, r12, r1\n"
+                  "\tlt r14, r13, 0\n"
+                  "\tsub r1, r1, 1\n"
+                  "\tgt r15, r1, 0\n"
+                  "\tjmpif r15, loop\n"
+                  "\thalt\n"},
+};
+
+struct Result {
+	std::string_view name;
+	// plain runs the program as written, fused after the optimizer
+	std::string_view assembly;
+	std::string_view mode;
+	uint64_t instructions = 0;
+	Clock::duration best = Clock::duration::max();
+	// the state the program ends in, the same in every mode and the same
+	// registers with either assembly
+	ray::vm::CPUCore cpu = {};
+
+	double perSecond() const {
+		auto seconds = std::chrono::duration<double>(best).count();
+		return seconds > 0 ? static_cast<double>(instructions) / seconds : 0;
+	}
+};
+
+std::optional<Result> measure(const Workload &workload,
+                              const Arguments &arguments, bool optimize,
+                              bool jit) {
+	ray::vm::Assembler assembler;
+	assembler.set_optimize(optimize);
+	auto assembled = assembler.assemble_program(std::format(
+	    "main:\n\tload r1, {}\n{}", arguments.loops, workload.body));
+	if (auto *errors = std::get_if<std::vector<std::string>>(&assembled)) {
+		std::cerr << std::format("{} does not assemble\n", workload.name);
+		for (const auto &error : *errors) {
+			std::cerr << error << '\n';
+		}
+		return std::nullopt;
+	}
+	const auto &program = std::get<ray::vm::Program>(assembled);
+
+	Result result{.name = workload.name,
+	              .assembly = optimize ? "fused" : "plain",
+	              .mode = jit ? "jit" : "interpreter"};
+	ray::vm::VM vm(4096);
+	vm.set_jit(jit);
+	for (size_t i = 0; i < arguments.iterations; i++) {
+		vm.load_program(program);
+		auto start = Clock::now();
+		vm.run();
+		result.best = std::min(result.best, Clock::now() - start);
+		const auto &cpu = vm.get_cpu();
+		if (cpu.inv_addr_f || cpu.of || cpu.inv_inst_f) {
+			std::cerr << std::format("{} trapped at instruction {}\n",
+			                         workload.name, cpu.pc);
+			return std::nullopt;
+		}
+		result.instructions = vm.get_executed();
+		result.cpu = cpu;
+	}
+	return result;
+}
+
+bool same_registers(const Result &plain, const Result &fused) {
+	for (size_t i = 0; i < plain.cpu.gpr.size(); i++) {
+		if (plain.cpu.gpr[i].qword != fused.cpu.gpr[i].qword) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// native code has to leave the program exactly where the interpreter does
+bool same_state(const Result &interpreted, const Result &compiled) {
+	const auto &expected = interpreted.cpu;
+	const auto &actual = compiled.cpu;
+	return same_registers(interpreted, compiled) &&
+	       expected.sp == actual.sp && expected.pc == actual.pc &&
+	       expected.ra == actual.ra &&
+	       interpreted.instructions == compiled.instructions;
+}
+
+} // namespace
+
+// runs loops of arithmetic, calls and memory accesses as written and after
+// the optimizer fused them, through the interpreter and through the JIT where
+// it is supported, and reports how long they take and how many instructions
+// they run per second. the JIT has to end every program in the same state as
+// the interpreter, and the fused program in the same registers as the plain
+// one. fused programs dispatch fewer instructions, so compare their times
+int main(int argc, char **argv) {
+	auto arguments = parseArguments(argc, argv);
+	if (!arguments) {
+		std::cerr << std::format(usage, argv[0]);
+		return 1;
+	}
+
+#ifdef RAYVM_THREADED_DISPATCH
+	constexpr std::string_view dispatch = "threaded";
+#else
+	constexpr std::string_view dispatch = "switch";
+#endif
+	std::cout << std::format("dispatch: {}\n", dispatch);
+
+#ifdef RAYVM_JIT
+	constexpr bool modes[] = {false, true};
+#else
+	constexpr bool modes[] = {false};
+#endif
+	std::vector<Result> results;
+	for (const auto &workload : workloads) {
+		std::optional<Result> plain;
+		for (bool optimize : {false, true}) {
+			for (bool jit : modes) {
+				auto result = measure(workload, *arguments, optimize, jit);
+				if (!result) {
+					return 1;
+				}
+				std::cout << std::format(
+				    "{:<12} {:<6} {:<12} {:>12} instructions  "
+				    "best {:>9.3f} ms  {:>8.1f} M/s\n",
+				    result->name, result->assembly, result->mode,
+				    result->instructions,
+				    std::chrono::duration<double, std::milli>(result->best)
+				        .count(),
+				    result->perSecond() / 1e6);
+				if (jit && !same_state(results.back(), *result)) {
+					std::cerr << std::format(
+					    "{} ends in a different state with the JIT\n",
+					    workload.name);
+					return 1;
+				}
+				if (!plain) {
+					plain = result;
+				} else if (!same_registers(*plain, *result)) {
+					std::cerr << std::format(
+					    "{} ends in different registers when fused\n",
+					    workload.name);
+					return 1;
+				}
+				results.push_back(*result);
+			}
+		}
+	}
+
+	if (!arguments->jsonFile.empty()) {
+		std::string json = std::format(
+		    "{{\"version\":2,\"dispatch\":\"{}\",\"loops\":{},"
+		    "\"iterations\":{},\"workloads\":[",
+		    dispatch, arguments->loops, arguments->iterations);
+		for (size_t i = 0; i < results.size(); i++) {
+			json += std::format(
+			    "{}{{\"name\":\"{}\",\"assembly\":\"{}\",\"mode\":\"{}\","
+			    "\"instructions\":{},\"bestNs\":{},"
+			    "\"instructionsPerSecond\":{:.0f}}}",
+			    i == 0 ? "" : ",", results[i].name, results[i].assembly,
+			    results[i].mode, results[i].instructions,
+			    std::chrono::nanoseconds(results[i].best).count(),
+			    results[i].perSecond());
+		}
+		json += "]}\n";
+		std::ofstream file(arguments->jsonFile, std::ios::binary);
+		file << json;
+		if (!file) {
+			std::cerr << std::format("could not write {}\n",
+			                         arguments->jsonFile);
+			return 1;
+		}
+	}
+	return 0;
+}
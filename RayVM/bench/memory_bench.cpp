@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ray/vm/memory.hpp>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view usage =
+    "Usage: {} [options]\n"
+    "  --size N         bytes of memory accessed (default 1048576)\n"
+    "  --accesses N     loads or stores in every run (default 50000000)\n"
+    "  --iterations N   runs of every benchmark, the best one is kept "
+    "(default 5)\n"
+    "  --json FILE      write the results to FILE as JSON\n";
+
+struct Arguments {
+	size_t size = 1024 * 1024;
+	size_t accesses = 50'000'000;
+	size_t iterations = 5;
+	std::string jsonFile;
+};
+
+std::optional<Arguments> parseArguments(int argc, char **argv) {
+	Arguments arguments;
+	for (int i = 1; i < argc; i++) {
+		std::string_view name = argv[i];
+		if (i + 1 >= argc) {
+			return std::nullopt;
+		}
+		std::string_view value = argv[++i];
+		auto number = [&]() {
+			return static_cast<size_t>(
+			    std::strtoull(value.data(), nullptr, 10));
+		};
+		if (name == "--size") {
+			arguments.size = std::max<size_t>(number(), 64);
+		} else if (name == "--accesses") {
+			arguments.accesses = std::max<size_t>(number(), 1);
+		} else if (name == "--iterations") {
+			arguments.iterations = std::max<size_t>(number(), 1);
+		} else if (name == "--json") {
+			arguments.jsonFile = value;
+		} else {
+			return std::nullopt;
+		}
+	}
+	return arguments;
+}
+
+struct Result {
+	std::string name;
+	size_t width = 0;
+	Clock::duration best = Clock::duration::max();
+	// keeps the loads from being optimized away
+	uint64_t checksum = 0;
+};
+
+struct Access {
+	bool store;
+	bool aligned;
+	bool checked;
+};
+
+// walks the memory with a stride that is not a multiple of the access width
+// when unaligned, wrapping before the last access that would not fit
+template <typename T>
+Result measure(ray::vm::Memory &memory, const Arguments &arguments,
+               Access access) {
+	auto [store, aligned, checked] = access;
+	Result result{.name = std::format("{}{}-{}{}", store ? "store" : "load",
+	                                  sizeof(T) * 8,
+	                                  aligned ? "aligned" : "unaligned",
+	                                  checked ? "" : "-unchecked"),
+	              .width = sizeof(T)};
+	const size_t stride = aligned ? sizeof(T) * 8 : sizeof(T) * 8 + 3;
+	const size_t end = memory.size() - sizeof(T);
+	for (size_t run = 0; run < arguments.iterations; run++) {
+		uint64_t checksum = 0;
+		size_t address = aligned ? 0 : 1;
+		auto start = Clock::now();
+		for (size_t i = 0; i < arguments.accesses; i++) {
+			if (store && !checked) {
+				memory.storeUnchecked(address, static_cast<T>(i));
+			} else if (store) {
+				if (!memory.store(address, static_cast<T>(i))) {
+					checksum++;
+				}
+			} else if (!checked) {
+				checksum += memory.loadUnchecked<T>(address);
+			} else {
+				T value{};
+				if (memory.load(address, value)) {
+					checksum += value;
+				}
+			}
+			address += stride;
+			if (address > end) {
+				address -= end;
+			}
+		}
+		result.best = std::min(result.best, Clock::now() - start);
+		result.checksum = checksum;
+	}
+	return result;
+}
+
+double perSecond(const Result &result, size_t accesses) {
+	auto seconds = std::chrono::duration<double>(result.best).count();
+	return seconds > 0 ? static_cast<double>(accesses) / seconds : 0;
+}
+
+} // namespace
+
+// loads and stores of every width through the accessors of the VM memory,
+// aligned and not, checked and not, and reports how many it performs per
+// second
+int main(int argc, char **argv) {
+	auto arguments = parseArguments(argc, argv);
+	if (!arguments) {
+		std::cerr << std::format(usage, argv[0]);
+		return 1;
+	}
+
+	ray::vm::Memory memory(arguments->size);
+	std::vector<Result> results;
+	for (bool store : {false, true}) {
+		for (bool aligned : {true, false}) {
+			for (bool checked : {true, false}) {
+				Access access{store, aligned, checked};
+				results.push_back(
+				    measure<uint16_t>(memory, *arguments, access));
+				results.push_back(
+				    measure<uint32_t>(memory, *arguments, access));
+				results.push_back(
+				    measure<uint64_t>(memory, *arguments, access));
+			}
+		}
+	}
+
+	for (const auto &result : results) {
+		double accesses = perSecond(result, arguments->accesses);
+		std::cout << std::format(
+		    "{:<30} best {:>9.3f} ms  {:>8.1f} M/s  {:>6.2f} GB/s\n",
+		    result.name,
+		    std::chrono::duration<double, std::milli>(result.best).count(),
+		    accesses / 1e6,
+		    accesses * static_cast<double>(result.width) / 1e9);
+	}
+
+	if (!arguments->jsonFile.empty()) {
+		std::string json = std::format(
+		    "{{\"version\":1,\"size\":{},\"accesses\":{},\"iterations\":{},"
+		    "\"benchmarks\":[",
+		    arguments->size, arguments->accesses, arguments->iterations);
+		for (size_t i = 0; i < results.size(); i++) {
+			json += std::format(
+			    "{}{{\"name\":\"{}\",\"bestNs\":{},\"accessesPerSecond\":"
+			    "{:.0f},\"checksum\":{}}}",
+			    i == 0 ? "" : ",", results[i].name,
+			    std::chrono::nanoseconds(results[i].best).count(),
+			    perSecond(results[i], arguments->accesses),
+			    results[i].checksum);
+		}
+		json += "]}\n";
+		std::ofstream file(arguments->jsonFile, std::ios::binary);
+		file << json;
+		if (!file) {
+			std::cerr << std::format("could not write {}\n",
+			                         arguments->jsonFile);
+			return 1;
+		}
+	}
+	return 0;
+}
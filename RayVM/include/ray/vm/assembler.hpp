@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <variant>
 #include <vector>
 
@@ -10,15 +13,38 @@
 namespace ray::vm {
 
 class Assembler {
+	bool optimizing = true;
 
 	OpCode parse_opcode(const std::string_view token);
 	std::tuple<std::vector<std::string>, bool>
 	parse_operand(const std::string_view operand);
+	std::optional<uint8_t> parse_register(std::string_view operand);
+	std::optional<int64_t> parse_immediate(std::string_view operand);
+	// fills the registers and the operand mode of the instruction, an empty
+	// string when the operands are valid or the reason they are not
+	std::string encode_operands(Instruction &instruction,
+	                            const std::vector<std::string> &operands,
+	                            Program &program);
+	std::string encode_source(Instruction &instruction,
+	                          std::string_view operand, Program &program,
+	                          bool fromMemory);
+	// the last operand of fused instructions, a register or a short
+	// immediate
+	std::string encode_short(Instruction &instruction,
+	                         std::string_view operand);
 
   public:
+	// runs the optimizer over every program assembled after it, the default
+	void set_optimize(bool enabled) { optimizing = enabled; }
+
+	// the program encoded as described in bytecode.hpp, or the errors found
 	[[nodiscard]]
 	std::variant<std::vector<std::byte>, std::vector<std::string>>
 	assemble(const std::string_view &source);
+	// the same program before it is serialized, optimized unless disabled
+	[[nodiscard]]
+	std::variant<Program, std::vector<std::string>>
+	assemble_program(const std::string_view &source);
 };
 
 } // namespace ray::vm
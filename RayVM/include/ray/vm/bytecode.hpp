@@ -1,10 +1,16 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
 
 namespace ray::vm {
-enum class OpCode {
+enum class OpCode : uint8_t {
 	// Arithmetic
 	Add,
 	Sub,
@@ -34,13 +40,125 @@ enum class OpCode {
 	// Misc
 	Nop,
 	Halt,
+	// Fused, made by the optimizer out of the instructions in their names.
+	// a comparison into a followed by a jump on a
+	EqJmpIf,
+	NeqJmpIf,
+	LtJmpIf,
+	LteJmpIf,
+	GtJmpIf,
+	GteJmpIf,
+	EqJmpIfNot,
+	NeqJmpIfNot,
+	LtJmpIfNot,
+	LteJmpIfNot,
+	GtJmpIfNot,
+	GteJmpIfNot,
+	// a load into a, the operation on a and the store of a back
+	LoadAddStore,
+	LoadSubStore,
+	// an increment of a followed by a jump on a
+	AddJmpIf,
 	// invalid/non parsable
 	INVALID,
 };
 
+// how the last operand of an instruction is read
+enum class OperandMode : uint8_t {
+	// the register in c
+	Register,
+	// the immediate itself, or the short immediate for fused instructions
+	// whose immediate is a target or a memory offset
+	Immediate,
+	// the constant pool entry indexed by the immediate, for values that do
+	// not fit in 32 bits
+	Constant,
+	// the 64 bit value at the address in register b plus the immediate
+	Memory,
+	INVALID,
+};
+
+constexpr size_t registerCount = 16;
+
+// every instruction is one little endian 64 bit word:
+//   bits  0-7   opcode
+//   bits  8-11  register a, the destination or the value stored
+//   bits 12-15  register b, the first source or the memory base
+//   bits 16-19  register c, the second source
+//   bits 20-23  operand mode of the last operand
+//   bits 24-31  signed short immediate of fused instructions
+//   bits 32-63  signed immediate, also the target instruction of jumps and
+//               calls
 struct Instruction {
-	OpCode opcode;
-	std::array<std::string, 3> operands;
+	OpCode opcode = OpCode::Nop;
+	OperandMode mode = OperandMode::Register;
+	uint8_t a = 0;
+	uint8_t b = 0;
+	uint8_t c = 0;
+	int32_t immediate = 0;
+	int8_t small = 0;
+
+	constexpr uint64_t encode() const {
+		return static_cast<uint64_t>(opcode) |
+		       static_cast<uint64_t>(a & 0xF) << 8 |
+		       static_cast<uint64_t>(b & 0xF) << 12 |
+		       static_cast<uint64_t>(c & 0xF) << 16 |
+		       static_cast<uint64_t>(mode) << 20 |
+		       static_cast<uint64_t>(static_cast<uint8_t>(small)) << 24 |
+		       static_cast<uint64_t>(static_cast<uint32_t>(immediate)) << 32;
+	}
+	static constexpr Instruction decode(uint64_t word) {
+		return {.opcode = static_cast<OpCode>(word & 0xFF),
+		        .mode = static_cast<OperandMode>((word >> 20) & 0xF),
+		        .a = static_cast<uint8_t>((word >> 8) & 0xF),
+		        .b = static_cast<uint8_t>((word >> 12) & 0xF),
+		        .c = static_cast<uint8_t>((word >> 16) & 0xF),
+		        .immediate = static_cast<int32_t>(word >> 32),
+		        .small = static_cast<int8_t>((word >> 24) & 0xFF)};
+	}
+};
+
+// a named instruction, the target of jumps and calls
+struct Tag {
+	std::string name;
+	uint32_t instruction;
 };
 
+// an assembled program, stored in a file as:
+//   header   magic "RAYB", u16 version, u16 reserved, u32 entry instruction,
+//            u32 instruction count, u32 constant count, u32 tag count
+//   code     the instruction words
+//   pool     the u64 constants
+//   tags     u32 instruction, u32 name size and the name, for disassembly
+// every value is little endian
+struct Program {
+	static constexpr std::array<char, 4> magic = {'R', 'A', 'Y', 'B'};
+	// bumped whenever an older VM would misread the code, deserialize only
+	// accepts this exact version. 2 added the fused opcodes and their signed
+	// short immediate in bits 24-31
+	static constexpr uint16_t version = 2;
+	static constexpr size_t headerSize = 24;
+
+	uint32_t entry = 0;
+	std::vector<uint64_t> code;
+	std::vector<uint64_t> constants;
+	std::vector<Tag> tags;
+
+	std::vector<std::byte> serialize() const;
+	// checks the header and every instruction, a program that decodes only
+	// jumps to its own instructions and reads its own constants
+	static std::variant<Program, std::vector<std::string>>
+	deserialize(std::span<const std::byte> bytes);
+	// the instruction checks of deserialize, empty for a valid program
+	std::vector<std::string> verify() const;
+
+	std::string disassemble() const;
+};
+
+std::string_view opcode_name(OpCode opcode);
+// jumps and calls, their immediate is the target instruction
+bool is_branch(OpCode opcode);
+// the comparison of a fused compare and jump
+OpCode fused_comparison(OpCode opcode);
+
 } // namespace ray::vm
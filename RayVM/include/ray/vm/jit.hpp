@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ray/vm/bytecode.hpp>
+#include <ray/vm/cpu.hpp>
+#include <ray/vm/memory.hpp>
+
+// the JIT emits x86-64 machine code and maps it with Linux system calls,
+// other platforms and builds defining RAYVM_NO_JIT only interpret
+#if defined(__x86_64__) && defined(__linux__) && !defined(RAYVM_NO_JIT)
+#define RAYVM_JIT 1
+#endif
+
+#ifdef RAYVM_JIT
+
+namespace ray::vm {
+
+// translates the functions the interpreter runs the most into native code,
+// stitched together from a machine code template per opcode. a function is
+// the instructions reachable from the entry or a call target without
+// following calls.
+//
+// native code only runs instructions it can finish: anything that would trap,
+// halt or leave for code that is not compiled returns to the interpreter
+// before the instruction, which runs it again with its own checks
+class Jit {
+	struct Region {
+		void *address;
+		std::size_t length;
+	};
+
+	std::vector<Instruction> code;
+	std::vector<uint64_t> constants;
+	// the native code of every instruction, null while it is not compiled.
+	// one past the program for the halt the interpreter appends
+	std::vector<const void *> entries;
+	// the first instruction of the function of every instruction
+	std::vector<uint32_t> functions;
+	// calls and loop iterations counted per function
+	std::vector<uint32_t> heat;
+	// read only executable mappings, never writable at the same time
+	std::vector<Region> regions;
+	// saves the host registers, loads the pinned ones and jumps to the code
+	const void *trampoline = nullptr;
+
+	const void *compile(uint64_t instruction);
+	bool translate(uint32_t start);
+	const void *install(const std::vector<uint8_t> &machineCode);
+
+  public:
+	// calls and loop iterations after which a function is compiled
+	static constexpr uint32_t threshold = 1000;
+
+	Jit() = default;
+	Jit(const Jit &) = delete;
+	Jit &operator=(const Jit &) = delete;
+	~Jit();
+
+	// forgets the code of the previous program, nothing is compiled until
+	// the functions of this one get hot
+	void reset(const Program &program);
+	// forgets the previous program without compiling anything after it
+	void clear();
+
+	// the native code of an instruction, null while it is not compiled
+	const void *entry(uint64_t instruction) const {
+		return instruction < entries.size() ? entries[instruction] : nullptr;
+	}
+	// counts a call to or a jump back to an instruction, the native code of
+	// the instruction once its function is hot
+	const void *hot(uint64_t instruction) {
+		if (instruction >= entries.size()) {
+			return nullptr;
+		}
+		if (const void *native = entries[instruction]) {
+			return native;
+		}
+		if (++heat[functions[instruction]] != threshold) {
+			return nullptr;
+		}
+		return compile(instruction);
+	}
+
+	// runs native code until an instruction it leaves to the interpreter,
+	// returns that instruction and adds the instructions run to executed
+	uint64_t run(const void *native, CPUCore &cpu, Memory &memory,
+	             uint64_t stackBase, uint64_t &executed);
+};
+
+} // namespace ray::vm
+
+#endif
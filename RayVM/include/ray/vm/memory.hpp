@@ -2,10 +2,17 @@
 
 #include <ray/vm/definitions.hpp>
 
-#include <vector>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
 
 namespace ray::vm {
 
+// the memory of a program, mapped with an inaccessible guard page after it
+// where the platform allows so an access past the end that skipped its check
+// faults instead of touching other memory
 class Memory {
 
 	using Byte = definitions::Byte;
@@ -13,13 +20,70 @@ class Memory {
 	using DWord = definitions::DWord;
 	using QWord = definitions::QWord;
 
-	std::vector<Byte> data;
+	// the memory ends right before the guard page, at the end of the mapping
+	Byte *data = nullptr;
+	std::size_t bytes = 0;
+	Byte *mapping = nullptr;
+	// length of the mapping, guard page included
+	std::size_t mapped = 0;
+	// first index where an access of 1, 2, 4 and 8 bytes does not fit, so
+	// every access is checked with a single comparison
+	std::array<std::size_t, 4> limits = {};
+
+	template <typename T> static constexpr std::size_t width() {
+		static_assert(std::is_trivially_copyable_v<T> &&
+		                  std::has_single_bit(sizeof(T)) && sizeof(T) <= 8,
+		              "memory accesses are 1, 2, 4 or 8 bytes");
+		return static_cast<std::size_t>(std::countr_zero(sizeof(T)));
+	}
+	// releases the current mapping and takes over the given one
+	void adopt(Byte *region, std::size_t length, std::size_t size);
 
   public:
 	Memory(size_t bytes = 256);
+	Memory(const Memory &) = delete;
+	Memory &operator=(const Memory &) = delete;
+	~Memory();
 
+	// keeps the contents that still fit, new bytes are zero
 	void resize(std::size_t size);
 
+	template <typename T> bool fits(std::size_t index) const {
+		return index < limits[width<T>()];
+	}
+	// the first index an access of T does not fit at, with base for code
+	// that checks and accesses the memory itself
+	template <typename T> std::size_t limit() const {
+		return limits[width<T>()];
+	}
+	Byte *base() { return data; }
+
+	// aligned or not, every access is a single copy of the whole value
+	template <typename T> bool load(std::size_t index, T &value) const {
+		if (!fits<T>(index)) {
+			return false;
+		}
+		std::memcpy(&value, data + index, sizeof(T));
+		return true;
+	}
+	template <typename T> bool store(std::size_t index, const T &value) {
+		if (!fits<T>(index)) {
+			return false;
+		}
+		std::memcpy(data + index, &value, sizeof(T));
+		return true;
+	}
+	// for accesses the caller already checked with fits
+	template <typename T> T loadUnchecked(std::size_t index) const {
+		T value;
+		std::memcpy(&value, data + index, sizeof(T));
+		return value;
+	}
+	template <typename T> void storeUnchecked(std::size_t index, T value) {
+		std::memcpy(data + index, &value, sizeof(T));
+	}
+
+	// reads out of the memory are zero, writes fail without writing
 	Byte readByte(std::size_t index) const;
 	bool writeByte(std::size_t index, Byte value);
 
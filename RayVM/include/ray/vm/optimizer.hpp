@@ -0,0 +1,17 @@
+#pragma once
+
+#include <ray/vm/bytecode.hpp>
+
+namespace ray::vm {
+
+// rewrites an assembled program into one that computes the same registers
+// and memory while dispatching fewer instructions:
+//   - registers known to hold a constant are folded into the instructions
+//     reading them, and instructions that change nothing are removed
+//   - tags nothing jumps, calls or returns to are dropped
+//   - common sequences are fused into the superinstructions of bytecode.hpp
+// instructions are renumbered, so jump targets, tags and the entry move with
+// them
+Program optimize(Program program);
+
+} // namespace ray::vm
@@ -1,27 +1,86 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <ray/vm/bytecode.hpp>
 #include <ray/vm/cpu.hpp>
 #include <ray/vm/definitions.hpp>
+#include <ray/vm/jit.hpp>
 #include <ray/vm/memory.hpp>
 
+// jumping through label addresses is a GNU extension, other compilers and
+// builds defining RAYVM_SWITCH_DISPATCH run the same handlers from a switch
+#if !defined(RAYVM_SWITCH_DISPATCH) &&                                         \
+    (defined(__GNUC__) || defined(__clang__))
+#define RAYVM_THREADED_DISPATCH 1
+#endif
+
 namespace ray::vm {
 
 class VM {
+	// an instruction decoded once when the program is loaded, the operand
+	// mode is folded into the handler so handlers never look at it
+	struct Operation {
+		// the address of the handler, set by the threaded dispatch
+		const void *label = nullptr;
+		uint8_t handler = 0;
+		uint8_t a = 0;
+		uint8_t b = 0;
+		uint8_t c = 0;
+		// the short immediate of fused instructions
+		int32_t operand = 0;
+		// the immediate, memory offset, jump target or constant
+		int64_t immediate = 0;
+	};
+
 	CPUCore cpu;
 	Memory memory;
+	Program program;
+	// why the last program could not be loaded
+	std::vector<std::string> errors;
+	// the program followed by a halt, so running off its end stops
+	std::vector<Operation> operations;
+	bool threaded = false;
+	// the stack grows down from the end of the memory
+	uint64_t stackBase = 0;
+	uint64_t executed = 0;
+	// the part of executed that ran as native code
+	uint64_t nativeExecuted = 0;
+	// whether hot functions of the next programs loaded are compiled
+	bool compiling = true;
+#ifdef RAYVM_JIT
+	Jit jit;
+#endif
 
   public:
 	VM(std::size_t memory_size = 256);
 
+	// decodes and verifies the program, a program that does not verify sets
+	// the invalid instruction flag and is not run
 	void load_program(const std::vector<std::byte> &program);
+	void load_program(Program program);
+	const std::vector<std::string> &get_errors() const { return errors; }
+	// compiles the hot functions of the programs loaded after it to native
+	// code where the JIT is supported, the default
+	void set_jit(bool enabled) { compiling = enabled; }
 
+	// runs from the program counter until a halt, a return from the entry
+	// or a trap. the program counter is left on the instruction that stopped
 	void run();
 
+	CPUCore &get_cpu() { return cpu; }
+	const CPUCore &get_cpu() const { return cpu; }
+	Memory &get_memory() { return memory; }
+	// instructions dispatched since the program was loaded
+	uint64_t get_executed() const { return executed; }
+	// the instructions of get_executed that the JIT compiled code ran
+	uint64_t get_native_executed() const { return nativeExecuted; }
+
   private:
-	void fetch();
 	void decode();
-	void execute();
 };
 
 } // namespace ray::vm
@@ -1,10 +1,21 @@
 #include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <cstddef>
+#include <cstdint>
 #include <format>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include <ray/vm/assembler.hpp>
+#include <ray/vm/optimizer.hpp>
 
 namespace ray::vm {
 
@@ -33,6 +44,21 @@ OpCode Assembler::parse_opcode(const std::string_view token) {
 	    {"store", OpCode::Store},
 	    {"nop", OpCode::Nop},
 	    {"halt", OpCode::Halt},
+	    {"eq.jmpif", OpCode::EqJmpIf},
+	    {"neq.jmpif", OpCode::NeqJmpIf},
+	    {"lt.jmpif", OpCode::LtJmpIf},
+	    {"lte.jmpif", OpCode::LteJmpIf},
+	    {"gt.jmpif", OpCode::GtJmpIf},
+	    {"gte.jmpif", OpCode::GteJmpIf},
+	    {"eq.jmpifnot", OpCode::EqJmpIfNot},
+	    {"neq.jmpifnot", OpCode::NeqJmpIfNot},
+	    {"lt.jmpifnot", OpCode::LtJmpIfNot},
+	    {"lte.jmpifnot", OpCode::LteJmpIfNot},
+	    {"gt.jmpifnot", OpCode::GtJmpIfNot},
+	    {"gte.jmpifnot", OpCode::GteJmpIfNot},
+	    {"load.add.store", OpCode::LoadAddStore},
+	    {"load.sub.store", OpCode::LoadSubStore},
+	    {"add.jmpif", OpCode::AddJmpIf},
 	};
 	std::string lower_token(token);
 	std::transform(lower_token.begin(), lower_token.end(), lower_token.begin(),
@@ -76,45 +102,274 @@ Assembler::parse_operand(const std::string_view operands_sv) {
 	return {valid ? operands : errors, valid};
 }
 
+namespace {
+
+// a jump or call to a tag, patched once every tag is known
+struct Relocation {
+	size_t instruction;
+	std::string tag;
+	size_t line;
+	size_t column;
+};
+
+std::string_view trim(std::string_view text) {
+	while (!text.empty() && std::isspace(static_cast<unsigned char>(text[0]))) {
+		text.remove_prefix(1);
+	}
+	while (!text.empty() &&
+	       std::isspace(static_cast<unsigned char>(text.back()))) {
+		text.remove_suffix(1);
+	}
+	return text;
+}
+
+bool fits_immediate(int64_t value) {
+	return value >= std::numeric_limits<int32_t>::min() &&
+	       value <= std::numeric_limits<int32_t>::max();
+}
+
+size_t operand_count(OpCode opcode) {
+	if (fused_comparison(opcode) != OpCode::INVALID) {
+		return 4;
+	}
+	switch (opcode) {
+	case OpCode::Not:
+	case OpCode::JmpIf:
+	case OpCode::JmpIfNot:
+	case OpCode::Load:
+	case OpCode::Store:
+		return 2;
+	case OpCode::Beq:
+	case OpCode::Call:
+		return 1;
+	case OpCode::Ret:
+	case OpCode::Nop:
+	case OpCode::Halt:
+	case OpCode::INVALID:
+		return 0;
+	default:
+		return 3;
+	}
+}
+
+} // namespace
+
+std::optional<uint8_t> Assembler::parse_register(std::string_view operand) {
+	if (operand.size() < 2 || std::tolower(operand[0]) != 'r') {
+		return std::nullopt;
+	}
+	unsigned index = 0;
+	const char *end = operand.data() + operand.size();
+	auto [last, error] = std::from_chars(operand.data() + 1, end, index);
+	if (error != std::errc() || last != end || index >= registerCount) {
+		return std::nullopt;
+	}
+	return static_cast<uint8_t>(index);
+}
+
+std::optional<int64_t> Assembler::parse_immediate(std::string_view operand) {
+	bool negative = operand.starts_with('-');
+	if (negative) {
+		operand.remove_prefix(1);
+	}
+	int base = 10;
+	if (operand.starts_with("0x") || operand.starts_with("0X")) {
+		base = 16;
+		operand.remove_prefix(2);
+	}
+	uint64_t value = 0;
+	const char *end = operand.data() + operand.size();
+	auto [last, error] = std::from_chars(operand.data(), end, value, base);
+	if (error != std::errc() || last != end) {
+		return std::nullopt;
+	}
+	return static_cast<int64_t>(negative ? 0 - value : value);
+}
+
+std::string Assembler::encode_source(Instruction &instruction,
+                                     std::string_view operand,
+                                     Program &program, bool fromMemory) {
+	if (operand.starts_with('[')) {
+		if (!fromMemory || !operand.ends_with(']')) {
+			return std::format("invalid memory operand '{}'", operand);
+		}
+		auto address = trim(operand.substr(1, operand.size() - 2));
+		size_t sign = address.find_first_of("+-");
+		auto base = parse_register(trim(address.substr(0, sign)));
+		if (!base) {
+			return std::format("invalid base register in '{}'", operand);
+		}
+		int64_t offset = 0;
+		if (sign != std::string_view::npos) {
+			auto value = parse_immediate(trim(address.substr(sign + 1)));
+			if (!value || !fits_immediate(*value)) {
+				return std::format("invalid offset in '{}'", operand);
+			}
+			offset = address[sign] == '-' ? -*value : *value;
+		}
+		instruction.mode = OperandMode::Memory;
+		instruction.b = *base;
+		instruction.immediate = static_cast<int32_t>(offset);
+		return "";
+	}
+	if (auto reg = parse_register(operand)) {
+		instruction.mode = OperandMode::Register;
+		instruction.c = *reg;
+		return "";
+	}
+	auto value = parse_immediate(operand);
+	if (!value) {
+		return std::format("invalid operand '{}'", operand);
+	}
+	if (fits_immediate(*value)) {
+		instruction.mode = OperandMode::Immediate;
+		instruction.immediate = static_cast<int32_t>(*value);
+		return "";
+	}
+	// only loads read the constant pool, other instructions stay one word
+	if (!fromMemory) {
+		return std::format("immediate '{}' does not fit in 32 bits", operand);
+	}
+	instruction.mode = OperandMode::Constant;
+	instruction.immediate = static_cast<int32_t>(program.constants.size());
+	program.constants.push_back(static_cast<uint64_t>(*value));
+	return "";
+}
+
+std::string Assembler::encode_short(Instruction &instruction,
+                                    std::string_view operand) {
+	if (auto reg = parse_register(operand)) {
+		instruction.mode = OperandMode::Register;
+		instruction.c = *reg;
+		return "";
+	}
+	auto value = parse_immediate(operand);
+	if (!value) {
+		return std::format("invalid operand '{}'", operand);
+	}
+	if (*value < std::numeric_limits<int8_t>::min() ||
+	    *value > std::numeric_limits<int8_t>::max()) {
+		return std::format("immediate '{}' does not fit in 8 bits", operand);
+	}
+	instruction.mode = OperandMode::Immediate;
+	instruction.small = static_cast<int8_t>(*value);
+	return "";
+}
+
+std::string Assembler::encode_operands(Instruction &instruction,
+                                       const std::vector<std::string> &operands,
+                                       Program &program) {
+	auto name = opcode_name(instruction.opcode);
+	if (operands.size() != operand_count(instruction.opcode)) {
+		return std::format("'{}' takes {} operands, got {}", name,
+		                   operand_count(instruction.opcode), operands.size());
+	}
+	std::optional<uint8_t> a;
+	if (operands.size() >= 2) {
+		a = parse_register(operands[0]);
+		if (!a) {
+			return std::format("invalid register '{}'", operands[0]);
+		}
+		instruction.a = *a;
+	}
+	switch (instruction.opcode) {
+	case OpCode::Not: {
+		auto c = parse_register(operands[1]);
+		if (!c) {
+			return std::format("invalid register '{}'", operands[1]);
+		}
+		instruction.c = *c;
+		return "";
+	}
+	case OpCode::Load:
+		return encode_source(instruction, operands[1], program, true);
+	case OpCode::Store:
+		if (!operands[1].starts_with('[')) {
+			return "'store' takes a memory operand";
+		}
+		return encode_source(instruction, operands[1], program, true);
+	case OpCode::LoadAddStore:
+	case OpCode::LoadSubStore: {
+		if (!operands[1].starts_with('[')) {
+			return std::format("'{}' takes a memory operand", name);
+		}
+		auto error = encode_source(instruction, operands[1], program, true);
+		return error.empty() ? encode_short(instruction, operands[2]) : error;
+	}
+	case OpCode::AddJmpIf: {
+		auto error = encode_short(instruction, operands[1]);
+		if (error.empty() && instruction.mode != OperandMode::Immediate) {
+			return "'add.jmpif' takes an immediate";
+		}
+		return error;
+	}
+	case OpCode::Beq:
+	case OpCode::Call:
+	case OpCode::JmpIf:
+	case OpCode::JmpIfNot:
+	// the target is relocated once every tag is known
+	case OpCode::Ret:
+	case OpCode::Nop:
+	case OpCode::Halt:
+	case OpCode::INVALID:
+		return "";
+	default: {
+		auto b = parse_register(operands[1]);
+		if (!b) {
+			return std::format("invalid register '{}'", operands[1]);
+		}
+		instruction.b = *b;
+		if (fused_comparison(instruction.opcode) != OpCode::INVALID) {
+			return encode_short(instruction, operands[2]);
+		}
+		return encode_source(instruction, operands[2], program, false);
+	}
+	}
+}
+
 [[nodiscard]]
 
 std::variant<std::vector<std::byte>, std::vector<std::string>>
 Assembler::assemble(const std::string_view &source) {
-	std::vector<std::byte> bytecode;
+	auto result = assemble_program(source);
+	if (auto *errors = std::get_if<std::vector<std::string>>(&result)) {
+		return std::move(*errors);
+	}
+	return std::get<Program>(result).serialize();
+}
+
+std::variant<Program, std::vector<std::string>>
+Assembler::assemble_program(const std::string_view &source) {
+	Program program;
 	std::vector<std::string> errors;
 	std::unordered_map<std::string, size_t> tags;
-	std::vector<Instruction> instructions;
+	std::vector<Relocation> relocations;
 
-	size_t line = 1;
-	size_t column = 1;
+	size_t line = 0;
+	for (size_t start = 0; start < source.size();) {
+		size_t end = std::min(source.find('\n', start), source.size());
+		// comments run until the end of the line
+		std::string_view text = source.substr(start, end - start);
+		text = text.substr(0, text.find(';'));
+		start = end + 1;
+		++line;
 
-	for (size_t i = 0; i < source.size(); ++i) {
-		switch (source[i]) {
-		case '\n':
-			++line;
-			column = 1;
-			break;
-		case ' ':
-		case '\t':
-			++column;
-			break;
-		case ';':
-			while (i < source.size() && source[i] != '\n') {
+		size_t i = 0;
+		while (i < text.size()) {
+			if (std::isspace(static_cast<unsigned char>(text[i]))) {
 				++i;
+				continue;
 			}
-			break;
-		default:
 			// possible instruction or tag
-			size_t start = i;
-			while (i < source.size() && source[i] != ' ' && source[i] != '\t' &&
-			       source[i] != '\n') {
+			size_t column = i + 1;
+			size_t tokenStart = i;
+			while (i < text.size() &&
+			       !std::isspace(static_cast<unsigned char>(text[i]))) {
 				++i;
-				line += source[i] == '\n';
-				column = source[i] == '\n' ? 1 : column + 1;
 			}
-			std::string_view token = source.substr(start, i - start);
+			std::string_view token = text.substr(tokenStart, i - tokenStart);
 
-			// check if it's a tag
+			// check if it's a tag, an instruction can follow it
 			if (token.back() == ':') {
 				token.remove_suffix(1);
 				std::string tag = std::string(token);
@@ -122,72 +377,82 @@ Assembler::assemble(const std::string_view &source) {
 					errors.push_back(
 					    std::format("Duplicate tag '{}' at line {} column {}",
 					                tag, line, column));
-					break;
 				} else {
-					tags.emplace(tag, bytecode.size());
+					tags.emplace(tag, program.code.size());
+					program.tags.push_back(
+					    {.name = tag,
+					     .instruction =
+					         static_cast<uint32_t>(program.code.size())});
 				}
-			} else {
-				OpCode opcode = parse_opcode(token);
-				if (opcode == OpCode::INVALID) {
-					errors.push_back(
-					    std::format("Invalid opcode '{}' at line {} column {}",
-					                token, line, column));
-				} else {
-					// read until first non-space/tab character
-					while (i < source.size() &&
-					       (source[i] == ' ' || source[i] == '\t')) {
-						++i;
-						column++;
-					}
-					size_t start = i;
-					// read until end of line or comment
-					while (i < source.size() && source[i] != '\n' &&
-					       source[i] != ';') {
-						++i;
-						column += source[i] == '\n';
-					}
-					size_t end = i;
-					std::string_view operands_sv =
-					    source.substr(start, end - start);
-					auto [list, valid] = parse_operand(operands_sv);
-					if (!valid) {
-						errors.push_back(std::format(
-						    "Invalid operands '{}' at line {} column {}",
-						    operands_sv, line, column));
-						// the list contains the error message
-						for (const auto &error : list) {
-							errors.push_back(error);
-						}
-					}
-
-					// write instruction with opcode and operands
-					Instruction instr{opcode};
-					if (list.size() > instr.operands.size()) {
-						errors.push_back(
-						    std::format("Too many operands for opcode '{}' at "
-						                "line {} column {}",
-						                token, line, column));
-					} else {
-						for (size_t i = 0; i < list.size(); ++i) {
-							instr.operands[i] = list[i];
-						}
-					}
-				}
-				// read until end of line
-				while (i < source.size() && source[i] != '\n') {
-					++i;
+				continue;
+			}
+
+			OpCode opcode = parse_opcode(token);
+			if (opcode == OpCode::INVALID) {
+				errors.push_back(
+				    std::format("Invalid opcode '{}' at line {} column {}",
+				                token, line, column));
+				break;
+			}
+			std::string_view operands_sv = trim(text.substr(i));
+			auto [list, valid] = parse_operand(operands_sv);
+			if (!valid) {
+				errors.push_back(
+				    std::format("Invalid operands '{}' at line {} column {}",
+				                operands_sv, line, column));
+				// the list contains the error message
+				for (const auto &error : list) {
+					errors.push_back(error);
 				}
-				line += source[i] == '\n';
-				column = source[i] == '\n' ? 1 : column + 1;
+				break;
+			}
+
+			// write instruction with opcode and operands
+			Instruction instr{opcode};
+			auto error = encode_operands(instr, list, program);
+			if (!error.empty()) {
+				errors.push_back(std::format("{} at line {} column {}", error,
+				                             line, column));
+			} else if (is_branch(opcode)) {
+				relocations.push_back({.instruction = program.code.size(),
+				                       .tag = list.back(),
+				                       .line = line,
+				                       .column = column});
 			}
+			program.code.push_back(instr.encode());
 			break;
 		}
 	}
 
+	for (const auto &relocation : relocations) {
+		auto tag = tags.find(relocation.tag);
+		if (tag == tags.end()) {
+			errors.push_back(std::format(
+			    "Undefined tag '{}' at line {} column {}", relocation.tag,
+			    relocation.line, relocation.column));
+		} else if (tag->second >= program.code.size()) {
+			errors.push_back(std::format(
+			    "Tag '{}' at line {} column {} has no instruction after it",
+			    relocation.tag, relocation.line, relocation.column));
+		} else {
+			auto &word = program.code[relocation.instruction];
+			word = (word & 0xFFFFFFFF) | static_cast<uint64_t>(tag->second)
+			                                 << 32;
+		}
+	}
+	// execution starts at main when there is one
+	if (auto main = tags.find("main");
+	    main != tags.end() && main->second < program.code.size()) {
+		program.entry = static_cast<uint32_t>(main->second);
+	}
+
 	if (!errors.empty()) {
 		return errors;
 	}
-	return bytecode;
+	if (optimizing) {
+		return optimize(std::move(program));
+	}
+	return program;
 }
 
 } // namespace ray::vm
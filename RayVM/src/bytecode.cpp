@@ -0,0 +1,447 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include <ray/vm/bytecode.hpp>
+
+namespace ray::vm {
+
+namespace {
+
+void write_u16(std::vector<std::byte> &bytes, uint16_t value) {
+	for (size_t i = 0; i < sizeof(value); i++) {
+		bytes.push_back(static_cast<std::byte>(value >> (i * 8)));
+	}
+}
+
+void write_u32(std::vector<std::byte> &bytes, uint32_t value) {
+	for (size_t i = 0; i < sizeof(value); i++) {
+		bytes.push_back(static_cast<std::byte>(value >> (i * 8)));
+	}
+}
+
+void write_u64(std::vector<std::byte> &bytes, uint64_t value) {
+	for (size_t i = 0; i < sizeof(value); i++) {
+		bytes.push_back(static_cast<std::byte>(value >> (i * 8)));
+	}
+}
+
+// reads little endian values, failing once the bytes run out
+class Reader {
+	std::span<const std::byte> bytes;
+	size_t offset = 0;
+
+  public:
+	explicit Reader(std::span<const std::byte> bytes) : bytes(bytes) {}
+
+	bool has(size_t size) const { return bytes.size() - offset >= size; }
+	size_t remaining() const { return bytes.size() - offset; }
+
+	uint64_t read(size_t size) {
+		uint64_t value = 0;
+		for (size_t i = 0; i < size; i++) {
+			value |= static_cast<uint64_t>(bytes[offset + i]) << (i * 8);
+		}
+		offset += size;
+		return value;
+	}
+	std::string_view read_string(size_t size) {
+		auto text = std::string_view(
+		    reinterpret_cast<const char *>(bytes.data() + offset), size);
+		offset += size;
+		return text;
+	}
+};
+
+bool is_binary(OpCode opcode) {
+	return opcode <= OpCode::Or && opcode != OpCode::Not;
+}
+
+// the operand modes every opcode accepts, checked once so the VM can trust
+// every instruction it runs
+std::string verify_instruction(const Program &program,
+                               const Instruction &instruction) {
+	if (instruction.opcode >= OpCode::INVALID) {
+		return std::format("unknown opcode {}",
+		                   static_cast<unsigned>(instruction.opcode));
+	}
+	if (instruction.mode >= OperandMode::INVALID) {
+		return std::format("unknown operand mode {}",
+		                   static_cast<unsigned>(instruction.mode));
+	}
+	if (is_binary(instruction.opcode) &&
+	    instruction.mode != OperandMode::Register &&
+	    instruction.mode != OperandMode::Immediate) {
+		return std::format("'{}' takes a register or an immediate",
+		                   opcode_name(instruction.opcode));
+	}
+	if (instruction.opcode == OpCode::Not &&
+	    instruction.mode != OperandMode::Register) {
+		return "'not' takes a register";
+	}
+	if ((fused_comparison(instruction.opcode) != OpCode::INVALID ||
+	     instruction.opcode == OpCode::LoadAddStore ||
+	     instruction.opcode == OpCode::LoadSubStore) &&
+	    instruction.mode != OperandMode::Register &&
+	    instruction.mode != OperandMode::Immediate) {
+		return std::format("'{}' takes a register or an immediate",
+		                   opcode_name(instruction.opcode));
+	}
+	if (instruction.opcode == OpCode::AddJmpIf &&
+	    instruction.mode != OperandMode::Immediate) {
+		return "'add.jmpif' takes an immediate";
+	}
+	if (instruction.opcode == OpCode::Store &&
+	    instruction.mode != OperandMode::Memory) {
+		return "'store' takes a memory operand";
+	}
+	if (is_branch(instruction.opcode) &&
+	    (instruction.immediate < 0 ||
+	     static_cast<size_t>(instruction.immediate) >= program.code.size())) {
+		return std::format("'{}' targets instruction {} out of the program",
+		                   opcode_name(instruction.opcode),
+		                   instruction.immediate);
+	}
+	if (instruction.mode == OperandMode::Constant &&
+	    (instruction.opcode != OpCode::Load || instruction.immediate < 0 ||
+	     static_cast<size_t>(instruction.immediate) >=
+	         program.constants.size())) {
+		return std::format("constant {} out of the constant pool",
+		                   instruction.immediate);
+	}
+	return "";
+}
+
+std::string register_name(uint8_t index) {
+	return std::format("r{}", static_cast<unsigned>(index));
+}
+
+} // namespace
+
+std::string_view opcode_name(OpCode opcode) {
+	switch (opcode) {
+	case OpCode::Add:
+		return "add";
+	case OpCode::Sub:
+		return "sub";
+	case OpCode::Mul:
+		return "mul";
+	case OpCode::Div:
+		return "div";
+	case OpCode::Mod:
+		return "mod";
+	case OpCode::Eq:
+		return "eq";
+	case OpCode::Neq:
+		return "neq";
+	case OpCode::Lt:
+		return "lt";
+	case OpCode::Lte:
+		return "lte";
+	case OpCode::Gt:
+		return "gt";
+	case OpCode::Gte:
+		return "gte";
+	case OpCode::And:
+		return "and";
+	case OpCode::Or:
+		return "or";
+	case OpCode::Not:
+		return "not";
+	case OpCode::Beq:
+		return "jmp";
+	case OpCode::JmpIf:
+		return "jmpif";
+	case OpCode::JmpIfNot:
+		return "jmpifnot";
+	case OpCode::Call:
+		return "call";
+	case OpCode::Ret:
+		return "ret";
+	case OpCode::Load:
+		return "load";
+	case OpCode::Store:
+		return "store";
+	case OpCode::Nop:
+		return "nop";
+	case OpCode::Halt:
+		return "halt";
+	case OpCode::EqJmpIf:
+		return "eq.jmpif";
+	case OpCode::NeqJmpIf:
+		return "neq.jmpif";
+	case OpCode::LtJmpIf:
+		return "lt.jmpif";
+	case OpCode::LteJmpIf:
+		return "lte.jmpif";
+	case OpCode::GtJmpIf:
+		return "gt.jmpif";
+	case OpCode::GteJmpIf:
+		return "gte.jmpif";
+	case OpCode::EqJmpIfNot:
+		return "eq.jmpifnot";
+	case OpCode::NeqJmpIfNot:
+		return "neq.jmpifnot";
+	case OpCode::LtJmpIfNot:
+		return "lt.jmpifnot";
+	case OpCode::LteJmpIfNot:
+		return "lte.jmpifnot";
+	case OpCode::GtJmpIfNot:
+		return "gt.jmpifnot";
+	case OpCode::GteJmpIfNot:
+		return "gte.jmpifnot";
+	case OpCode::LoadAddStore:
+		return "load.add.store";
+	case OpCode::LoadSubStore:
+		return "load.sub.store";
+	case OpCode::AddJmpIf:
+		return "add.jmpif";
+	case OpCode::INVALID:
+		break;
+	}
+	return "invalid";
+}
+
+bool is_branch(OpCode opcode) {
+	return opcode == OpCode::Beq || opcode == OpCode::JmpIf ||
+	       opcode == OpCode::JmpIfNot || opcode == OpCode::Call ||
+	       opcode == OpCode::AddJmpIf ||
+	       fused_comparison(opcode) != OpCode::INVALID;
+}
+
+OpCode fused_comparison(OpCode opcode) {
+	if (opcode >= OpCode::EqJmpIf && opcode <= OpCode::GteJmpIf) {
+		auto offset = static_cast<uint8_t>(opcode) -
+		              static_cast<uint8_t>(OpCode::EqJmpIf);
+		return static_cast<OpCode>(static_cast<uint8_t>(OpCode::Eq) + offset);
+	}
+	if (opcode >= OpCode::EqJmpIfNot && opcode <= OpCode::GteJmpIfNot) {
+		auto offset = static_cast<uint8_t>(opcode) -
+		              static_cast<uint8_t>(OpCode::EqJmpIfNot);
+		return static_cast<OpCode>(static_cast<uint8_t>(OpCode::Eq) + offset);
+	}
+	return OpCode::INVALID;
+}
+
+std::vector<std::byte> Program::serialize() const {
+	std::vector<std::byte> bytes;
+	size_t tagBytes = 0;
+	for (const auto &tag : tags) {
+		tagBytes += 2 * sizeof(uint32_t) + tag.name.size();
+	}
+	bytes.reserve(headerSize + (code.size() + constants.size()) * 8 +
+	              tagBytes);
+
+	for (char c : magic) {
+		bytes.push_back(static_cast<std::byte>(c));
+	}
+	write_u16(bytes, version);
+	write_u16(bytes, 0);
+	write_u32(bytes, entry);
+	write_u32(bytes, static_cast<uint32_t>(code.size()));
+	write_u32(bytes, static_cast<uint32_t>(constants.size()));
+	write_u32(bytes, static_cast<uint32_t>(tags.size()));
+	for (auto word : code) {
+		write_u64(bytes, word);
+	}
+	for (auto constant : constants) {
+		write_u64(bytes, constant);
+	}
+	for (const auto &tag : tags) {
+		write_u32(bytes, tag.instruction);
+		write_u32(bytes, static_cast<uint32_t>(tag.name.size()));
+		for (char c : tag.name) {
+			bytes.push_back(static_cast<std::byte>(c));
+		}
+	}
+	return bytes;
+}
+
+std::variant<Program, std::vector<std::string>>
+Program::deserialize(std::span<const std::byte> bytes) {
+	std::vector<std::string> errors;
+	Reader reader(bytes);
+	if (!reader.has(headerSize)) {
+		errors.push_back("file too small for a program header");
+		return errors;
+	}
+	for (char c : magic) {
+		if (static_cast<char>(reader.read(1)) != c) {
+			errors.push_back("not a RayVM program");
+			return errors;
+		}
+	}
+	auto fileVersion = static_cast<uint16_t>(reader.read(2));
+	if (fileVersion != version) {
+		errors.push_back(std::format(
+		    "unsupported program version {}, expected {}", fileVersion,
+		    version));
+		return errors;
+	}
+	(void)reader.read(2);
+
+	Program program;
+	program.entry = static_cast<uint32_t>(reader.read(4));
+	size_t codeSize = reader.read(4);
+	size_t constantCount = reader.read(4);
+	size_t tagCount = reader.read(4);
+	if (reader.remaining() / 8 < codeSize + constantCount) {
+		errors.push_back("program truncated");
+		return errors;
+	}
+	program.code.reserve(codeSize);
+	for (size_t i = 0; i < codeSize; i++) {
+		program.code.push_back(reader.read(8));
+	}
+	program.constants.reserve(constantCount);
+	for (size_t i = 0; i < constantCount; i++) {
+		program.constants.push_back(reader.read(8));
+	}
+	for (size_t i = 0; i < tagCount; i++) {
+		if (!reader.has(2 * sizeof(uint32_t))) {
+			errors.push_back("program truncated");
+			return errors;
+		}
+		auto instruction = static_cast<uint32_t>(reader.read(4));
+		size_t nameSize = reader.read(4);
+		if (!reader.has(nameSize)) {
+			errors.push_back("program truncated");
+			return errors;
+		}
+		program.tags.push_back(
+		    {.name = std::string(reader.read_string(nameSize)),
+		     .instruction = instruction});
+	}
+
+	errors = program.verify();
+	if (!errors.empty()) {
+		return errors;
+	}
+	return program;
+}
+
+std::vector<std::string> Program::verify() const {
+	std::vector<std::string> errors;
+	if (!code.empty() && entry >= code.size()) {
+		errors.push_back(std::format("entry {} out of the program", entry));
+	}
+	for (size_t i = 0; i < code.size(); i++) {
+		auto error = verify_instruction(*this, Instruction::decode(code[i]));
+		if (!error.empty()) {
+			errors.push_back(std::format("instruction {}: {}", i, error));
+		}
+	}
+	return errors;
+}
+
+std::string Program::disassemble() const {
+	std::unordered_map<uint32_t, std::string_view> tagNames;
+	for (const auto &tag : tags) {
+		tagNames.try_emplace(tag.instruction, tag.name);
+	}
+	auto target = [&](int32_t instruction) {
+		auto tag = tagNames.find(static_cast<uint32_t>(instruction));
+		return tag != tagNames.end() ? std::string(tag->second)
+		                             : std::format("{}", instruction);
+	};
+	auto operand = [&](const Instruction &instruction) {
+		switch (instruction.mode) {
+		case OperandMode::Register:
+			return register_name(instruction.c);
+		case OperandMode::Immediate:
+			return std::format("{}", instruction.immediate);
+		case OperandMode::Constant:
+			return std::format(
+			    "{}", static_cast<int64_t>(constants[instruction.immediate]));
+		case OperandMode::Memory:
+			if (instruction.immediate == 0) {
+				return std::format("[{}]", register_name(instruction.b));
+			}
+			return std::format(
+			    "[{} {} {}]", register_name(instruction.b),
+			    instruction.immediate < 0 ? '-' : '+',
+			    std::abs(static_cast<int64_t>(instruction.immediate)));
+		case OperandMode::INVALID:
+			break;
+		}
+		return std::string("?");
+	};
+	// the last operand of a fused instruction
+	auto shortOperand = [&](const Instruction &instruction) {
+		if (instruction.mode == OperandMode::Register) {
+			return register_name(instruction.c);
+		}
+		return std::format("{}", static_cast<int>(instruction.small));
+	};
+
+	std::string text;
+	for (size_t i = 0; i < code.size(); i++) {
+		if (auto tag = tagNames.find(static_cast<uint32_t>(i));
+		    tag != tagNames.end()) {
+			text += std::format("{}:\n", tag->second);
+		}
+		auto instruction = Instruction::decode(code[i]);
+		text += std::format("\t{}", opcode_name(instruction.opcode));
+		switch (instruction.opcode) {
+		case OpCode::Not:
+			text += std::format(" {}, {}", register_name(instruction.a),
+			                    register_name(instruction.c));
+			break;
+		case OpCode::Beq:
+		case OpCode::Call:
+			text += std::format(" {}", target(instruction.immediate));
+			break;
+		case OpCode::JmpIf:
+		case OpCode::JmpIfNot:
+			text += std::format(" {}, {}", register_name(instruction.a),
+			                    target(instruction.immediate));
+			break;
+		case OpCode::Load:
+		case OpCode::Store:
+			text += std::format(" {}, {}", register_name(instruction.a),
+			                    operand(instruction));
+			break;
+		case OpCode::LoadAddStore:
+		case OpCode::LoadSubStore: {
+			auto address = instruction;
+			address.mode = OperandMode::Memory;
+			text += std::format(" {}, {}, {}", register_name(instruction.a),
+			                    operand(address), shortOperand(instruction));
+			break;
+		}
+		case OpCode::AddJmpIf:
+			text += std::format(" {}, {}, {}", register_name(instruction.a),
+			                    shortOperand(instruction),
+			                    target(instruction.immediate));
+			break;
+		case OpCode::Ret:
+		case OpCode::Nop:
+		case OpCode::Halt:
+		case OpCode::INVALID:
+			break;
+		default:
+			if (fused_comparison(instruction.opcode) != OpCode::INVALID) {
+				text += std::format(
+				    " {}, {}, {}, {}", register_name(instruction.a),
+				    register_name(instruction.b), shortOperand(instruction),
+				    target(instruction.immediate));
+				break;
+			}
+			text += std::format(" {}, {}, {}", register_name(instruction.a),
+			                    register_name(instruction.b),
+			                    operand(instruction));
+			break;
+		}
+		text += '\n';
+	}
+	return text;
+}
+
+} // namespace ray::vm
@@ -0,0 +1,796 @@
+#include <ray/vm/jit.hpp>
+
+#ifdef RAYVM_JIT
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace ray::vm {
+
+namespace {
+
+// host registers by their encoding
+enum Host : uint8_t {
+	rax,
+	rcx,
+	rdx,
+	rbx,
+	rsp,
+	rbp,
+	rsi,
+	rdi,
+	r8,
+	r9,
+	r10,
+	r11,
+	r12,
+	r13,
+	r14,
+	r15,
+};
+
+// the condition codes of jcc and setcc
+enum Condition : uint8_t {
+	AboveEqual = 0x3,
+	Equal = 0x4,
+	NotEqual = 0x5,
+	Less = 0xC,
+	GreaterEqual = 0xD,
+	LessEqual = 0xE,
+	Greater = 0xF,
+};
+
+// the VM registers r0 to r7 live in host registers while native code runs,
+// the others stay in the CPU core. rax, rcx and rdx are scratch, r12 counts
+// the instructions run, r13 holds the memory, r14 the frame and r15 the CPU
+constexpr std::array<Host, 8> pinned = {rbx, rbp, rsi, rdi, r8, r9, r10, r11};
+constexpr Host counter = r12;
+constexpr Host memoryBase = r13;
+constexpr Host frameBase = r14;
+constexpr Host cpuBase = r15;
+
+// what native code reads besides the CPU, filled in on every entry
+struct Frame {
+	CPUCore *cpu;
+	std::byte *memory;
+	// the first address a 64 bit access does not fit at
+	uint64_t limit;
+	uint64_t stackBase;
+	const void *const *entries;
+	// the entries, a return to one past them traps
+	uint64_t instructions;
+	uint64_t executed;
+};
+
+int32_t displacement(std::size_t offset) {
+	return static_cast<int32_t>(offset);
+}
+
+int32_t register_offset(uint8_t index) {
+	return static_cast<int32_t>(offsetof(CPUCore, gpr) +
+	                            index * sizeof(definitions::QWord));
+}
+
+// the handful of x86-64 instructions the templates are made of, every
+// operand is 64 bits wide
+class Emitter {
+	std::vector<uint8_t> bytes;
+
+	void byte(uint8_t value) { bytes.push_back(value); }
+	void rex(unsigned reg, unsigned index, unsigned base) {
+		byte(static_cast<uint8_t>(0x48 | (reg >> 3) << 2 | (index >> 3) << 1 |
+		                          base >> 3));
+	}
+
+  public:
+	std::size_t size() const { return bytes.size(); }
+	std::vector<uint8_t> take() { return std::move(bytes); }
+
+	void dword(uint32_t value) {
+		for (std::size_t i = 0; i < sizeof(value); i++) {
+			byte(static_cast<uint8_t>(value >> (i * 8)));
+		}
+	}
+
+	// opcode rm, reg between two registers
+	void registers(uint8_t opcode, Host rm, Host reg) {
+		rex(reg, 0, rm);
+		byte(opcode);
+		byte(static_cast<uint8_t>(0xC0 | (reg & 7) << 3 | (rm & 7)));
+	}
+	// opcode reg, [base + displacement] or the other way around
+	void memory(uint8_t opcode, unsigned reg, Host base, int32_t displacement) {
+		rex(reg, 0, base);
+		byte(opcode);
+		byte(static_cast<uint8_t>(0x80 | (reg & 7) << 3 | (base & 7)));
+		if ((base & 7) == rsp) {
+			byte(0x24);
+		}
+		dword(static_cast<uint32_t>(displacement));
+	}
+	// opcode reg, [base + index << scale] or the other way around
+	void indexed(uint8_t opcode, Host reg, Host base, Host index,
+	             uint8_t scale) {
+		rex(reg, index, base);
+		byte(opcode);
+		// an 8 bit displacement of zero, so r13 can be the base
+		byte(static_cast<uint8_t>(0x44 | (reg & 7) << 3));
+		byte(static_cast<uint8_t>(scale << 6 | (index & 7) << 3 | (base & 7)));
+		byte(0);
+	}
+	// add, or, and, sub or cmp selected by digit with a 32 bit immediate
+	void arithmetic(uint8_t digit, Host rm, int32_t value) {
+		rex(0, 0, rm);
+		byte(0x81);
+		byte(static_cast<uint8_t>(0xC0 | digit << 3 | (rm & 7)));
+		dword(static_cast<uint32_t>(value));
+	}
+	void multiply(Host reg, Host rm) {
+		rex(reg, 0, rm);
+		byte(0x0F);
+		byte(0xAF);
+		byte(static_cast<uint8_t>(0xC0 | (reg & 7) << 3 | (rm & 7)));
+	}
+	void multiply(Host reg, int32_t value) {
+		rex(reg, 0, reg);
+		byte(0x69);
+		byte(static_cast<uint8_t>(0xC0 | (reg & 7) << 3 | (reg & 7)));
+		dword(static_cast<uint32_t>(value));
+	}
+	// rdx:rax divided by rm, the quotient in rax and the remainder in rdx
+	void divide(Host rm) {
+		rex(0, 0, rax);
+		byte(0x99);
+		rex(0, 0, rm);
+		byte(0xF7);
+		byte(static_cast<uint8_t>(0xF8 | (rm & 7)));
+	}
+	void move(Host reg, int64_t value) {
+		rex(0, 0, reg);
+		if (value >= std::numeric_limits<int32_t>::min() &&
+		    value <= std::numeric_limits<int32_t>::max()) {
+			byte(0xC7);
+			byte(static_cast<uint8_t>(0xC0 | (reg & 7)));
+			dword(static_cast<uint32_t>(value));
+			return;
+		}
+		byte(static_cast<uint8_t>(0xB8 | (reg & 7)));
+		dword(static_cast<uint32_t>(value));
+		dword(static_cast<uint32_t>(static_cast<uint64_t>(value) >> 32));
+	}
+	void increment(Host reg) {
+		rex(0, 0, reg);
+		byte(0xFF);
+		byte(static_cast<uint8_t>(0xC0 | (reg & 7)));
+	}
+	// rax is 1 when the condition holds and 0 otherwise
+	void set(Condition condition) {
+		byte(0x0F);
+		byte(0x90 | condition);
+		byte(0xC0);
+		byte(0x0F);
+		byte(0xB6);
+		byte(0xC0);
+	}
+	void push(Host reg) {
+		if (reg >= r8) {
+			byte(0x41);
+		}
+		byte(static_cast<uint8_t>(0x50 | (reg & 7)));
+	}
+	void pop(Host reg) {
+		if (reg >= r8) {
+			byte(0x41);
+		}
+		byte(static_cast<uint8_t>(0x58 | (reg & 7)));
+	}
+	void leave(uint32_t instruction) {
+		byte(0xB8);
+		dword(instruction);
+	}
+	void ret() { byte(0xC3); }
+	void jump(Host reg) {
+		if (reg >= r8) {
+			byte(0x41);
+		}
+		byte(0xFF);
+		byte(static_cast<uint8_t>(0xE0 | (reg & 7)));
+	}
+
+	// jumps return where their displacement is, patched once the target is
+	// emitted
+	std::size_t jump() {
+		byte(0xE9);
+		dword(0);
+		return bytes.size() - 4;
+	}
+	std::size_t jump(Condition condition) {
+		byte(0x0F);
+		byte(0x80 | condition);
+		dword(0);
+		return bytes.size() - 4;
+	}
+	void patch(std::size_t at, std::size_t target) {
+		auto displacement = static_cast<uint32_t>(
+		    static_cast<int64_t>(target) - static_cast<int64_t>(at + 4));
+		for (std::size_t i = 0; i < 4; i++) {
+			bytes[at + i] = static_cast<uint8_t>(displacement >> (i * 8));
+		}
+	}
+};
+
+// MOV, CMP, TEST and the arithmetic opcodes between a register and r/m
+constexpr uint8_t opAdd = 0x01;
+constexpr uint8_t opOr = 0x09;
+constexpr uint8_t opAnd = 0x21;
+constexpr uint8_t opSub = 0x29;
+constexpr uint8_t opXor = 0x31;
+constexpr uint8_t opCmp = 0x39;
+constexpr uint8_t opCmpLoad = 0x3B;
+constexpr uint8_t opTest = 0x85;
+constexpr uint8_t opStore = 0x89;
+constexpr uint8_t opLoad = 0x8B;
+constexpr uint8_t opStoreImmediate = 0xC7;
+// the digit selecting the operation of an immediate
+constexpr uint8_t digitAdd = 0;
+constexpr uint8_t digitOr = 1;
+constexpr uint8_t digitAnd = 4;
+constexpr uint8_t digitSub = 5;
+constexpr uint8_t digitCmp = 7;
+
+// saves the registers the caller keeps, loads the pinned ones and jumps to
+// the native code given as the second argument, the frame is the first
+std::vector<uint8_t> emit_trampoline() {
+	Emitter out;
+	for (auto reg : {rbx, rbp, r12, r13, r14, r15}) {
+		out.push(reg);
+	}
+	out.registers(opStore, frameBase, rdi);
+	out.registers(opStore, rax, rsi);
+	out.memory(opLoad, cpuBase, frameBase, displacement(offsetof(Frame, cpu)));
+	out.memory(opLoad, memoryBase, frameBase,
+	           displacement(offsetof(Frame, memory)));
+	out.registers(opXor, counter, counter);
+	for (uint8_t i = 0; i < pinned.size(); i++) {
+		out.memory(opLoad, pinned[i], cpuBase, register_offset(i));
+	}
+	out.jump(rax);
+	return out.take();
+}
+
+// the machine code of one function, laid out in the order of its
+// instructions with the exits to the interpreter after them
+class Translator {
+	const std::vector<Instruction> &code;
+	const std::vector<uint64_t> &constants;
+	const std::vector<bool> &members;
+	std::vector<std::size_t> &offsets;
+	Emitter out;
+
+	struct Patch {
+		std::size_t at;
+		uint32_t instruction;
+	};
+	// jumps to instructions of the function
+	std::vector<Patch> branches;
+	// jumps returning to the interpreter before an instruction
+	std::vector<Patch> exits;
+
+	void read(Host host, uint8_t index) {
+		if (index < pinned.size()) {
+			out.registers(opStore, host, pinned[index]);
+		} else {
+			out.memory(opLoad, host, cpuBase, register_offset(index));
+		}
+	}
+	void write(uint8_t index, Host host) {
+		if (index < pinned.size()) {
+			out.registers(opStore, pinned[index], host);
+		} else {
+			out.memory(opStore, host, cpuBase, register_offset(index));
+		}
+	}
+	void leave(uint32_t instruction) {
+		exits.push_back({out.jump(), instruction});
+	}
+	void leave(Condition condition, uint32_t instruction) {
+		exits.push_back({out.jump(condition), instruction});
+	}
+	void branch(uint32_t target) {
+		if (target < code.size() && members[target]) {
+			branches.push_back({out.jump(), target});
+		} else {
+			leave(target);
+		}
+	}
+	// rax is the address of a 64 bit access, leaving when it does not fit
+	void address(const Instruction &instruction, uint32_t index) {
+		read(rax, instruction.b);
+		if (instruction.immediate != 0) {
+			out.arithmetic(digitAdd, rax, instruction.immediate);
+		}
+		out.memory(opCmpLoad, rax, frameBase,
+		           displacement(offsetof(Frame, limit)));
+		leave(AboveEqual, index);
+	}
+
+	// host is combined with c or the immediate
+	void operate(const Instruction &instruction, Host host, uint8_t opcode,
+	             uint8_t digit, int32_t immediate) {
+		if (instruction.mode == OperandMode::Immediate) {
+			out.arithmetic(digit, host, immediate);
+		} else {
+			read(rdx, instruction.c);
+			out.registers(opcode, host, rdx);
+		}
+	}
+	void binary(const Instruction &instruction, uint8_t opcode, uint8_t digit) {
+		read(rax, instruction.b);
+		operate(instruction, rax, opcode, digit, instruction.immediate);
+		write(instruction.a, rax);
+	}
+	void compare(const Instruction &instruction, Condition condition,
+	             int32_t immediate) {
+		read(rax, instruction.b);
+		operate(instruction, rax, opCmp, digitCmp, immediate);
+		out.set(condition);
+		write(instruction.a, rax);
+	}
+	// the jump of the fused instructions, on the value in rax
+	void jump(bool whenSet, int32_t target) {
+		out.increment(counter);
+		out.registers(opTest, rax, rax);
+		branches.push_back({out.jump(whenSet ? NotEqual : Equal),
+		                    static_cast<uint32_t>(target)});
+	}
+	// leaves for the interpreter to trap on a zero divisor or an overflow
+	bool divide(const Instruction &instruction, uint32_t index) {
+		read(rax, instruction.b);
+		if (instruction.mode == OperandMode::Immediate) {
+			if (instruction.immediate == 0) {
+				leave(index);
+				return false;
+			}
+			if (instruction.immediate == -1) {
+				out.move(rdx, std::numeric_limits<int64_t>::min());
+				out.registers(opCmp, rax, rdx);
+				leave(Equal, index);
+			}
+			out.move(rcx, instruction.immediate);
+		} else {
+			read(rcx, instruction.c);
+			out.registers(opTest, rcx, rcx);
+			leave(Equal, index);
+			out.arithmetic(digitCmp, rcx, -1);
+			auto divisible = out.jump(NotEqual);
+			out.move(rdx, std::numeric_limits<int64_t>::min());
+			out.registers(opCmp, rax, rdx);
+			leave(Equal, index);
+			out.patch(divisible, out.size());
+		}
+		out.divide(rcx);
+		write(instruction.a, instruction.opcode == OpCode::Div ? rax : rdx);
+		return true;
+	}
+	// the call is made only when its target has native code, the interpreter
+	// makes the others and counts them towards compiling the target
+	void call(const Instruction &instruction, uint32_t index) {
+		auto target = static_cast<uint32_t>(instruction.immediate);
+		bool local = members[target];
+		if (!local) {
+			out.memory(opLoad, rdx, frameBase,
+			           displacement(offsetof(Frame, entries)));
+			out.move(rcx, target);
+			out.indexed(opLoad, rdx, rdx, rcx, 3);
+			out.registers(opTest, rdx, rdx);
+			leave(Equal, index);
+		}
+		out.memory(opLoad, rax, cpuBase, displacement(offsetof(CPUCore, sp)));
+		out.arithmetic(digitSub, rax, sizeof(uint64_t));
+		out.memory(opCmpLoad, rax, frameBase,
+		           displacement(offsetof(Frame, limit)));
+		leave(AboveEqual, index);
+		out.memory(opLoad, rcx, cpuBase, displacement(offsetof(CPUCore, ra)));
+		out.indexed(opStore, rcx, memoryBase, rax, 0);
+		out.memory(opStore, rax, cpuBase, displacement(offsetof(CPUCore, sp)));
+		out.memory(opStoreImmediate, 0, cpuBase,
+		           displacement(offsetof(CPUCore, ra)));
+		out.dword(index + 1);
+		out.increment(counter);
+		if (local) {
+			branch(target);
+		} else {
+			out.jump(rdx);
+		}
+	}
+	// returns to native code only, the end of the program, traps and
+	// interpreted callers are left to the interpreter
+	void ret(uint32_t index) {
+		out.memory(opLoad, rax, cpuBase, displacement(offsetof(CPUCore, sp)));
+		out.memory(opCmpLoad, rax, frameBase,
+		           displacement(offsetof(Frame, stackBase)));
+		leave(AboveEqual, index);
+		out.memory(opCmpLoad, rax, frameBase,
+		           displacement(offsetof(Frame, limit)));
+		leave(AboveEqual, index);
+		out.memory(opLoad, rdx, cpuBase, displacement(offsetof(CPUCore, ra)));
+		out.memory(opCmpLoad, rdx, frameBase,
+		           displacement(offsetof(Frame, instructions)));
+		leave(AboveEqual, index);
+		out.memory(opLoad, rcx, frameBase,
+		           displacement(offsetof(Frame, entries)));
+		out.indexed(opLoad, rcx, rcx, rdx, 3);
+		out.registers(opTest, rcx, rcx);
+		leave(Equal, index);
+		out.indexed(opLoad, rdx, memoryBase, rax, 0);
+		out.memory(opStore, rdx, cpuBase, displacement(offsetof(CPUCore, ra)));
+		out.arithmetic(digitAdd, rax, sizeof(uint64_t));
+		out.memory(opStore, rax, cpuBase, displacement(offsetof(CPUCore, sp)));
+		out.increment(counter);
+		out.jump(rcx);
+	}
+
+	// the template of one instruction, false when it never falls through
+	bool emit(uint32_t index) {
+		const auto &instruction = code[index];
+		switch (instruction.opcode) {
+		case OpCode::Add:
+			binary(instruction, opAdd, digitAdd);
+			break;
+		case OpCode::Sub:
+			binary(instruction, opSub, digitSub);
+			break;
+		case OpCode::Mul:
+			read(rax, instruction.b);
+			if (instruction.mode == OperandMode::Immediate) {
+				out.multiply(rax, instruction.immediate);
+			} else {
+				read(rcx, instruction.c);
+				out.multiply(rax, rcx);
+			}
+			write(instruction.a, rax);
+			break;
+		case OpCode::Div:
+		case OpCode::Mod:
+			if (!divide(instruction, index)) {
+				return false;
+			}
+			break;
+		case OpCode::Eq:
+			compare(instruction, Equal, instruction.immediate);
+			break;
+		case OpCode::Neq:
+			compare(instruction, NotEqual, instruction.immediate);
+			break;
+		case OpCode::Lt:
+			compare(instruction, Less, instruction.immediate);
+			break;
+		case OpCode::Lte:
+			compare(instruction, LessEqual, instruction.immediate);
+			break;
+		case OpCode::Gt:
+			compare(instruction, Greater, instruction.immediate);
+			break;
+		case OpCode::Gte:
+			compare(instruction, GreaterEqual, instruction.immediate);
+			break;
+		case OpCode::And:
+			binary(instruction, opAnd, digitAnd);
+			break;
+		case OpCode::Or:
+			binary(instruction, opOr, digitOr);
+			break;
+		case OpCode::Not:
+			read(rax, instruction.c);
+			out.registers(opTest, rax, rax);
+			out.set(Equal);
+			write(instruction.a, rax);
+			break;
+		case OpCode::Beq:
+			out.increment(counter);
+			branch(static_cast<uint32_t>(instruction.immediate));
+			return false;
+		case OpCode::JmpIf:
+		case OpCode::JmpIfNot: {
+			// counted first, incrementing changes the flags
+			out.increment(counter);
+			read(rax, instruction.a);
+			out.registers(opTest, rax, rax);
+			auto target = static_cast<uint32_t>(instruction.immediate);
+			branches.push_back(
+			    {out.jump(instruction.opcode == OpCode::JmpIf ? NotEqual
+			                                                  : Equal),
+			     target});
+			return true;
+		}
+		case OpCode::Call:
+			call(instruction, index);
+			return false;
+		case OpCode::Ret:
+			ret(index);
+			return false;
+		case OpCode::Load:
+			switch (instruction.mode) {
+			case OperandMode::Register:
+				read(rax, instruction.c);
+				break;
+			case OperandMode::Constant:
+				out.move(rax, static_cast<int64_t>(
+				                  constants[instruction.immediate]));
+				break;
+			case OperandMode::Memory:
+				address(instruction, index);
+				out.indexed(opLoad, rax, memoryBase, rax, 0);
+				break;
+			default:
+				out.move(rax, instruction.immediate);
+				break;
+			}
+			write(instruction.a, rax);
+			break;
+		case OpCode::Store:
+			address(instruction, index);
+			read(rcx, instruction.a);
+			out.indexed(opStore, rcx, memoryBase, rax, 0);
+			break;
+		case OpCode::Nop:
+			break;
+		case OpCode::Halt:
+		case OpCode::INVALID:
+			leave(index);
+			return false;
+		case OpCode::LoadAddStore:
+		case OpCode::LoadSubStore: {
+			bool add = instruction.opcode == OpCode::LoadAddStore;
+			address(instruction, index);
+			if (instruction.mode == OperandMode::Immediate) {
+				out.move(rdx, instruction.small);
+			} else {
+				read(rdx, instruction.c);
+			}
+			// updates the memory in place and reads the result back
+			out.indexed(add ? opAdd : opSub, rdx, memoryBase, rax, 0);
+			out.indexed(opLoad, rcx, memoryBase, rax, 0);
+			write(instruction.a, rcx);
+			break;
+		}
+		case OpCode::AddJmpIf:
+			read(rax, instruction.a);
+			out.arithmetic(digitAdd, rax, instruction.small);
+			write(instruction.a, rax);
+			jump(true, instruction.immediate);
+			return true;
+		default: {
+			// the fused comparisons and jumps, in the order of the plain
+			// comparisons
+			auto comparison = fused_comparison(instruction.opcode);
+			constexpr Condition conditions[] = {
+			    Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual};
+			compare(instruction,
+			        conditions[static_cast<uint8_t>(comparison) -
+			                   static_cast<uint8_t>(OpCode::Eq)],
+			        instruction.small);
+			jump(instruction.opcode <= OpCode::GteJmpIf, instruction.immediate);
+			return true;
+		}
+		}
+		out.increment(counter);
+		return true;
+	}
+
+  public:
+	Translator(const std::vector<Instruction> &code,
+	           const std::vector<uint64_t> &constants,
+	           const std::vector<bool> &members,
+	           std::vector<std::size_t> &offsets)
+	    : code(code), constants(constants), members(members),
+	      offsets(offsets) {}
+
+	std::vector<uint8_t> translate() {
+		for (uint32_t i = 0; i < code.size(); i++) {
+			if (!members[i]) {
+				continue;
+			}
+			offsets[i] = out.size();
+			// falling through to the next instruction needs a jump when it
+			// is not laid out right after, past the end of the program
+			if (emit(i) && (i + 1 >= code.size() || !members[i + 1])) {
+				branch(i + 1);
+			}
+		}
+		for (auto [at, target] : branches) {
+			out.patch(at, offsets[target]);
+		}
+
+		// an exit per instruction left at, sharing the code storing the
+		// pinned registers and returning the instruction
+		std::unordered_map<uint32_t, std::size_t> stubs;
+		std::vector<std::size_t> returns;
+		for (auto [at, instruction] : exits) {
+			auto [stub, added] = stubs.try_emplace(instruction, out.size());
+			if (added) {
+				out.leave(instruction);
+				returns.push_back(out.jump());
+			}
+			out.patch(at, stub->second);
+		}
+		for (auto at : returns) {
+			out.patch(at, out.size());
+		}
+		for (uint8_t i = 0; i < pinned.size(); i++) {
+			out.memory(opStore, pinned[i], cpuBase, register_offset(i));
+		}
+		out.memory(opStore, counter, frameBase,
+		           displacement(offsetof(Frame, executed)));
+		for (auto reg : {r15, r14, r13, r12, rbp, rbx}) {
+			out.pop(reg);
+		}
+		out.ret();
+		return out.take();
+	}
+};
+
+} // namespace
+
+Jit::~Jit() { clear(); }
+
+void Jit::reset(const Program &program) {
+	clear();
+	code.reserve(program.code.size());
+	for (auto word : program.code) {
+		code.push_back(Instruction::decode(word));
+	}
+	constants = program.constants;
+	entries.assign(code.size() + 1, nullptr);
+	heat.assign(code.size() + 1, 0);
+
+	// functions start at the entry and every call target and run until the
+	// next one starts
+	std::vector<bool> starts(code.size() + 1, false);
+	starts[0] = true;
+	starts[std::min<std::size_t>(program.entry, code.size())] = true;
+	for (const auto &instruction : code) {
+		if (instruction.opcode == OpCode::Call) {
+			starts[static_cast<uint32_t>(instruction.immediate)] = true;
+		}
+	}
+	functions.resize(code.size() + 1);
+	uint32_t function = 0;
+	for (uint32_t i = 0; i < functions.size(); i++) {
+		if (starts[i]) {
+			function = i;
+		}
+		functions[i] = function;
+	}
+}
+
+void Jit::clear() {
+	for (auto region : regions) {
+		::munmap(region.address, region.length);
+	}
+	regions.clear();
+	trampoline = nullptr;
+	code.clear();
+	constants.clear();
+	entries.clear();
+	functions.clear();
+	heat.clear();
+}
+
+const void *Jit::compile(uint64_t instruction) {
+	// a loop that is not reachable from the start of its function is
+	// compiled on its own
+	if (!translate(functions[instruction]) || !entries[instruction]) {
+		translate(static_cast<uint32_t>(instruction));
+	}
+	return entries[instruction];
+}
+
+bool Jit::translate(uint32_t start) {
+	if (start >= code.size()) {
+		return false;
+	}
+	if (trampoline == nullptr) {
+		trampoline = install(emit_trampoline());
+		if (trampoline == nullptr) {
+			return false;
+		}
+	}
+
+	std::vector<bool> members(code.size(), false);
+	std::vector<uint32_t> pending = {start};
+	auto reach = [&](uint64_t instruction) {
+		if (instruction < code.size() && !members[instruction]) {
+			members[instruction] = true;
+			pending.push_back(static_cast<uint32_t>(instruction));
+		}
+	};
+	members[start] = true;
+	while (!pending.empty()) {
+		uint32_t index = pending.back();
+		pending.pop_back();
+		const auto &instruction = code[index];
+		switch (instruction.opcode) {
+		case OpCode::Beq:
+			reach(static_cast<uint32_t>(instruction.immediate));
+			break;
+		case OpCode::Ret:
+		case OpCode::Halt:
+		case OpCode::INVALID:
+			break;
+		case OpCode::Call:
+			// calls continue at the next instruction once they return
+			reach(index + 1);
+			break;
+		default:
+			if (is_branch(instruction.opcode)) {
+				reach(static_cast<uint32_t>(instruction.immediate));
+			}
+			reach(index + 1);
+			break;
+		}
+	}
+
+	std::vector<std::size_t> offsets(code.size(), 0);
+	auto machineCode =
+	    Translator(code, constants, members, offsets).translate();
+	auto *native = static_cast<const uint8_t *>(install(machineCode));
+	if (native == nullptr) {
+		return false;
+	}
+	for (uint32_t i = 0; i < code.size(); i++) {
+		if (members[i] && entries[i] == nullptr) {
+			entries[i] = native + offsets[i];
+		}
+	}
+	return true;
+}
+
+// the code is copied into writable pages that become executable only once
+// they are no longer writable
+const void *Jit::install(const std::vector<uint8_t> &machineCode) {
+	static const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	std::size_t length = (machineCode.size() + page - 1) / page * page;
+	void *address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+	                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (address == MAP_FAILED) {
+		return nullptr;
+	}
+	std::memcpy(address, machineCode.data(), machineCode.size());
+	if (::mprotect(address, length, PROT_READ | PROT_EXEC) != 0) {
+		::munmap(address, length);
+		return nullptr;
+	}
+	regions.push_back({address, length});
+	return address;
+}
+
+uint64_t Jit::run(const void *native, CPUCore &cpu, Memory &memory,
+                  uint64_t stackBase, uint64_t &executed) {
+	Frame frame{.cpu = &cpu,
+	            .memory = memory.base(),
+	            .limit = memory.limit<uint64_t>(),
+	            .stackBase = stackBase,
+	            .entries = entries.data(),
+	            .instructions = entries.size(),
+	            .executed = 0};
+	using Enter = uint64_t (*)(Frame *, const void *);
+	auto enter = reinterpret_cast<Enter>(const_cast<void *>(trampoline));
+	uint64_t instruction = enter(&frame, native);
+	executed += frame.executed;
+	return instruction;
+}
+
+} // namespace ray::vm
+
+#endif
@@ -1,5 +1,16 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
 #include <ray/vm/memory.hpp>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define RAYVM_MEMORY_MMAP 1
+#endif
+
 namespace ray::vm {
 
 using Byte = definitions::Byte;
@@ -7,75 +18,133 @@ using Word = definitions::Word;
 using DWord = definitions::DWord;
 using QWord = definitions::QWord;
 
-Memory::Memory(std::size_t bytes) : data(bytes) {}
+namespace {
 
-void Memory::resize(std::size_t size) { data.resize(size); }
+struct Region {
+	Byte *mapping;
+	std::size_t mapped;
+};
 
-Byte Memory::readByte(std::size_t index) const {
-	if (index >= size()) {
-		return static_cast<Byte>(0);
+#ifdef RAYVM_MEMORY_MMAP
+
+std::size_t page_size() {
+	static const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	return page;
+}
+
+// the memory rounded up to whole pages followed by one inaccessible page,
+// anonymous pages start zeroed
+Region map_region(std::size_t bytes) {
+	std::size_t page = page_size();
+	std::size_t usable = (bytes + page - 1) / page * page;
+	std::size_t mapped = usable + page;
+	void *address = ::mmap(nullptr, mapped, PROT_NONE,
+	                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (address == MAP_FAILED) {
+		throw std::bad_alloc();
 	}
-	return data.at(index);
+	if (usable > 0 &&
+	    ::mprotect(address, usable, PROT_READ | PROT_WRITE) != 0) {
+		::munmap(address, mapped);
+		throw std::bad_alloc();
+	}
+	return {static_cast<Byte *>(address), mapped};
 }
-bool Memory::writeByte(std::size_t index, Byte value) {
-	if (index >= size()) {
-		return false;
+
+void unmap_region(Region region) {
+	if (region.mapping != nullptr) {
+		::munmap(region.mapping, region.mapped);
+	}
+}
+
+// the usable pages of a mapping, the guard page is the last one
+std::size_t usable_bytes(Region region) {
+	return region.mapped - page_size();
+}
+
+#else
+
+// without a guard page the bound checks alone keep accesses in the memory
+Region map_region(std::size_t bytes) {
+	return {new Byte[std::max<std::size_t>(bytes, 1)](), bytes};
+}
+
+void unmap_region(Region region) { delete[] region.mapping; }
+
+std::size_t usable_bytes(Region region) { return region.mapped; }
+
+#endif
+
+// the memory ends as close to the guard page as it can while starting 8 byte
+// aligned, at most 7 bytes are left between them
+Byte *memory_start(Region region, std::size_t bytes) {
+	std::size_t slack = usable_bytes(region) - bytes;
+	return region.mapping + (slack & ~std::size_t{7});
+}
+
+} // namespace
+
+Memory::Memory(std::size_t bytes) {
+	auto region = map_region(bytes);
+	adopt(region.mapping, region.mapped, bytes);
+}
+
+Memory::~Memory() { unmap_region({mapping, mapped}); }
+
+void Memory::adopt(Byte *region, std::size_t length, std::size_t size) {
+	unmap_region({mapping, mapped});
+	mapping = region;
+	mapped = length;
+	bytes = size;
+	data = memory_start({region, length}, size);
+	for (std::size_t i = 0; i < limits.size(); i++) {
+		std::size_t access = std::size_t{1} << i;
+		limits[i] = bytes >= access ? bytes - access + 1 : 0;
 	}
-	data.at(index) = value;
-	return true;
+}
+
+void Memory::resize(std::size_t size) {
+	auto region = map_region(size);
+	std::memcpy(memory_start(region, size), data, std::min(size, bytes));
+	adopt(region.mapping, region.mapped, size);
+}
+
+Byte Memory::readByte(std::size_t index) const {
+	Byte value{};
+	load(index, value);
+	return value;
+}
+bool Memory::writeByte(std::size_t index, Byte value) {
+	return store(index, value);
 }
 
 Word Memory::readWord(std::size_t index) const {
 	Word word = {};
-	for (std::size_t i = 0; i < std::min(sizeof(Word), size() - index); i++) {
-		word.bytes.at(i) = data.at(index + i);
-	}
+	load(index, word);
 	return word;
 }
 bool Memory::writeWord(std::size_t index, Word value) {
-	if (index > size() - sizeof(Word)) {
-		return false;
-	}
-	for (std::size_t i = 0; i < sizeof(Word); i++) {
-		data.at(index + i) = value.bytes.at(i);
-	}
-	return true;
+	return store(index, value);
 }
 
 DWord Memory::readDWord(std::size_t index) const {
 	DWord dword = {};
-	for (std::size_t i = 0; i < std::min(sizeof(DWord), size() - index); i++) {
-		dword.bytes.at(i) = data.at(index + i);
-	}
+	load(index, dword);
 	return dword;
 }
 bool Memory::writeDWord(std::size_t index, DWord value) {
-	if (index > size() - sizeof(DWord)) {
-		return false;
-	}
-	for (std::size_t i = 0; i < sizeof(DWord); i++) {
-		data.at(index + i) = value.bytes.at(i);
-	}
-	return true;
+	return store(index, value);
 }
 
 QWord Memory::readQWord(std::size_t index) const {
 	QWord qword = {};
-	for (std::size_t i = 0; i < std::min(sizeof(QWord), size() - index); i++) {
-		qword.bytes.at(i) = data.at(index + i);
-	}
+	load(index, qword);
 	return qword;
 }
 bool Memory::writeQWord(std::size_t index, QWord value) {
-	if (index > size() - sizeof(QWord)) {
-		return false;
-	}
-	for (std::size_t i = 0; i < sizeof(QWord); i++) {
-		data.at(index + i) = value.bytes.at(i);
-	}
-	return true;
+	return store(index, value);
 }
 
-std::size_t Memory::size() const { return data.size(); }
+std::size_t Memory::size() const { return bytes; }
 
 } // namespace ray::vm
@@ -0,0 +1,441 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <ray/vm/optimizer.hpp>
+
+namespace ray::vm {
+
+namespace {
+
+// what is known of every register at an instruction, the value of the ones
+// holding a constant
+using Known = std::array<std::optional<uint64_t>, registerCount>;
+
+bool fits_immediate(int64_t value) {
+	return value >= std::numeric_limits<int32_t>::min() &&
+	       value <= std::numeric_limits<int32_t>::max();
+}
+
+bool fits_short(int64_t value) {
+	return value >= std::numeric_limits<int8_t>::min() &&
+	       value <= std::numeric_limits<int8_t>::max();
+}
+
+bool is_binary(OpCode opcode) {
+	return opcode <= OpCode::Or && opcode != OpCode::Not;
+}
+
+bool is_comparison(OpCode opcode) {
+	return opcode >= OpCode::Eq && opcode <= OpCode::Gte;
+}
+
+// the value the VM computes, nothing when the operation traps
+std::optional<uint64_t> fold(OpCode opcode, uint64_t lhs, uint64_t rhs) {
+	auto left = static_cast<int64_t>(lhs);
+	auto right = static_cast<int64_t>(rhs);
+	switch (opcode) {
+	case OpCode::Add:
+		return lhs + rhs;
+	case OpCode::Sub:
+		return lhs - rhs;
+	case OpCode::Mul:
+		return lhs * rhs;
+	case OpCode::Div:
+	case OpCode::Mod:
+		if (right == 0 ||
+		    (left == std::numeric_limits<int64_t>::min() && right == -1)) {
+			return std::nullopt;
+		}
+		return static_cast<uint64_t>(opcode == OpCode::Div ? left / right
+		                                                   : left % right);
+	case OpCode::Eq:
+		return lhs == rhs;
+	case OpCode::Neq:
+		return lhs != rhs;
+	case OpCode::Lt:
+		return left < right;
+	case OpCode::Lte:
+		return left <= right;
+	case OpCode::Gt:
+		return left > right;
+	case OpCode::Gte:
+		return left >= right;
+	case OpCode::And:
+		return lhs & rhs;
+	case OpCode::Or:
+		return lhs | rhs;
+	default:
+		return std::nullopt;
+	}
+}
+
+// whether the operation leaves b unchanged with the immediate
+bool is_identity(OpCode opcode, int32_t immediate) {
+	switch (opcode) {
+	case OpCode::Add:
+	case OpCode::Sub:
+	case OpCode::Or:
+		return immediate == 0;
+	case OpCode::Mul:
+	case OpCode::Div:
+		return immediate == 1;
+	case OpCode::And:
+		return immediate == -1;
+	default:
+		return false;
+	}
+}
+
+// the instructions reached other than by falling through, where nothing is
+// known about the registers and no fused sequence can continue
+std::vector<bool> find_targets(const Program &program,
+                               const std::vector<Instruction> &code) {
+	std::vector<bool> targets(code.size(), false);
+	if (program.entry < code.size()) {
+		targets[program.entry] = true;
+	}
+	for (size_t i = 0; i < code.size(); i++) {
+		if (is_branch(code[i].opcode)) {
+			targets[static_cast<uint32_t>(code[i].immediate)] = true;
+		}
+		// returns land after the call
+		if (code[i].opcode == OpCode::Call && i + 1 < code.size()) {
+			targets[i + 1] = true;
+		}
+	}
+	return targets;
+}
+
+Instruction load_constant(Program &program, uint8_t reg, uint64_t value) {
+	Instruction load{
+	    .opcode = OpCode::Load, .mode = OperandMode::Immediate, .a = reg};
+	auto signedValue = static_cast<int64_t>(value);
+	if (fits_immediate(signedValue)) {
+		load.immediate = static_cast<int32_t>(signedValue);
+		return load;
+	}
+	auto &constants = program.constants;
+	auto constant = std::find(constants.begin(), constants.end(), value);
+	if (constant == constants.end()) {
+		constant = constants.insert(constants.end(), value);
+	}
+	load.mode = OperandMode::Constant;
+	load.immediate = static_cast<int32_t>(constant - constants.begin());
+	return load;
+}
+
+// drops the removed instructions, whatever pointed at one of them points at
+// the next instruction kept
+void compact(Program &program, std::vector<Instruction> &code,
+             std::vector<bool> &removed) {
+	// the last instruction stays so there always is a next one
+	if (!code.empty()) {
+		removed.back() = false;
+	}
+	std::vector<uint32_t> renumbered(code.size() + 1);
+	uint32_t next = 0;
+	for (size_t i = 0; i < code.size(); i++) {
+		renumbered[i] = next;
+		next += removed[i] ? 0 : 1;
+	}
+	renumbered[code.size()] = next;
+
+	std::vector<Instruction> kept;
+	kept.reserve(next);
+	for (size_t i = 0; i < code.size(); i++) {
+		if (removed[i]) {
+			continue;
+		}
+		auto instruction = code[i];
+		if (is_branch(instruction.opcode)) {
+			instruction.immediate = static_cast<int32_t>(
+			    renumbered[static_cast<uint32_t>(instruction.immediate)]);
+		}
+		kept.push_back(instruction);
+	}
+	for (auto &tag : program.tags) {
+		tag.instruction =
+		    renumbered[std::min<size_t>(tag.instruction, code.size())];
+	}
+	program.entry = renumbered[std::min<size_t>(program.entry, code.size())];
+	code = std::move(kept);
+	removed.assign(code.size(), false);
+}
+
+// follows the registers holding constants through every block, folding them
+// into the instructions reading them and removing the instructions that do
+// nothing
+void fold_constants(Program &program, std::vector<Instruction> &code) {
+	auto targets = find_targets(program, code);
+	std::vector<bool> removed(code.size(), false);
+	Known known;
+	for (size_t i = 0; i < code.size(); i++) {
+		if (targets[i]) {
+			known = {};
+		}
+		auto &instruction = code[i];
+		auto target = static_cast<size_t>(instruction.immediate);
+		if (is_binary(instruction.opcode)) {
+			auto c = known[instruction.c];
+			if (instruction.mode == OperandMode::Register && c &&
+			    fits_immediate(static_cast<int64_t>(*c))) {
+				instruction.mode = OperandMode::Immediate;
+				instruction.immediate = static_cast<int32_t>(*c);
+			}
+			if (instruction.mode != OperandMode::Immediate) {
+				known[instruction.a] = std::nullopt;
+				continue;
+			}
+			auto rhs = static_cast<uint64_t>(
+			    static_cast<int64_t>(instruction.immediate));
+			if (auto b = known[instruction.b]) {
+				if (auto value = fold(instruction.opcode, *b, rhs)) {
+					instruction =
+					    load_constant(program, instruction.a, *value);
+					known[instruction.a] = value;
+					continue;
+				}
+			}
+			if (is_identity(instruction.opcode, instruction.immediate)) {
+				if (instruction.a == instruction.b) {
+					removed[i] = true;
+					continue;
+				}
+				instruction = {.opcode = OpCode::Load,
+				               .mode = OperandMode::Register,
+				               .a = instruction.a,
+				               .c = instruction.b};
+				known[instruction.a] = known[instruction.c];
+				continue;
+			}
+			known[instruction.a] = std::nullopt;
+			continue;
+		}
+
+		switch (instruction.opcode) {
+		case OpCode::Not:
+			if (auto c = known[instruction.c]) {
+				instruction = load_constant(program, instruction.a, *c == 0);
+				known[instruction.a] = *c == 0;
+			} else {
+				known[instruction.a] = std::nullopt;
+			}
+			break;
+		case OpCode::Load:
+			switch (instruction.mode) {
+			case OperandMode::Register: {
+				auto c = known[instruction.c];
+				if (instruction.a == instruction.c) {
+					removed[i] = true;
+				} else if (c) {
+					instruction = load_constant(program, instruction.a, *c);
+				}
+				known[instruction.a] = c;
+				break;
+			}
+			case OperandMode::Immediate:
+				known[instruction.a] = static_cast<uint64_t>(
+				    static_cast<int64_t>(instruction.immediate));
+				break;
+			case OperandMode::Constant:
+				known[instruction.a] = program.constants[target];
+				break;
+			default:
+				known[instruction.a] = std::nullopt;
+				break;
+			}
+			break;
+		case OpCode::JmpIf:
+		case OpCode::JmpIfNot:
+			if (target == i + 1) {
+				removed[i] = true;
+			} else if (auto a = known[instruction.a]) {
+				bool taken =
+				    (*a != 0) == (instruction.opcode == OpCode::JmpIf);
+				if (taken) {
+					instruction = {.opcode = OpCode::Beq,
+					               .immediate = instruction.immediate};
+					known = {};
+				} else {
+					removed[i] = true;
+				}
+			}
+			break;
+		case OpCode::Beq:
+			if (target == i + 1) {
+				removed[i] = true;
+			} else {
+				known = {};
+			}
+			break;
+		case OpCode::Nop:
+			removed[i] = true;
+			break;
+		case OpCode::Call:
+		case OpCode::Ret:
+		case OpCode::Halt:
+			known = {};
+			break;
+		case OpCode::Store:
+			break;
+		default:
+			// the fused instructions written in the source
+			known[instruction.a] = std::nullopt;
+			break;
+		}
+	}
+	compact(program, code, removed);
+}
+
+// load rA, [rB + offset]; add or sub rA, rA, rC or a short immediate;
+// store rA, [rB + offset]
+std::optional<Instruction> fuse_update(const Instruction &load,
+                                       const Instruction &operation,
+                                       const Instruction &store) {
+	if (load.opcode != OpCode::Load || load.mode != OperandMode::Memory ||
+	    (operation.opcode != OpCode::Add && operation.opcode != OpCode::Sub) ||
+	    store.opcode != OpCode::Store) {
+		return std::nullopt;
+	}
+	// the load changing the base would move the store
+	if (load.b == load.a || operation.a != load.a || operation.b != load.a ||
+	    store.a != load.a || store.b != load.b ||
+	    store.immediate != load.immediate) {
+		return std::nullopt;
+	}
+	Instruction fused{.opcode = operation.opcode == OpCode::Add
+	                                ? OpCode::LoadAddStore
+	                                : OpCode::LoadSubStore,
+	                  .mode = operation.mode,
+	                  .a = load.a,
+	                  .b = load.b,
+	                  .c = operation.c,
+	                  .immediate = load.immediate};
+	if (operation.mode == OperandMode::Register) {
+		// the operand is read before the load replaces it
+		if (operation.c == load.a) {
+			return std::nullopt;
+		}
+		return fused;
+	}
+	if (!fits_short(operation.immediate)) {
+		return std::nullopt;
+	}
+	fused.small = static_cast<int8_t>(operation.immediate);
+	return fused;
+}
+
+// add or sub rA, rA, a short immediate; jmpif rA, tag
+// or a comparison into rA followed by jmpif or jmpifnot rA, tag
+std::optional<Instruction> fuse_branch(const Instruction &first,
+                                       const Instruction &jump) {
+	bool whenSet = jump.opcode == OpCode::JmpIf;
+	if ((!whenSet && jump.opcode != OpCode::JmpIfNot) || jump.a != first.a) {
+		return std::nullopt;
+	}
+	if ((first.opcode == OpCode::Add || first.opcode == OpCode::Sub) &&
+	    first.mode == OperandMode::Immediate && first.a == first.b &&
+	    whenSet) {
+		int64_t step = first.opcode == OpCode::Add
+		                   ? first.immediate
+		                   : -static_cast<int64_t>(first.immediate);
+		if (!fits_short(step)) {
+			return std::nullopt;
+		}
+		return Instruction{.opcode = OpCode::AddJmpIf,
+		                   .mode = OperandMode::Immediate,
+		                   .a = first.a,
+		                   .immediate = jump.immediate,
+		                   .small = static_cast<int8_t>(step)};
+	}
+	if (!is_comparison(first.opcode)) {
+		return std::nullopt;
+	}
+	auto base = whenSet ? OpCode::EqJmpIf : OpCode::EqJmpIfNot;
+	auto offset = static_cast<uint8_t>(first.opcode) -
+	              static_cast<uint8_t>(OpCode::Eq);
+	Instruction fused{
+	    .opcode = static_cast<OpCode>(static_cast<uint8_t>(base) + offset),
+	    .mode = first.mode,
+	    .a = first.a,
+	    .b = first.b,
+	    .c = first.c,
+	    .immediate = jump.immediate};
+	if (first.mode == OperandMode::Immediate) {
+		if (!fits_short(first.immediate)) {
+			return std::nullopt;
+		}
+		fused.small = static_cast<int8_t>(first.immediate);
+	}
+	return fused;
+}
+
+// replaces the sequences only entered at their first instruction by the
+// superinstruction doing the same
+void fuse(Program &program, std::vector<Instruction> &code) {
+	auto targets = find_targets(program, code);
+	std::vector<bool> removed(code.size(), false);
+	auto fallsThrough = [&](size_t first, size_t count) {
+		if (first + count >= code.size()) {
+			return false;
+		}
+		for (size_t i = first + 1; i <= first + count; i++) {
+			if (targets[i]) {
+				return false;
+			}
+		}
+		return true;
+	};
+	for (size_t i = 0; i < code.size(); i++) {
+		if (fallsThrough(i, 2)) {
+			if (auto fused = fuse_update(code[i], code[i + 1], code[i + 2])) {
+				code[i] = *fused;
+				removed[i + 1] = removed[i + 2] = true;
+				i += 2;
+				continue;
+			}
+		}
+		if (fallsThrough(i, 1)) {
+			if (auto fused = fuse_branch(code[i], code[i + 1])) {
+				code[i] = *fused;
+				removed[i + 1] = true;
+				i += 1;
+			}
+		}
+	}
+	compact(program, code, removed);
+}
+
+} // namespace
+
+Program optimize(Program program) {
+	std::vector<Instruction> code;
+	code.reserve(program.code.size());
+	for (auto word : program.code) {
+		code.push_back(Instruction::decode(word));
+	}
+
+	fold_constants(program, code);
+
+	// tags are kept for the disassembly of the instructions still reached
+	auto targets = find_targets(program, code);
+	std::erase_if(program.tags, [&](const Tag &tag) {
+		return tag.instruction >= code.size() || !targets[tag.instruction];
+	});
+
+	fuse(program, code);
+
+	program.code.clear();
+	for (const auto &instruction : code) {
+		program.code.push_back(instruction.encode());
+	}
+	return program;
+}
+
+} // namespace ray::vm
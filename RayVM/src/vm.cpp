@@ -1,3 +1,529 @@
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
 #include <ray/vm/vm.hpp>
 
-namespace ray::vm {}
+namespace ray::vm {
+
+namespace {
+
+// every handler of the dispatch loop, arithmetic, comparisons and the fused
+// instructions have a register (R) and an immediate (I) form in the order of
+// their opcodes.
+// jumps back to an earlier instruction have their own handlers counting loop
+// iterations for the JIT
+#define RAYVM_HANDLERS(X)                                                      \
+	X(AddR)                                                                    \
+	X(AddI)                                                                    \
+	X(SubR)                                                                    \
+	X(SubI)                                                                    \
+	X(MulR)                                                                    \
+	X(MulI)                                                                    \
+	X(DivR)                                                                    \
+	X(DivI)                                                                    \
+	X(ModR)                                                                    \
+	X(ModI)                                                                    \
+	X(EqR)                                                                     \
+	X(EqI)                                                                     \
+	X(NeqR)                                                                    \
+	X(NeqI)                                                                    \
+	X(LtR)                                                                     \
+	X(LtI)                                                                     \
+	X(LteR)                                                                    \
+	X(LteI)                                                                    \
+	X(GtR)                                                                     \
+	X(GtI)                                                                     \
+	X(GteR)                                                                    \
+	X(GteI)                                                                    \
+	X(AndR)                                                                    \
+	X(AndI)                                                                    \
+	X(OrR)                                                                     \
+	X(OrI)                                                                     \
+	X(Not)                                                                     \
+	X(Jmp)                                                                     \
+	X(JmpIf)                                                                   \
+	X(JmpIfNot)                                                                \
+	X(JmpBack)                                                                 \
+	X(JmpIfBack)                                                               \
+	X(JmpIfNotBack)                                                            \
+	X(Call)                                                                    \
+	X(Ret)                                                                     \
+	X(LoadI)                                                                   \
+	X(LoadR)                                                                   \
+	X(LoadM)                                                                   \
+	X(Store)                                                                   \
+	X(Nop)                                                                     \
+	X(Halt)                                                                    \
+	X(EqJmpIfR)                                                                \
+	X(EqJmpIfI)                                                                \
+	X(NeqJmpIfR)                                                               \
+	X(NeqJmpIfI)                                                               \
+	X(LtJmpIfR)                                                                \
+	X(LtJmpIfI)                                                                \
+	X(LteJmpIfR)                                                               \
+	X(LteJmpIfI)                                                               \
+	X(GtJmpIfR)                                                                \
+	X(GtJmpIfI)                                                                \
+	X(GteJmpIfR)                                                               \
+	X(GteJmpIfI)                                                               \
+	X(EqJmpIfNotR)                                                             \
+	X(EqJmpIfNotI)                                                             \
+	X(NeqJmpIfNotR)                                                            \
+	X(NeqJmpIfNotI)                                                            \
+	X(LtJmpIfNotR)                                                             \
+	X(LtJmpIfNotI)                                                             \
+	X(LteJmpIfNotR)                                                            \
+	X(LteJmpIfNotI)                                                            \
+	X(GtJmpIfNotR)                                                             \
+	X(GtJmpIfNotI)                                                             \
+	X(GteJmpIfNotR)                                                            \
+	X(GteJmpIfNotI)                                                            \
+	X(LoadAddStoreR)                                                           \
+	X(LoadAddStoreI)                                                           \
+	X(LoadSubStoreR)                                                           \
+	X(LoadSubStoreI)                                                           \
+	X(AddJmpIf)
+
+#define RAYVM_HANDLER_ENUM(name) name,
+enum class Handler : uint8_t { RAYVM_HANDLERS(RAYVM_HANDLER_ENUM) };
+#undef RAYVM_HANDLER_ENUM
+
+Handler handler_for(const Instruction &instruction, std::size_t index) {
+	bool immediate = instruction.mode == OperandMode::Immediate;
+	bool back = static_cast<std::size_t>(instruction.immediate) <= index;
+	switch (instruction.opcode) {
+	case OpCode::Not:
+		return Handler::Not;
+	case OpCode::Beq:
+		return back ? Handler::JmpBack : Handler::Jmp;
+	case OpCode::JmpIf:
+		return back ? Handler::JmpIfBack : Handler::JmpIf;
+	case OpCode::JmpIfNot:
+		return back ? Handler::JmpIfNotBack : Handler::JmpIfNot;
+	case OpCode::Call:
+		return Handler::Call;
+	case OpCode::Ret:
+		return Handler::Ret;
+	case OpCode::Load:
+		if (instruction.mode == OperandMode::Memory) {
+			return Handler::LoadM;
+		}
+		return instruction.mode == OperandMode::Register ? Handler::LoadR
+		                                                 : Handler::LoadI;
+	case OpCode::Store:
+		return Handler::Store;
+	case OpCode::Nop:
+		return Handler::Nop;
+	case OpCode::Halt:
+	case OpCode::INVALID:
+		return Handler::Halt;
+	case OpCode::AddJmpIf:
+		return Handler::AddJmpIf;
+	default:
+		if (instruction.opcode >= OpCode::EqJmpIf) {
+			auto fused = static_cast<uint8_t>(instruction.opcode) -
+			             static_cast<uint8_t>(OpCode::EqJmpIf);
+			return static_cast<Handler>(
+			    static_cast<uint8_t>(Handler::EqJmpIfR) + fused * 2 +
+			    immediate);
+		}
+		// the binary operations come first in both enums
+		auto registerForm = static_cast<uint8_t>(instruction.opcode) * 2;
+		return static_cast<Handler>(registerForm + immediate);
+	}
+}
+
+// signed division traps instead of being undefined
+bool divisible(int64_t dividend, int64_t divisor) {
+	return divisor != 0 && !(dividend == std::numeric_limits<int64_t>::min() &&
+	                         divisor == -1);
+}
+
+} // namespace
+
+VM::VM(std::size_t memory_size) : memory(memory_size) {}
+
+void VM::load_program(const std::vector<std::byte> &bytes) {
+	auto result = Program::deserialize(std::span(bytes));
+	if (auto *failures = std::get_if<std::vector<std::string>>(&result)) {
+		cpu = CPUCore{};
+		errors = std::move(*failures);
+		program = Program{};
+		operations.clear();
+		cpu.inv_inst_f = true;
+		return;
+	}
+	load_program(std::move(std::get<Program>(result)));
+}
+
+void VM::load_program(Program loaded) {
+	cpu = CPUCore{};
+	errors = loaded.verify();
+	program = std::move(loaded);
+	operations.clear();
+	if (!errors.empty()) {
+		program = Program{};
+		cpu.inv_inst_f = true;
+#ifdef RAYVM_JIT
+		jit.clear();
+#endif
+		return;
+	}
+	decode();
+#ifdef RAYVM_JIT
+	if (compiling) {
+		jit.reset(program);
+	} else {
+		jit.clear();
+	}
+#endif
+	stackBase = memory.size() & ~uint64_t{7};
+	cpu.sp = stackBase;
+	cpu.pc = program.entry;
+	executed = 0;
+	nativeExecuted = 0;
+}
+
+void VM::decode() {
+	operations.clear();
+	operations.reserve(program.code.size() + 1);
+	for (std::size_t i = 0; i < program.code.size(); i++) {
+		auto instruction = Instruction::decode(program.code[i]);
+		Operation operation{
+		    .handler = static_cast<uint8_t>(handler_for(instruction, i)),
+		    .a = instruction.a,
+		    .b = instruction.b,
+		    .c = instruction.c,
+		    .operand = instruction.small,
+		    .immediate = instruction.immediate};
+		// constants are read once here instead of on every load
+		if (instruction.mode == OperandMode::Constant) {
+			operation.immediate =
+			    static_cast<int64_t>(program.constants[instruction.immediate]);
+		}
+		operations.push_back(operation);
+	}
+	operations.push_back(
+	    {.handler = static_cast<uint8_t>(Handler::Halt)});
+	threaded = false;
+}
+
+// the handlers are written once, as labels jumped to through the address
+// stored in every operation or as the cases of a switch jumped back to
+#ifdef RAYVM_THREADED_DISPATCH
+#define HANDLER(name) handle_##name:
+#define DISPATCH()                                                             \
+	do {                                                                       \
+		++count;                                                               \
+		goto *op->label;                                                       \
+	} while (false)
+#else
+#define HANDLER(name) case Handler::name:
+#define DISPATCH() goto dispatch
+#endif
+#define NEXT()                                                                 \
+	do {                                                                       \
+		++op;                                                                  \
+		DISPATCH();                                                            \
+	} while (false)
+// continues in native code once the function of the instruction jumped to is
+// compiled
+#ifdef RAYVM_JIT
+#define ENTER(lookup)                                                          \
+	do {                                                                       \
+		if ((native = (lookup)) != nullptr) {                                  \
+			goto enter;                                                        \
+		}                                                                      \
+	} while (false)
+#else
+#define ENTER(lookup)                                                          \
+	do {                                                                       \
+	} while (false)
+#endif
+#define TRAP(flag)                                                             \
+	do {                                                                       \
+		cpu.flag = true;                                                       \
+		goto stop;                                                             \
+	} while (false)
+
+#define BINARY(name, expression)                                               \
+	HANDLER(name##R) {                                                         \
+		uint64_t lhs = gpr[op->b].qword;                                       \
+		uint64_t rhs = gpr[op->c].qword;                                       \
+		gpr[op->a].qword = (expression);                                       \
+		NEXT();                                                                \
+	}                                                                          \
+	HANDLER(name##I) {                                                         \
+		uint64_t lhs = gpr[op->b].qword;                                       \
+		uint64_t rhs = static_cast<uint64_t>(op->immediate);                   \
+		gpr[op->a].qword = (expression);                                       \
+		NEXT();                                                                \
+	}
+#define DIVISION(name, operator)                                               \
+	HANDLER(name##R) {                                                         \
+		auto lhs = static_cast<int64_t>(gpr[op->b].qword);                     \
+		auto rhs = static_cast<int64_t>(gpr[op->c].qword);                     \
+		if (!divisible(lhs, rhs)) {                                            \
+			TRAP(of);                                                          \
+		}                                                                      \
+		gpr[op->a].qword = static_cast<uint64_t>(lhs operator rhs);            \
+		NEXT();                                                                \
+	}                                                                          \
+	HANDLER(name##I) {                                                         \
+		auto lhs = static_cast<int64_t>(gpr[op->b].qword);                     \
+		if (!divisible(lhs, op->immediate)) {                                  \
+			TRAP(of);                                                          \
+		}                                                                      \
+		gpr[op->a].qword = static_cast<uint64_t>(lhs operator op->immediate);  \
+		NEXT();                                                                \
+	}
+#define COMPARISON(name, operator)                                             \
+	BINARY(name, static_cast<uint64_t>(static_cast<int64_t>(lhs)               \
+	                                       operator static_cast<int64_t>(rhs)))
+
+// fused jumps count loop iterations for the JIT when they jump back
+#define JUMP(target)                                                           \
+	do {                                                                       \
+		int64_t destination = (target);                                        \
+		if (destination <= op - base) {                                        \
+			ENTER(jit.hot(destination));                                       \
+		}                                                                      \
+		op = base + destination;                                               \
+		DISPATCH();                                                            \
+	} while (false)
+#define COMPARE_JUMP(name, operator, rhs, when)                                \
+	HANDLER(name) {                                                            \
+		bool result = static_cast<int64_t>(gpr[op->b].qword)                   \
+		    operator static_cast<int64_t>(rhs);                                \
+		gpr[op->a].qword = result;                                             \
+		if (result != (when)) {                                                \
+			NEXT();                                                            \
+		}                                                                      \
+		JUMP(op->immediate);                                                   \
+	}
+#define COMPARE_JUMPS(name, operator)                                          \
+	COMPARE_JUMP(name##JmpIfR, operator, gpr[op->c].qword, true)               \
+	COMPARE_JUMP(name##JmpIfI, operator, op->operand, true)                    \
+	COMPARE_JUMP(name##JmpIfNotR, operator, gpr[op->c].qword, false)           \
+	COMPARE_JUMP(name##JmpIfNotI, operator, op->operand, false)
+// the store cannot fail once the load from the same address succeeded
+#define UPDATE(name, operator, rhs)                                            \
+	HANDLER(name) {                                                            \
+		uint64_t address =                                                     \
+		    gpr[op->b].qword + static_cast<uint64_t>(op->immediate);           \
+		uint64_t value;                                                        \
+		if (!memory.load(address, value)) {                                    \
+			TRAP(inv_addr_f);                                                  \
+		}                                                                      \
+		value = value operator static_cast<uint64_t>(rhs);                     \
+		gpr[op->a].qword = value;                                              \
+		memory.storeUnchecked(address, value);                                 \
+		NEXT();                                                                \
+	}
+#define UPDATES(name, operator)                                                \
+	UPDATE(name##R, operator, gpr[op->c].qword)                                \
+	UPDATE(name##I, operator, op->operand)
+
+void VM::run() {
+	if (operations.empty() || cpu.inv_inst_f) {
+		return;
+	}
+	if (cpu.pc >= operations.size()) {
+		cpu.inv_addr_f = true;
+		return;
+	}
+
+	auto &gpr = cpu.gpr;
+	const Operation *base = operations.data();
+	const Operation *op = base + cpu.pc;
+	uint64_t count = 0;
+#ifdef RAYVM_JIT
+	const void *native = nullptr;
+#endif
+
+#ifdef RAYVM_THREADED_DISPATCH
+#define RAYVM_HANDLER_LABEL(name) &&handle_##name,
+	static const void *const labels[] = {
+	    RAYVM_HANDLERS(RAYVM_HANDLER_LABEL)};
+#undef RAYVM_HANDLER_LABEL
+	if (!threaded) {
+		for (auto &operation : operations) {
+			operation.label = labels[operation.handler];
+		}
+		threaded = true;
+	}
+	DISPATCH();
+#else
+dispatch:
+	++count;
+	switch (static_cast<Handler>(op->handler)) {
+#endif
+
+	BINARY(Add, lhs + rhs)
+	BINARY(Sub, lhs - rhs)
+	BINARY(Mul, lhs * rhs)
+	// dividing by zero or overflowing traps with the overflow flag
+	DIVISION(Div, /)
+	DIVISION(Mod, %)
+	COMPARISON(Eq, ==)
+	COMPARISON(Neq, !=)
+	COMPARISON(Lt, <)
+	COMPARISON(Lte, <=)
+	COMPARISON(Gt, >)
+	COMPARISON(Gte, >=)
+	BINARY(And, lhs & rhs)
+	BINARY(Or, lhs | rhs)
+	HANDLER(Not) {
+		gpr[op->a].qword = gpr[op->c].qword == 0;
+		NEXT();
+	}
+
+	HANDLER(Jmp) {
+		op = base + op->immediate;
+		DISPATCH();
+	}
+	HANDLER(JmpIf) {
+		op = gpr[op->a].qword != 0 ? base + op->immediate : op + 1;
+		DISPATCH();
+	}
+	HANDLER(JmpIfNot) {
+		op = gpr[op->a].qword == 0 ? base + op->immediate : op + 1;
+		DISPATCH();
+	}
+	HANDLER(JmpBack) {
+		ENTER(jit.hot(op->immediate));
+		op = base + op->immediate;
+		DISPATCH();
+	}
+	HANDLER(JmpIfBack) {
+		if (gpr[op->a].qword == 0) {
+			NEXT();
+		}
+		ENTER(jit.hot(op->immediate));
+		op = base + op->immediate;
+		DISPATCH();
+	}
+	HANDLER(JmpIfNotBack) {
+		if (gpr[op->a].qword != 0) {
+			NEXT();
+		}
+		ENTER(jit.hot(op->immediate));
+		op = base + op->immediate;
+		DISPATCH();
+	}
+	// the caller's return address is pushed and ra holds the new one
+	HANDLER(Call) {
+		// an empty stack wraps around and fails the store as well
+		uint64_t slot = cpu.sp - sizeof(uint64_t);
+		if (!memory.store(slot, cpu.ra)) {
+			TRAP(inv_addr_f);
+		}
+		cpu.sp = slot;
+		cpu.ra = static_cast<uint64_t>(op - base) + 1;
+		ENTER(jit.hot(op->immediate));
+		op = base + op->immediate;
+		DISPATCH();
+	}
+	HANDLER(Ret) {
+		// returning from the entry ends the program
+		if (cpu.sp >= stackBase) {
+			goto stop;
+		}
+		uint64_t target = cpu.ra;
+		if (target >= operations.size() || !memory.load(cpu.sp, cpu.ra)) {
+			TRAP(inv_addr_f);
+		}
+		cpu.sp += sizeof(uint64_t);
+		ENTER(jit.entry(target));
+		op = base + target;
+		DISPATCH();
+	}
+
+	HANDLER(LoadI) {
+		gpr[op->a].qword = static_cast<uint64_t>(op->immediate);
+		NEXT();
+	}
+	HANDLER(LoadR) {
+		gpr[op->a].qword = gpr[op->c].qword;
+		NEXT();
+	}
+	HANDLER(LoadM) {
+		uint64_t address =
+		    gpr[op->b].qword + static_cast<uint64_t>(op->immediate);
+		if (!memory.load(address, gpr[op->a].qword)) {
+			TRAP(inv_addr_f);
+		}
+		NEXT();
+	}
+	HANDLER(Store) {
+		uint64_t address =
+		    gpr[op->b].qword + static_cast<uint64_t>(op->immediate);
+		if (!memory.store(address, gpr[op->a].qword)) {
+			TRAP(inv_addr_f);
+		}
+		NEXT();
+	}
+
+	// the fused instructions do the work of the ones they replace
+	COMPARE_JUMPS(Eq, ==)
+	COMPARE_JUMPS(Neq, !=)
+	COMPARE_JUMPS(Lt, <)
+	COMPARE_JUMPS(Lte, <=)
+	COMPARE_JUMPS(Gt, >)
+	COMPARE_JUMPS(Gte, >=)
+	UPDATES(LoadAddStore, +)
+	UPDATES(LoadSubStore, -)
+	HANDLER(AddJmpIf) {
+		uint64_t value = gpr[op->a].qword + static_cast<uint64_t>(op->operand);
+		gpr[op->a].qword = value;
+		if (value == 0) {
+			NEXT();
+		}
+		JUMP(op->immediate);
+	}
+
+	HANDLER(Nop) { NEXT(); }
+	HANDLER(Halt) { goto stop; }
+
+#ifndef RAYVM_THREADED_DISPATCH
+	}
+#endif
+
+#ifdef RAYVM_JIT
+	// native code returns before the instruction it cannot run, which the
+	// interpreter runs and counts instead
+enter: {
+	uint64_t before = count;
+	op = base + jit.run(native, cpu, memory, stackBase, count);
+	nativeExecuted += count - before;
+	DISPATCH();
+}
+#endif
+
+stop:
+	cpu.pc = static_cast<uint64_t>(op - base);
+	executed += count;
+}
+
+#undef UPDATES
+#undef UPDATE
+#undef COMPARE_JUMPS
+#undef COMPARE_JUMP
+#undef JUMP
+#undef COMPARISON
+#undef DIVISION
+#undef BINARY
+#undef TRAP
+#undef ENTER
+#undef NEXT
+#undef DISPATCH
+#undef HANDLER
+#undef RAYVM_HANDLERS
+
+} // namespace ray::vm
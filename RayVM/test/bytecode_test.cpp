@@ -0,0 +1,231 @@
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <ray/vm/assembler.hpp>
+#include <ray/vm/bytecode.hpp>
+
+namespace {
+
+using Errors = std::vector<std::string>;
+
+// calls, a loop the optimizer fuses, a constant too wide for an immediate
+// and a memory operand, so every section of the file holds something
+constexpr std::string_view source = "main:\n"
+                                    "\tload r1, 10\n"
+                                    "\tload r2, 0x123456789abc\n"
+                                    "\tcall leaf\n"
+                                    "loop:\n"
+                                    "\tadd r0, r0, r1\n"
+                                    "\tsub r1, r1, 1\n"
+                                    "\tjmpif r1, loop\n"
+                                    "\tstore r0, [r6 + 8]\n"
+                                    "\thalt\n"
+                                    "leaf:\n"
+                                    "\tlt r3, r1, 5\n"
+                                    "\tret\n";
+
+std::optional<ray::vm::Program> assemble() {
+	ray::vm::Assembler assembler;
+	auto assembled = assembler.assemble_program(source);
+	if (auto *errors = std::get_if<Errors>(&assembled)) {
+		std::cerr << "test program does not assemble\n";
+		for (const auto &error : *errors) {
+			std::cerr << error << '\n';
+		}
+		return std::nullopt;
+	}
+	return std::get<ray::vm::Program>(std::move(assembled));
+}
+
+void write_u16(std::vector<std::byte> &bytes, size_t offset, uint16_t value) {
+	bytes[offset] = static_cast<std::byte>(value);
+	bytes[offset + 1] = static_cast<std::byte>(value >> 8);
+}
+
+void write_u32(std::vector<std::byte> &bytes, size_t offset, uint32_t value) {
+	for (size_t i = 0; i < sizeof(value); i++) {
+		bytes[offset + i] = static_cast<std::byte>(value >> (i * 8));
+	}
+}
+
+// fails unless deserialize rejects the bytes with an error containing
+// expected
+std::optional<std::string> rejected(std::span<const std::byte> bytes,
+                                    std::string_view expected) {
+	auto result = ray::vm::Program::deserialize(bytes);
+	auto *errors = std::get_if<Errors>(&result);
+	if (errors == nullptr) {
+		return std::format("was accepted, expected '{}'", expected);
+	}
+	for (const auto &error : *errors) {
+		if (error.find(expected) != std::string::npos) {
+			return std::nullopt;
+		}
+	}
+	return std::format("failed with '{}', expected '{}'",
+	                   errors->empty() ? "" : errors->front(), expected);
+}
+
+std::optional<std::string> roundTrip(const ray::vm::Program &program) {
+	if (program.constants.empty() || program.tags.empty()) {
+		return "the test program has no constants or no tags";
+	}
+	auto bytes = program.serialize();
+	auto result = ray::vm::Program::deserialize(bytes);
+	if (auto *errors = std::get_if<Errors>(&result)) {
+		return std::format("was rejected: {}",
+		                   errors->empty() ? "" : errors->front());
+	}
+	const auto &loaded = std::get<ray::vm::Program>(result);
+	if (loaded.entry != program.entry) {
+		return std::format("entry is {} instead of {}", loaded.entry,
+		                   program.entry);
+	}
+	if (loaded.code != program.code) {
+		return "code differs";
+	}
+	if (loaded.constants != program.constants) {
+		return "constants differ";
+	}
+	if (loaded.tags.size() != program.tags.size()) {
+		return std::format("{} tags instead of {}", loaded.tags.size(),
+		                   program.tags.size());
+	}
+	for (size_t i = 0; i < program.tags.size(); i++) {
+		if (loaded.tags[i].name != program.tags[i].name ||
+		    loaded.tags[i].instruction != program.tags[i].instruction) {
+			return std::format("tag {} differs", i);
+		}
+	}
+	if (loaded.serialize() != bytes) {
+		return "serializes to different bytes";
+	}
+	return std::nullopt;
+}
+
+// every prefix of a valid file is missing part of a section
+std::optional<std::string> truncated(const ray::vm::Program &program) {
+	auto bytes = program.serialize();
+	for (size_t size = 0; size < bytes.size(); size++) {
+		auto expected = size < ray::vm::Program::headerSize
+		                    ? "file too small"
+		                    : "program truncated";
+		if (auto error =
+		        rejected(std::span(bytes).first(size), expected)) {
+			return std::format("first {} of {} bytes {}", size, bytes.size(),
+			                   *error);
+		}
+	}
+	return std::nullopt;
+}
+
+std::optional<std::string> badMagic(const ray::vm::Program &program) {
+	auto bytes = program.serialize();
+	for (size_t i = 0; i < ray::vm::Program::magic.size(); i++) {
+		auto corrupted = bytes;
+		corrupted[i] ^= std::byte{0x20};
+		if (auto error = rejected(corrupted, "not a RayVM program")) {
+			return std::format("magic byte {} changed {}", i, *error);
+		}
+	}
+	return std::nullopt;
+}
+
+std::optional<std::string> wrongVersion(const ray::vm::Program &program) {
+	auto bytes = program.serialize();
+	for (uint16_t version :
+	     {uint16_t(0), uint16_t(ray::vm::Program::version - 1),
+	      uint16_t(ray::vm::Program::version + 1)}) {
+		auto corrupted = bytes;
+		write_u16(corrupted, 4, version);
+		if (auto error = rejected(corrupted, "unsupported program version")) {
+			return std::format("version {} {}", version, *error);
+		}
+	}
+	return std::nullopt;
+}
+
+// retargets every branch past both ends of the code, both in the file and
+// in a program that was never serialized
+std::optional<std::string> badBranchTarget(const ray::vm::Program &program) {
+	auto bytes = program.serialize();
+	size_t branches = 0;
+	for (size_t i = 0; i < program.code.size(); i++) {
+		auto instruction = ray::vm::Instruction::decode(program.code[i]);
+		if (!ray::vm::is_branch(instruction.opcode)) {
+			continue;
+		}
+		branches++;
+		auto codeSize = static_cast<int32_t>(program.code.size());
+		for (int32_t target : {-1, codeSize, codeSize + 1000}) {
+			auto corrupted = bytes;
+			// the immediate is the upper half of the instruction word
+			write_u32(corrupted, ray::vm::Program::headerSize + i * 8 + 4,
+			          static_cast<uint32_t>(target));
+			if (auto error = rejected(corrupted, "out of the program")) {
+				return std::format("instruction {} jumping to {} {}", i,
+				                   target, *error);
+			}
+			auto patched = program;
+			instruction.immediate = target;
+			patched.code[i] = instruction.encode();
+			if (patched.verify().empty()) {
+				return std::format("instruction {} jumping to {} verifies",
+				                   i, target);
+			}
+		}
+	}
+	if (branches == 0) {
+		return "the test program has no branch";
+	}
+	return std::nullopt;
+}
+
+} // namespace
+
+// serializes an assembled program and loads it back unchanged, then checks
+// that deserialize rejects every truncation of the file, a wrong magic, any
+// other version and branches out of the code
+int main() {
+	auto program = assemble();
+	if (!program) {
+		return 1;
+	}
+	struct Case {
+		std::string_view name;
+		std::function<std::optional<std::string>(const ray::vm::Program &)>
+		    check;
+	};
+	const Case cases[] = {
+	    {"round trip", roundTrip},
+	    {"truncated", truncated},
+	    {"bad magic", badMagic},
+	    {"wrong version", wrongVersion},
+	    {"bad branch target", badBranchTarget},
+	};
+
+	int failed = 0;
+	for (const auto &test : cases) {
+		if (auto error = test.check(*program)) {
+			std::cerr << std::format("{}: {}\n", test.name, *error);
+			failed++;
+			continue;
+		}
+		std::cout << std::format("{}: ok\n", test.name);
+	}
+	if (failed != 0) {
+		std::cerr << std::format("{} of {} checks failed\n", failed,
+		                         std::size(cases));
+		return 1;
+	}
+	return 0;
+}
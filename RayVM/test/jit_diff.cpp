@@ -0,0 +1,409 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <ray/vm/assembler.hpp>
+#include <ray/vm/bytecode.hpp>
+#include <ray/vm/cpu.hpp>
+#include <ray/vm/vm.hpp>
+
+namespace {
+
+// large enough for a recursion to get hot before it runs out of stack
+constexpr std::size_t memorySize = 64 * 1024;
+
+// how a program has to stop, checked on the interpreter so a program that
+// no longer reaches its bail out fails instead of comparing nothing
+enum class Stop { Halt, Overflow, InvalidAddress };
+
+struct Case {
+	std::string name;
+	std::string source;
+	Stop stop = Stop::Halt;
+};
+
+// main counts r1 down from 3000, well past the point its loop is compiled,
+// running the body on every iteration. r6 stays 0 as a memory base
+std::string hotLoop(std::string_view setup, std::string_view body) {
+	return std::format("main:\n"
+	                   "\tload r1, 3000\n"
+	                   "{}"
+	                   "loop:\n"
+	                   "{}"
+	                   "\tsub r1, r1, 1\n"
+	                   "\tjmpif r1, loop\n"
+	                   "\thalt\n",
+	                   setup, body);
+}
+
+// a template per opcode, with the register and the immediate forms and
+// registers past r7 that the JIT does not keep in host registers
+std::vector<Case> templateCases() {
+	std::vector<Case> cases = {
+	    {"add", hotLoop("\tload r9, 3\n", "\tadd r2, r2, r1\n"
+	                                      "\tadd r9, r9, 3\n"
+	                                      "\tadd r3, r2, -7\n"
+	                                      "\tadd r10, r9, r3\n")},
+	    {"sub", hotLoop("", "\tsub r2, r2, r1\n"
+	                        "\tsub r10, r10, 11\n"
+	                        "\tsub r3, r10, r2\n")},
+	    {"mul", hotLoop("\tload r3, 1\n", "\tmul r2, r1, r1\n"
+	                                      "\tmul r3, r3, 3\n"
+	                                      "\tadd r3, r3, 1\n"
+	                                      "\tmul r11, r2, -5\n"
+	                                      "\tmul r12, r11, r3\n")},
+	    {"div", hotLoop("\tload r9, 1000000\n"
+	                    "\tload r10, -123456\n",
+	                    "\tdiv r2, r1, 3\n"
+	                    "\tdiv r3, r9, r1\n"
+	                    "\tdiv r4, r10, r1\n"
+	                    "\tdiv r11, r10, -7\n"
+	                    "\tadd r0, r0, r4\n")},
+	    {"mod", hotLoop("\tload r9, 1000000\n"
+	                    "\tload r10, -123456\n",
+	                    "\tmod r2, r1, 3\n"
+	                    "\tmod r3, r9, r1\n"
+	                    "\tmod r4, r10, r1\n"
+	                    "\tmod r11, r10, -7\n"
+	                    "\tadd r0, r0, r4\n")},
+	    {"and", hotLoop("\tload r9, 0x3c3\n", "\tand r2, r1, 0x55\n"
+	                                          "\tand r10, r1, r9\n"
+	                                          "\tadd r0, r0, r10\n")},
+	    {"or", hotLoop("\tload r9, 0x3c3\n", "\tor r2, r1, 0x55\n"
+	                                         "\tor r10, r1, r9\n"
+	                                         "\tadd r0, r0, r10\n")},
+	    {"not", hotLoop("", "\tand r3, r1, 1\n"
+	                        "\tnot r2, r3\n"
+	                        "\tnot r10, r2\n"
+	                        "\tadd r0, r0, r10\n")},
+	    {"jmp", hotLoop("", "\tjmp over\n"
+	                        "\tadd r0, r0, 100\n"
+	                        "over:\n"
+	                        "\tadd r0, r0, 1\n")},
+	    {"jmpif", hotLoop("", "\tand r2, r1, 3\n"
+	                          "\tjmpif r2, skip\n"
+	                          "\tadd r0, r0, 5\n"
+	                          "skip:\n"
+	                          "\tadd r0, r0, 1\n")},
+	    {"jmpifnot", hotLoop("", "\tand r10, r1, 3\n"
+	                             "\tjmpifnot r10, skip\n"
+	                             "\tadd r0, r0, 5\n"
+	                             "skip:\n"
+	                             "\tadd r0, r0, 1\n")},
+	    {"call and ret", "main:\n"
+	                     "\tload r1, 3000\n"
+	                     "loop:\n"
+	                     "\tcall outer\n"
+	                     "\tsub r1, r1, 1\n"
+	                     "\tjmpif r1, loop\n"
+	                     "\thalt\n"
+	                     "outer:\n"
+	                     "\tcall inner\n"
+	                     "\tadd r3, r3, r2\n"
+	                     "\tcall inner\n"
+	                     "\tret\n"
+	                     "inner:\n"
+	                     "\tadd r2, r2, r1\n"
+	                     "\tret\n"},
+	    {"load", hotLoop("\tload r9, 77\n"
+	                     "\tstore r9, [r6 + 64]\n",
+	                     "\tload r2, r1\n"
+	                     "\tload r3, -77\n"
+	                     "\tload r4, 0x123456789abc\n"
+	                     "\tload r5, [r6 + 64]\n"
+	                     "\tload r10, [r1 + 3]\n"
+	                     "\tadd r0, r2, r5\n"
+	                     "\tadd r0, r0, r10\n")},
+	    {"store", hotLoop("", "\tstore r1, [r6 + 64]\n"
+	                          "\tstore r1, [r1 + 101]\n"
+	                          "\tadd r10, r10, r1\n"
+	                          "\tstore r10, [r1 + 8000]\n")},
+	    {"nop", hotLoop("", "\tnop\n"
+	                        "\tadd r0, r0, 1\n")},
+	    {"load.add.store", hotLoop("\tload r9, 5\n",
+	                               "\tload.add.store r2, [r6 + 8], 5\n"
+	                               "\tload.add.store r10, [r1 + 16], r9\n"
+	                               "\tload.add.store r3, [r6 + 24], r1\n")},
+	    {"load.sub.store", hotLoop("\tload r9, 5\n",
+	                               "\tload.sub.store r2, [r6 + 8], 5\n"
+	                               "\tload.sub.store r10, [r1 + 16], r9\n"
+	                               "\tload.sub.store r3, [r6 + 24], r1\n")},
+	    {"add.jmpif", "main:\n"
+	                  "\tload r1, 3000\n"
+	                  "loop:\n"
+	                  "\tadd r2, r2, r1\n"
+	                  "\tadd.jmpif r1, -1, loop\n"
+	                  "\tload r10, -3\n"
+	                  "back:\n"
+	                  "\tadd r11, r11, 1\n"
+	                  "\tadd.jmpif r10, 1, back\n"
+	                  "\thalt\n"},
+	};
+
+	// r4 walks from 1500 down to -1500 across the signed comparisons
+	for (std::string_view comparison :
+	     {"eq", "neq", "lt", "lte", "gt", "gte"}) {
+		cases.push_back(
+		    {std::string(comparison),
+		     hotLoop("\tload r4, 1500\n"
+		             "\tload r9, -20\n",
+		             std::format("\t{0} r2, r1, 1500\n"
+		                         "\t{0} r3, r4, r9\n"
+		                         "\t{0} r12, r4, -3\n"
+		                         "\tadd r0, r0, r2\n"
+		                         "\tadd r0, r0, r3\n"
+		                         "\tadd r0, r0, r12\n"
+		                         "\tsub r4, r4, 1\n",
+		                         comparison))});
+		for (std::string_view jump : {"jmpif", "jmpifnot"}) {
+			cases.push_back(
+			    {std::format("{}.{}", comparison, jump),
+			     hotLoop("\tload r4, 1500\n"
+			             "\tload r9, -20\n",
+			             std::format("\t{0}.{1} r2, r4, 7, first\n"
+			                         "\tadd r0, r0, 1\n"
+			                         "first:\n"
+			                         "\t{0}.{1} r10, r4, r9, second\n"
+			                         "\tadd r0, r0, 2\n"
+			                         "second:\n"
+			                         "\tsub r4, r4, 1\n",
+			                         comparison, jump))});
+		}
+	}
+	return cases;
+}
+
+// every way native code leaves for the interpreter to trap or stop
+std::vector<Case> bailOutCases() {
+	// r1 reaches 10 long after the loop is compiled, then the body runs the
+	// instruction that has to leave
+	auto late = [](std::string_view setup, std::string_view instruction) {
+		return hotLoop(setup, std::format("\tlt r3, r1, 10\n"
+		                                  "\tjmpifnot r3, fine\n"
+		                                  "{}"
+		                                  "fine:\n"
+		                                  "\tadd r0, r0, r1\n",
+		                                  instruction));
+	};
+	constexpr std::string_view minimum = "\tload r2, 0x8000000000000000\n"
+	                                     "\tload r4, -1\n";
+	return {
+	    {"div by zero register", hotLoop("\tload r2, 100000\n",
+	                                     "\tsub r5, r1, 10\n"
+	                                     "\tdiv r3, r2, r5\n"
+	                                     "\tadd r0, r0, r3\n"),
+	     Stop::Overflow},
+	    {"div by zero immediate", late("", "\tdiv r5, r1, 0\n"),
+	     Stop::Overflow},
+	    {"mod by zero", late("\tload r7, 0\n", "\tmod r5, r1, r7\n"),
+	     Stop::Overflow},
+	    {"INT64_MIN div -1 register", late(minimum, "\tdiv r5, r2, r4\n"),
+	     Stop::Overflow},
+	    {"INT64_MIN div -1 immediate", late(minimum, "\tdiv r5, r2, -1\n"),
+	     Stop::Overflow},
+	    {"INT64_MIN mod -1 register", late(minimum, "\tmod r5, r2, r4\n"),
+	     Stop::Overflow},
+	    {"INT64_MIN mod -1 immediate", late(minimum, "\tmod r5, r2, -1\n"),
+	     Stop::Overflow},
+	    {"out of bounds load", "main:\n"
+	                           "\tload r1, 0\n"
+	                           "loop:\n"
+	                           "\tload r9, [r1 + 0]\n"
+	                           "\tadd r0, r0, r9\n"
+	                           "\tadd r1, r1, 8\n"
+	                           "\tjmp loop\n",
+	     Stop::InvalidAddress},
+	    {"out of bounds store", "main:\n"
+	                            "\tload r1, 0\n"
+	                            "loop:\n"
+	                            "\tstore r1, [r1 + 3]\n"
+	                            "\tadd r1, r1, 8\n"
+	                            "\tjmp loop\n",
+	     Stop::InvalidAddress},
+	    {"out of bounds update", "main:\n"
+	                             "\tload r1, 0\n"
+	                             "loop:\n"
+	                             "\tload.add.store r9, [r1 + 0], 3\n"
+	                             "\tload.sub.store r10, [r1 + 4], r1\n"
+	                             "\tadd r1, r1, 8\n"
+	                             "\tjmp loop\n",
+	     Stop::InvalidAddress},
+	    {"stack overflow", "main:\n"
+	                       "\tload r1, 0\n"
+	                       "recurse:\n"
+	                       "\tadd r1, r1, 1\n"
+	                       "\tcall recurse\n"
+	                       "\tret\n",
+	     Stop::InvalidAddress},
+	    // main loops too few times to be compiled, leaf is called often
+	    // enough and has to return to the interpreted main
+	    {"ret into uncompiled caller", "main:\n"
+	                                   "\tload r1, 900\n"
+	                                   "loop:\n"
+	                                   "\tcall leaf\n"
+	                                   "\tcall leaf\n"
+	                                   "\tsub r1, r1, 1\n"
+	                                   "\tjmpif r1, loop\n"
+	                                   "\thalt\n"
+	                                   "leaf:\n"
+	                                   "\tadd r2, r2, r1\n"
+	                                   "\tret\n"},
+	    {"ret from the entry", "main:\n"
+	                           "\tload r1, 3000\n"
+	                           "loop:\n"
+	                           "\tcall leaf\n"
+	                           "\tsub r1, r1, 1\n"
+	                           "\tjmpif r1, loop\n"
+	                           "\tret\n"
+	                           "leaf:\n"
+	                           "\tadd r2, r2, r1\n"
+	                           "\tret\n"},
+	    {"halt", late("", "\thalt\n")},
+	};
+}
+
+struct State {
+	ray::vm::CPUCore cpu;
+	std::vector<std::byte> memory;
+	uint64_t executed = 0;
+	uint64_t nativeExecuted = 0;
+};
+
+std::optional<State> run(const Case &test, bool jit) {
+	ray::vm::Assembler assembler;
+	// the fused instructions are written out, the optimizer would change
+	// which templates run
+	assembler.set_optimize(false);
+	auto assembled = assembler.assemble_program(test.source);
+	if (auto *errors = std::get_if<std::vector<std::string>>(&assembled)) {
+		std::cerr << std::format("{} does not assemble\n", test.name);
+		for (const auto &error : *errors) {
+			std::cerr << error << '\n';
+		}
+		return std::nullopt;
+	}
+	ray::vm::VM vm(memorySize);
+	vm.set_jit(jit);
+	vm.load_program(std::get<ray::vm::Program>(assembled));
+	vm.run();
+
+	State state{.cpu = vm.get_cpu(),
+	            .memory = std::vector<std::byte>(memorySize),
+	            .executed = vm.get_executed(),
+	            .nativeExecuted = vm.get_native_executed()};
+	std::memcpy(state.memory.data(), vm.get_memory().base(), memorySize);
+	return state;
+}
+
+bool stoppedAs(const ray::vm::CPUCore &cpu, Stop stop) {
+	switch (stop) {
+	case Stop::Halt:
+		return !cpu.of && !cpu.inv_addr_f && !cpu.inv_inst_f;
+	case Stop::Overflow:
+		return cpu.of && !cpu.inv_addr_f && !cpu.inv_inst_f;
+	case Stop::InvalidAddress:
+		return !cpu.of && cpu.inv_addr_f && !cpu.inv_inst_f;
+	}
+	return false;
+}
+
+// the first field the JIT left different from the interpreter
+std::optional<std::string> difference(const State &expected,
+                                      const State &actual) {
+	for (std::size_t i = 0; i < expected.cpu.gpr.size(); i++) {
+		if (expected.cpu.gpr[i].qword != actual.cpu.gpr[i].qword) {
+			return std::format("r{} is {} instead of {}", i,
+			                   actual.cpu.gpr[i].qword,
+			                   expected.cpu.gpr[i].qword);
+		}
+	}
+	auto field = [](std::string_view name, uint64_t expectedValue,
+	                uint64_t actualValue) -> std::optional<std::string> {
+		if (expectedValue == actualValue) {
+			return std::nullopt;
+		}
+		return std::format("{} is {} instead of {}", name, actualValue,
+		                   expectedValue);
+	};
+	const auto &e = expected.cpu;
+	const auto &a = actual.cpu;
+	for (auto mismatch :
+	     {field("sp", e.sp, a.sp), field("pc", e.pc, a.pc),
+	      field("ra", e.ra, a.ra), field("zf", e.zf, a.zf),
+	      field("of", e.of, a.of), field("inv_addr_f", e.inv_addr_f,
+	                                     a.inv_addr_f),
+	      field("inv_inst_f", e.inv_inst_f, a.inv_inst_f),
+	      field("executed", expected.executed, actual.executed)}) {
+		if (mismatch) {
+			return mismatch;
+		}
+	}
+	for (std::size_t i = 0; i < expected.memory.size(); i++) {
+		if (expected.memory[i] != actual.memory[i]) {
+			return std::format("memory byte {} is {} instead of {}", i,
+			                   static_cast<unsigned>(actual.memory[i]),
+			                   static_cast<unsigned>(expected.memory[i]));
+		}
+	}
+	return std::nullopt;
+}
+
+} // namespace
+
+// runs a program per JIT template and per way its code leaves for the
+// interpreter, once interpreted and once with the JIT, and fails on the first
+// register, flag, stack pointer, program counter, memory byte or instruction
+// count they end with differently. every program has to get hot enough to
+// run native code, and to stop the way it was written to
+int main() {
+	auto cases = templateCases();
+	for (auto &bailOut : bailOutCases()) {
+		cases.push_back(std::move(bailOut));
+	}
+
+	int failed = 0;
+	for (const auto &test : cases) {
+		auto interpreted = run(test, false);
+		auto compiled = run(test, true);
+		if (!interpreted || !compiled) {
+			return 1;
+		}
+		std::optional<std::string> error;
+		if (!stoppedAs(interpreted->cpu, test.stop)) {
+			error = std::format("stopped at instruction {} with of={} "
+			                    "inv_addr_f={} inv_inst_f={}",
+			                    interpreted->cpu.pc, interpreted->cpu.of,
+			                    interpreted->cpu.inv_addr_f,
+			                    interpreted->cpu.inv_inst_f);
+		} else if (interpreted->nativeExecuted != 0) {
+			error = "ran native code with the JIT disabled";
+		} else if (auto mismatch = difference(*interpreted, *compiled)) {
+			error = std::format("differs with the JIT, {}", *mismatch);
+		}
+#ifdef RAYVM_JIT
+		else if (compiled->nativeExecuted == 0) {
+			error = "never ran native code";
+		}
+#endif
+		if (error) {
+			std::cerr << std::format("{}: {}\n", test.name, *error);
+			failed++;
+			continue;
+		}
+		std::cout << std::format("{}: {} instructions, {} native\n", test.name,
+		                         compiled->executed, compiled->nativeExecuted);
+	}
+	if (failed != 0) {
+		std::cerr << std::format("{} of {} programs failed\n", failed,
+		                         cases.size());
+		return 1;
+	}
+	return 0;
+}
@@ -101,6 +101,17 @@ def defineType(baseName: str, clazz: dict[str]):
     else:
         stringList.append(")")
     stringList.append(" {}\n\n")
+
+    # arena aware factory, nodes are constructed in place inside the arena
+    stringList.append(f"\tstatic NodePtr<{clazz["Name"]}> create(Arena& arena")
+    for param in constructorParams:
+        stringList.append(f",\n\t{" " * 8}{param}")
+    stringList.append(") {\n")
+    forwardedArgs = [f"std::move({field["Name"]})" for field in clazz["Fields"]]
+    forwardedArgs.append("std::move(token)")
+    forwardedList = ", ".join(forwardedArgs)
+    stringList.append(f"\t\treturn arena.make<{clazz["Name"]}>({forwardedList});\n")
+    stringList.append("\t}\n\n")
     stringList.append(f"\tvoid visit({baseName}Visitor& visitor) const override {{\n\t\tvisitor.visit{clazz["Name"]}{baseName}(*this);\n\t}}\n\n")
     stringList.append(f"\tconst std::string_view variantName() const override {{ return \"{clazz["Name"]}\"; }}\n\n")
     stringList.append(f"\tconst Token& getToken() const override {{ return token; }};\n")
@@ -123,57 +134,469 @@ def defineVisitor(baseName: str, types: dict):
 
 
 
+def lowerCamel(name: str):
+    return name[0].lower() + name[1:]
+
+
+def flatField(fieldType: str, nodeNames: list[str]):
+    # maps a pointer tree field into its flat encoding, the second value tells
+    # the builder how the field gets lowered
+    if fieldType == "Token":
+        return ("TokenId", "token")
+    if fieldType.startswith("NodePtr<"):
+        return ("NodeId", "node")
+    if fieldType.startswith("std::optional<"):
+        inner = fieldType[len("std::optional<"):-1]
+        if inner.startswith("NodePtr<") or inner in nodeNames:
+            return ("NodeId", "node")
+    if fieldType.startswith("std::vector<"):
+        inner = fieldType[len("std::vector<"):-1]
+        if inner.startswith("NodePtr<") or inner in nodeNames:
+            return ("NodeRange", "range")
+    return (fieldType, "copy")
+
+
+def flatClasses(groups: list):
+    classes = list[dict]()
+    for (baseName, processedClasses) in groups:
+        for clazz in processedClasses:
+            classes.append({
+                "Name": clazz["Name"],
+                "Base": baseName,
+                "Fields": clazz["Fields"]
+            })
+    return classes
+
+
+def defineFlatAst(outputDir: str, definitions: list[str], groups: list):
+    filePath = os.path.join(outputDir, "flat.hpp")
+    classes = flatClasses(groups)
+    nodeNames = [clazz["Name"] for clazz in classes]
+    lastExpression = [clazz for clazz in classes if clazz["Base"] == "Expression"][-1]
+    stringList = list[str]()
+    stringList.append("#pragma once\n")
+    for header in ["cassert", "cstddef", "cstdint", "limits", "span",
+                   "string", "string_view", "type_traits", "unordered_map",
+                   "utility", "vector", "ray/compiler/lexer/token.hpp",
+                   "ray/compiler/ast/intrinsic.hpp"]:
+        stringList.append(f"#include <{header}>\n")
+    stringList.append("\n")
+    stringList.append("namespace ray::compiler::ast::flat {\n\n")
+    for definition in definitions:
+        (name, value) = [x.strip() for x in definition.split("=")]
+        stringList.append(f"using {name} = {value};\n")
+    stringList.append("\n")
+
+    stringList.append("// index of a node inside a Tree, default constructed ids refer to no node\n")
+    stringList.append("struct NodeId {\n")
+    stringList.append("\tstatic constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();\n")
+    stringList.append("\tuint32_t index = invalidIndex;\n\n")
+    stringList.append("\tbool valid() const { return index != invalidIndex; }\n")
+    stringList.append("\texplicit operator bool() const { return valid(); }\n")
+    stringList.append("\tbool operator==(const NodeId& other) const = default;\n")
+    stringList.append("};\n\n")
+    stringList.append("// index of a token inside a Tree\n")
+    stringList.append("using TokenId = uint32_t;\n\n")
+    stringList.append("// children of a node stored back to back inside a Tree\n")
+    stringList.append("struct NodeRange {\n")
+    stringList.append("\tuint32_t first = 0;\n")
+    stringList.append("\tuint32_t count = 0;\n\n")
+    stringList.append("\tsize_t size() const { return count; }\n")
+    stringList.append("\tbool empty() const { return count == 0; }\n")
+    stringList.append("};\n\n")
+
+    stringList.append("enum class NodeKind : uint8_t {\n")
+    for clazz in classes:
+        stringList.append(f"\t{clazz["Name"]},\n")
+    stringList.append("};\n\n")
+    stringList.append("// expression kinds are laid out first\n")
+    stringList.append(f"inline bool isExpression(NodeKind kind) {{ return kind <= NodeKind::{lastExpression["Name"]}; }}\n")
+    stringList.append("inline bool isStatement(NodeKind kind) { return !isExpression(kind); }\n\n")
+
+    # per kind payloads
+    for clazz in classes:
+        stringList.append(f"struct {clazz["Name"]} {{\n")
+        stringList.append(f"\tstatic constexpr NodeKind nodeKind = NodeKind::{clazz["Name"]};\n")
+        stringList.append(f"\tstatic constexpr std::string_view variantName() {{ return \"{clazz["Name"]}\"; }}\n\n")
+        for field in clazz["Fields"]:
+            (flatType, _) = flatField(field["Type"], nodeNames)
+            stringList.append(f"\t{flatType} {field["Name"]};\n")
+        stringList.append("\tTokenId token;\n")
+        stringList.append("};\n\n")
+
+    # tree storage
+    stringList.append("// AST of a compilation unit stored as flat arrays, a node is its kind plus\n")
+    stringList.append("// an index into the payload table of that kind, children are referenced by\n")
+    stringList.append("// NodeId and variable sized children lists are slices of a shared array\n")
+    stringList.append("class Tree {\n")
+    stringList.append("\tstd::vector<NodeKind> kinds;\n")
+    stringList.append("\tstd::vector<uint32_t> payloads;\n")
+    stringList.append("\tstd::vector<NodeId> children;\n")
+    stringList.append("\tstd::vector<Token> tokens;\n")
+    stringList.append("\tNodeRange roots;\n\n")
+    for clazz in classes:
+        stringList.append(f"\tstd::vector<{clazz["Name"]}> {lowerCamel(clazz["Name"])}Nodes;\n")
+    stringList.append("\n  public:\n")
+    stringList.append("\tsize_t size() const { return kinds.size(); }\n")
+    stringList.append("\tsize_t tokenCount() const { return tokens.size(); }\n\n")
+    stringList.append("\tNodeKind kind(NodeId id) const {\n")
+    stringList.append("\t\tassert(id.index < kinds.size());\n")
+    stringList.append("\t\treturn kinds[id.index];\n")
+    stringList.append("\t}\n")
+    stringList.append("\tconst Token& token(TokenId id) const {\n")
+    stringList.append("\t\tassert(id < tokens.size());\n")
+    stringList.append("\t\treturn tokens[id];\n")
+    stringList.append("\t}\n")
+    stringList.append("\tstd::span<const NodeId> range(NodeRange range) const {\n")
+    stringList.append("\t\treturn std::span<const NodeId>(children).subspan(range.first, range.count);\n")
+    stringList.append("\t}\n")
+    stringList.append("\tstd::span<const NodeId> getRoots() const { return range(roots); }\n\n")
+    stringList.append("\ttemplate <typename T> const T& get(NodeId id) const {\n")
+    stringList.append("\t\tassert(kind(id) == T::nodeKind);\n")
+    stringList.append("\t\treturn table(std::type_identity<T>())[payloads[id.index]];\n")
+    stringList.append("\t}\n")
+    stringList.append("\t// returns nullptr when the node is not of the requested kind\n")
+    stringList.append("\ttemplate <typename T> const T* tryGet(NodeId id) const {\n")
+    stringList.append("\t\treturn id && kind(id) == T::nodeKind ? &get<T>(id) : nullptr;\n")
+    stringList.append("\t}\n\n")
+
+    stringList.append("\tconst Token& getToken(NodeId id) const {\n")
+    stringList.append("\t\tswitch (kind(id)) {\n")
+    for clazz in classes:
+        stringList.append(f"\t\tcase NodeKind::{clazz["Name"]}:\n")
+        stringList.append(f"\t\t\treturn token(get<{clazz["Name"]}>(id).token);\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t\tstd::unreachable();\n")
+    stringList.append("\t}\n")
+    stringList.append("\tstd::string_view variantName(NodeId id) const {\n")
+    stringList.append("\t\tswitch (kind(id)) {\n")
+    for clazz in classes:
+        stringList.append(f"\t\tcase NodeKind::{clazz["Name"]}:\n")
+        stringList.append(f"\t\t\treturn {clazz["Name"]}::variantName();\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t\tstd::unreachable();\n")
+    stringList.append("\t}\n\n")
+
+    stringList.append("\t// bytes used by the node storage, excluding unused capacity and memory\n")
+    stringList.append("\t// owned by the payload values\n")
+    stringList.append("\tsize_t getBytesUsed() const {\n")
+    stringList.append("\t\treturn kinds.size() * sizeof(NodeKind) +\n")
+    stringList.append("\t\t       payloads.size() * sizeof(uint32_t) +\n")
+    stringList.append("\t\t       children.size() * sizeof(NodeId) +\n")
+    stringList.append("\t\t       tokens.size() * sizeof(Token)")
+    for clazz in classes:
+        stringList.append(f" +\n\t\t       {lowerCamel(clazz["Name"])}Nodes.size() * sizeof({clazz["Name"]})")
+    stringList.append(";\n")
+    stringList.append("\t}\n\n")
+
+    stringList.append("\ttemplate <typename T> NodeId add(T payload) {\n")
+    stringList.append("\t\tauto& nodes = table(std::type_identity<T>());\n")
+    stringList.append("\t\tassert(kinds.size() < NodeId::invalidIndex);\n")
+    stringList.append("\t\tNodeId id{static_cast<uint32_t>(kinds.size())};\n")
+    stringList.append("\t\tkinds.push_back(T::nodeKind);\n")
+    stringList.append("\t\tpayloads.push_back(static_cast<uint32_t>(nodes.size()));\n")
+    stringList.append("\t\tnodes.push_back(std::move(payload));\n")
+    stringList.append("\t\treturn id;\n")
+    stringList.append("\t}\n")
+    stringList.append("\tTokenId addToken(const Token& token) {\n")
+    stringList.append("\t\ttokens.push_back(token);\n")
+    stringList.append("\t\treturn static_cast<TokenId>(tokens.size() - 1);\n")
+    stringList.append("\t}\n")
+    stringList.append("\tNodeRange addRange(std::span<const NodeId> ids) {\n")
+    stringList.append("\t\tNodeRange range{static_cast<uint32_t>(children.size()),\n")
+    stringList.append("\t\t                static_cast<uint32_t>(ids.size())};\n")
+    stringList.append("\t\tchildren.insert(children.end(), ids.begin(), ids.end());\n")
+    stringList.append("\t\treturn range;\n")
+    stringList.append("\t}\n")
+    stringList.append("\tvoid setRoots(NodeRange range) { roots = range; }\n\n")
+
+    stringList.append("  private:\n")
+    for clazz in classes:
+        tableName = f"{lowerCamel(clazz["Name"])}Nodes"
+        stringList.append(f"\tconst std::vector<{clazz["Name"]}>& table(std::type_identity<{clazz["Name"]}>) const {{ return {tableName}; }}\n")
+        stringList.append(f"\tstd::vector<{clazz["Name"]}>& table(std::type_identity<{clazz["Name"]}>) {{ return {tableName}; }}\n")
+    stringList.append("};\n\n")
+
+    # switch based dispatcher
+    stringList.append("// walks a Tree dispatching on the node kind, Derived implements the same\n")
+    stringList.append("// visit methods as the pointer tree visitors taking the node payloads\n")
+    stringList.append("template <typename Derived> class Visitor {\n")
+    stringList.append("\tconst Tree* currentTree = nullptr;\n\n")
+    stringList.append("  protected:\n")
+    stringList.append("\tvoid bind(const Tree& tree) { currentTree = &tree; }\n")
+    stringList.append("\tconst Tree& tree() const {\n")
+    stringList.append("\t\tassert(currentTree != nullptr);\n")
+    stringList.append("\t\treturn *currentTree;\n")
+    stringList.append("\t}\n")
+    stringList.append("\tconst Token& token(TokenId id) const { return tree().token(id); }\n")
+    stringList.append("\tconst Token& getToken(NodeId id) const { return tree().getToken(id); }\n\n")
+    stringList.append("\tvoid visit(NodeId id) {\n")
+    stringList.append("\t\tDerived& derived = static_cast<Derived&>(*this);\n")
+    stringList.append("\t\tconst Tree& nodes = tree();\n")
+    stringList.append("\t\tswitch (nodes.kind(id)) {\n")
+    for clazz in classes:
+        stringList.append(f"\t\tcase NodeKind::{clazz["Name"]}:\n")
+        stringList.append(f"\t\t\tderived.visit{clazz["Name"]}{clazz["Base"]}(nodes.get<{clazz["Name"]}>(id));\n")
+        stringList.append("\t\t\tbreak;\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t}\n")
+    stringList.append("};\n\n")
+    stringList.append("} // namespace ray::compiler::ast::flat\n")
+
+    with open(filePath, "w") as headerFile:
+        headerFile.write("".join(stringList))
+
+
+def defineFlatBuilder(outputDir: str, groups: list):
+    filePath = os.path.join(outputDir, "flatBuilder.hpp")
+    classes = flatClasses(groups)
+    nodeNames = [clazz["Name"] for clazz in classes]
+    stringList = list[str]()
+    stringList.append("#pragma once\n")
+    for header in ["optional", "vector", "ray/compiler/ast/expression.hpp",
+                   "ray/compiler/ast/flat.hpp",
+                   "ray/compiler/ast/statement.hpp",
+                   "ray/util/counters.hpp"]:
+        stringList.append(f"#include <{header}>\n")
+    stringList.append("\n")
+    stringList.append("namespace ray::compiler::ast::flat {\n\n")
+    stringList.append("// lowers a pointer tree into a Tree, children are stored before their parent\n")
+    stringList.append("class Builder : public ast::ExpressionVisitor, public ast::StatementVisitor {\n")
+    stringList.append("\tTree tree;\n")
+    stringList.append("\tNodeId lastNode;\n\n")
+    stringList.append("  public:\n")
+    stringList.append("\tTree build(const std::vector<NodePtr<ast::Statement>>& statements) {\n")
+    stringList.append("\t\ttree = Tree();\n")
+    stringList.append("\t\tNodeRange roots = lowerRange(statements);\n")
+    stringList.append("\t\ttree.setRoots(roots);\n")
+    stringList.append("\t\tutil::threadCounters.astNodes += tree.size();\n")
+    stringList.append("\t\treturn std::move(tree);\n")
+    stringList.append("\t}\n\n")
+    stringList.append("  private:\n")
+    for clazz in classes:
+        stringList.append(f"\tvoid visit{clazz["Name"]}{clazz["Base"]}(const ast::{clazz["Name"]}& node) override {{\n")
+        fields = [(field, flatField(field["Type"], nodeNames)[1]) for field in clazz["Fields"]]
+        # tokens first so the node token is deduplicated against its fields
+        for (field, lowering) in fields:
+            if lowering == "token":
+                stringList.append(f"\t\tTokenId {field["Name"]} = lowerToken(node.{field["Name"]});\n")
+        stringList.append("\t\tTokenId token = lowerToken(node.token);\n")
+        for (field, lowering) in fields:
+            if lowering == "node":
+                stringList.append(f"\t\tNodeId {field["Name"]} = lowerNode(node.{field["Name"]});\n")
+            elif lowering == "range":
+                stringList.append(f"\t\tNodeRange {field["Name"]} = lowerRange(node.{field["Name"]});\n")
+        stringList.append(f"\t\tlastNode = tree.add({clazz["Name"]}{{\n")
+        for (field, lowering) in fields:
+            value = f"node.{field["Name"]}" if lowering == "copy" else field["Name"]
+            stringList.append(f"\t\t    .{field["Name"]} = {value},\n")
+        stringList.append("\t\t    .token = token,\n")
+        stringList.append("\t\t});\n")
+        stringList.append("\t}\n")
+    stringList.append("\n")
+    stringList.append("\tTokenId lowerToken(const Token& token) {\n")
+    stringList.append("\t\t// nodes usually repeat one of their own tokens as location\n")
+    stringList.append("\t\tif (tree.tokenCount() > 0) {\n")
+    stringList.append("\t\t\tTokenId previous = static_cast<TokenId>(tree.tokenCount() - 1);\n")
+    stringList.append("\t\t\tconst Token& last = tree.token(previous);\n")
+    stringList.append("\t\t\tif (last.type == token.type && last.line == token.line &&\n")
+    stringList.append("\t\t\t    last.column == token.column &&\n")
+    stringList.append("\t\t\t    last.lexeme.data() == token.lexeme.data() &&\n")
+    stringList.append("\t\t\t    last.lexeme.size() == token.lexeme.size()) {\n")
+    stringList.append("\t\t\t\treturn previous;\n")
+    stringList.append("\t\t\t}\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t\treturn tree.addToken(token);\n")
+    stringList.append("\t}\n")
+    stringList.append("\ttemplate <typename T> NodeId lowerNode(const T& node) {\n")
+    stringList.append("\t\tnode.visit(*this);\n")
+    stringList.append("\t\treturn lastNode;\n")
+    stringList.append("\t}\n")
+    stringList.append("\ttemplate <typename T> NodeId lowerNode(const NodePtr<T>& node) {\n")
+    stringList.append("\t\treturn node ? lowerNode(*node) : NodeId();\n")
+    stringList.append("\t}\n")
+    stringList.append("\ttemplate <typename T> NodeId lowerNode(const std::optional<T>& node) {\n")
+    stringList.append("\t\treturn node ? lowerNode(*node) : NodeId();\n")
+    stringList.append("\t}\n")
+    stringList.append("\ttemplate <typename T> NodeRange lowerRange(const std::vector<T>& nodes) {\n")
+    stringList.append("\t\t// children lower their own ranges first, collect before appending\n")
+    stringList.append("\t\tstd::vector<NodeId> ids;\n")
+    stringList.append("\t\tids.reserve(nodes.size());\n")
+    stringList.append("\t\tfor (const auto& node : nodes) {\n")
+    stringList.append("\t\t\tids.push_back(lowerNode(node));\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t\treturn tree.addRange(ids);\n")
+    stringList.append("\t}\n")
+    stringList.append("};\n\n")
+    stringList.append("} // namespace ray::compiler::ast::flat\n")
+
+    with open(filePath, "w") as headerFile:
+        headerFile.write("".join(stringList))
+
+
+def walkedFields(clazz: dict, nodeNames: list[str]):
+    # the fields holding child nodes, in the order the builder lowers them
+    return [field["Name"] for field in clazz["Fields"]
+            if flatField(field["Type"], nodeNames)[1] in ("node", "range")]
+
+
+def defineTreeWalkers(outputDir: str, groups: list):
+    filePath = os.path.join(outputDir, "tree_walk.hpp")
+    classes = flatClasses(groups)
+    nodeNames = [clazz["Name"] for clazz in classes]
+    stringList = list[str]()
+    stringList.append("#pragma once\n")
+    for header in ["cstddef", "optional", "vector",
+                   "ray/compiler/ast/expression.hpp",
+                   "ray/compiler/ast/flat.hpp",
+                   "ray/compiler/ast/statement.hpp"]:
+        stringList.append(f"#include <{header}>\n")
+    stringList.append("\n")
+    stringList.append("namespace ray::bench {\n\n")
+
+    # pointer tree, dispatched through the virtual visitors
+    stringList.append("// visits every node of a pointer tree through the virtual visitors the passes\n")
+    stringList.append("// used before the flat tree, children before their parent\n")
+    stringList.append("class PointerTreeWalker : public compiler::ast::ExpressionVisitor,\n")
+    stringList.append("                          public compiler::ast::StatementVisitor {\n")
+    stringList.append("\tsize_t nodes = 0;\n\n")
+    stringList.append("  public:\n")
+    stringList.append("\tsize_t walk(const std::vector<compiler::ast::NodePtr<compiler::ast::Statement>>& statements) {\n")
+    stringList.append("\t\tnodes = 0;\n")
+    stringList.append("\t\twalkChildren(statements);\n")
+    stringList.append("\t\treturn nodes;\n")
+    stringList.append("\t}\n\n")
+    stringList.append("  private:\n")
+    for clazz in classes:
+        children = walkedFields(clazz, nodeNames)
+        parameter = " node" if children else ""
+        stringList.append(f"\tvoid visit{clazz["Name"]}{clazz["Base"]}(const compiler::ast::{clazz["Name"]}&{parameter}) override {{\n")
+        for child in children:
+            stringList.append(f"\t\twalkChildren(node.{child});\n")
+        stringList.append("\t\tnodes++;\n")
+        stringList.append("\t}\n")
+    stringList.append("\n")
+    stringList.append("\ttemplate <typename T> void walkChildren(const T& node) { node.visit(*this); }\n")
+    stringList.append("\ttemplate <typename T> void walkChildren(const compiler::ast::NodePtr<T>& node) {\n")
+    stringList.append("\t\tif (node) {\n")
+    stringList.append("\t\t\twalkChildren(*node);\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t}\n")
+    stringList.append("\ttemplate <typename T> void walkChildren(const std::optional<T>& node) {\n")
+    stringList.append("\t\tif (node) {\n")
+    stringList.append("\t\t\twalkChildren(*node);\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t}\n")
+    stringList.append("\ttemplate <typename T> void walkChildren(const std::vector<T>& nodes) {\n")
+    stringList.append("\t\tfor (const auto& node : nodes) {\n")
+    stringList.append("\t\t\twalkChildren(node);\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t}\n")
+    stringList.append("};\n\n")
+
+    # flat tree, dispatched through the kind switch
+    stringList.append("// visits every node of a flat tree through the kind switch of\n")
+    stringList.append("// flat::Visitor, in the same order as PointerTreeWalker\n")
+    stringList.append("class FlatTreeWalker : public compiler::ast::flat::Visitor<FlatTreeWalker> {\n")
+    stringList.append("\tfriend class compiler::ast::flat::Visitor<FlatTreeWalker>;\n\n")
+    stringList.append("\tsize_t nodes = 0;\n\n")
+    stringList.append("  public:\n")
+    stringList.append("\tsize_t walk(const compiler::ast::flat::Tree& tree) {\n")
+    stringList.append("\t\tbind(tree);\n")
+    stringList.append("\t\tnodes = 0;\n")
+    stringList.append("\t\tfor (compiler::ast::flat::NodeId root : tree.getRoots()) {\n")
+    stringList.append("\t\t\twalkChildren(root);\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t\treturn nodes;\n")
+    stringList.append("\t}\n\n")
+    stringList.append("  private:\n")
+    for clazz in classes:
+        children = walkedFields(clazz, nodeNames)
+        parameter = " node" if children else ""
+        stringList.append(f"\tvoid visit{clazz["Name"]}{clazz["Base"]}(const compiler::ast::flat::{clazz["Name"]}&{parameter}) {{\n")
+        for child in children:
+            stringList.append(f"\t\twalkChildren(node.{child});\n")
+        stringList.append("\t\tnodes++;\n")
+        stringList.append("\t}\n")
+    stringList.append("\n")
+    stringList.append("\tvoid walkChildren(compiler::ast::flat::NodeId id) {\n")
+    stringList.append("\t\tif (id) {\n")
+    stringList.append("\t\t\tvisit(id);\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t}\n")
+    stringList.append("\tvoid walkChildren(compiler::ast::flat::NodeRange range) {\n")
+    stringList.append("\t\tfor (compiler::ast::flat::NodeId id : tree().range(range)) {\n")
+    stringList.append("\t\t\twalkChildren(id);\n")
+    stringList.append("\t\t}\n")
+    stringList.append("\t}\n")
+    stringList.append("};\n\n")
+    stringList.append("} // namespace ray::bench\n")
+
+    with open(filePath, "w") as headerFile:
+        headerFile.write("".join(stringList))
+
+
+expressionHeaders = ["memory",
+                     "vector",
+                     "optional",
+                     "ray/compiler/lexer/token.hpp",
+                     "ray/compiler/ast/arena.hpp",
+                     "ray/compiler/ast/intrinsic.hpp"
+                    ]
+expressionTypes = ["Variable		= Token name",
+                   "Intrinsic		= Token name, IntrinsicType intrinsic",
+                   "Assign		= NodePtr<Expression> lhs, Token assignmentOp, NodePtr<Expression> rhs",
+                   "Binary		= NodePtr<Expression> left, Token op, NodePtr<Expression> right",
+                   "Call			= NodePtr<Expression> callee, Token paren, std::vector<NodePtr<Expression>> arguments",
+                   "IntrinsicCall	= NodePtr<Intrinsic> callee, Token paren, std::vector<NodePtr<Expression>> arguments",
+                   "Get			= NodePtr<Expression> object, Token name",
+                   "Grouping		= NodePtr<Expression> expression",
+                   "Literal		= Token kind, std::string_view value",
+                   "Logical		= NodePtr<Expression> left, Token op, NodePtr<Expression> right",
+                   "Set			= NodePtr<Expression> object, Token name, Token assignmentOp, NodePtr<Expression> value",
+                   "Unary			= Token op, bool isPrefix, NodePtr<Expression> expr",
+                   "ArrayAccess	= NodePtr<Expression> array, NodePtr<Expression> index",
+                   "ArrayType		= bool isMutable, NodePtr<Expression> subType",
+                   "TupleType		= bool isMutable, std::vector<NodePtr<Expression>> expressions",
+                   "PointerType	= bool isMutable, NodePtr<Expression> subtype",
+                   "NamedType		= Token name, bool isMutable",
+                   "Cast			= NodePtr<Expression> expression, NodePtr<Expression> type",
+                   "Parameter		= Token name, NodePtr<Expression> type",
+                  ]
+
+statementHeaders = ["memory",
+                    "unordered_map",
+                    "vector",
+                    "optional",
+                    "ray/compiler/lexer/token.hpp",
+                    "ray/compiler/ast/arena.hpp",
+                    "ray/compiler/ast/expression.hpp"
+                   ]
+statementDefinitions = ["CompDirectiveAttr = std::unordered_map<std::string, std::string>"]
+statementTypes = ["Block			= std::vector<NodePtr<Statement>> statements",
+                  "TerminalExpr	= std::optional<NodePtr<Expression>> expression",
+                  "ExpressionStmt= NodePtr<Expression> expression",
+                  "Function		= Token name, bool publicVisibility, std::vector<Parameter> params, std::optional<Block> body, NodePtr<ast::Expression> returnType",
+                  "If			= NodePtr<Expression> condition, NodePtr<Statement> thenBranch, std::optional<NodePtr<Statement>> elseBranch",
+                  "Jump			= Token keyword, std::optional<NodePtr<Expression>> returnValue",
+                  "VarDecl		= Token name, NodePtr<Expression> type, bool is_mutable, std::optional<NodePtr<Expression>> initializer",
+                  "Member		= Token name, NodePtr<Expression> type, bool is_mutable, std::optional<NodePtr<Expression>> initializer",
+                  "While			= NodePtr<Expression> condition, NodePtr<Statement> body",
+                  "Struct		= Token name, bool publicVisibility, bool declaration, std::vector<Member> members, std::vector<bool> memberVisibility",
+                  "CompDirective	= Token name, CompDirectiveAttr values, NodePtr<Statement> child"
+                 ]
+
+
 def main():
     outputDir = "./RayC/include/ray/compiler/ast"
-    defineAst(outputDir, "Expression",
-            ["memory",
-             "vector",
-             "optional",
-             "ray/compiler/lexer/token.hpp",
-             "ray/compiler/ast/intrinsic.hpp"
-            ],
-            [],
-            ["Variable		= Token name",
-             "Intrinsic		= Token name, IntrinsicType intrinsic",
-             "Assign		= std::unique_ptr<Expression> lhs, Token assignmentOp, std::unique_ptr<Expression> rhs",
-             "Binary		= std::unique_ptr<Expression> left, Token op, std::unique_ptr<Expression> right",
-             "Call			= std::unique_ptr<Expression> callee, Token paren, std::vector<std::unique_ptr<Expression>> arguments",
-             "IntrinsicCall	= std::unique_ptr<Intrinsic> callee, Token paren, std::vector<std::unique_ptr<Expression>> arguments",
-             "Get			= std::unique_ptr<Expression> object, Token name",
-             "Grouping		= std::unique_ptr<Expression> expression",
-             "Literal		= Token kind, std::string value",
-             "Logical		= std::unique_ptr<Expression> left, Token op, std::unique_ptr<Expression> right",
-             "Set			= std::unique_ptr<Expression> object, Token name, Token assignmentOp, std::unique_ptr<Expression> value",
-             "Unary			= Token op, bool isPrefix, std::unique_ptr<Expression> expr",
-             "ArrayAccess	= std::unique_ptr<Expression> array, std::unique_ptr<Expression> index",
-			 "ArrayType		= bool isMutable, std::unique_ptr<Expression> subType",
-			 "TupleType		= bool isMutable, std::vector<std::unique_ptr<Expression>> expressions",
-			 "PointerType	= bool isMutable, std::unique_ptr<Expression> subtype",
-             "NamedType		= Token name, bool isMutable",
-             "Cast			= std::unique_ptr<Expression> expression, std::unique_ptr<Expression> type",
-             "Parameter		= Token name, std::unique_ptr<Expression> type",
-            ])
-    defineAst(outputDir, "Statement",
-            ["memory",
-             "unordered_map",
-             "vector",
-             "optional",
-             "ray/compiler/lexer/token.hpp",
-             "ray/compiler/ast/expression.hpp"
-            ],
-            ["CompDirectiveAttr = std::unordered_map<std::string, std::string>"],
-            ["Block			= std::vector<std::unique_ptr<Statement>> statements",
-             "TerminalExpr	= std::optional<std::unique_ptr<Expression>> expression",
-             "ExpressionStmt= std::unique_ptr<Expression> expression",
-             "Function		= Token name, bool publicVisibility, std::vector<Parameter> params, std::optional<Block> body, std::unique_ptr<ast::Expression> returnType",
-             "If			= std::unique_ptr<Expression> condition, std::unique_ptr<Statement> thenBranch, std::optional<std::unique_ptr<Statement>> elseBranch",
-             "Jump			= Token keyword, std::optional<std::unique_ptr<Expression>> returnValue",
-             "VarDecl		= Token name, std::unique_ptr<Expression> type, bool is_mutable, std::optional<std::unique_ptr<Expression>> initializer",
-             "Member		= Token name, std::unique_ptr<Expression> type, bool is_mutable, std::optional<std::unique_ptr<Expression>> initializer",
-             "While			= std::unique_ptr<Expression> condition, std::unique_ptr<Statement> body",
-             "Struct		= Token name, bool publicVisibility, bool declaration, std::vector<Member> members, std::vector<bool> memberVisibility",
-             "CompDirective	= Token name, CompDirectiveAttr values, std::unique_ptr<Statement> child"
-            ])
+    defineAst(outputDir, "Expression", expressionHeaders, [], expressionTypes)
+    defineAst(outputDir, "Statement", statementHeaders, statementDefinitions,
+              statementTypes)
+    groups = [("Expression", preprocessTypes("Expression", expressionTypes)),
+              ("Statement", preprocessTypes("Statement", statementTypes))]
+    defineFlatAst(outputDir, statementDefinitions, groups)
+    defineFlatBuilder(outputDir, groups)
+    defineTreeWalkers("./RayC/bench", groups)
 
 
 if __name__ == "__main__":